@@ -0,0 +1,165 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <utility>
+#include <vector>
+
+namespace OpenMS
+{
+
+/**
+  @brief An inverted index from fragment m/z to peptides for fast candidate selection in database searches.
+
+  Instead of generating a theoretical spectrum for every peptide whose precursor mass matches a spectrum, all fragment
+  ions of all candidate peptides are binned once: each bin lists the peptides (in ascending order) that have a fragment
+  in this bin. A spectrum is then queried by looking up the bins of its peaks and counting, for each peptide of a
+  precursor mass range, how many peaks hit one of its fragments. Only the best candidates need to be scored in detail.
+
+  Peptides must be added in ascending order of their precursor mass, so a precursor mass window corresponds to a
+  contiguous range of peptide indices (see getPeptideRange()). Within a bin, the peptides are stored as 32 bit
+  integers (peptide index and ion series), so a precursor window is found by binary search in each bin.
+
+  Bins are as wide as the fragment tolerance (in Da or, for ppm tolerances, on a logarithmic m/z scale).
+  A peak is looked up in all bins overlapping its tolerance window, so the counts are an upper bound of the matches
+  a scoring function with the same tolerance will find.
+
+  The fragments of each peptide are kept as well (see getSpectrum()) for scoring the selected candidates.
+
+  The index is read-only after build() and can be queried from multiple threads concurrently.
+*/
+class OPENMS_DLLAPI FragmentIndex
+{
+public:
+  /// number of fragment peaks of a peptide matched by a spectrum
+  struct Match
+  {
+    Size peptide_index = 0;    ///< index of the peptide (in insertion order)
+    UInt32 matched_prefix = 0; ///< number of peaks matching prefix (e.g. b) ions
+    UInt32 matched_suffix = 0; ///< number of peaks matching suffix (e.g. y) ions
+
+    Size matched() const { return matched_prefix + matched_suffix; }
+  };
+
+  /// scratch space of query(), reused between queries (one per thread)
+  struct QueryBuffer
+  {
+    std::vector<Match> counts;   ///< counts per peptide of the queried range (all zero between queries)
+    std::vector<UInt32> touched; ///< peptides of the range with at least one match
+  };
+
+  /// Default constructor (fragment tolerance of 10 ppm)
+  FragmentIndex() = default;
+
+  /// Constructor with the fragment tolerance that determines the bin width
+  FragmentIndex(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm);
+
+  /**
+    @brief Add a peptide and its (singly charged) fragment ions; returns the index of the peptide
+
+    @param precursor_mass Neutral mass of the peptide. Must not be smaller than the mass of the previously added peptide.
+    @param prefix_mz m/z of the prefix (e.g. b) ions in ascending order
+    @param suffix_mz m/z of the suffix (e.g. y) ions in ascending order
+
+    @throw Exception::IllegalArgument if the peptides are not added in order of their mass or the index is already built
+  */
+  Size addPeptide(double precursor_mass, const std::vector<double>& prefix_mz, const std::vector<double>& suffix_mz);
+
+  /// Build the inverted index from all added peptides. Must be called before query().
+  void build();
+
+  /// Remove all peptides (keeps the tolerance)
+  void clear();
+
+  /// number of peptides
+  Size size() const;
+
+  /// number of fragments of all peptides
+  Size getFragmentCount() const;
+
+  /// precursor mass of peptide @p peptide_index
+  double getPrecursorMass(Size peptide_index) const;
+
+  /// the half-open range of peptide indices with a precursor mass in [@p min_mass, @p max_mass]
+  std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const;
+
+  /**
+    @brief Theoretical spectrum of peptide @p peptide_index, sorted by m/z
+
+    Peaks have an intensity of 1 and are annotated with the ion names ("b2+", "y3+", ...) in the first StringDataArray,
+    as generated by @ref TheoreticalSpectrumGenerator with add_metainfo, so the result can be scored directly (e.g. by HyperScore).
+    Names assume that all suffix ions (y1 to y(n-1)) were added; prefix ions are numbered accordingly.
+  */
+  void getSpectrum(Size peptide_index, PeakSpectrum& spectrum) const;
+
+  /**
+    @brief Count the fragments of peptides [@p first, @p last) matched by the peaks of @p spectrum
+
+    @param spectrum The (centroided) experimental spectrum
+    @param first First peptide index to consider (see getPeptideRange())
+    @param last One past the last peptide index to consider
+    @param min_matched Report only peptides with at least this many matched fragments
+    @param max_matches Report only the peptides with most matched fragments (0 = all)
+    @param matches The result, sorted by number of matched fragments (descending) and peptide index
+    @param buffer Scratch space, which grows to the largest queried range and should be reused for all queries of a thread
+  */
+  void query(const PeakSpectrum& spectrum, Size first, Size last, Size min_matched, Size max_matches, std::vector<Match>& matches, QueryBuffer& buffer) const;
+
+  /// Same as above, but with a temporary buffer (allocated for each call)
+  void query(const PeakSpectrum& spectrum, Size first, Size last, Size min_matched, Size max_matches, std::vector<Match>& matches) const;
+
+protected:
+  /// bin of @p mz (before subtracting min_bin_)
+  Int64 bin_(double mz) const;
+
+  double fragment_mass_tolerance_ = 10.0;       ///< fragment tolerance (Da or ppm)
+  bool fragment_mass_tolerance_unit_ppm_ = true;///< is the tolerance in ppm?
+  double inv_bin_width_ = 0.0;                  ///< 1 / bin width (in Da or on the log m/z scale)
+  bool built_ = false;                          ///< has build() been called?
+
+  std::vector<double> precursor_masses_;        ///< peptide masses (ascending)
+  std::vector<Size> fragment_offsets_;          ///< start of each peptide's fragments in fragment_mz_ (plus end)
+  std::vector<UInt32> prefix_counts_;           ///< number of prefix ions of each peptide
+  std::vector<double> fragment_mz_;             ///< prefix ions followed by suffix ions of each peptide
+
+  Int64 min_bin_ = 0;                           ///< bin of the smallest fragment
+  std::vector<Size> bin_offsets_;               ///< start of each bin in bin_entries_ (plus end)
+  std::vector<UInt32> bin_entries_;             ///< (peptide index << 1 | is_suffix) per fragment, grouped by bin, ascending
+};
+
+} // namespace OpenMS
@@ -0,0 +1,220 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+  namespace iostreams
+  {
+    class mapped_file_source;
+  }
+}
+
+namespace OpenMS
+{
+
+/**
+  @brief A persistent database of digested and modified candidate peptides, sorted by mass.
+
+  Database search engines digest the protein database and enumerate the modified variants of each peptide on every
+  run. This class does it once: build() digests the proteins, removes duplicate peptides, applies fixed and variable
+  modifications (@ref ModifiedPeptideGenerator) and writes all candidates, sorted by their monoisotopic mass, to a binary file.
+  load() maps such a file into memory, so candidates for a precursor mass are found by binary search (getCandidateRange())
+  without reading or parsing the whole file.
+
+  Each candidate stores its mass, its modified sequence (as written by AASequence::toString()), the unmodified
+  peptide it was derived from and the index of the modified variant (as enumerated by ModifiedPeptideGenerator::applyVariableModifications()).
+  Each unmodified peptide stores the proteins it was digested from.
+
+  Peptides containing ambiguous amino acids (B, X, Z) are skipped.
+
+  A database is only valid for the proteins and settings it was built from. These are summarized by Settings::getKey(),
+  which is stored in the file and should be compared to the current settings after loading (see isCompatible()).
+
+  All access functions are const and thread-safe.
+*/
+class OPENMS_DLLAPI PeptideDatabase
+{
+public:
+  /// proteins and digestion/modification settings a database is built from
+  struct OPENMS_DLLAPI Settings
+  {
+    String checksum;                ///< identifier of the protein list (e.g. SHA1 of the FASTA file, plus anything that changes the proteins, like decoy generation)
+    String enzyme = "Trypsin";      ///< enzyme (see ProteaseDB)
+    Size missed_cleavages = 1;      ///< number of missed cleavages
+    Size min_length = 7;            ///< minimum peptide length
+    Size max_length = 40;           ///< maximum peptide length (0 = no limit)
+    StringList fixed_modifications;    ///< fixed modifications (UniMod terms)
+    StringList variable_modifications; ///< variable modifications (UniMod terms)
+    Size max_variable_mods_per_peptide = 2; ///< maximum number of variable modifications per peptide
+
+    /// string representation of all settings, stored in the database file
+    String getKey() const;
+  };
+
+  /// a (modified) candidate peptide; record layout in the database file
+  struct Candidate
+  {
+    double mono_mass;        ///< monoisotopic mass (uncharged)
+    UInt32 peptide_index;    ///< index of the unmodified peptide (see getPeptide())
+    UInt32 mod_index;        ///< index of the modified variant of the peptide
+    UInt64 sequence_offset;  ///< position of the modified sequence in the text section
+    UInt32 sequence_length;  ///< length of the modified sequence
+    UInt32 reserved;         ///< padding (always zero)
+  };
+
+  /// an unmodified peptide; record layout in the database file
+  struct Peptide
+  {
+    UInt64 sequence_offset;  ///< position of the sequence in the text section
+    UInt32 sequence_length;  ///< length of the sequence
+    UInt32 protein_count;    ///< number of proteins containing the peptide
+    UInt64 protein_offset;   ///< position of the first protein reference (see getProteinIndex())
+  };
+
+  /// Default constructor (no database loaded)
+  PeptideDatabase();
+
+  /// Destructor, unmaps the file
+  ~PeptideDatabase();
+
+  PeptideDatabase(const PeptideDatabase&) = delete;
+  PeptideDatabase& operator=(const PeptideDatabase&) = delete;
+
+  /**
+    @brief Digest and modify @p proteins and write the resulting candidates to @p filename
+
+    Digestion is parallelized over proteins (OpenMP). Duplicate peptides are removed by sorting, not by a shared lookup.
+    The database is written to a temporary file in the same directory, which then replaces @p filename.
+
+    @throw Exception::UnableToCreateFile if the file cannot be written
+    @throw Exception::InvalidSize if the database exceeds the limits of the file format (2^32 peptides)
+  */
+  static void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings, const String& filename);
+
+  /**
+    @brief Map the database file @p filename into memory
+
+    @throw Exception::FileNotFound if the file cannot be opened or mapped
+    @throw Exception::ParseError if the file is not a peptide database or has an unsupported version
+  */
+  void load(const String& filename);
+
+  /// Unmap the loaded database (if any)
+  void clear();
+
+  /// is a database loaded?
+  bool isLoaded() const;
+
+  /// the key of the settings the loaded database was built with
+  const String& getKey() const;
+
+  /// was the loaded database built with @p settings?
+  bool isCompatible(const Settings& settings) const;
+
+  /// number of candidates
+  Size size() const;
+
+  /// candidate @p index (candidates are sorted by mass)
+  const Candidate& getCandidate(Size index) const;
+
+  /// the half-open range of candidates with a mass in [@p min_mass, @p max_mass]
+  std::pair<Size, Size> getCandidateRange(double min_mass, double max_mass) const;
+
+  /// modified sequence of candidate @p index (e.g. "PEPM(Oxidation)TIDEK")
+  StringView getModifiedSequence(Size index) const;
+
+  /// number of unmodified peptides
+  Size getPeptideCount() const;
+
+  /// unmodified peptide @p index
+  const Peptide& getPeptide(Size index) const;
+
+  /// sequence of unmodified peptide @p index
+  StringView getPeptideSequence(Size index) const;
+
+  /// number of proteins the database was built from
+  Size getProteinCount() const;
+
+  /// index (in the protein list given to build()) of the @p i-th protein of @p peptide
+  Size getProteinIndex(const Peptide& peptide, Size i) const;
+
+  /// accession of protein @p index
+  StringView getProteinAccession(Size index) const;
+
+protected:
+  /// Read a UInt64 field at @p offset and advance @p offset (with bounds check)
+  UInt64 readSize_(Size& offset) const;
+
+  /// Pointer to a section of @p count elements of size @p element_size at @p offset; advances @p offset to the next 8 byte boundary
+  const char* readSection_(Size& offset, Size count, Size element_size) const;
+
+  /// The mapping
+  std::unique_ptr<boost::iostreams::mapped_file_source> file_;
+
+  /// Name of the mapped file
+  String filename_;
+
+  /// Settings key of the loaded database
+  String key_;
+
+  /// Start and size of the mapped data
+  const char* data_ = nullptr;
+  Size size_ = 0;
+
+  /// Sections of the mapping
+  const Candidate* candidates_ = nullptr;
+  Size candidate_count_ = 0;
+  const Peptide* peptides_ = nullptr;
+  Size peptide_count_ = 0;
+  const UInt32* protein_refs_ = nullptr;
+  Size protein_ref_count_ = 0;
+  const UInt64* accession_offsets_ = nullptr;
+  Size protein_count_ = 0;
+  const char* text_ = nullptr;
+  Size text_size_ = 0;
+};
+
+} // namespace OpenMS
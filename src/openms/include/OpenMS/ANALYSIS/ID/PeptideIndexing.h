@@ -34,6 +34,7 @@
 
 #pragma once
 
+#include <OpenMS/ANALYSIS/ID/ProteinSequenceIndex.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/DATASTRUCTURES/FASTAContainer.h>
@@ -44,8 +45,11 @@
 #include <OpenMS/METADATA/PeptideIdentification.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 
+#include <functional>
+
 namespace OpenMS
 {
+  class ProteaseDigestion;
 
 /**
   @brief Refreshes the protein references for all peptide hits in a vector of PeptideIdentifications and adds target/decoy information.
@@ -108,6 +112,11 @@ namespace OpenMS
   Threading:
   This tool support multiple threads (@p threads option) to speed up computation, at the cost of little extra memory.
 
+  Persistent index:
+  When many runs are indexed against the same database, build a @ref ProteinSequenceIndex once (and store it to disk) and pass it to run().
+  Exact matches are then found by binary search in a suffix array (with the peptides sharded across threads), and only the few proteins containing
+  ambiguous amino acids are scanned with Aho-Corasick. Results are identical to a full database scan.
+
 */
 
  class OPENMS_DLLAPI PeptideIndexing :
@@ -195,6 +204,17 @@ public:
     /// Same as run() with TFI_File, but for proteins which are already in memory
     ExitCodes run(FASTAContainer<TFI_Vector>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids);
 
+    /**
+      @brief Same as run() with TFI_File, but uses a prebuilt protein-side index of the database
+
+      Use this to index many runs against the same database: the index is built (or loaded) once and each run only costs
+      a few binary searches per peptide. Results are identical to the other run() methods.
+      If 'mismatches_max' is larger than zero, all proteins need to be scanned with Aho-Corasick and the index does not save any time.
+
+      @throw Exception::InvalidParameter if the index was built with a different 'IL_equivalent' setting
+    */
+    ExitCodes run(const ProteinSequenceIndex& index, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids);
+
     /// Which string is used to determine if a protein is a decoy or not
     const String& getDecoyString() const;
 
@@ -206,6 +226,19 @@ public:
 
     template<typename T> ExitCodes run_(FASTAContainer<T>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids);
 
+    /// search results (peptide to protein matches and protein annotation); defined in the .cpp
+    struct SearchResult_;
+
+    /// determine decoy string (if not given), enzyme and its specificity from parameters and @p prot_ids
+    template<typename T> void prepare_(FASTAContainer<T>& proteins, const std::vector<ProteinIdentification>& prot_ids, ProteaseDigestion& enzyme, bool& xtandem_fix_parameters);
+
+    /// handle empty @p pep_ids (i.e. clear protein hits, if requested)
+    ExitCodes emptyPeptideIds_(std::vector<ProteinIdentification>& prot_ids) const;
+
+    /// annotate @p pep_ids and @p prot_ids with the search results; @p read_protein fetches a database entry by index
+    ExitCodes annotate_(SearchResult_& result, const Size protein_count, const std::function<void(Size, FASTAFile::FASTAEntry&)>& read_protein,
+                        std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids);
+
     String decoy_string_{};
     bool prefix_{ false };
     MissingDecoy missing_decoy_action_ = MissingDecoy::IS_ERROR;
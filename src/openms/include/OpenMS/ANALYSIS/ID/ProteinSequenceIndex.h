@@ -0,0 +1,156 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <OpenMS/ANALYSIS/ID/AhoCorasickAmbiguous.h>
+#include <OpenMS/DATASTRUCTURES/FASTAContainer.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+/**
+  @brief A persistent, protein-side index of a sequence database for repeated peptide-to-protein lookups.
+
+  @ref PeptideIndexing normally builds an Aho-Corasick trie from the peptides of a single search and then scans the whole database.
+  When many runs are indexed against the same (large) database, most of this work can be done once: this class stores the database entries
+  together with a suffix array over the (preprocessed) protein sequences. Exact occurrences of a peptide are then found by
+  two binary searches, independent of the database size.
+
+  Sequences are preprocessed exactly like @ref PeptideIndexing does for a scan (stop codons '*' are removed and, if requested,
+  'L' and 'J' are converted to 'I'). Proteins which still contain ambiguous amino acids (B, J, Z, X) or any character other than
+  the uppercase letters 'A' to 'Z' cannot be matched exactly and are therefore excluded from the suffix array; they are listed
+  in getAmbiguousProteins() and need to be searched with Aho-Corasick (which is cheap, since there are usually only a few of them).
+
+  The index can be stored to and loaded from a binary file. It carries a user-defined checksum of the database it was
+  built from (e.g. the SHA1 of the FASTA file) so callers can decide if a stored index is still valid.
+
+  Building the suffix array is parallelized (OpenMP) and the index is read-only afterwards, i.e. it can be queried from multiple threads concurrently.
+*/
+class OPENMS_DLLAPI ProteinSequenceIndex
+{
+public:
+  /// an exact occurrence of a peptide in a protein
+  struct Occurrence
+  {
+    Hit::T protein_index; ///< index of the protein (in database order)
+    Hit::T position;      ///< position of the peptide within the (preprocessed) protein sequence
+  };
+
+  /// Default constructor (empty index)
+  ProteinSequenceIndex() = default;
+
+  /**
+    @brief Build the index from a database
+
+    @param proteins The database (read once, from start to end)
+    @param IL_equivalent Convert 'L' and 'J' to 'I' (see @ref PeptideIndexing)
+    @param checksum Identifier of the database (e.g. a SHA1 of the FASTA file), stored verbatim; see getChecksum()
+
+    @throw Exception::InvalidSize if the preprocessed sequences exceed 4 GB in total
+  */
+  void build(FASTAContainer<TFI_File>& proteins, bool IL_equivalent, const String& checksum);
+
+  /// Same as build() with TFI_File, but for proteins which are already in memory
+  void build(FASTAContainer<TFI_Vector>& proteins, bool IL_equivalent, const String& checksum);
+
+  /**
+    @brief Store the index in binary format
+
+    @throw Exception::UnableToCreateFile if the file cannot be written
+  */
+  void store(const String& filename) const;
+
+  /**
+    @brief Load an index previously written by store()
+
+    @throw Exception::FileNotFound if the file does not exist
+    @throw Exception::ParseError if the file is not an index file or has an unsupported version
+  */
+  void load(const String& filename);
+
+  /// the checksum given to build()
+  const String& getChecksum() const;
+
+  /// was the index built with 'IL_equivalent'?
+  bool isILEquivalent() const;
+
+  /// number of proteins in the index
+  Size size() const;
+
+  /// is the index empty?
+  bool empty() const;
+
+  /// the original database entries (in database order)
+  const std::vector<FASTAFile::FASTAEntry>& getEntries() const;
+
+  /// the preprocessed sequence of protein @p protein_index (as searched and validated by @ref PeptideIndexing)
+  const String& getSearchSequence(Size protein_index) const;
+
+  /// indices of proteins not covered by the suffix array (see class description), in ascending order
+  const std::vector<Hit::T>& getAmbiguousProteins() const;
+
+  /// does any protein contain '[' or '(' (usually indicating modifications, which are not allowed)?
+  bool hasInvalidSequences() const;
+
+  /**
+    @brief Find all exact occurrences of @p peptide in proteins covered by the suffix array
+
+    Occurrences are appended to @p result in no particular order.
+  */
+  void findExact(const std::string& peptide, std::vector<Occurrence>& result) const;
+
+protected:
+  template<typename T> void build_(FASTAContainer<T>& proteins, bool IL_equivalent, const String& checksum);
+
+  /// sort all (non-ambiguous) suffixes of text_ into sa_
+  void buildSuffixArray_();
+
+  String checksum_;                              ///< user-defined database checksum
+  bool IL_equivalent_ = false;                   ///< were 'L' and 'J' converted to 'I'?
+  bool has_invalid_sequences_ = false;           ///< any '[' or '(' in a protein sequence?
+  std::vector<FASTAFile::FASTAEntry> entries_;   ///< original database entries
+  std::string text_;                             ///< preprocessed sequences, each one followed by '$'
+  std::vector<Hit::T> offsets_;                  ///< start of each protein in text_ (plus end of text_)
+  std::vector<String> search_sequences_;         ///< preprocessed sequences (same as in text_, not stored in the index file)
+  std::vector<Hit::T> ambiguous_;                ///< proteins excluded from the suffix array
+  std::vector<Hit::T> sa_;                       ///< suffix array (positions in text_)
+};
+
+} // namespace OpenMS
@@ -32,10 +32,15 @@
 // $Authors: Timo Sachsenberg $
 // --------------------------------------------------------------------------
 
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 
+#include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
 #include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
+#include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
+#include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/DATASTRUCTURES/StringView.h>
 
@@ -93,6 +98,49 @@ class OPENMS_DLLAPI SimpleSearchEngineAlgorithm :
     /// @brief filter, deisotope, decharge spectra
     static void preprocessSpectra_(PeakMap& exp, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm);
 
+    /// @brief splits the singly charged fragments of @p peptide computed by @p generator (b and y ions only) into ascending prefix and suffix m/z; @p ions is a reusable buffer
+    static void getFragmentMZs_(const TheoreticalSpectrumGenerator& generator,
+      const AASequence& peptide,
+      std::vector<TheoreticalSpectrumGenerator::FragmentIon>& ions,
+      std::vector<double>& prefix_mz,
+      std::vector<double>& suffix_mz);
+
+    /// @brief score each digested (and modified) peptide against all spectra with a matching precursor mass
+    void searchClassic_(const PeakMap& spectra,
+      const std::vector<FASTAFile::FASTAEntry>& fasta_db,
+      const ProteaseDigestion& digestor,
+      const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+      const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+      std::vector<std::vector<AnnotatedHit_> >& annotated_hits) const;
+
+    /// @brief index the fragments of all (modified) peptides once and score each spectrum against its best candidates in the index
+    /// The candidates are taken from @p peptide_db if given, otherwise @p fasta_db is digested.
+    void searchFragmentIndex_(const PeakMap& spectra,
+      const std::vector<FASTAFile::FASTAEntry>& fasta_db,
+      const PeptideDatabase* peptide_db,
+      const ProteaseDigestion& digestor,
+      const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+      const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+      std::vector<std::vector<AnnotatedHit_> >& annotated_hits) const;
+
+    /// @brief score each candidate of @p peptide_db against all spectra with a matching precursor mass (one theoretical spectrum per candidate)
+    void searchPeptideDatabase_(const PeakMap& spectra,
+      const PeptideDatabase& peptide_db,
+      std::vector<std::vector<AnnotatedHit_> >& annotated_hits) const;
+
+    /// @brief load the peptide database cache (or build it, if missing or built from a different database or with different settings)
+    void loadPeptideDatabase_(const String& in_db,
+      const std::vector<FASTAFile::FASTAEntry>& fasta_db,
+      const ProteaseDigestion& digestor,
+      PeptideDatabase& peptide_db) const;
+
+    /// @brief candidate mass ranges (one per precursor isotope, merged if overlapping) of @p spectrum
+    /// @return false if the spectrum is not searched (see classic search)
+    bool getCandidateMassRanges_(const PeakSpectrum& spectrum, std::vector<std::pair<double, double> >& mass_ranges) const;
+
+    /// @brief add a scored candidate to the hits of a spectrum (keeps at most 2 * report:top_hits hits)
+    void addHit_(std::vector<AnnotatedHit_>& hits, const StringView& sequence, SignedSize peptide_mod_index, double score, const HyperScore::PSMDetail& detail) const;
+
     /// @brief filter and annotate search results
     /// most of the parameters are used to properly add meta data to the id objects
     void postProcessHits_(const PeakMap& exp, 
@@ -146,6 +194,13 @@ class OPENMS_DLLAPI SimpleSearchEngineAlgorithm :
     String peptide_motif_;
 
     Size report_top_hits_;
+
+    String search_mode_;
+
+    String database_cache_;
+
+    Size fragment_index_candidates_;
+    Size fragment_index_min_matched_peaks_;
 };
 
 } // namespace
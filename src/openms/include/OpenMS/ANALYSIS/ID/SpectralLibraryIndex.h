@@ -0,0 +1,222 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/DATASTRUCTURES/StringView.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+  namespace iostreams
+  {
+    class mapped_file_source;
+  }
+}
+
+namespace OpenMS
+{
+
+/**
+  @brief A persistent, precursor m/z sorted index of a spectral library with a parallel batch search.
+
+  Spectral library search tools load the whole library into an MSExperiment and compare each query against the
+  library spectra in its precursor window. This class stores the library once in a compact binary file:
+  build() sorts the library spectra by precursor m/z and packs their peaks into two flat arrays
+  (m/z and intensity, the latter pre-normalized to unit length). load() maps such a file into memory,
+  so the library is available without parsing it and only the pages of the candidates actually compared are read.
+
+  search() scores a batch of query spectra against the library in parallel (OpenMP over queries, with thread local
+  scratch buffers). The score is the normalized dot product (cosine) of the intensities of matched peaks,
+  where peaks are matched one-to-one in order of m/z within the fragment tolerance.
+
+  Each entry stores the index of the spectrum in the library given to build() and an optional label
+  (e.g. the peptide sequence), so results can be annotated without loading the original library.
+
+  A library index is only valid for the library and preprocessing it was built from. A caller-defined key
+  (e.g. a checksum of the library file and the preprocessing settings) is stored in the file and should
+  be compared after loading.
+
+  All access functions are const and thread-safe.
+*/
+class OPENMS_DLLAPI SpectralLibraryIndex
+{
+public:
+  /// a library spectrum; record layout in the index file
+  struct Entry
+  {
+    double precursor_mz;    ///< precursor m/z
+    double rt;              ///< retention time of the library spectrum
+    Int32 charge;           ///< precursor charge (0 = unknown)
+    UInt32 library_index;   ///< index of the spectrum in the library given to build()
+    UInt64 peak_offset;     ///< position of the first peak in the peak arrays
+    UInt32 peak_count;      ///< number of peaks
+    UInt32 label_length;    ///< length of the label
+    UInt64 label_offset;    ///< position of the label in the text section
+    double norm;            ///< Euclidean norm of the original intensities (stored intensities are divided by it)
+  };
+
+  /// a scored library entry
+  struct Match
+  {
+    Size entry_index;  ///< index of the matching entry (see getEntry())
+    double score;      ///< normalized dot product
+    Int isotope;       ///< isotopic misassignment of the query precursor that led to the match
+  };
+
+  /// settings of search()
+  struct SearchParameters
+  {
+    double precursor_mass_tolerance = 10.0;      ///< precursor m/z tolerance
+    bool precursor_mass_tolerance_ppm = true;    ///< precursor tolerance in ppm (otherwise Th)
+    double fragment_mass_tolerance = 0.5;        ///< fragment m/z tolerance
+    bool fragment_mass_tolerance_ppm = false;    ///< fragment tolerance in ppm (otherwise Th)
+    IntList isotopes = {0};                      ///< precursor isotopic misassignments to consider (only used if the query charge is known)
+    bool match_charge = true;                    ///< skip entries with a known charge different from a known query charge
+    Size top_hits = 10;                          ///< maximum number of matches reported per query (0 = all)
+  };
+
+  /// Default constructor (no index loaded)
+  SpectralLibraryIndex();
+
+  /// Destructor, unmaps the file
+  ~SpectralLibraryIndex();
+
+  SpectralLibraryIndex(const SpectralLibraryIndex&) = delete;
+  SpectralLibraryIndex& operator=(const SpectralLibraryIndex&) = delete;
+
+  /**
+    @brief Sort @p library by precursor m/z and write it to @p filename
+
+    Spectra without precursor are skipped. Peaks are stored as given (the library should already be preprocessed).
+
+    @param library Library spectra (peaks sorted by m/z)
+    @param labels Optional label per library spectrum (empty or of the same size as @p library)
+    @param key Identifier of the library and its preprocessing, stored in the file (see getKey())
+    @param filename The index file
+
+    @throw Exception::IllegalArgument if the number of labels does not match the library
+    @throw Exception::UnableToCreateFile if the file cannot be written
+    @throw Exception::InvalidSize if the library exceeds the limits of the file format (2^32 spectra)
+  */
+  static void build(const PeakMap& library, const std::vector<String>& labels, const String& key, const String& filename);
+
+  /**
+    @brief Map the index file @p filename into memory
+
+    @throw Exception::FileNotFound if the file cannot be opened or mapped
+    @throw Exception::ParseError if the file is not a spectral library index or has an unsupported version
+  */
+  void load(const String& filename);
+
+  /// Unmap the loaded index (if any)
+  void clear();
+
+  /// is an index loaded?
+  bool isLoaded() const;
+
+  /// the key given to build()
+  const String& getKey() const;
+
+  /// number of entries
+  Size size() const;
+
+  /// entry @p index (entries are sorted by precursor m/z)
+  const Entry& getEntry(Size index) const;
+
+  /// the half-open range of entries with a precursor m/z in [@p min_mz, @p max_mz]
+  std::pair<Size, Size> getPrecursorRange(double min_mz, double max_mz) const;
+
+  /// label of entry @p index
+  StringView getLabel(Size index) const;
+
+  /// restores the peaks (with original intensities) of entry @p index into @p spectrum
+  void getSpectrum(Size index, PeakSpectrum& spectrum) const;
+
+  /**
+    @brief Score @p queries against all entries in their precursor windows
+
+    Queries are processed in parallel. Each query needs a precursor and peaks sorted by m/z.
+    @p results contains one list of matches per query, sorted by decreasing score.
+  */
+  void search(const std::vector<PeakSpectrum>& queries, const SearchParameters& params, std::vector<std::vector<Match> >& results) const;
+
+  /// normalized dot product of the (sorted) peaks of @p query and entry @p index (see search())
+  double score(const PeakSpectrum& query, Size index, double fragment_mass_tolerance, bool fragment_mass_tolerance_ppm) const;
+
+protected:
+  /// dot product of peaks with pre-normalized @p query_intensities and entry @p index
+  double score_(const PeakSpectrum& query, const std::vector<double>& query_intensities, Size index, double fragment_mass_tolerance, bool fragment_mass_tolerance_ppm) const;
+
+  /// unit length intensities of @p query
+  static void normalizeIntensities_(const PeakSpectrum& query, std::vector<double>& intensities);
+
+  /// Read a UInt64 field at @p offset and advance @p offset (with bounds check)
+  UInt64 readSize_(Size& offset) const;
+
+  /// Pointer to a section of @p count elements of size @p element_size at @p offset; advances @p offset to the next 8 byte boundary
+  const char* readSection_(Size& offset, Size count, Size element_size) const;
+
+  /// The mapping
+  std::unique_ptr<boost::iostreams::mapped_file_source> file_;
+
+  /// Name of the mapped file
+  String filename_;
+
+  /// Key of the loaded index
+  String key_;
+
+  /// Start and size of the mapped data
+  const char* data_ = nullptr;
+  Size size_ = 0;
+
+  /// Sections of the mapping
+  const Entry* entries_ = nullptr;
+  Size entry_count_ = 0;
+  const double* peak_mz_ = nullptr;
+  const float* peak_intensities_ = nullptr;
+  Size peak_count_ = 0;
+  const char* text_ = nullptr;
+  Size text_size_ = 0;
+};
+
+} // namespace OpenMS
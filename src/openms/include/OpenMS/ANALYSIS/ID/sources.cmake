@@ -19,6 +19,7 @@ ConsensusIDAlgorithmSimilarity.h
 ConsensusIDAlgorithmWorst.h
 ConsensusMapMergerAlgorithm.h
 FalseDiscoveryRate.h
+FragmentIndex.h
 FIAMSDataProcessor.h
 FIAMSScheduler.h
 HiddenMarkovModel.h
@@ -36,11 +37,14 @@ MetaboliteSpectralMatching.h
 PeptideProteinResolution.h
 PrecursorPurity.h
 ProtonDistributionModel.h
+PeptideDatabase.h
 PeptideIndexing.h
+ProteinSequenceIndex.h
 PercolatorFeatureSetHelper.h
 SimpleSearchEngineAlgorithm.h
 SiriusAdapterAlgorithm.h
 SiriusMSConverter.h
+SpectralLibraryIndex.h
 )
 
 ### add path to the filenames
@@ -84,6 +84,24 @@ public:
       }
     };
 
+    /**
+     * @brief Extraction windows of a set of coordinates, sorted by m/z
+     *
+     * Holds the window bounds of all coordinates in separate arrays, such
+     * that they only need to be computed once per extraction and can be
+     * processed in a single pass over a spectrum (see
+     * extract_values_tophat). All bounds are exclusive.
+     *
+    */
+    struct ExtractionWindows
+    {
+      std::vector<double> mz; ///< target m/z value (ascending)
+      std::vector<double> mz_left; ///< lower bound of the m/z window
+      std::vector<double> mz_right; ///< upper bound of the m/z window
+      std::vector<double> im_left; ///< lower bound of the ion mobility window (-inf if no ion mobility filter is applied)
+      std::vector<double> im_right; ///< upper bound of the ion mobility window (+inf if no ion mobility filter is applied)
+    };
+
     /**
      * @brief Extract chromatograms at the m/z and RT defined by the ExtractionCoordinates.
      *
@@ -181,6 +199,49 @@ public:
                               const double im_extraction_window,
                               const bool ppm);
 
+    /**
+     * @brief Computes the extraction windows of a set of coordinates
+     *
+     * @param extraction_coordinates Coordinates sorted by m/z
+     * @param mz_extraction_window Full window width in m/z (in Th or ppm)
+     * @param ppm Whether mz_extraction_window is in ppm or in Th
+     * @param im_extraction_window Full window width in ion mobility, no
+     *   ion mobility filter is applied if it is not positive or if the ion
+     *   mobility of a coordinate is negative
+     *
+    */
+    static ExtractionWindows prepareExtractionWindows(const std::vector<ExtractionCoordinates>& extraction_coordinates,
+                                                      double mz_extraction_window,
+                                                      bool ppm,
+                                                      double im_extraction_window);
+
+    /**
+     * @brief Extract the integrated intensities of many windows from a single spectrum.
+     *
+     * Batched version of extract_value_tophat: the windows @p indices (which
+     * need to be ascending) of @p windows are extracted in a single pass
+     * over the spectrum. Since both the spectrum and the windows are sorted
+     * by m/z, the window bounds only move forward and the intensities within each window are summed up
+     * by a branch-free loop which the compiler can vectorize. The results are identical to calling extract_value_tophat
+     * for each window (up to floating point summation order).
+     *
+     * @param mz m/z values of the spectrum (ascending)
+     * @param intensity Intensity values of the spectrum
+     * @param im Ion mobility values of the spectrum (may be nullptr, then no ion mobility filter is applied)
+     * @param size Number of data points of the spectrum
+     * @param windows Extraction windows (see prepareExtractionWindows)
+     * @param indices Ascending indices of the windows to extract
+     * @param integrated_intensities Resulting intensities, one per entry in @p indices (will be overwritten)
+     *
+    */
+    static void extract_values_tophat(const double* mz,
+                                      const double* intensity,
+                                      const double* im,
+                                      Size size,
+                                      const ExtractionWindows& windows,
+                                      const std::vector<Size>& indices,
+                                      std::vector<double>& integrated_intensities);
+
 private:
 
     int getFilterNr_(const String& filter);
@@ -40,6 +40,7 @@
 #include <OpenMS/KERNEL/MSExperiment.h>
 
 #include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLMappedFile.h>
 
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
 
@@ -55,10 +56,18 @@ namespace OpenMS
     (ISpectrumAccess) using the CachedmzML class which is able to read and
     write a cached mzML file.
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    If constructed with @p memory_mapped, the cached data file is mapped into
+    memory (see Internal::CachedMzMLMappedFile) and data items are read from
+    the mapping instead of seeking in a file stream. The mapping is shared
+    between all light clones, such that multiple extraction threads use the
+    same pages, and getSpectrumViewById() provides direct access to the data
+    without copying it. In this case the index of the data items is taken
+    from the mapping, so the cached file is only read once.
+
+    @note Without memory mapping, this implementation is @a not thread-safe
+    since it keeps internally a single file access pointer which it moves
+    when accessing a specific data item. The caller is responsible to ensure
+    that access is performed atomically.
 
   */
   class OPENMS_DLLAPI SpectrumAccessOpenMSCached :
@@ -75,11 +84,14 @@ public:
 
       @param filename The filename of the .mzML file (it is assumed a second
       file .mzML.cached exists).
+      @param memory_mapped Whether to access the data through a memory mapping
+      of the .mzML.cached file (falls back to file stream access if the file
+      cannot be mapped)
 
       @throws Exception::FileNotFound is thrown if the file is not found
       @throws Exception::ParseError is thrown if the file cannot be parsed
     */
-    explicit SpectrumAccessOpenMSCached(const String& filename);
+    explicit SpectrumAccessOpenMSCached(const String& filename, bool memory_mapped = false);
 
     /**
       @brief Destructor
@@ -96,6 +108,17 @@ public:
 
     OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const override;
 
+    /// Whether the data is accessed through a memory mapping
+    bool isMemoryMapped() const;
+
+    /**
+      @brief In-place view on the m/z and intensity data of spectrum @p id (no copy)
+
+      Only available if the data is memory-mapped (returns false otherwise).
+      The view stays valid as long as this object or one of its light clones exists.
+    */
+    bool getSpectrumViewById(int id, OpenSwath::SpectrumView& view) const override;
+
     std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const override;
 
     size_t getNrSpectra() const override;
@@ -109,6 +132,11 @@ public:
     ChromatogramSettings getChromatogramMetaInfo(int id) const;
 
     std::string getChromatogramNativeID(int id) const override;
+
+protected:
+
+    /// Memory mapping of the cached data file (shared between light clones, empty if not memory-mapped)
+    boost::shared_ptr<const Internal::CachedMzMLMappedFile> mapped_file_;
   };
 
 } //end namespace
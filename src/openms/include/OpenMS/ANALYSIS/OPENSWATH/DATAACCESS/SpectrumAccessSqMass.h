@@ -45,6 +45,9 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <memory>
+#include <utility>
+
 namespace OpenMS
 {
   /**
@@ -69,6 +72,11 @@ namespace OpenMS
    * sqlite3 supports multiple parallel read threads as long as they use a
    * different db connection.
    *
+   * The retention times of the accessible spectra are read once on
+   * construction, so that getSpectraByRT is answered from memory (by binary
+   * search) instead of a query against the file. The index is shared between
+   * copies and light clones.
+   *
    * Sample usage:
    *
    *
@@ -113,6 +121,7 @@ public:
     /// Load all spectra from the underlying sqMass file into memory
     void getAllSpectra(std::vector< OpenSwath::SpectrumPtr > & spectra, std::vector< OpenSwath::SpectrumMeta > & spectra_meta) const;
 
+    /// Get the (external) indices of spectra within RT +/- deltaRT, sorted ascending (if deltaRT is zero, only the first spectrum with a retention time of at least RT)
     std::vector<std::size_t> getSpectraByRT(double /* RT */, double /* deltaRT */) const override;
 
     size_t getNrSpectra() const override;
@@ -129,6 +138,11 @@ private:
     OpenMS::Internal::MzMLSqliteHandler handler_;
     /// Optional subset of spectral indices
     std::vector<int> sidx_;
+    /// Retention time and external index of all accessible spectra, sorted by retention time
+    std::shared_ptr<const std::vector<std::pair<double, std::size_t> > > rt_index_;
+
+    /// Build the retention time index from the given retention times (by external index)
+    void buildRTIndex_(const std::vector<double>& rts);
   };
 } //end namespace OpenMS
 
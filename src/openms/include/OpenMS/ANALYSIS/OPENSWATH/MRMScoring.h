@@ -44,6 +44,8 @@
 #include "OpenMS/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h"
 #include "OpenMS/OPENSWATHALGO/ALGO/StatsHelpers.h"
 #include "OpenMS/OPENSWATHALGO/ALGO/Scoring.h"
+#include "OpenMS/OPENSWATHALGO/ALGO/MIEngine.h"
+#include "OpenMS/OPENSWATHALGO/ALGO/XCorrEngine.h"
 
 namespace OpenSwath
 {
@@ -68,6 +70,16 @@ namespace OpenSwath
         - rt_score: deviation from the expected retention time
         - elution_fit_score: how well the elution profile fits a theoretical elution profile
 
+        Cross-correlations are computed by an XCorrEngine, which standardizes
+        every trace once. The scores only need the highest peak (lag and
+        correlation) of each cross-correlation; the full cross-correlation
+        arrays are computed on the first call of getXCorrMatrix() (and related
+        functions) and cached until the matrix is initialized again. These
+        getters fill the cache, so they must not be called concurrently on the
+        same object.
+        Mutual information is computed by an MIEngine, which ranks every
+        trace once and caches its marginal histogram.
+
     */
     class OPENMS_DLLAPI MRMScoring
     {
@@ -79,6 +91,8 @@ namespace OpenSwath
         typedef OpenSwath::Scoring::XCorrArrayType XCorrArrayType;
         /// Cross Correlation matrix
         typedef OpenMS::Matrix<XCorrArrayType> XCorrMatrixType;
+        /// Matrix of the highest cross-correlation peaks (lag, correlation)
+        typedef OpenMS::Matrix<OpenSwath::XCorrEngine::XCorrPeak> XCorrPeakMatrixType;
 
         typedef OpenSwath::SpectrumPtr SpectrumType;
         typedef OpenSwath::LightTransition TransitionType;
@@ -90,19 +104,28 @@ namespace OpenSwath
 
         /** @name Accessors */
         //@{
-        /// non-mutable access to the cross-correlation matrix
+        /// non-mutable access to the highest peaks of the cross-correlation matrix
+        const XCorrPeakMatrixType& getXCorrPeakMatrix() const;
+
+        /// non-mutable access to the highest peaks of the cross-correlation contrast matrix
+        const XCorrPeakMatrixType& getXCorrContrastPeakMatrix() const;
+
+        /// non-mutable access to the highest peaks of the cross-correlation precursor contrast matrix
+        const XCorrPeakMatrixType& getXCorrPrecursorContrastPeakMatrix() const;
+
+        /// non-mutable access to the highest peaks of the cross-correlation precursor combined matrix
+        const XCorrPeakMatrixType& getXCorrPrecursorCombinedPeakMatrix() const;
+
+        /// non-mutable access to the cross-correlation matrix (computed on first access; only the upper triangle is filled)
         const XCorrMatrixType& getXCorrMatrix() const;
-        //@}
 
-        /// non-mutable access to the cross-correlation contrast matrix
+        /// non-mutable access to the cross-correlation contrast matrix (computed on first access)
         const XCorrMatrixType& getXCorrContrastMatrix() const;
-        //@}
 
-        /// non-mutable access to the cross-correlation precursor contrast matrix
+        /// non-mutable access to the cross-correlation precursor contrast matrix (computed on first access)
         const XCorrMatrixType& getXCorrPrecursorContrastMatrix() const;
-        //@}
 
-        /// non-mutable access to the cross-correlation precursor contrast matrix
+        /// non-mutable access to the cross-correlation precursor combined matrix (computed on first access; only the upper triangle is filled)
         const XCorrMatrixType& getXCorrPrecursorCombinedMatrix() const;
         //@}
 
@@ -275,33 +298,37 @@ namespace OpenSwath
     private:
         /** @name Members */
         //@{
-        /// the precomputed cross correlation matrix
-        XCorrMatrixType xcorr_matrix_;
-
-        /// contains max Peaks from xcorr_matrix_
-        OpenMS::Matrix<int> xcorr_matrix_max_peak_;
-        OpenMS::Matrix<double> xcorr_matrix_max_peak_sec_;
-
-        /// the precomputed contrast cross correlation
-        XCorrMatrixType xcorr_contrast_matrix_;
-        //@}
-
-        /// contains max Peaks from xcorr_contrast_matrix_
-        OpenMS::Matrix<double > xcorr_contrast_matrix_max_peak_sec_;
-
-        /// the precomputed cross correlation matrix of the MS1 trace
-        XCorrMatrixType xcorr_precursor_matrix_;
-
-        /// the precomputed cross correlation against the MS1 trace
-        XCorrMatrixType xcorr_precursor_contrast_matrix_;
+        /// traces and highest peaks of the cross correlation matrix
+        XCorrEngine xcorr_engine_;
+        XCorrPeakMatrixType xcorr_matrix_;
+
+        /// traces (set1, then set2) and highest peaks of the contrast cross correlation
+        XCorrEngine xcorr_contrast_engine_;
+        XCorrPeakMatrixType xcorr_contrast_matrix_;
+
+        /// traces and highest peaks of the cross correlation matrix of the MS1 trace
+        XCorrEngine xcorr_precursor_engine_;
+        XCorrPeakMatrixType xcorr_precursor_matrix_;
+
+        /// traces (precursors, then fragments) and highest peaks of the cross correlation against the MS1 trace
+        XCorrEngine xcorr_precursor_contrast_engine_;
+        XCorrPeakMatrixType xcorr_precursor_contrast_matrix_;
+
+        /// traces and highest peaks of the cross correlation with the MS1 trace
+        XCorrEngine xcorr_precursor_combined_engine_;
+        XCorrPeakMatrixType xcorr_precursor_combined_matrix_;
+
+        /// full cross correlation arrays, computed on first access by getXCorrMatrix() etc. (empty if not computed yet)
+        mutable XCorrMatrixType xcorr_matrix_arrays_;
+        mutable XCorrMatrixType xcorr_contrast_matrix_arrays_;
+        mutable XCorrMatrixType xcorr_precursor_contrast_matrix_arrays_;
+        mutable XCorrMatrixType xcorr_precursor_combined_matrix_arrays_;
         //@}
 
-        /// the precomputed cross correlation with the MS1 trace
-        XCorrMatrixType xcorr_precursor_combined_matrix_;
-        //@}
+        /// ranked traces of the most recently initialized mutual information matrix
+        MIEngine mi_engine_;
 
         /// the precomputed mutual information matrix
-
         OpenMS::Matrix<double> mi_matrix_;
         /// the precomputed contrast mutual information matrix
         OpenMS::Matrix<double> mi_contrast_matrix_;
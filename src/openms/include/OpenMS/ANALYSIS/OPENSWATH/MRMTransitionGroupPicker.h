@@ -48,6 +48,7 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 
 // Cross-correlation
+#include <OpenMS/OPENSWATHALGO/ALGO/MIEngine.h>
 #include <OpenMS/OPENSWATHALGO/ALGO/Scoring.h>
 #include <OpenMS/OPENSWATHALGO/ALGO/StatsHelpers.h>
 
@@ -117,11 +118,12 @@ public:
 
       std::vector<MSChromatogram > picked_chroms;
       std::vector<MSChromatogram > smoothed_chroms;
+      std::vector<const MSChromatogram* > chroms_to_pick;
 
-      // Pick fragment ion chromatograms
+      // Collect fragment ion chromatograms
       for (Size k = 0; k < transition_group.getChromatograms().size(); k++)
       {
-        MSChromatogram& chromatogram = transition_group.getChromatograms()[k];
+        const MSChromatogram& chromatogram = transition_group.getChromatograms()[k];
         String native_id = chromatogram.getNativeID();
 
         // only pick detecting transitions (skip all others)
@@ -131,30 +133,30 @@ public:
         {
           continue;
         }
-
-        MSChromatogram picked_chrom, smoothed_chrom;
-        smoothed_chrom.setNativeID(native_id);
-        picker_.pickChromatogram(chromatogram, picked_chrom, smoothed_chrom);
-        picked_chrom.sortByIntensity();
-        picked_chroms.push_back(std::move(picked_chrom));
-        smoothed_chroms.push_back(std::move(smoothed_chrom));
+        chroms_to_pick.push_back(&chromatogram);
       }
+      const Size n_fragment_chroms = chroms_to_pick.size();
 
-      // Pick precursor chromatograms
+      // Collect precursor chromatograms
       if (use_precursors_)
       {
         for (Size k = 0; k < transition_group.getPrecursorChromatograms().size(); k++)
         {
-          SpectrumT picked_chrom, smoothed_chrom;
-          SpectrumT& chromatogram = transition_group.getPrecursorChromatograms()[k];
-
-          picker_.pickChromatogram(chromatogram, picked_chrom, smoothed_chrom);
-          picked_chrom.sortByIntensity();
-          picked_chroms.push_back(picked_chrom);
-          smoothed_chroms.push_back(smoothed_chrom);
+          chroms_to_pick.push_back(&transition_group.getPrecursorChromatograms()[k]);
         }
       }
 
+      // Pick all chromatograms of the group (smoothing is done in one batch)
+      picker_.pickChromatograms(chroms_to_pick, picked_chroms, smoothed_chroms);
+      for (Size k = 0; k < picked_chroms.size(); k++)
+      {
+        picked_chroms[k].sortByIntensity();
+      }
+      for (Size k = 0; k < n_fragment_chroms; k++)
+      {
+        smoothed_chroms[k].setNativeID(chroms_to_pick[k]->getNativeID());
+      }
+
       // Find features (peak groups) in this group of transitions.
       // While there are still peaks left, one will be picked and used to create
       // a feature. Whenever we run out of peaks, we will get -1 back as index
@@ -405,6 +407,23 @@ public:
                                     const int chr_idx,
                                     const int peak_idx)
     {
+      // rank every chromatogram once for the total mutual information
+      OpenSwath::MIEngine mi_engine;
+      if (compute_total_mi_)
+      {
+        std::vector<double> chrom_vect;
+        for (Size k = 0; k < transition_group.getTransitions().size(); k++)
+        {
+          const SpectrumT& chromatogram = selectChromHelper_(transition_group, transition_group.getTransitions()[k].getNativeID());
+          chrom_vect.clear();
+          for (typename SpectrumT::const_iterator it = chromatogram.begin(); it != chromatogram.end(); it++)
+          {
+            chrom_vect.push_back(it->getIntensity());
+          }
+          mi_engine.addTrace(chrom_vect);
+        }
+      }
+
       for (Size k = 0; k < transition_group.getTransitions().size(); k++)
       {
 
@@ -445,27 +464,13 @@ public:
         double transition_total_mi = 0;
         if (compute_total_mi_)
         {
-          std::vector<unsigned int> chrom_vect_id_ranked, chrom_vect_det_ranked;
-          std::vector<double> chrom_vect_id, chrom_vect_det;
-          for (typename SpectrumT::const_iterator it = chromatogram.begin(); it != chromatogram.end(); it++)
-          {
-            chrom_vect_id.push_back(it->getIntensity());
-          }
-          unsigned int max_rank_det = OpenSwath::Scoring::computeAndAppendRank(chrom_vect_id, chrom_vect_det_ranked);
           // compute baseline mutual information
           int transition_total_mi_norm = 0;
           for (Size m = 0; m < transition_group.getTransitions().size(); m++)
           {
             if (transition_group.getTransitions()[m].isDetectingTransition())
             {
-              const SpectrumT& chromatogram_det = selectChromHelper_(transition_group, transition_group.getTransitions()[m].getNativeID());
-              chrom_vect_det.clear();
-              for (typename SpectrumT::const_iterator it = chromatogram_det.begin(); it != chromatogram_det.end(); it++)
-              {
-                chrom_vect_det.push_back(it->getIntensity());
-              }
-              unsigned int max_rank_id = OpenSwath::Scoring::computeAndAppendRank(chrom_vect_det, chrom_vect_id_ranked);
-              transition_total_mi += OpenSwath::Scoring::rankedMutualInformation(chrom_vect_id_ranked, chrom_vect_det_ranked, max_rank_id, max_rank_det);
+              transition_total_mi += mi_engine.mutualInformation(m, k);
               transition_total_mi_norm++;
             }
           }
@@ -222,13 +222,14 @@ protected:
     */
     bool pasef_;
 
-    /** @brief How many threads should be used for the outer loop
+    /** @brief At most how many SWATH windows should be worked on at the same time
      *
-     *  @note A value of -1 will use all threads in the outer loop
+     *  @note A value of -1 does not limit the number of windows (all threads
+     *  work on the batches of all windows, in the order of the windows)
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
+     *  @note Limiting the number of windows limits memory usage when the
+     *  windows are loaded into memory, but threads may be idle while waiting
+     *  for a window to be finished.
      *
      **/
     int threads_outer_loop_;
@@ -390,9 +391,11 @@ protected:
    *
    *    - Obtain precursor ion chromatograms (if enabled) through MS1Extraction_()
    *    - Perform scoring of precursor ion chromatograms if no MS2 is given
-   *    - Iterate through each SWATH-MS window:
-   *      - Select which transitions to extract (proceed in batches) using OpenSwathHelper::selectSwathTransitions()
-   *      - Iterate through each batch of transitions:
+   *    - Process the SWATH-MS windows in parallel (dynamically scheduled over all threads), opening
+   *      windows in order whenever no batches of the open windows are pending:
+   *      - Select which transitions to extract from the opened window using OpenSwathHelper::selectSwathTransitions()
+   *      - Split the transitions of the window into batches, each batch of a window is one task
+   *      - Process the tasks of all open windows in parallel:
    *        - Extract current batch of transitions from current SWATH window:
    *          - Select transitions for current batch (see selectCompoundsForBatch_())
    *          - Prepare transition extraction (see prepareExtractionCoordinates_())
@@ -414,15 +417,11 @@ protected:
      *
      *  @param use_ms1_traces Whether to use MS1 data
      *  @param use_ms1_ion_mobility Whether to use ion mobility extraction on MS1 traces
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
+     *  @param threads_outer_loop At most how many SWATH windows should be
+     *  worked on at the same time (-1 will work on as many windows as needed
+     *  to keep all threads busy)
      *  @param prm Whether data is acquired in targeted DIA (e.g. PRM mode) with potentially overlapping windows
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
-     *
      **/
     OpenSwathWorkflow(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, bool pasef, int threads_outer_loop) :
     OpenSwathWorkflowBase(use_ms1_traces, use_ms1_ion_mobility, prm, pasef, threads_outer_loop)
@@ -573,6 +572,52 @@ protected:
     void copyBatchTransitions_(const std::vector<OpenSwath::LightCompound>& used_compounds,
       const std::vector<OpenSwath::LightTransition>& all_transitions,
       std::vector<OpenSwath::LightTransition>& output);
+
+    /// A unit of work of performExtraction(): one batch of transitions of one SWATH window
+    struct ExtractionTask_
+    {
+      ExtractionTask_(Size window_idx, Size batch_idx, Size batches) :
+        window(window_idx), batch(batch_idx), nr_batches(batches)
+      {
+      }
+
+      Size window; ///< index of the SWATH window
+      Size batch; ///< index of the batch within the window
+      Size nr_batches; ///< number of batches of the window
+      int thread = 0; ///< thread which processed the task
+      double seconds = 0.0; ///< wall time used to process the task
+    };
+
+    /** @brief Select which transitions to extract from a single SWATH window (and copy to output)
+     *
+     * For regular SWATH data, all transitions whose precursor falls into the
+     * window are selected (see OpenSwathHelper::selectSwathTransitions()). For
+     * PRM and diaPASEF data, the transitions assigned to the window in
+     * @p tr_win_map are selected together with their compounds and proteins.
+     *
+     * @param swath_maps The raw data (swath maps)
+     * @param window_idx Index of the SWATH window in @p swath_maps
+     * @param transition_exp The full set of assays
+     * @param tr_win_map Maps each transition to the window from which it should be extracted (PRM and diaPASEF only)
+     * @param cp Parameter set for the chromatogram extraction
+     * @param transition_exp_used_all The selected set of transitions
+     *
+    */
+    void selectTransitionsForWindow_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+      SignedSize window_idx,
+      const OpenSwath::LightTargetedExperiment& transition_exp,
+      const std::vector<int>& tr_win_map,
+      const ChromExtractParams & cp,
+      OpenSwath::LightTargetedExperiment& transition_exp_used_all) const;
+
+    /** @brief Write a summary of the timing of all tasks to the log
+     *
+     * Reports the total and busy time, the thread utilization and the
+     * longest window and task, which shows whether the run was limited by a
+     * single SWATH window.
+     *
+    */
+    void printSchedulingSummary_(const std::vector<ExtractionTask_>& tasks, int nr_threads, double wall_time) const;
   };
 
   /**
@@ -101,8 +101,24 @@ public:
     */
     void pickChromatogram(const MSChromatogram& chromatogram, MSChromatogram& picked_chrom, MSChromatogram& smoothed_chrom);
 
+    /**
+      @brief Finds peaks in a batch of chromatograms and annotates left/right borders
+
+      All chromatograms are smoothed in one batch (in parallel if the batch is
+      large and no parallel region is active) before the peaks are picked one
+      chromatogram after the other. The results are the same as
+      calling pickChromatogram() for each chromatogram; @p picked_chroms and
+      @p smoothed_chroms are resized to the number of input chromatograms.
+    */
+    void pickChromatograms(const std::vector<const MSChromatogram*>& chromatograms,
+                           std::vector<MSChromatogram>& picked_chroms,
+                           std::vector<MSChromatogram>& smoothed_chroms);
+
 protected:
 
+    /// Picks peaks in @p chromatogram based on its smoothed version @p smoothed_chrom
+    void pickSmoothedChromatogram_(const MSChromatogram& chromatogram, const MSChromatogram& smoothed_chrom, MSChromatogram& picked_chrom);
+
     void pickChromatogramCrawdad_(const MSChromatogram& chromatogram, MSChromatogram& picked_chrom);
 
     void pickChromatogram_(const MSChromatogram& chromatogram, MSChromatogram& picked_chrom);
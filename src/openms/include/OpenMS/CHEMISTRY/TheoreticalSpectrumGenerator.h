@@ -70,6 +70,15 @@ namespace OpenMS
   {
     public:
 
+    /// A backbone fragment ion as reported by getFragmentIons()
+    struct FragmentIon
+    {
+      double mz; ///< m/z of the monoisotopic peak
+      Residue::ResidueType type; ///< ion series (a, b, c, x, y or z)
+      UInt32 ordinal; ///< number of residues in the fragment
+      Int charge; ///< charge state
+    };
+
     /** @name Constructors and Destructors
     */
     //@{
@@ -101,12 +110,35 @@ namespace OpenMS
     /// @throw Exception::InvalidParameter   If fragmentation method is anything else than 'CID', 'HCID', 'ECD' or 'ETD'.
     static MSSpectrum generateSpectrum(const Precursor::ActivationMethod& fm, const AASequence& seq, int precursor_charge);
 
+    /**
+      @brief Lightweight alternative to getSpectrum() that only computes fragment m/z values
+
+      Generates the monoisotopic m/z of the a/b/c/x/y/z ion series enabled by the add_*_ions parameters
+      (honouring add_first_prefix_ion) for all charges from @p min_charge to @p max_charge.
+      Losses, isotopes, precursor and immonium peaks are not generated and no intensities or meta data are written.
+      The residue masses are summed up once per terminus and shared by all ion series and charges,
+      so no AASequence, String or EmpiricalFormula objects are created.
+
+      @p mz is cleared but keeps its capacity, so reusing the same vector avoids allocations on the hot path.
+      The result is sorted by m/z and identical (up to rounding) to the peak positions of getSpectrum().
+
+      @throw Exception::IllegalArgument if @p min_charge is smaller than 1
+    */
+    void getFragmentMZs(const AASequence& peptide, Int min_charge, Int max_charge, std::vector<double>& mz) const;
+
+    /// Same as getFragmentMZs() but also reports ion series, ordinal and charge of each fragment (sorted by m/z)
+    void getFragmentIons(const AASequence& peptide, Int min_charge, Int max_charge, std::vector<FragmentIon>& ions) const;
+
     /// overwrite
     void updateMembers_() override;
     //@}
 
     protected:
 
+    /// calls @p emit(mz, ion type, ordinal, charge) for each fragment of the enabled ion series (see getFragmentMZs())
+    template <typename EmitFunction>
+    void forEachFragment_(const AASequence& peptide, Int min_charge, Int max_charge, EmitFunction emit) const;
+
     /// adds peaks to a spectrum of the given ion-type, peptide, charge, and intensity, also adds charges and ion names to the DataArrays, if the add_metainfo parameter is set to true
     virtual void addPeaks_(PeakSpectrum& spectrum, const AASequence& peptide, DataArrays::StringDataArray& ion_names, DataArrays::IntegerDataArray& charges, MSSpectrum::Chunks& chunks, const Residue::ResidueType res_type, Int charge = 1) const;
 
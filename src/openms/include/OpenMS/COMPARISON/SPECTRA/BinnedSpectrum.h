@@ -160,6 +160,9 @@ public:
     /// get the bin size
     inline float getBinSize() const { return bin_size_; }
 
+    /// true if the bin size is given in ppm
+    inline bool isUnitPpm() const { return unit_ppm_; }
+
     /// get the bin spread
     inline size_t getBinSpread() const { return bin_spread_; }
 
@@ -0,0 +1,147 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSpectrum.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+  /**
+    @brief A contiguous block of binned spectra for fast one-vs-many comparisons
+
+    Stores the non-empty bins of many BinnedSpectrum objects (e.g. a spectral library) back to back in two flat arrays
+    (bin indices and intensities) together with their precomputed self similarity terms (squared norm, intensity sum
+    and number of filled bins).
+
+    A query is compared against a range of block spectra using a hybrid representation:
+    the query is expanded once into a dense intensity array covering its occupied bin range,
+    and each block spectrum is then scored by a branch-free gather over its sparse bins.
+    The inner loops carry no data dependencies apart from the reduction and are written to be auto-vectorized.
+
+    The scores are the same as computed by BinnedSpectralContrastAngle, BinnedSharedPeakCount and
+    BinnedSumAgreeingIntensities for a pair of spectra (up to floating point rounding).
+
+    All spectra added to a block and all queries must share the same binning (see BinnedSpectrum::isCompatible).
+
+    @see BinnedSpectrum
+    @see BinnedSpectrumCompareFunctor
+
+    @ingroup SpectraComparison
+  */
+  class OPENMS_DLLAPI BinnedSpectrumBlock
+  {
+public:
+    /// default constructor
+    BinnedSpectrumBlock() = default;
+
+    /**
+      @brief appends a binned spectrum to the block
+
+      @return index of the spectrum in the block
+      @throw Exception::IllegalArgument if the binning differs from the spectra already in the block
+    */
+    Size add(const BinnedSpectrum& spectrum);
+
+    /// removes all spectra
+    void clear();
+
+    /// reserves memory for @p spectra spectra with @p bins filled bins in total
+    void reserve(Size spectra, Size bins);
+
+    /// number of spectra in the block
+    Size size() const;
+
+    /// number of filled bins of spectrum @p index
+    Size getNonZeros(Size index) const;
+
+    /**
+      @brief spectral contrast angle between @p query and the block spectra [@p first, @p last)
+
+      @p scores is resized to last - first and filled in the order of the block.
+      @throw Exception::IllegalArgument if the binning of @p query differs from the block
+    */
+    void compareContrastAngle(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const;
+
+    /// fraction of shared bins between @p query and the block spectra [@p first, @p last) (see compareContrastAngle())
+    void compareSharedPeakCount(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const;
+
+    /// sum of agreeing intensities between @p query and the block spectra [@p first, @p last) (see compareContrastAngle())
+    void compareSumAgreeingIntensities(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const;
+
+protected:
+    /// dense copy of the query intensities for the bins [first_bin, first_bin + intensities.size())
+    struct DenseQuery_
+    {
+      int first_bin = 0;
+      std::vector<float> intensities;
+      double squared_norm = 0.0;
+      double intensity_sum = 0.0;
+      Size non_zeros = 0;
+    };
+
+    /// checks the binning of @p query and expands it into @p dense
+    void densify_(const BinnedSpectrum& query, DenseQuery_& dense) const;
+
+    /// range of bins of block spectrum @p index that overlap the dense query (as offsets into bin_indices_/intensities_)
+    std::pair<Size, Size> getOverlap_(Size index, const DenseQuery_& dense) const;
+
+    /// checks if @p spectrum has the binning of this block
+    bool isCompatible_(const BinnedSpectrum& spectrum) const;
+
+    /// bin layout of the block (taken from the first spectrum)
+    float bin_size_ = 0.0f;
+    float offset_ = 0.0f;
+    bool unit_ppm_ = false;
+
+    /// start of each spectrum in bin_indices_/intensities_ (size() + 1 entries)
+    std::vector<Size> offsets_ = std::vector<Size>(1, 0);
+
+    /// bin indices (sorted per spectrum)
+    std::vector<int> bin_indices_;
+
+    /// bin intensities
+    std::vector<float> intensities_;
+
+    /// precomputed sum of squared intensities per spectrum
+    std::vector<double> squared_norms_;
+
+    /// precomputed sum of intensities per spectrum
+    std::vector<double> intensity_sums_;
+  };
+
+}
@@ -70,6 +70,11 @@ namespace OpenMS
     {
     }
 
+    // create view on @p size characters starting at @p s
+    StringView(const char* s, Size size) : begin_(s), size_(size)
+    {
+    }
+
     /// less operator
     bool operator<(const StringView other) const
     {
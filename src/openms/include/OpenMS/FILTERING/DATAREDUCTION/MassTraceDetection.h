@@ -40,6 +40,8 @@
 #include <OpenMS/DATASTRUCTURES/DefaultParamHandler.h>
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 
+#include <boost/dynamic_bitset.hpp>
+
 namespace OpenMS
 {
 
@@ -65,6 +67,14 @@ namespace OpenMS
       length as well as having the minimal sample rate criterion fulfilled) get
       added to the result.
 
+      Apices are processed in batches when multiple threads are available: all
+      apices of a batch are extended concurrently against the set of peaks
+      claimed by earlier batches, and the resulting candidate traces are then
+      committed in order of decreasing apex intensity. A candidate which would
+      have collected a peak claimed by a higher-intensity trace of the same
+      batch is extended again. Thus, the result is identical to a sequential run,
+      independent of the number of threads.
+
       @htmlinclude OpenMS_MassTraceDetection.parameters
 
       @ingroup Quantitation
@@ -110,6 +120,24 @@ namespace OpenMS
           Size peak_idx;
         };
 
+        /// A mass trace collected from a single apex (not yet checked against traces of the same batch)
+        struct TraceCandidate
+        {
+          std::list<PeakType> trace; ///< collected peaks, sorted by RT
+          std::vector<double> fwhms_mz; ///< peak-FWHM meta values of collected peaks
+          std::vector<std::pair<Size, Size> > gathered_idx; ///< (scan, peak) indices of collected peaks; the first one is the apex
+          bool extended = false; ///< was the candidate computed at all?
+          bool accepted = false; ///< does the trace pass the length and quality criteria?
+        };
+
+        /// Extend a mass trace from @p apex in both RT directions, skipping peaks already in @p peak_visited (which is not modified)
+        void extendTrace_(const Apex& apex,
+                          const PeakMap& work_exp,
+                          const std::vector<Size>& spec_offsets,
+                          const boost::dynamic_bitset<>& peak_visited,
+                          const int fwhm_meta_idx,
+                          TraceCandidate& candidate);
+
         /// The internal run method
         void run_(const std::vector<Apex>& chrom_apices,
                   const Size peak_count,
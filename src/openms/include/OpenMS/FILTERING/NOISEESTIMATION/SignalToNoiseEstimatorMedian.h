@@ -42,6 +42,7 @@
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <vector>
 #include <algorithm> //for std::max_element
+#include <exception>
 
 namespace OpenMS
 {
@@ -65,6 +66,10 @@ namespace OpenMS
     case you should increase <i>max_intensity</i> (and optionally the
     <i>bin_count</i>).
 
+    The histogram and the position of the median bin are updated incrementally
+    while the window slides over the data, so the runtime hardly depends on
+    the window length and the number of bins.
+
     Changing any of the parameters will invalidate the S/N values (which will invoke a recomputation on the next request).
 
     @note If more than 20 percent of windows have less than <i>min_required_elements</i> of elements, a warning is issued to <i>OPENMS_LOG_WARN</i> and noise estimates in those windows are set to the constant <i>noise_for_empty_window</i>.
@@ -177,6 +182,44 @@ public:
       return histogram_oob_percent_;
     }
 
+    /**
+      @brief Computes the S/N values of all data points in @p data, e.g. all spectra of an MSExperiment
+
+      The containers are processed in parallel (if OpenMP is enabled), each thread using its own copy
+      of this estimator. The result is the same as calling init() for each container and
+      getSignalToNoise() for each of its data points. The state of this estimator is not changed.
+
+      @return S/N values per container (in the order of @p data) and data point
+      @exception Throws Exception::InvalidValue (see init())
+    */
+    std::vector<std::vector<double> > estimateSignalToNoise(const std::vector<Container>& data) const
+    {
+      std::vector<std::vector<double> > result(data.size());
+      std::exception_ptr error;
+#pragma omp parallel
+      {
+        SignalToNoiseEstimatorMedian estimator(*this);
+        estimator.setLogType(ProgressLogger::NONE);
+#pragma omp for schedule(dynamic)
+        for (SignedSize i = 0; i < (SignedSize)data.size(); ++i)
+        {
+          if (data[i].empty()) continue;
+          try
+          {
+            estimator.init(data[i]);
+            result[i].swap(estimator.stn_estimates_);
+          }
+          catch (...)
+          {
+#pragma omp critical (SignalToNoiseEstimatorMedian_estimateSignalToNoise)
+            if (!error) error = std::current_exception();
+          }
+        }
+      }
+      if (error) std::rethrow_exception(error);
+      return result;
+    }
+
 protected:
 
 
@@ -289,9 +332,9 @@ protected:
       // bin in which a datapoint would fall
       int to_bin = 0;
 
-      // index of bin where the median is located
+      // index of bin where the median is located (kept from one window to the next)
       int median_bin = 0;
-      // additive number of elements from left to x in histogram
+      // additive number of elements from left up to (including) 'median_bin' in histogram
       int element_inc_count = 0;
 
       // tracks elements in current window, which may vary because of unevenly spaced data
@@ -316,6 +359,7 @@ protected:
         {
           to_bin = std::max(std::min<int>((int)((*window_pos_borderleft).getIntensity() / bin_size), bin_count_minus_1), 0);
           --histogram[to_bin];
+          if (to_bin <= median_bin) --element_inc_count;
           --elements_in_window;
           ++window_pos_borderleft;
         }
@@ -327,6 +371,7 @@ protected:
           //std::cerr << (*window_pos_borderright).getIntensity() << " " << bin_size << " " << bin_count_minus_1 << std::endl;
           to_bin = std::max(std::min<int>((int)((*window_pos_borderright).getIntensity() / bin_size), bin_count_minus_1), 0);
           ++histogram[to_bin];
+          if (to_bin <= median_bin) ++element_inc_count;
           ++elements_in_window;
           ++window_pos_borderright;
         }
@@ -338,10 +383,14 @@ protected:
         }
         else
         {
-          // find bin i where ceil[elements_in_window/2] <= sum_c(0..i){ histogram[c] }
-          median_bin = -1;
-          element_inc_count = 0;
+          // find first bin i where ceil[elements_in_window/2] <= sum_c(0..i){ histogram[c] } (or the last bin);
+          // the window changes only slightly, so move there from the median bin of the previous window
           element_in_window_half = (elements_in_window + 1) / 2;
+          while (median_bin > 0 && element_inc_count - histogram[median_bin] >= element_in_window_half)
+          {
+            element_inc_count -= histogram[median_bin];
+            --median_bin;
+          }
           while (median_bin < bin_count_minus_1 && element_inc_count < element_in_window_half)
           {
             ++median_bin;
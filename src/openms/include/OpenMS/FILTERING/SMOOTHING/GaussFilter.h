@@ -92,12 +92,25 @@ public:
     /**
       @brief Smoothes an MSExperiment containing profile data.
 
+      Spectra and chromatograms are smoothed in parallel.
+
       @exception Exception::IllegalArgument is thrown, if the @em gaussian_width parameter is too small.
     */
     void filterExperiment(PeakMap & map);
 
+    /**
+      @brief Smoothes a batch of chromatograms (in parallel).
+
+      Calls filter() on each chromatogram. Small batches, and batches smoothed from within a parallel
+      region (e.g. one transition group per thread), are processed by the calling thread only.
+    */
+    void filterChromatograms(std::vector<MSChromatogram> & chromatograms);
+
 protected:
 
+    /// Smoothes @p spectrum using @p algo (which is re-initialized for every data point if a ppm tolerance is used)
+    void filter_(MSSpectrum & spectrum, GaussFilterAlgorithm & algo) const;
+
     GaussFilterAlgorithm gauss_algo_;
 
     /// The spacing of the pre-tabulated kernel coefficients
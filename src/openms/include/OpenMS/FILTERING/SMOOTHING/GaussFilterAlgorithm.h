@@ -37,6 +37,7 @@
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/INTERFACES/DataStructures.h>
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -61,6 +62,11 @@ namespace OpenMS
 
     @note The data must be sorted according to ascending m/z!
 
+    If the data points are equally spaced (and no ppm tolerance is used), the kernel is evaluated
+    only once for the whole data array and applied as a discrete convolution. The result is equal
+    to that of the point-wise integration used on non-uniform data up to rounding (positions that
+    deviate from the common spacing by rounding errors only, and a different summation order).
+
     @ingroup SignalProcessing
   */
 
@@ -136,6 +142,13 @@ public:
         IterT mz_out,
         IterT int_out)
     {
+      // equally spaced data (e.g. chromatograms or resampled spectra) share one precomputed kernel
+      double step = 0.0;
+      if (!use_ppm_tolerance_ && isUniform_(mz_in_start, mz_in_end, step) && !isOnKernelBorder_(step))
+      {
+        return filterUniform_(mz_in_start, mz_in_end, int_in_start, mz_out, int_out, step);
+      }
+
       bool found_signal = false;
 
       ConstIterT mz_it = mz_in_start;
@@ -176,6 +189,152 @@ protected:
     bool use_ppm_tolerance_;
     double ppm_tolerance_;
 
+    /// Checks whether the positions in [first, last) are equally spaced and stores the spacing in @p step
+    template <typename ConstIterT>
+    static bool isUniform_(ConstIterT first, ConstIterT last, double& step)
+    {
+      const std::ptrdiff_t n = std::distance(first, last);
+      if (n < 3) return false;
+
+      step = (*(last - 1) - *first) / (n - 1);
+      if (!(step > 0.0)) return false;
+
+      // allow for rounding errors only - anything else changes the kernel weights
+      const double tolerance = step * 1e-6;
+      for (ConstIterT it = first + 1; it != last; ++it)
+      {
+        if (fabs((*it - *(it - 1)) - step) > tolerance) return false;
+      }
+      return true;
+    }
+
+    /**
+      @brief Checks whether multiples of @p step end (up to rounding) exactly on the border of the kernel window
+
+      Whether integrate_() uses such data points depends on rounding errors of the individual positions,
+      so this case is left to the point-wise integration.
+    */
+    bool isOnKernelBorder_(double step) const
+    {
+      const double ratio = coeffs_.size() * spacing_ / step;
+      return fabs(ratio - floor(ratio + 0.5)) < 1e-6 * ratio;
+    }
+
+    /// Linear interpolation of the tabulated kernel at @p distance (as done in integrate_())
+    double interpolateCoefficient_(double distance) const
+    {
+      const Size middle = coeffs_.size();
+      const Size left_position = std::min((Size)floor(distance / spacing_), middle - 1);
+      const Size right_position = left_position + 1;
+      const double d = fabs((left_position * spacing_) - distance) / spacing_;
+      return (right_position < middle) ? (1 - d) * coeffs_[left_position] + d * coeffs_[right_position]
+                                       : coeffs_[left_position];
+    }
+
+    /**
+      @brief Convolution of equally spaced data with a kernel precomputed for spacing @p step
+
+      Uses the weights of integrate_() (trapezoidal integration, where the first and the last
+      data point are never used as neighbours), computed from the common spacing @p step, so the result
+      is equal to that of integrate_() up to rounding. The kernel is evaluated once per data array and
+      the inner loop is a plain dot product that the compiler can vectorize.
+    */
+    template <typename ConstIterT, typename IterT>
+    bool filterUniform_(
+        ConstIterT mz_in_start,
+        ConstIterT mz_in_end,
+        ConstIterT int_in_start,
+        IterT mz_out,
+        IterT int_out,
+        double step) const
+    {
+      const Size n = std::distance(mz_in_start, mz_in_end);
+      const double window = coeffs_.size() * spacing_;
+
+      // kernel values for the offsets 0, 1, ..., radius
+      std::vector<double> kernel;
+      for (Size k = 0; k * step < window; ++k)
+      {
+        kernel.push_back(interpolateCoefficient_(k * step));
+      }
+      const Size radius = kernel.size() - 1;
+
+      // full (symmetric) kernel for points with 'radius' neighbours on both sides;
+      // the centre and the outermost points get half weights from the trapezoidal rule
+      std::vector<double> weights(2 * radius + 1);
+      weights[radius] = kernel[0];
+      for (Size k = 1; k < radius; ++k)
+      {
+        weights[radius - k] = weights[radius + k] = kernel[k];
+      }
+      if (radius > 0)
+      {
+        weights.front() = weights.back() = 0.5 * kernel[radius];
+      }
+      double weights_sum = 0.;
+      for (double w : weights) weights_sum += w;
+      const Size n_weights = weights.size();
+      const double* w = weights.data();
+
+      bool found_signal = false;
+      for (Size i = 0; i < n; ++i)
+      {
+        // number of neighbours on each side (the first and the last data point are excluded)
+        const Size left = std::min(radius, (i > 0) ? i - 1 : 0);
+        const Size right = std::min(radius, (i + 2 < n) ? n - 2 - i : 0);
+
+        double v = 0.;
+        double norm = 0.;
+        if (radius > 0 && left == radius && right == radius)
+        {
+          ConstIterT y = int_in_start + (i - radius);
+#pragma omp simd reduction(+: v)
+          for (Size k = 0; k < n_weights; ++k)
+          {
+            v += w[k] * y[k];
+          }
+          norm = weights_sum;
+        }
+        else
+        {
+          const double y_i = *(int_in_start + i);
+          if (left > 0)
+          {
+            v += 0.5 * kernel[0] * y_i;
+            norm += 0.5 * kernel[0];
+            for (Size k = 1; k < left; ++k)
+            {
+              v += kernel[k] * *(int_in_start + (i - k));
+              norm += kernel[k];
+            }
+            v += 0.5 * kernel[left] * *(int_in_start + (i - left));
+            norm += 0.5 * kernel[left];
+          }
+          if (right > 0)
+          {
+            v += 0.5 * kernel[0] * y_i;
+            norm += 0.5 * kernel[0];
+            for (Size k = 1; k < right; ++k)
+            {
+              v += kernel[k] * *(int_in_start + (i + k));
+              norm += kernel[k];
+            }
+            v += 0.5 * kernel[right] * *(int_in_start + (i + right));
+            norm += 0.5 * kernel[right];
+          }
+        }
+
+        const double new_int = (v > 0) ? v / norm : 0;
+        *mz_out = *(mz_in_start + i);
+        *int_out = new_int;
+        ++mz_out;
+        ++int_out;
+
+        if (fabs(new_int) > 0) found_signal = true;
+      }
+      return found_signal;
+    }
+
     /// Computes the convolution of the raw data at position x and the gaussian kernel
     template <typename InputPeakIterator>
     double integrate_(InputPeakIterator x /* mz */, InputPeakIterator y /* int */, InputPeakIterator first, InputPeakIterator last)
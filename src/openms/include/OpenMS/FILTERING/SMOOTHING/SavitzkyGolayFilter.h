@@ -118,68 +118,55 @@ public:
 
       if (frame_size_ > n) { return; }
 
-      int i;
-      UInt j;
-      int mid = (frame_size_ / 2);
-      double help;
+      // gather the intensities in a contiguous array, so the FIR loops below can be vectorized
+      std::vector<double> intensities(n);
+      for (size_t k = 0; k < n; ++k)
+      {
+        intensities[k] = (first + k)->getIntensity();
+      }
+      const double* y = intensities.data();
+      const double* coeffs = coeffs_.data();
+      const size_t frame_size = frame_size_;
+      const size_t mid = frame_size / 2;
 
-      // compute the transient on
       OutputIt out_it = d_first;
-
-      for (i = 0; i <= mid; ++i)
+      for (size_t i = 0; i < n; ++i, ++first, ++out_it)
       {
-        InputIt it_forward = (first - i);
-        help = 0;
-        for (j = 0; j < frame_size_; ++j)
+        double help = 0;
+        if (i <= mid)
         {
-          help += it_forward->getIntensity() * coeffs_[(i + 1) * frame_size_ - 1 - j];
-          ++it_forward;
+          // compute the transient on (window starts at the first data point)
+          const double* c = coeffs + (i + 1) * frame_size - 1;
+          for (size_t j = 0; j < frame_size; ++j)
+          {
+            help += y[j] * c[-(std::ptrdiff_t)j];
+          }
         }
-
-        out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
-      }
-
-      // compute the steady state output
-      InputIt it_help = (last - mid);
-
-      while (first != it_help)
-      {
-        InputIt it_forward = (first - mid);
-        help = 0;
-
-        for (j = 0; j < frame_size_; ++j)
+        else if (i < n - mid)
         {
-          help += it_forward->getIntensity() * coeffs_[mid * frame_size_ + j];
-          ++it_forward;
+          // compute the steady state output
+          const double* window = y + (i - mid);
+          const double* c = coeffs + mid * frame_size;
+#pragma omp simd reduction(+: help)
+          for (size_t j = 0; j < frame_size; ++j)
+          {
+            help += window[j] * c[j];
+          }
         }
-
-        out_it->setPosition(first->getPosition());
-        out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
-      }
-
-      // compute the transient off
-      for (i = (mid - 1); i >= 0; --i)
-      {
-        InputIt it_forward = (first - (frame_size_ - i - 1));
-        help = 0;
-
-        for (j = 0; j < frame_size_; ++j)
+        else
         {
-          help += it_forward->getIntensity() * coeffs_[i * frame_size_ + j];
-          ++it_forward;
+          // compute the transient off (window ends at the last data point)
+          const double* window = y + (n - frame_size);
+          const double* c = coeffs + (n - 1 - i) * frame_size;
+          for (size_t j = 0; j < frame_size; ++j)
+          {
+            help += window[j] * c[j];
+          }
         }
 
         out_it->setPosition(first->getPosition());
         out_it->setIntensity(std::max(0.0, help));
-        ++out_it;
-        ++first;
       }
-
     }
 
     /**
@@ -210,23 +197,18 @@ public:
 
     /**
       @brief Removed the noise from an MSExperiment containing profile data.
+
+      Spectra and chromatograms are smoothed in parallel.
     */
-    void filterExperiment(PeakMap & map)
-    {
-      Size progress = 0;
-      startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
-      for (Size i = 0; i < map.size(); ++i)
-      {
-        filter(map[i]);
-        setProgress(++progress);
-      }
-      for (Size i = 0; i < map.getChromatograms().size(); ++i)
-      {
-        filter(map.getChromatogram(i));
-        setProgress(++progress);
-      }
-      endProgress();
-    }
+    void filterExperiment(PeakMap & map);
+
+    /**
+      @brief Removed the noise from a batch of chromatograms (in parallel).
+
+      Calls filter() on each chromatogram. Small batches, and batches smoothed from within a parallel
+      region (e.g. one transition group per thread), are processed by the calling thread only.
+    */
+    void filterChromatograms(std::vector<MSChromatogram> & chromatograms);
 
 protected:
     /// Coefficients
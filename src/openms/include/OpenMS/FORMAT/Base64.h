@@ -48,6 +48,7 @@
 #include <algorithm>
 #include <iterator>
 #include <cmath>
+#include <cstring>
 #include <vector>
 
 #include <QByteArray>
@@ -149,24 +150,39 @@ public:
     */
     static void decodeSingleString(const String& in, QByteArray& base64_uncompressed, bool zlib_compression);
 
-private:
+    /**
+        @brief Decodes Base64 characters into a byte buffer
 
-    ///Internal class needed for type-punning
-    union Reinterpreter64_
-    {
-      double f;
-      UInt64 i;
-    };
+        This is the kernel used by all decoding functions. It uses AVX2 or
+        SSSE3 instructions if the CPU supports them (detected at runtime) and a
+        table-driven scalar loop otherwise.
 
-    ///Internal class needed for type-punning
-    union Reinterpreter32_
-    {
-      float f;
-      UInt32 i;
-    };
+        @param in Pointer to the Base64 characters
+        @param in_size Number of characters, must be a multiple of 4 (trailing '=' padding is allowed)
+        @param out Output buffer with room for at least (in_size / 4) * 3 bytes
+        @return The number of bytes written to @p out
+
+        @note Characters outside the Base64 alphabet (including whitespace) are not detected, they decode to zero bits.
+
+        @exception Exception::ConversionError is thrown if @p in_size is not a multiple of 4
+    */
+    static Size decodeRaw(const char* in, Size in_size, Byte* out);
+
+    /**
+        @brief Encodes a byte buffer to Base64 characters (including '=' padding)
+
+        @param in Pointer to the bytes to encode
+        @param in_size Number of bytes
+        @param out Output buffer with room for at least ceil(in_size / 3) * 4 characters
+        @return The number of characters written to @p out
+    */
+    static Size encodeRaw(const Byte* in, Size in_size, char* out);
+
+private:
+
+    /// Reverses the byte order of @p count elements of size @p element_size (4 or 8 bytes) in place
+    static void swapByteOrder_(void* data, Size count, Size element_size);
 
-    static const char encoder_[];
-    static const char decoder_[];
     /// Decodes a Base64 string to a vector of floating point numbers
     template <typename ToType>
     static void decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
@@ -222,26 +238,7 @@ private:
     //Change endianness if necessary
     if ((OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      if (element_size == 4)
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          Reinterpreter32_ tmp;
-          tmp.f = in[i];
-          tmp.i = endianize32(tmp.i);
-          in[i] = tmp.f;
-        }
-      }
-      else
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          Reinterpreter64_ tmp;
-          tmp.f = static_cast<double>(in[i]);
-          tmp.i = endianize64(tmp.i);
-          in[i] = tmp.f;
-        }
-      }
+      swapByteOrder_(&in[0], in.size(), element_size);
     }
 
     //encode with compression
@@ -290,47 +287,7 @@ private:
       end = it + input_bytes;
     }
 
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
-    out.resize(written);         //no more space is needed
+    out.resize(encodeRaw(it, end - it, &out[0]));     //no more space is needed
   }
 
   template <typename ToType>
@@ -389,16 +346,7 @@ private:
     // change endianness if necessary
     if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      if (element_size == 4) // 32 bit
-      {
-        UInt32 * p = reinterpret_cast<UInt32 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize32);
-      }
-      else // 64 bit
-      {
-        UInt64 * p = reinterpret_cast<UInt64 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize64);
-      }
+      swapByteOrder_(byte_buffer, float_count, element_size);
     }
 
     // copy values
@@ -421,103 +369,23 @@ private:
       throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Malformed base64 input, length is not a multiple of 4.");
     }
 
-    Size src_size = in.size();
-    // last one or two '=' are skipped if contained
-    int padding = 0;
-    if (in[src_size - 1] == '=') padding++;
-    if (in[src_size - 2] == '=') padding++;
-
-    src_size -= padding;
-
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
+    // decode directly into the (zero-initialized) memory of the output vector
+    // NOTE: bytes covered by '=' padding count as zero bytes (some writers
+    // truncate trailing zero bytes of the last element), incomplete trailing
+    // elements are dropped
+    const Size byte_count = in.size() / 4 * 3;
+    out.resize((byte_count + element_size - 1) / element_size);
+    decodeRaw(in.c_str(), in.size(), reinterpret_cast<Byte *>(&out[0]));
+    out.resize(byte_count / element_size);
 
     // Parse little endian data in big endian OpenMS (or other way round)
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || 
-       (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
+    if (!out.empty() &&
+        ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) ||
+        (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN)))
     {
-      offset = 0;
-      inc = 1;
-    }
-
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
-    {
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
+      swapByteOrder_(&out[0], out.size(), element_size);
     }
   }
 
@@ -537,24 +405,7 @@ private:
     //Change endianness if necessary
     if ((OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_BIGENDIAN))
     {
-      if (element_size == 4)
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          UInt32 tmp = in[i];
-          tmp = endianize32(tmp);
-          in[i] = tmp;
-        }
-      }
-      else
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          UInt64 tmp = in[i];
-          tmp = endianize64(tmp);
-          in[i] = tmp;
-        }
-      }
+      swapByteOrder_(&in[0], in.size(), element_size);
     }
 
     //encode with compression (use Qt because of zlib support)
@@ -585,47 +436,7 @@ private:
       end = it + input_bytes;
     }
 
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
-    out.resize(written);         //no more space is needed
+    out.resize(encodeRaw(it, end - it, &out[0]));     //no more space is needed
   }
 
   template <typename ToType>
@@ -684,8 +495,7 @@ private:
         if (buffer_size % element_size != 0)
           throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
         Size float_count = buffer_size / element_size;
-        UInt32 * p = reinterpret_cast<UInt32 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize32);
+        swapByteOrder_(byte_buffer, float_count, element_size);
 
         out.resize(float_count);
         // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
@@ -704,8 +514,7 @@ private:
 
         Size float_count = buffer_size / element_size;
 
-        UInt64 * p = reinterpret_cast<UInt64 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize64);
+        swapByteOrder_(byte_buffer, float_count, element_size);
 
         out.resize(float_count);
         // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
@@ -765,131 +574,35 @@ private:
       return;
     }
 
-    Size src_size = in.size();
-    // last one or two '=' are skipped if contained
-    int padding = 0;
-    if (in[src_size - 1] == '=') padding++;
-    if (in[src_size - 2] == '=') padding++;
-
-    src_size -= padding;
-
-    UInt a;
-    UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
     const Size element_size = sizeof(ToType);
 
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
+    // bytes covered by '=' padding count as zero bytes (see decodeUncompressed_)
+    std::vector<Byte> decoded(in.size() / 4 * 3, 0);
+    decodeRaw(in.c_str(), in.size(), &decoded[0]);
+    const Size element_count = decoded.size() / element_size;
 
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
+    if (element_count > 0 &&
+        ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) ||
+        (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN)))
     {
-      offset = 0;
-      inc = 1;
+      swapByteOrder_(&decoded[0], element_count, element_size);
     }
 
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
+    out.resize(element_count);
+    // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
+    for (Size i = 0; i < element_count; ++i)
     {
-
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
+      if (element_size == 4)
       {
-        b = 0;
+        Int32 value;
+        std::memcpy(&value, &decoded[i * element_size], element_size);
+        out[i] = (ToType) value;
       }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
+      else
       {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
+        Int64 value;
+        std::memcpy(&value, &decoded[i * element_size], element_size);
+        out[i] = (ToType) value;
       }
     }
   }
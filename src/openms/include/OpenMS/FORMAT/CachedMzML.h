@@ -108,6 +108,9 @@ protected:
 
     void load_(const String& filename);
 
+    /// Open the cached data file and load the meta data, but do not create the indices
+    void loadMetaData_(const String& filename);
+
     /// Meta data
     MSExperiment meta_ms_experiment_;
 
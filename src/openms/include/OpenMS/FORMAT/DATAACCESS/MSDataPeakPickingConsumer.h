@@ -0,0 +1,129 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/MSChromatogram.h>
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+
+    /**
+      @brief Centroids spectra and chromatograms on the fly using PeakPickerHiRes
+
+      This consumer picks the spectra and chromatograms passed to it (see
+      PeakPickerHiRes::pickOrCopy() for which spectra are picked) and passes
+      the results to the next consumer (see Constructor), e.g. an
+      MSDataWritingConsumer. Together with MzMLFile::transform(), this allows
+      centroiding a profile file without loading it into memory.
+
+      Spectra and chromatograms are collected in batches, which are picked in
+      parallel (if OpenMP is enabled) and then passed on in their original
+      order. Memory use is therefore bounded by the batch size.
+
+      @note Spectra and chromatograms are moved into the batch, i.e. the
+      objects passed to consumeSpectrum() and consumeChromatogram() are left
+      empty.
+
+      @note Call flush() after the last spectrum/chromatogram to pass on the
+      remaining data (this also happens on destruction, but errors can then
+      not be reported to the caller).
+    */
+    class OPENMS_DLLAPI MSDataPeakPickingConsumer :
+      public Interfaces::IMSDataConsumer
+    {
+
+    public:
+
+      /**
+        @brief Constructor
+
+        @param next_consumer  consumer which receives the picked data
+        @param pp  peak picker (a copy with the same parameters is used)
+        @param batch_size  number of spectra/chromatograms picked together
+        @param check_spectrum_type  if set, throws an exception if a centroided spectrum is selected for picking (see PeakPickerHiRes::pickOrCopy())
+
+        @note This does not transfer ownership of the consumer
+      */
+      MSDataPeakPickingConsumer(Interfaces::IMSDataConsumer* next_consumer, const PeakPickerHiRes& pp,
+                                Size batch_size = 256, bool check_spectrum_type = false);
+
+      /**
+        @brief Destructor
+
+        Flushes data to next consumer
+
+        @note It is essential to not delete the underlying next_consumer before
+        deleting this object, otherwise we risk a memory error
+      */
+      ~MSDataPeakPickingConsumer() override;
+
+      void setExpectedSize(Size expected_spectra, Size expected_chromatograms) override;
+
+      void consumeSpectrum(SpectrumType& s) override;
+
+      void consumeChromatogram(ChromatogramType& c) override;
+
+      void setExperimentalSettings(const ExperimentalSettings& exp) override;
+
+      /**
+        @brief Picks the data collected so far and passes it to the next consumer
+
+        @throw Exception::IllegalArgument if spectrum type checking is enabled and a centroided spectrum is selected for picking
+      */
+      void flush();
+
+    protected:
+
+      /// Picks and passes on the collected spectra
+      void flushSpectra_();
+
+      /// Picks and passes on the collected chromatograms
+      void flushChromatograms_();
+
+      Interfaces::IMSDataConsumer* next_consumer_;
+      PeakPickerHiRes pp_;
+      Size batch_size_;
+      bool check_spectrum_type_;
+      std::vector<SpectrumType> spectra_;
+      std::vector<ChromatogramType> chromatograms_;
+    };
+
+} //end namespace OpenMS
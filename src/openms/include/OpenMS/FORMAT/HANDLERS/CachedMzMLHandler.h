@@ -46,7 +46,8 @@
 
 #include <fstream>
 
-#define CACHED_MZML_FILE_IDENTIFIER 8094
+#define CACHED_MZML_FILE_IDENTIFIER 8095
+#define CACHED_MZML_FILE_VERSION 2
 
 namespace OpenMS
 {
@@ -62,6 +63,14 @@ namespace Internal
     be very fast and done in random order (once the in-memory index is built
     for the file).
 
+    The file starts with a header (identifier and format version, see
+    CACHED_MZML_FILE_IDENTIFIER and CACHED_MZML_FILE_VERSION) followed by
+    all spectra and chromatograms and the number of spectra and
+    chromatograms at the end of the file. All fields and data blocks are
+    aligned to 8 bytes (array names are padded with zeros), such that the
+    data can be accessed in place when the file is memory-mapped (see
+    CachedMzMLMappedFile).
+
   */
   class OPENMS_DLLAPI CachedMzMLHandler :
     public ProgressLogger
@@ -123,6 +132,26 @@ public:
     const std::vector<std::streampos>& getChromatogramIndex() const;
     //@}
 
+    /** @name File format helpers
+    */
+    //@{
+    /// Size of the file header (identifier and format version) in bytes
+    static constexpr Size HEADER_SIZE = 2 * sizeof(int);
+
+    /**
+      @brief Check identifier and format version read from a file header
+
+      @throws Exception::ParseError is thrown if the file is not a cached mzML file of the current format version
+    */
+    static void checkHeader(int identifier, int version, const String& filename);
+
+    /// Number of bytes an array name of length @p len occupies on disk (padded to a multiple of 8 bytes)
+    static Size paddedSize(Size len)
+    {
+      return (len + 7) & ~Size(7);
+    }
+    //@}
+
     /** @name Direct access to a single Spectrum or Chromatogram
     */
     //@{
@@ -207,6 +236,12 @@ public:
 
 protected:
 
+    /// write the file header (identifier and format version) to filestream
+    static void writeHeader_(std::ofstream& ofs);
+
+    /// read and check the file header (identifier and format version) from filestream
+    static void readHeader_(std::ifstream& ifs, const String& filename);
+
     /// write a single spectrum to filestream
     void writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs) const;
 
@@ -217,6 +252,10 @@ protected:
     static inline void readDataFast_(std::ifstream& ifs, std::vector<OpenSwath::BinaryDataArrayPtr>& data, const Size& data_size, 
       const Size& nr_float_arrays);
 
+    /// write an additional (float or integer) data array with its name to filestream
+    template <typename DataArrayType>
+    static void writeDataArray_(const DataArrayType& array, std::ofstream& ofs);
+
     /// Members
     std::vector<std::streampos> spectra_index_;
     std::vector<std::streampos> chrom_index_;
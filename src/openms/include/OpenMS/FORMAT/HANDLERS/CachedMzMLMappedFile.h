@@ -0,0 +1,165 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <OpenMS/OPENSWATHALGO/DATAACCESS/DataStructures.h>
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <memory>
+#include <vector>
+
+namespace boost
+{
+  namespace iostreams
+  {
+    class mapped_file_source;
+  }
+}
+
+namespace OpenMS
+{
+
+namespace Internal
+{
+
+  /**
+    @brief Read-only, memory-mapped access to a cached mzML data file
+
+    Maps a file written by CachedMzMLHandler (or MSDataCachedConsumer) into
+    memory and builds an index of all spectra and chromatograms by walking the
+    mapping once. Afterwards, individual data items are accessed without any
+    file system calls: getSpectrumView() and getChromatogramView() return
+    pointers directly into the mapping (the file format keeps all data
+    aligned), getSpectrumData() and getChromatogramData() copy the data into
+    OpenSwath data arrays.
+
+    All access functions are const and thread-safe, so a single instance can
+    be shared by multiple threads which then share the pages of the mapping.
+
+    @note Views are only valid as long as the object they were obtained from exists.
+  */
+  class OPENMS_DLLAPI CachedMzMLMappedFile
+  {
+public:
+
+    /// In-place view on the data of a single spectrum or chromatogram
+    struct DataView
+    {
+      const double* position = nullptr;  ///< m/z (spectra) or retention time (chromatograms) values
+      const double* intensity = nullptr; ///< intensity values
+      Size size = 0;                     ///< number of data points
+      int ms_level = 0;                  ///< MS level (spectra only)
+      double rt = -1.0;                  ///< retention time (spectra only)
+    };
+
+    /**
+      @brief Map the cached data file @p filename into memory and index it
+
+      @throws Exception::FileNotFound is thrown if the file cannot be opened or mapped
+      @throws Exception::ParseError is thrown if the file is not a valid cached mzML file
+    */
+    explicit CachedMzMLMappedFile(const String& filename);
+
+    /// Destructor, unmaps the file
+    ~CachedMzMLMappedFile();
+
+    CachedMzMLMappedFile(const CachedMzMLMappedFile&) = delete;
+    CachedMzMLMappedFile& operator=(const CachedMzMLMappedFile&) = delete;
+
+    /// Number of spectra in the file
+    Size getNrSpectra() const;
+
+    /// Number of chromatograms in the file
+    Size getNrChromatograms() const;
+
+    /// Byte offsets of all spectra in the file (same as CachedMzMLHandler::getSpectraIndex())
+    const std::vector<Size>& getSpectraIndex() const;
+
+    /// Byte offsets of all chromatograms in the file (same as CachedMzMLHandler::getChromatogramIndex())
+    const std::vector<Size>& getChromatogramIndex() const;
+
+    /// In-place view on spectrum @p id (m/z and intensity)
+    DataView getSpectrumView(Size id) const;
+
+    /// In-place view on chromatogram @p id (retention time and intensity)
+    DataView getChromatogramView(Size id) const;
+
+    /**
+      @brief Copy of all data arrays of spectrum @p id (m/z, intensity and additional arrays)
+
+      Equivalent to CachedMzMLHandler::readSpectrumFast().
+    */
+    std::vector<OpenSwath::BinaryDataArrayPtr> getSpectrumData(Size id, int& ms_level, double& rt) const;
+
+    /**
+      @brief Copy of all data arrays of chromatogram @p id (retention time, intensity and additional arrays)
+
+      Equivalent to CachedMzMLHandler::readChromatogramFast().
+    */
+    std::vector<OpenSwath::BinaryDataArrayPtr> getChromatogramData(Size id) const;
+
+protected:
+
+    /// Read a Size field at @p offset and advance @p offset (with bounds check)
+    Size readSize_(Size& offset) const;
+
+    /// Skip the additional data arrays starting at @p offset (with bounds check)
+    void skipDataArrays_(Size& offset, Size nr_arrays) const;
+
+    /// Append copies of the additional data arrays starting at @p offset to @p data
+    void copyDataArrays_(Size offset, Size nr_arrays, std::vector<OpenSwath::BinaryDataArrayPtr>& data) const;
+
+    /// The mapping
+    std::unique_ptr<boost::iostreams::mapped_file_source> file_;
+
+    /// Start of the mapped data
+    const char* data_ = nullptr;
+
+    /// Size of the mapped data in bytes
+    Size size_ = 0;
+
+    /// Name of the mapped file
+    String filename_;
+
+    /// Offsets of all spectra and chromatograms
+    std::vector<Size> spectra_index_;
+    std::vector<Size> chrom_index_;
+  };
+
+}
+}
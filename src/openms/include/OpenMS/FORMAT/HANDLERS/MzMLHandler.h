@@ -50,6 +50,7 @@
 #include <OpenMS/FORMAT/VALIDATORS/SemanticValidator.h>
 
 #include <map>
+#include <memory>
 
 
 //MISSING:
@@ -261,6 +262,25 @@ protected:
                                     const PeakFileOptions& peak_file_options,
                                     SpectrumType& spectrum);
 
+      /**
+          @brief Fill a single spectrum by decoding straight into its peak and float data arrays
+
+          Fast path of populateSpectraWithData_() which avoids the
+          intermediate decoded arrays of MzMLHandlerHelper::BinaryData (and
+          releases the Base64 strings as soon as they are decoded). It only
+          handles plain (optionally zlib compressed) float arrays without
+          m/z or intensity range restrictions.
+
+          @note Do not modify any internal state variables of the class since
+          this function will be executed in parallel.
+
+          @return false if the data cannot be handled by the fast path (nothing is changed then)
+      */
+      bool populateSpectraWithDataDirect_(std::vector<MzMLHandlerHelper::BinaryData>& input_data,
+                                          Size& length,
+                                          const PeakFileOptions& peak_file_options,
+                                          SpectrumType& spectrum);
+
       /**
           @brief Fill a single chromatogram with data from input
 
@@ -482,6 +502,37 @@ protected:
       /// Vector of chromatogram data stored for later parallel processing
       std::vector<ChromatogramData> chromatogram_data_;
 
+      /// Background decoding and delivery of spectra (see submitSpectraToPipeline_())
+      struct SpectraPipeline_;
+      std::unique_ptr<SpectraPipeline_> spectra_pipeline_;
+
+      /**
+          @brief Decode the binary data of all spectra in @p spectra (using multiple threads if available)
+
+          @exception Exception::ParseError is thrown if the binary data cannot be decoded
+      */
+      void decodeSpectra_(std::vector<SpectrumData>& spectra);
+
+      /// Hand all (decoded) spectra in @p spectra to the consumer / experiment in order
+      void deliverSpectra_(std::vector<SpectrumData>& spectra);
+
+      /**
+          @brief Queue the spectra on the current work stack for decoding in the background
+
+          Used instead of populateSpectraWithData_() when a consumer is set
+          and PeakFileOptions::getMaxInFlightBytes() is non-zero. Blocks
+          while the encoded data in flight would exceed the byte budget.
+      */
+      void submitSpectraToPipeline_();
+
+      /**
+          @brief Wait until all queued spectra were handed to the consumer
+
+          If @p stop is true, the background worker is shut down as well.
+          Errors encountered by the worker are re-thrown here.
+      */
+      void waitForSpectraPipeline_(bool stop);
+
       //@}
       
       /**@name temporary data structures to hold written data
@@ -154,6 +154,36 @@ namespace OpenMS
       */
       static void decodeBase64Arrays(std::vector<BinaryData> & data_, const bool skipXMLCheck = false);
 
+      /**
+        @brief Whether a data array can be decoded with decodeFloatArray()
+
+        True for (optionally zlib compressed) 32 or 64 bit float arrays
+        without numpress compression.
+      */
+      static bool isPlainFloatArray(const BinaryData& data);
+
+      /**
+        @brief Decode a single Base64 float array directly into a caller provided container
+
+        In contrast to decodeBase64Arrays(), the decoded values are not
+        stored in the (per spectrum) arrays of @p data: if the precision of
+        the data matches the value type of @p out, the data is decoded
+        straight into @p out, otherwise a per-thread scratch buffer is reused.
+        The Base64 string of @p data is released afterwards, so only the
+        target container holds the data.
+
+        The unit multiplier is applied and @p data.size is corrected if it
+        does not match the decoded length (with a warning, as in decodeBase64Arrays()).
+
+        @param data The data array, needs to fulfill isPlainFloatArray()
+        @param out The container to decode into (e.g. a FloatDataArray)
+        @param skipXMLCheck Whether to skip removing whitespaces from the Base64 array
+      */
+      static void decodeFloatArray(BinaryData& data, std::vector<float>& out, const bool skipXMLCheck = false);
+
+      /// @overload
+      static void decodeFloatArray(BinaryData& data, std::vector<double>& out, const bool skipXMLCheck = false);
+
       /**
         @brief Identify a data array from a list.
 
@@ -184,6 +214,16 @@ namespace OpenMS
                                                const String& value,
                                                const String& name,
                                                const String& unit_accession);
+
+    private:
+
+      /// Multiplies all values with the unit multiplier of @p data (e.g. minutes to seconds)
+      template <typename T>
+      static void applyUnitMultiplier_(const BinaryData& data, std::vector<T>& values);
+
+      /// Implementation of decodeFloatArray()
+      template <typename T>
+      static void decodeFloatArray_(BinaryData& data, std::vector<T>& out, const bool skipXMLCheck);
     };
 
 
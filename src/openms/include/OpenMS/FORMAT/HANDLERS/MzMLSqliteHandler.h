@@ -113,6 +113,9 @@ public:
           @param exp The result
           @param indices A list of indices restricting the resulting spectra only to those specified here
           @param meta_only Only read the meta data
+
+          Binary data is decoded in parallel; larger sorted index lists are
+          additionally read in chunks through one connection per thread.
       */
       void readSpectra(std::vector<MSSpectrum> & exp, const std::vector<int> & indices, bool meta_only = false) const;
 
@@ -122,6 +125,9 @@ public:
           @param exp The result
           @param indices A list of indices restricting the resulting chromatograms only to those specified here
           @param meta_only Only read the meta data
+
+          Binary data is decoded in parallel; larger sorted index lists are
+          additionally read in chunks through one connection per thread.
       */
       void readChromatograms(std::vector<MSChromatogram> & exp, const std::vector<int> & indices, bool meta_only = false) const;
 
@@ -165,6 +171,32 @@ public:
       */
       std::vector<size_t> getSpectraIndicesbyRT(double RT, double deltaRT, const std::vector<int> & indices) const;
 
+      /**
+          @brief Get spectral indices within a retention time range, optionally restricted by MS level and precursor
+
+          The query uses bound parameters and the indices on SPECTRUM.RETENTION_TIME,
+          SPECTRUM.MSLEVEL and PRECURSOR.ISOLATION_TARGET.
+
+          @param rt_start Start of the retention time range (inclusive)
+          @param rt_end End of the retention time range (inclusive)
+          @param ms_level Only consider spectra of this MS level (if zero or less, all spectra are considered)
+          @param isolation_target Only consider spectra with a precursor isolated at this m/z (if negative, spectra are not filtered by precursor)
+          @param isolation_tolerance Tolerance (absolute m/z) for matching @p isolation_target
+          @return The indices of the matching spectra (each spectrum once), sorted by retention time
+      */
+      std::vector<int> getSpectraIndicesByRange(double rt_start, double rt_end, int ms_level = 0,
+                                                double isolation_target = -1.0, double isolation_tolerance = 0.01) const;
+
+      /**
+          @brief Get the retention times of spectra
+
+          @param indices Spectra to consider (if empty, all spectra are considered, ordered by index)
+          @return The retention times, in the order of @p indices
+
+          @exception Exception::IllegalArgument is thrown if an index does not exist in the file
+      */
+      std::vector<double> getSpectraRT(const std::vector<int> & indices) const;
+
 protected:
 
       void populateChromatogramsWithData_(sqlite3 *db, std::vector<MSChromatogram>& chromatograms) const;
@@ -45,6 +45,7 @@
 #include <xercesc/sax2/DefaultHandler.hpp>
 #include <xercesc/sax2/Attributes.hpp>
 
+#include <functional>
 #include <iosfwd>
 #include <string>
 #include <memory>
@@ -458,6 +459,20 @@ protected:
       /// Writes the content of MetaInfoInterface to the file
       void writeUserParam_(const String & tag_name, std::ostream & os, const MetaInfoInterface & meta, UInt indent) const;
 
+      /**
+        @brief Writes @p count elements (e.g. features) to @p os, formatting blocks of elements in parallel
+
+        @p write_element(stream, i) writes element @p i to the given stream. It is called concurrently for
+        different elements, so it must not modify shared state (warning() and error() are safe to use).
+        The formatted blocks are written to @p os in order, so the output is identical to calling
+        @p write_element for each element in a sequential loop - which is what happens for few elements,
+        without OpenMP, or when called from within a parallel region.
+
+        @p progress (optional) is called from the calling thread with the number of elements written so far.
+      */
+      void writeElementsInParallel_(std::ostream & os, Size count, const std::function<void(std::ostream&, Size)> & write_element,
+                                    const std::function<void(Size)> & progress = {}) const;
+
       //@}
 
       ///@name controlled vocabulary handling methods
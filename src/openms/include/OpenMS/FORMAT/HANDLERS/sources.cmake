@@ -5,6 +5,7 @@ set(directory include/OpenMS/FORMAT/HANDLERS)
 set(sources_list_h
 AcqusHandler.h
 CachedMzMLHandler.h
+CachedMzMLMappedFile.h
 FidHandler.h
 IndexedMzMLDecoder.h
 IndexedMzMLHandler.h
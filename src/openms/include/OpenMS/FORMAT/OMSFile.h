@@ -38,6 +38,8 @@
 #include <OpenMS/KERNEL/FeatureMap.h>
 #include <OpenMS/METADATA/ID/IdentificationData.h>
 
+#include <functional>
+
 namespace OpenMS
 {
   /**
@@ -69,6 +71,19 @@ namespace OpenMS
      */
     void store(const String& filename, const FeatureMap& features);
 
+    /** @brief Write identification data to SQL-based OMS file in batches
+     *
+     * Calls @p next_batch repeatedly with an empty IdentificationData object, which the function should fill with the next chunk of data.
+     * Each batch is written to the file (in one transaction) before the next one is requested, so that the complete data never has to be held in memory.
+     * Entries occurring in several batches (e.g. input files, score types, processing steps, observations, identified molecules) are merged based on their unique properties; their attached information (scores, meta values) is taken from the first batch that contains them.
+     * To keep the memory use independent of the amount of data written, entries of the data tables (observations, parent sequences, identified molecules, matches) from earlier batches are looked up in the file rather than kept in memory.
+     *
+     * @param filename The output file
+     * @param next_batch Function that fills a batch and returns whether there is data to write; writing stops once it returns false
+     */
+    void storeBatches(const String& filename,
+                      const std::function<bool(IdentificationData&)>& next_batch);
+
     /** @brief Read in a OMS file and construct an IdentificationData object
      *
      * @param filename The input file
@@ -35,10 +35,13 @@
 #pragma once
 
 #include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/FORMAT/SqliteConnector.h>
 #include <OpenMS/KERNEL/FeatureMap.h>
 #include <OpenMS/METADATA/ID/IdentificationData.h>
 
-#include <QtSql/QSqlQuery>
+#include <memory>
+#include <set>
+#include <unordered_map>
 
 class QSqlError;
 
@@ -71,16 +74,33 @@ namespace OpenMS
     void raiseDBError_(const QSqlError& error, int line,
                        const char* function, const String& context);
 
+    /*!
+      @brief Raise a more informative database error
+
+      Add context to the last error reported by SQLite for database @p db and throw it as a FailedAPICall exception.
+
+      @throw Exception::FailedAPICall Throw this exception
+    */
+    void raiseDBError_(sqlite3* db, int line,
+                       const char* function, const String& context);
+
 
     /*!
       @brief Helper class for storing .oms files (SQLite format)
 
       This class encapsulates the SQLite database in a .oms file and allows to write data to it.
+
+      Data is written through the native SQLite API, using prepared statements that are compiled only once and reused for all rows of a table.
+      Every call to one of the @p store functions is written in a single transaction.
+
+      @p store(const IdentificationData&) can be called repeatedly to write large data sets in batches, so that the full data never has to be held in memory.
+      Entries that have a natural unique key (input files, score types, processing software, processing steps, search parameters, observations, parent sequences, identified molecules, adducts and observation matches) are merged with matching entries from previous batches.
+      In that case, the information attached to the entry (meta values, scores etc.) is taken from the batch where it first occurred.
     */
     class OMSFileStore: public ProgressLogger
     {
     public:
-      using Key = qint64; ///< Type used for database keys
+      using Key = Int64; ///< Type used for database keys
 
        /*!
         @brief Constructor
@@ -98,17 +118,29 @@ namespace OpenMS
       /*!
         @brief Destructor
 
-        Closes the connection to the database file.
+        Calls close() if that hasn't happened yet. Errors at this point are only logged, not thrown.
       */
       ~OMSFileStore();
 
-      /// Write data from an IdentificationData object to database
+      /// Write data from an IdentificationData object to database (can be called repeatedly to write batches)
       void store(const IdentificationData& id_data);
 
       /// Write data from a FeatureMap object to database
       void store(const FeatureMap& features);
 
+      /*!
+        @brief Finish writing
+
+        Creates database indexes (which are deferred until all data is written, since maintaining them during the bulk inserts is slower) and releases the prepared statements.
+        No more data can be stored afterwards.
+
+        @throw Exception::FailedAPICall An index cannot be created
+      */
+      void close();
+
     private:
+      void storeIdentificationData_(const IdentificationData& id_data);
+
       void storeVersionAndDate_();
 
       void storeScoreTypes_(const IdentificationData& id_data);
@@ -137,8 +169,27 @@ namespace OpenMS
 
       void storeFeatures_(const FeatureMap& features);
 
-      void createTable_(const String& name, const String& definition,
-                        bool may_exist = false);
+      /// Create a table (does nothing if the table was created before)
+      void createTable_(const String& name, const String& definition);
+
+      /// Check whether a table was created by this object
+      bool tableExists_(const String& name) const;
+
+      /// Execute an SQL statement that doesn't return data
+      void execute_(const String& sql, const String& context);
+
+      /// Get the prepared statement called @p name (the statement is compiled from @p sql on first use)
+      sqlite3_stmt* prepareQuery_(const String& name, const String& sql);
+
+      /// Get a prepared statement that was created before
+      sqlite3_stmt* getQuery_(const String& name);
+
+      /// Execute a prepared statement (and reset it for reuse on success)
+      static bool execQuery_(sqlite3_stmt* query);
+
+      void beginTransaction_();
+
+      void commitTransaction_();
 
       void createTableMoleculeType_();
 
@@ -164,30 +215,58 @@ namespace OpenMS
 
       void createTableIdentifiedMolecule_();
 
-      Key getAddress_(const IdentificationData::IdentifiedMolecule& molecule_var);
+      Key getAddress_(const IdentificationData::IdentifiedMolecule& molecule_var) const;
 
       void createTableParentMatches_();
 
       void storeParentMatches_(
         const IdentificationData::ParentMatches& matches, Key molecule_id);
 
+      /*!
+        @brief Assign a database key to an element of the current batch
+
+        If @p natural_key is given and an element of @p table with the same natural key was stored before, its key is reused.
+
+        @return The key and whether the element is new (i.e. still needs to be written)
+      */
+      std::pair<Key, bool> registerKey_(const void* element, const String& table,
+                                        const String& natural_key = "");
+
+      /*!
+        @brief Assign a database key to an element of the current batch, reusing the key of a row stored in a previous batch
+
+        Used for tables with one row per data element (observations, parent sequences, identified molecules, matches), whose natural keys are not kept in memory.
+        Instead, @p lookup_query (a prepared "SELECT id" query on a unique index, with all parameters bound) looks the element up among the rows written before.
+
+        @return The key and whether the element is new (i.e. still needs to be written)
+      */
+      std::pair<Key, bool> registerRowKey_(const void* element, sqlite3_stmt* lookup_query);
+
+      /// Look up the key (and "new" status) of an element registered in the current batch
+      const std::pair<Key, bool>& lookupKey_(const void* element) const;
+
+      /// Get the key of an element registered in the current batch
+      Key getKey_(const void* element) const
+      {
+        return lookupKey_(element).first;
+      }
+
       template<class MetaInfoInterfaceContainer>
       void storeMetaInfos_(const MetaInfoInterfaceContainer& container,
                            const String& parent_table)
       {
         bool table_created = false;
-        QSqlQuery query; // prepare query only once and only if needed
         for (const auto& element : container)
         {
-          if (!element.isMetaEmpty())
+          if (element.isMetaEmpty()) continue;
+          const std::pair<Key, bool>& key = lookupKey_(&element);
+          if (!key.second) continue; // stored in a previous batch
+          if (!table_created)
           {
-            if (!table_created)
-            {
-              createTableMetaInfo_(parent_table);
-              table_created = true;
-            }
-            storeMetaInfo_(element, parent_table, Key(&element));
+            createTableMetaInfo_(parent_table);
+            table_created = true;
           }
+          storeMetaInfo_(element, parent_table, key.first);
         }
       }
 
@@ -199,20 +278,20 @@ namespace OpenMS
         bool table_created = false;
         for (const auto& element : container)
         {
-          if (!element.steps_and_scores.empty())
+          if (element.steps_and_scores.empty()) continue;
+          const std::pair<Key, bool>& key = lookupKey_(&element);
+          if (!key.second) continue; // stored in a previous batch
+          if (!table_created)
           {
-            if (!table_created)
-            {
-              createTableAppliedProcessingStep_(parent_table);
-              table_created = true;
-            }
-            Size counter = 0;
-            for (const IdentificationData::AppliedProcessingStep& step :
-                   element.steps_and_scores)
-            {
-              storeAppliedProcessingStep_(step, ++counter, parent_table,
-                                          Key(&element));
-            }
+            createTableAppliedProcessingStep_(parent_table);
+            table_created = true;
+          }
+          Size counter = 0;
+          for (const IdentificationData::AppliedProcessingStep& step :
+                 element.steps_and_scores)
+          {
+            storeAppliedProcessingStep_(step, ++counter, parent_table,
+                                        key.first);
           }
         }
         storeMetaInfos_(container, parent_table);
@@ -240,11 +319,29 @@ namespace OpenMS
 
       void storeDataProcessing_(const FeatureMap& features);
 
-      // store name, not database connection itself (see https://stackoverflow.com/a/55200682):
-      QString db_name_;
+      /// connection to the database
+      std::unique_ptr<SqliteConnector> db_;
 
       /// prepared queries for inserting data into different tables
-      std::map<std::string, QSqlQuery> prepared_queries_;
+      std::map<std::string, sqlite3_stmt*> prepared_queries_;
+
+      /// tables that have been created so far
+      std::set<String> tables_;
+
+      /// database keys of the elements in the current batch (and whether they are new)
+      std::unordered_map<const void*, std::pair<Key, bool>> keys_;
+
+      /// database keys of stored metadata elements (input files, score types, etc.), indexed by table and natural key (persist across batches)
+      std::unordered_map<std::string, Key> natural_keys_;
+
+      /// has a batch been committed before the current one?
+      bool previous_batches_ = false;
+
+      /// next unused database key
+      Key next_key_ = 1;
+
+      /// number of parent group sets stored so far
+      Size grouping_counter_ = 0;
     };
   }
 }
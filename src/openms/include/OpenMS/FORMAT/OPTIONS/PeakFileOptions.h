@@ -221,6 +221,22 @@ public:
     Size getMaxDataPoolSize() const;
     /// Set maximal size of the data pool
     void setMaxDataPoolSize(Size size);
+
+    /**
+        @brief Get the maximal number of encoded bytes that may be in flight between parser and consumer
+
+        If non-zero and the reader forwards its data to a consumer
+        (Interfaces::IMSDataConsumer), full data pools are decoded and handed
+        to the consumer by a background worker while the parser continues
+        reading. The parser blocks whenever the encoded size of all pending
+        data pools would exceed this budget, so memory usage stays bounded.
+        A value of zero (default) disables the pipeline.
+
+        @note Currently only supported by the mzML reader
+    */
+    Size getMaxInFlightBytes() const;
+    /// Set the maximal number of encoded bytes in flight (0 disables pipelined decoding)
+    void setMaxInFlightBytes(Size bytes);
     //@}
 
     /// [mzML only!] Whether to use the "selected ion m/z" value as the precursor m/z value (alternative: use the "isolation window target m/z" value)
@@ -257,6 +273,7 @@ private:
     MSNumpressCoder::NumpressConfig np_config_int_;
     MSNumpressCoder::NumpressConfig np_config_fda_;
     Size maximal_data_pool_size_;
+    Size max_in_flight_bytes_;
     bool precursor_mz_selected_ion_;
   };
 
@@ -0,0 +1,219 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <OpenMS/INTERFACES/DataStructures.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/KERNEL/MSChromatogram.h>
+
+#include <string>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Column-oriented, optionally compressed in-memory representation of a mass spectrometry experiment
+
+    The peak data of all spectra is stored in contiguous columns (m/z as
+    double, intensity and ion mobility as float) instead of one
+    std::vector<Peak1D> per spectrum. This avoids the padding of Peak1D (12
+    instead of 16 bytes per peak) and keeps the data of consecutive spectra
+    adjacent in memory. Algorithms can work directly on the columns through
+    getSpectrumView() without materializing Peak1D objects, while
+    getSpectrum() returns a regular MSSpectrum.
+
+    Ion mobility values are taken from the float data array of spectra which
+    represent an IM frame (see MSSpectrum::getIMData()) and are stored as a
+    separate column. All other data arrays and all meta data are kept in a
+    peak-less MSExperiment (see getMetaData()).
+
+    Optionally, the peak data of each spectrum is compressed using MS Numpress
+    (linear for m/z and ion mobility, slof for intensities), which reduces the
+    memory footprint further. Compressed spectra have to be decoded on access
+    (see decodeSpectrum()) and encoding is lossy within the accuracy of the
+    numpress schemes. Columns for which numpress exceeds its error tolerance
+    are stored uncompressed. Chromatograms are always stored uncompressed.
+
+    The interface is modeled after OnDiscMSExperiment. Use
+    SpectrumAccessOpenMSColumnar to run OpenSWATH algorithms on it. Spectra
+    are appended one by one, such that the container can be filled directly
+    from a file using an Interfaces::IMSDataConsumer without holding the full
+    MSExperiment in memory:
+
+    @code
+    ColumnarMSExperiment columnar;
+    MSDataTransformingConsumer consumer;
+    consumer.setSpectraProcessingFunc([&columnar](MSSpectrum& s) { columnar.addSpectrum(s); });
+    consumer.setChromatogramProcessingFunc([&columnar](MSChromatogram& c) { columnar.addChromatogram(c); });
+    MzMLFile().transform(filename, &consumer);
+    @endcode
+
+    @note All const member functions may be called concurrently.
+
+    @ingroup Kernel
+  */
+  class OPENMS_DLLAPI ColumnarMSExperiment
+  {
+public:
+
+    /// Compression of the peak data
+    enum Compression
+    {
+      NONE,      ///< plain columns, in-place access through getSpectrumView()
+      NUMPRESS,  ///< peak data of each spectrum is compressed with MS Numpress
+      SIZE_OF_COMPRESSION
+    };
+
+    /// In-place view on the peak data of a single (uncompressed) spectrum
+    struct SpectrumView
+    {
+      const double* mz = nullptr;          ///< m/z values
+      const float* intensity = nullptr;    ///< intensity values
+      const float* ion_mobility = nullptr; ///< ion mobility values (nullptr if the spectrum has no ion mobility data)
+      Size size = 0;                       ///< number of peaks
+    };
+
+    /// Constructor
+    explicit ColumnarMSExperiment(Compression compression = NONE);
+
+    /// Constructor, converts all spectra and chromatograms of @p exp
+    explicit ColumnarMSExperiment(const PeakMap& exp, Compression compression = NONE);
+
+    /// Returns the compression of the peak data
+    Compression getCompression() const;
+
+    /// alias for getNrSpectra
+    Size size() const;
+
+    /// returns whether spectra are empty
+    bool empty() const;
+
+    /// get the total number of spectra available
+    Size getNrSpectra() const;
+
+    /// get the total number of chromatograms available
+    Size getNrChromatograms() const;
+
+    /// returns the meta data (spectra and chromatograms without peaks)
+    const PeakMap& getMetaData() const;
+
+    /// Number of bytes used to store the peak data of all spectra and chromatograms
+    Size getPeakDataSize() const;
+
+    /**
+      @brief Appends a spectrum
+
+      The meta data (including additional data arrays) is copied, the peaks and
+      the ion mobility array (if present) are appended to the columns.
+    */
+    void addSpectrum(const MSSpectrum& spectrum);
+
+    /// Appends a chromatogram
+    void addChromatogram(const MSChromatogram& chromatogram);
+
+    /**
+      @brief In-place view on the peak data of spectrum @p id
+
+      The view is invalidated when further spectra are added.
+
+      @throws Exception::IllegalArgument if the peak data is compressed (use decodeSpectrum() instead)
+    */
+    SpectrumView getSpectrumView(Size id) const;
+
+    /**
+      @brief Copies (or decodes) the peak data of spectrum @p id into the given columns
+
+      Works for all compression modes. @p ion_mobility is empty if the
+      spectrum has no ion mobility data.
+    */
+    void decodeSpectrum(Size id, std::vector<double>& mz, std::vector<float>& intensity, std::vector<float>& ion_mobility) const;
+
+    /// alias for getSpectrum
+    MSSpectrum operator[](Size n) const;
+
+    /// returns a single spectrum (meta data and peaks)
+    MSSpectrum getSpectrum(Size id) const;
+
+    /// returns the m/z and intensity data of a single spectrum
+    Interfaces::SpectrumPtr getSpectrumById(Size id) const;
+
+    /// returns a single chromatogram (meta data and peaks)
+    MSChromatogram getChromatogram(Size id) const;
+
+    /// returns the retention time and intensity data of a single chromatogram
+    Interfaces::ChromatogramPtr getChromatogramById(Size id) const;
+
+protected:
+
+    /// Appends the numpress encoded peak data of a spectrum to compressed_
+    void compressSpectrum_(const MSSpectrum& spectrum, const std::vector<float>* ion_mobility);
+
+    /// Compression of the peak data
+    Compression compression_;
+
+    /// The meta data (spectra and chromatograms without peaks)
+    PeakMap meta_ms_experiment_;
+
+    /// Start of each spectrum in the peak columns (or in compressed_), one entry more than there are spectra
+    std::vector<Size> spectrum_offsets_;
+
+    /// Whether a spectrum has ion mobility data
+    std::vector<bool> has_ion_mobility_;
+
+    /// Column of m/z values of all spectra (uncompressed)
+    std::vector<double> mz_;
+
+    /// Column of intensities of all spectra (uncompressed)
+    std::vector<float> intensity_;
+
+    /// Column of ion mobility values (uncompressed, empty if no spectrum has ion mobility data)
+    std::vector<float> ion_mobility_;
+
+    /// Numpress encoded peak data of all spectra (compressed)
+    std::string compressed_;
+
+    /// Start of each chromatogram in the chromatogram columns, one entry more than there are chromatograms
+    std::vector<Size> chromatogram_offsets_;
+
+    /// Column of retention times of all chromatograms
+    std::vector<double> chrom_rt_;
+
+    /// Column of intensities of all chromatograms
+    std::vector<float> chrom_intensity_;
+  };
+
+} // namespace OpenMS
@@ -22,6 +22,7 @@ MSChromatogram.h
 MSExperiment.h
 MSSpectrum.h
 OnDiscMSExperiment.h
+ColumnarMSExperiment.h
 Peak1D.h
 Peak2D.h
 PeakIndex.h
@@ -62,17 +62,26 @@ namespace OpenMS
       std::optional<ProcessingStepRef> processing_step_opt;
 
       /// Map of scores and their types
-      std::map<ScoreTypeRef, double> scores;
+      ScoreMap scores;
 
       /// Constructor
       explicit AppliedProcessingStep(
         const std::optional<ProcessingStepRef>& processing_step_opt =
-        std::nullopt, const std::map<ScoreTypeRef, double>& scores =
-        std::map<ScoreTypeRef, double>()):
+        std::nullopt, const ScoreMap& scores = ScoreMap()):
         processing_step_opt(processing_step_opt), scores(scores)
       {
       }
 
+      /// Constructor (scores given as @p std::map)
+      AppliedProcessingStep(
+        const std::optional<ProcessingStepRef>& processing_step_opt,
+        const std::map<ScoreTypeRef, double>& scores):
+        processing_step_opt(processing_step_opt),
+        scores(boost::container::ordered_unique_range, scores.begin(),
+               scores.end())
+      {
+      }
+
       /// Equality operator (needed for multi-index container)
       bool operator==(const AppliedProcessingStep& other) const
       {
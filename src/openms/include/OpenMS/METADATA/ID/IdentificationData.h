@@ -125,6 +125,7 @@ namespace OpenMS
     using ScoreType = IdentificationDataInternal::ScoreType;
     using ScoreTypes = IdentificationDataInternal::ScoreTypes;
     using ScoreTypeRef = IdentificationDataInternal::ScoreTypeRef;
+    using ScoreMap = IdentificationDataInternal::ScoreMap;
 
     using ScoredProcessingResult =
       IdentificationDataInternal::ScoredProcessingResult;
@@ -676,7 +677,7 @@ namespace OpenMS
     AddressLookup observation_match_lookup_;
 
     /// Helper function to check if all score types are valid
-    void checkScoreTypes_(const std::map<ScoreTypeRef, double>& scores) const;
+    void checkScoreTypes_(const ScoreMap& scores) const;
 
     /// Helper function to check if all applied processing steps are valid
     void checkAppliedProcessingSteps_(const AppliedProcessingSteps&
@@ -49,7 +49,7 @@ namespace OpenMS
     // @TODO: derive from MetaInfoInterface?
     struct ParentGroup
     {
-      std::map<ScoreTypeRef, double> scores;
+      ScoreMap scores;
       // @TODO: does this need a "leader" or some such?
       std::set<ParentSequenceRef> parent_refs;
     };
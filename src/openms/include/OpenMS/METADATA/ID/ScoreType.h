@@ -36,6 +36,8 @@
 
 #include <OpenMS/METADATA/ID/MetaData.h>
 
+#include <boost/container/flat_map.hpp>
+
 namespace OpenMS
 {
   namespace IdentificationDataInternal
@@ -90,5 +92,14 @@ namespace OpenMS
 
     typedef std::set<ScoreType> ScoreTypes;
     typedef IteratorWrapper<ScoreTypes::iterator> ScoreTypeRef;
+
+    /*!
+      @brief Scores by score type
+
+      Results typically carry only one or a few scores, so a sorted vector
+      avoids the per-score node allocation (and overhead) of a @p std::map.
+      This matters for the millions of matches in large data sets.
+    */
+    typedef boost::container::flat_map<ScoreTypeRef, double> ScoreMap;
   }
 }
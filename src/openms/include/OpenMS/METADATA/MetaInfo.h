@@ -41,6 +41,7 @@
 #include <OpenMS/DATASTRUCTURES/DataValue.h>
 
 #include <boost/container/flat_map.hpp>
+#include <boost/container/small_vector.hpp>
 
 namespace OpenMS
 {
@@ -126,7 +127,12 @@ public:
     void clear();
 
 private:
-    using MapType = boost::container::flat_map<UInt, DataValue>;
+    /// Number of values stored without an additional allocation (most objects carry only a few)
+    static constexpr Size INLINE_VALUES = 4;
+
+    /// Sorted vector of (index, value) pairs; the first @p INLINE_VALUES entries are stored inside the object
+    using MapType = boost::container::flat_map<UInt, DataValue, std::less<UInt>,
+                                               boost::container::small_vector<std::pair<UInt, DataValue>, INLINE_VALUES>>;
 
     /// Static MetaInfoRegistry
     static MetaInfoRegistry registry_;
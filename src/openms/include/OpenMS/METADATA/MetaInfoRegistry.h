@@ -41,6 +41,9 @@
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/DATASTRUCTURES/String.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #ifdef OPENMS_COMPILER_MSVC
@@ -70,6 +73,13 @@ namespace OpenMS
       12 - low_quality<BR>
       13 - charge<BR>
 
+      The registry is read far more often than it is modified (every access to
+      a meta value by name is a lookup). Its state is therefore kept in an
+      immutable snapshot that is replaced as a whole when a name is registered
+      or a description/unit is changed. Reading threads cache the current
+      snapshot and only synchronize when the registry has changed since their
+      last access, so concurrent lookups do not serialize.
+
       @ingroup Metadata
   */
   class OPENMS_DLLAPI MetaInfoRegistry
@@ -161,19 +171,42 @@ public:
     String getUnit(const String& name) const;
 
 private:
-    /// internal counter, that stores the next index to assign
-    UInt next_index_;
     using MapString2IndexType = std::unordered_map<std::string, UInt>;
     using MapIndex2StringType = std::unordered_map<UInt, std::string>;
-    
-    /// map from name to index
-    MapString2IndexType name_to_index_;
-    /// map from index to name
-    MapIndex2StringType index_to_name_;
-    /// map from index to description
-    MapIndex2StringType index_to_description_;
-    /// map from index to unit
-    MapIndex2StringType index_to_unit_;
+
+    /// State of the registry (never modified once published)
+    struct Snapshot
+    {
+      /// internal counter, that stores the next index to assign
+      UInt next_index = 1024;
+      /// map from name to index
+      MapString2IndexType name_to_index;
+      /// map from index to name
+      MapIndex2StringType index_to_name;
+      /// map from index to description
+      MapIndex2StringType index_to_description;
+      /// map from index to unit
+      MapIndex2StringType index_to_unit;
+    };
+
+    /**
+      @brief Returns the current state for reading
+
+      The reference stays valid until the calling thread calls this function again.
+    */
+    const Snapshot& snapshot_() const;
+
+    /// Publishes a modified state (@p write_mutex_ must be held)
+    void publish_(const std::shared_ptr<const Snapshot>& snapshot);
+
+    /// Current state (guarded by @p write_mutex_)
+    std::shared_ptr<const Snapshot> current_;
+    /// Serializes modifications (and refreshes of the per-thread snapshot caches)
+    mutable std::mutex write_mutex_;
+    /// Incremented whenever a new state is published
+    std::atomic<UInt64> version_;
+    /// Unique id of this registry (to distinguish registries in the per-thread caches)
+    UInt64 id_;
   };
 
 } // namespace OpenMS
@@ -137,10 +137,28 @@ public:
      */
     void pick(const MSChromatogram& input, MSChromatogram& output, std::vector<PeakBoundary>& boundaries, bool check_spacings = false) const;
 
+    /**
+      @brief Applies the peak-picking algorithm to a single spectrum if it is
+      selected for picking, otherwise copies it to the output.
+
+      A spectrum is selected if its MS level is listed in parameter
+      'ms_levels', or - if that list is empty (auto mode) - if it is not
+      centroided. This is the per-spectrum step of pickExperiment().
+
+      @param input  input spectrum
+      @param output  output spectrum with picked peaks (or a copy of @p input)
+      @param boundaries  boundaries of the picked peaks (unchanged if the spectrum was copied)
+      @param check_spectrum_type  if set, checks spectrum type and throws an exception if a centroided spectrum is selected for picking
+      @return Whether the spectrum was picked
+
+      @throw Exception::IllegalArgument if @p check_spectrum_type is set and a centroided spectrum is selected for picking
+     */
+    bool pickOrCopy(const MSSpectrum& input, MSSpectrum& output, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type = true) const;
+
     /**
       @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      method picks peaks for each scan in the map (in parallel, if OpenMP is
+      enabled). The resulting picked peaks are written to the output map.
      
       @param input  input map in profile mode
       @param output  output map with picked peaks
@@ -150,8 +168,8 @@ public:
 
     /**
       @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      method picks peaks for each scan in the map (in parallel, if OpenMP is
+      enabled). The resulting picked peaks are written to the output map.
      
       @param input  input map in profile mode
       @param output  output map with picked peaks
@@ -167,8 +185,11 @@ public:
 
     /**
       @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      method picks peaks for each scan in the map. The resulting picked peaks
+      are written to the output map.
+
+      Spectra are read from disc sequentially in batches; the spectra of a
+      batch are picked in parallel (if OpenMP is enabled).
 
       Currently we have to give up const-correctness but we know that everything on disc is constant
     */
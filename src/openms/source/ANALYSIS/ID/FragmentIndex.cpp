@@ -0,0 +1,272 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace OpenMS
+{
+  FragmentIndex::FragmentIndex(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm) :
+    fragment_mass_tolerance_(fragment_mass_tolerance),
+    fragment_mass_tolerance_unit_ppm_(fragment_mass_tolerance_unit_ppm)
+  {
+    if (fragment_mass_tolerance <= 0.0)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Fragment mass tolerance must be positive.");
+    }
+  }
+
+  Int64 FragmentIndex::bin_(double mz) const
+  {
+    if (fragment_mass_tolerance_unit_ppm_)
+    {
+      return (Int64)floor(log(mz) * inv_bin_width_);
+    }
+    return (Int64)floor(mz * inv_bin_width_);
+  }
+
+  Size FragmentIndex::addPeptide(double precursor_mass, const vector<double>& prefix_mz, const vector<double>& suffix_mz)
+  {
+    if (built_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Cannot add peptides to an index that is already built.");
+    }
+    if (!precursor_masses_.empty() && precursor_mass < precursor_masses_.back())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Peptides must be added in ascending order of their precursor mass.");
+    }
+    // one bit of each bin entry encodes the ion series
+    if (precursor_masses_.size() >= (Size(1) << 31))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Too many peptides for a fragment index.");
+    }
+
+    if (fragment_offsets_.empty()) { fragment_offsets_.push_back(0); }
+    precursor_masses_.push_back(precursor_mass);
+    prefix_counts_.push_back((UInt32)prefix_mz.size());
+    fragment_mz_.insert(fragment_mz_.end(), prefix_mz.begin(), prefix_mz.end());
+    fragment_mz_.insert(fragment_mz_.end(), suffix_mz.begin(), suffix_mz.end());
+    fragment_offsets_.push_back(fragment_mz_.size());
+    return precursor_masses_.size() - 1;
+  }
+
+  void FragmentIndex::build()
+  {
+    inv_bin_width_ = fragment_mass_tolerance_unit_ppm_ ?
+      1.0 / log1p(fragment_mass_tolerance_ * 1e-6) :
+      1.0 / fragment_mass_tolerance_;
+
+    bin_offsets_.clear();
+    bin_entries_.clear();
+    built_ = true;
+
+    if (fragment_mz_.empty())
+    {
+      min_bin_ = 0;
+      bin_offsets_.push_back(0);
+      return;
+    }
+
+    // bin of every fragment (fragments are stored peptide by peptide)
+    vector<Int64> bins(fragment_mz_.size());
+    Int64 max_bin = numeric_limits<Int64>::min();
+    min_bin_ = numeric_limits<Int64>::max();
+    for (Size i = 0; i != fragment_mz_.size(); ++i)
+    {
+      bins[i] = bin_(std::max(fragment_mz_[i], numeric_limits<double>::min()));
+      min_bin_ = std::min(min_bin_, bins[i]);
+      max_bin = std::max(max_bin, bins[i]);
+    }
+
+    // counting sort: peptides are scattered in ascending order, so each bin ends up sorted
+    bin_offsets_.assign(max_bin - min_bin_ + 2, 0);
+    for (Int64 b : bins) { ++bin_offsets_[b - min_bin_ + 1]; }
+    for (Size b = 1; b < bin_offsets_.size(); ++b) { bin_offsets_[b] += bin_offsets_[b - 1]; }
+
+    vector<Size> insert_pos(bin_offsets_.begin(), bin_offsets_.end() - 1);
+    bin_entries_.resize(fragment_mz_.size());
+    for (Size p = 0; p != precursor_masses_.size(); ++p)
+    {
+      const UInt32 entry = (UInt32)p << 1;
+      const Size prefix_end = fragment_offsets_[p] + prefix_counts_[p];
+      for (Size i = fragment_offsets_[p]; i != fragment_offsets_[p + 1]; ++i)
+      {
+        bin_entries_[insert_pos[bins[i] - min_bin_]++] = entry | UInt32(i >= prefix_end);
+      }
+    }
+  }
+
+  void FragmentIndex::clear()
+  {
+    built_ = false;
+    precursor_masses_.clear();
+    fragment_offsets_.clear();
+    prefix_counts_.clear();
+    fragment_mz_.clear();
+    min_bin_ = 0;
+    bin_offsets_.clear();
+    bin_entries_.clear();
+  }
+
+  Size FragmentIndex::size() const
+  {
+    return precursor_masses_.size();
+  }
+
+  Size FragmentIndex::getFragmentCount() const
+  {
+    return fragment_mz_.size();
+  }
+
+  double FragmentIndex::getPrecursorMass(Size peptide_index) const
+  {
+    return precursor_masses_[peptide_index];
+  }
+
+  pair<Size, Size> FragmentIndex::getPeptideRange(double min_mass, double max_mass) const
+  {
+    auto first = lower_bound(precursor_masses_.begin(), precursor_masses_.end(), min_mass);
+    auto last = upper_bound(first, precursor_masses_.end(), max_mass);
+    return { Size(first - precursor_masses_.begin()), Size(last - precursor_masses_.begin()) };
+  }
+
+  void FragmentIndex::getSpectrum(Size peptide_index, PeakSpectrum& spectrum) const
+  {
+    spectrum.clear(true);
+    const Size begin = fragment_offsets_[peptide_index];
+    const Size end = fragment_offsets_[peptide_index + 1];
+    const Size n_prefix = prefix_counts_[peptide_index];
+    const Size n_suffix = end - begin - n_prefix;
+
+    spectrum.reserve(end - begin);
+    spectrum.getStringDataArrays().resize(1);
+    spectrum.getStringDataArrays()[0].setName("IonNames");
+    PeakSpectrum::StringDataArray& ion_names = spectrum.getStringDataArrays()[0];
+    ion_names.reserve(end - begin);
+
+    // suffix ions are y1 ... y(n-1), so the last prefix ion is b(n-1)
+    const Size first_prefix_number = n_suffix + 1 - n_prefix;
+    for (Size i = 0; i != n_prefix; ++i)
+    {
+      spectrum.emplace_back(fragment_mz_[begin + i], 1.0);
+      ion_names.emplace_back("b" + String(first_prefix_number + i) + "+");
+    }
+    for (Size i = 0; i != n_suffix; ++i)
+    {
+      spectrum.emplace_back(fragment_mz_[begin + n_prefix + i], 1.0);
+      ion_names.emplace_back("y" + String(i + 1) + "+");
+    }
+    spectrum.sortByPosition();
+  }
+
+  void FragmentIndex::query(const PeakSpectrum& spectrum, Size first, Size last, Size min_matched, Size max_matches, vector<Match>& matches) const
+  {
+    QueryBuffer buffer;
+    query(spectrum, first, last, min_matched, max_matches, matches, buffer);
+  }
+
+  void FragmentIndex::query(const PeakSpectrum& spectrum, Size first, Size last, Size min_matched, Size max_matches, vector<Match>& matches, QueryBuffer& buffer) const
+  {
+    matches.clear();
+    last = std::min(last, size());
+    if (!built_ || first >= last || bin_entries_.empty()) { return; }
+
+    const Int64 max_bin = min_bin_ + (Int64)bin_offsets_.size() - 2;
+    const UInt32 first_entry = (UInt32)first << 1;
+    const UInt32 last_entry = (UInt32)last << 1;
+
+    // counts per peptide of the range, touched peptides are collected to avoid scanning (and resetting) the whole range
+    vector<Match>& counts = buffer.counts;
+    vector<UInt32>& touched = buffer.touched;
+    if (counts.size() < last - first) { counts.resize(last - first); }
+    touched.clear();
+
+    for (const Peak1D& p : spectrum)
+    {
+      const double mz = p.getMZ();
+      const double tolerance = fragment_mass_tolerance_unit_ppm_ ? mz * fragment_mass_tolerance_ * 1e-6 : fragment_mass_tolerance_;
+      if (mz + tolerance <= 0.0) { continue; }
+
+      const Int64 low_bin = std::max(bin_(std::max(mz - tolerance, numeric_limits<double>::min())), min_bin_);
+      const Int64 high_bin = std::min(bin_(mz + tolerance), max_bin);
+      for (Int64 b = low_bin; b <= high_bin; ++b)
+      {
+        auto bin_begin = bin_entries_.begin() + bin_offsets_[b - min_bin_];
+        auto bin_end = bin_entries_.begin() + bin_offsets_[b - min_bin_ + 1];
+        for (auto it = lower_bound(bin_begin, bin_end, first_entry); it != bin_end && *it < last_entry; ++it)
+        {
+          const UInt32 idx = (*it >> 1) - (UInt32)first;
+          Match& m = counts[idx];
+          if (m.matched() == 0) { touched.push_back(idx); }
+          if (*it & 1) { ++m.matched_suffix; } else { ++m.matched_prefix; }
+        }
+      }
+    }
+
+    for (UInt32 idx : touched)
+    {
+      if (counts[idx].matched() >= min_matched)
+      {
+        counts[idx].peptide_index = first + idx;
+        matches.push_back(counts[idx]);
+      }
+      counts[idx] = Match(); // leave the buffer clean for the next query
+    }
+
+    auto more_matched = [](const Match& a, const Match& b)
+    {
+      if (a.matched() != b.matched()) { return a.matched() > b.matched(); }
+      return a.peptide_index < b.peptide_index;
+    };
+
+    if (max_matches != 0 && matches.size() > max_matches)
+    {
+      partial_sort(matches.begin(), matches.begin() + max_matches, matches.end(), more_matched);
+      matches.resize(max_matches);
+    }
+    else
+    {
+      sort(matches.begin(), matches.end(), more_matched);
+    }
+  }
+
+} // namespace OpenMS
@@ -0,0 +1,403 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/ModifiedPeptideGenerator.h>
+#include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const uint64_t DATABASE_FILE_IDENTIFIER = 0x4244504550534d4f; // "OMSPEPDB"
+    const int32_t DATABASE_FILE_VERSION = 1;
+
+    /// size of @p bytes rounded up to the next multiple of 8
+    Size padded(Size bytes)
+    {
+      return (bytes + 7) & ~Size(7);
+    }
+
+    template<typename T>
+    void writeValue(std::ofstream& ofs, const T& value)
+    {
+      ofs.write((const char*)&value, sizeof(T));
+    }
+
+    /// write the element count, the elements and zero padding up to the next 8 byte boundary
+    void writeSection(std::ofstream& ofs, const void* data, Size count, Size element_size)
+    {
+      static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      writeValue(ofs, (uint64_t)count);
+      ofs.write((const char*)data, count * element_size);
+      ofs.write(zeros, padded(count * element_size) - count * element_size);
+    }
+  }
+
+  String PeptideDatabase::Settings::getKey() const
+  {
+    return "checksum=" + checksum
+      + ";enzyme=" + enzyme
+      + ";missed_cleavages=" + String(missed_cleavages)
+      + ";min_length=" + String(min_length)
+      + ";max_length=" + String(max_length)
+      + ";fixed=" + ListUtils::concatenate(fixed_modifications, ",")
+      + ";variable=" + ListUtils::concatenate(variable_modifications, ",")
+      + ";max_variable_mods=" + String(max_variable_mods_per_peptide);
+  }
+
+  PeptideDatabase::PeptideDatabase() = default;
+
+  PeptideDatabase::~PeptideDatabase() = default;
+
+  void PeptideDatabase::build(const vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings, const String& filename)
+  {
+    ProteaseDigestion digestor;
+    digestor.setEnzyme(settings.enzyme);
+    digestor.setMissedCleavages(settings.missed_cleavages);
+
+    // digest all proteins; peptides are collected per thread and grouped by sorting afterwards
+    vector<pair<std::string_view, UInt32> > digest; // (peptide, protein index)
+#pragma omp parallel
+    {
+      vector<pair<std::string_view, UInt32> > local_digest;
+      vector<pair<Size, Size> > current_digest;
+
+#pragma omp for schedule(dynamic, 100) nowait
+      for (SignedSize protein_index = 0; protein_index < (SignedSize)proteins.size(); ++protein_index)
+      {
+        const String& sequence = proteins[protein_index].sequence;
+        current_digest.clear();
+        digestor.digestUnmodified(sequence, current_digest, settings.min_length, settings.max_length);
+        for (const auto& c : current_digest)
+        {
+          std::string_view peptide(sequence.data() + c.first, c.second);
+          if (peptide.find_first_of("XBZ") != std::string_view::npos) { continue; }
+          local_digest.emplace_back(peptide, (UInt32)protein_index);
+        }
+      }
+
+#pragma omp critical (PeptideDatabase_digest)
+      digest.insert(digest.end(), local_digest.begin(), local_digest.end());
+    }
+
+    // lexicographic order makes the database independent of the thread schedule
+    std::sort(digest.begin(), digest.end());
+
+    // unique peptides with their proteins, and the text section (peptides, modified sequences and accessions)
+    vector<Peptide> peptides;
+    vector<UInt32> protein_refs;
+    String text;
+    for (Size i = 0; i < digest.size(); ++i)
+    {
+      if (i == 0 || digest[i].first != digest[i - 1].first)
+      {
+        peptides.push_back({text.size(), (UInt32)digest[i].first.size(), 0, protein_refs.size()});
+        text.append(digest[i].first.data(), digest[i].first.size());
+      }
+      // a peptide may occur more than once in a protein
+      if (peptides.back().protein_count == 0 || protein_refs.back() != digest[i].second)
+      {
+        protein_refs.push_back(digest[i].second);
+        ++peptides.back().protein_count;
+      }
+    }
+    vector<pair<std::string_view, UInt32> >().swap(digest);
+
+    if (peptides.size() > numeric_limits<UInt32>::max())
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, peptides.size());
+    }
+
+    // all modified variants of all peptides
+    ModifiedPeptideGenerator::MapToResidueType fixed_modifications = ModifiedPeptideGenerator::getModifications(settings.fixed_modifications);
+    ModifiedPeptideGenerator::MapToResidueType variable_modifications = ModifiedPeptideGenerator::getModifications(settings.variable_modifications);
+
+    vector<Candidate> candidates;
+    vector<AASequence> all_modified_peptides;
+    for (Size peptide_index = 0; peptide_index < peptides.size(); ++peptide_index)
+    {
+      const Peptide& p = peptides[peptide_index];
+      AASequence aas = AASequence::fromString(text.substr(p.sequence_offset, p.sequence_length));
+      all_modified_peptides.clear();
+      ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+      ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, settings.max_variable_mods_per_peptide, all_modified_peptides);
+
+      for (Size mod_index = 0; mod_index < all_modified_peptides.size(); ++mod_index)
+      {
+        const String modified = all_modified_peptides[mod_index].toString();
+        candidates.push_back({all_modified_peptides[mod_index].getMonoWeight(), (UInt32)peptide_index, (UInt32)mod_index, text.size(), (UInt32)modified.size(), 0});
+        text += modified;
+      }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+    {
+      if (a.mono_mass != b.mono_mass) { return a.mono_mass < b.mono_mass; }
+      if (a.peptide_index != b.peptide_index) { return a.peptide_index < b.peptide_index; }
+      return a.mod_index < b.mod_index;
+    });
+
+    vector<UInt64> accession_offsets;
+    for (const auto& protein : proteins)
+    {
+      accession_offsets.push_back(text.size());
+      text += protein.identifier;
+    }
+    accession_offsets.push_back(text.size());
+
+    // write to a temporary file next to the target and rename it, so concurrent or interrupted runs never see (or
+    // leave behind) a partially written database
+    const String tmp_filename = filename + "." + File::getUniqueName(false) + ".tmp";
+    std::ofstream ofs(tmp_filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    const String key = settings.getKey();
+    writeValue(ofs, DATABASE_FILE_IDENTIFIER);
+    writeValue(ofs, DATABASE_FILE_VERSION);
+    writeValue(ofs, int32_t(0)); // padding
+    writeSection(ofs, key.data(), key.size(), 1);
+    writeSection(ofs, candidates.data(), candidates.size(), sizeof(Candidate));
+    writeSection(ofs, peptides.data(), peptides.size(), sizeof(Peptide));
+    writeSection(ofs, protein_refs.data(), protein_refs.size(), sizeof(UInt32));
+    writeSection(ofs, accession_offsets.data(), accession_offsets.size(), sizeof(UInt64));
+    writeSection(ofs, text.data(), text.size(), 1);
+    ofs.close();
+    if (!ofs)
+    {
+      File::remove(tmp_filename);
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error while writing the peptide database.");
+    }
+    // rename() replaces an existing file atomically on POSIX systems; Windows does not replace existing files
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0 && !File::rename(tmp_filename, filename, true, false))
+    {
+      File::remove(tmp_filename);
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Could not replace the peptide database.");
+    }
+  }
+
+  UInt64 PeptideDatabase::readSize_(Size& offset) const
+  {
+    if (offset + sizeof(UInt64) > size_)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Peptide database file is truncated. Aborting!", filename_);
+    }
+    UInt64 value;
+    std::memcpy(&value, data_ + offset, sizeof(UInt64));
+    offset += sizeof(UInt64);
+    return value;
+  }
+
+  const char* PeptideDatabase::readSection_(Size& offset, Size count, Size element_size) const
+  {
+    if (count > (size_ - offset) / element_size || offset + padded(count * element_size) > size_)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Peptide database file is truncated. Aborting!", filename_);
+    }
+    const char* section = data_ + offset;
+    offset += padded(count * element_size);
+    return section;
+  }
+
+  void PeptideDatabase::clear()
+  {
+    file_.reset();
+    filename_.clear();
+    key_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    candidates_ = nullptr;
+    peptides_ = nullptr;
+    protein_refs_ = nullptr;
+    accession_offsets_ = nullptr;
+    text_ = nullptr;
+    candidate_count_ = peptide_count_ = protein_ref_count_ = protein_count_ = text_size_ = 0;
+  }
+
+  void PeptideDatabase::load(const String& filename)
+  {
+    clear();
+    filename_ = filename;
+
+    std::unique_ptr<boost::iostreams::mapped_file_source> file;
+    try
+    {
+      file.reset(new boost::iostreams::mapped_file_source(filename));
+    }
+    catch (std::exception&)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    data_ = file->data();
+    size_ = file->size();
+
+    Size offset = 0;
+    const UInt64 identifier = readSize_(offset);
+    if (identifier != DATABASE_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a peptide database (wrong file magic number). Aborting!", filename);
+    }
+    const UInt64 version_and_padding = readSize_(offset);
+    int32_t version;
+    std::memcpy(&version, &version_and_padding, sizeof(version));
+    if (version != DATABASE_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Unsupported peptide database version " + String(version) + " (expected " + String(DATABASE_FILE_VERSION) + "). Aborting!", filename);
+    }
+
+    // read all sections first, so a truncated file leaves no partially loaded database
+    Size count = readSize_(offset);
+    const char* key = readSection_(offset, count, 1);
+    String file_key(key, key + count);
+
+    const Size candidate_count = readSize_(offset);
+    const char* candidates = readSection_(offset, candidate_count, sizeof(Candidate));
+    const Size peptide_count = readSize_(offset);
+    const char* peptides = readSection_(offset, peptide_count, sizeof(Peptide));
+    const Size protein_ref_count = readSize_(offset);
+    const char* protein_refs = readSection_(offset, protein_ref_count, sizeof(UInt32));
+    const Size accession_count = readSize_(offset);
+    const UInt64* accession_offsets = reinterpret_cast<const UInt64*>(readSection_(offset, accession_count, sizeof(UInt64)));
+    const Size text_size = readSize_(offset);
+    const char* text = readSection_(offset, text_size, 1);
+    if (accession_count == 0 || accession_offsets[accession_count - 1] > text_size)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Peptide database file is corrupt. Aborting!", filename);
+    }
+
+    file_ = std::move(file);
+    key_ = file_key;
+    candidates_ = reinterpret_cast<const Candidate*>(candidates);
+    candidate_count_ = candidate_count;
+    peptides_ = reinterpret_cast<const Peptide*>(peptides);
+    peptide_count_ = peptide_count;
+    protein_refs_ = reinterpret_cast<const UInt32*>(protein_refs);
+    protein_ref_count_ = protein_ref_count;
+    accession_offsets_ = accession_offsets;
+    protein_count_ = accession_count - 1;
+    text_ = text;
+    text_size_ = text_size;
+  }
+
+  bool PeptideDatabase::isLoaded() const
+  {
+    return file_ != nullptr;
+  }
+
+  const String& PeptideDatabase::getKey() const
+  {
+    return key_;
+  }
+
+  bool PeptideDatabase::isCompatible(const Settings& settings) const
+  {
+    return isLoaded() && key_ == settings.getKey();
+  }
+
+  Size PeptideDatabase::size() const
+  {
+    return candidate_count_;
+  }
+
+  const PeptideDatabase::Candidate& PeptideDatabase::getCandidate(Size index) const
+  {
+    return candidates_[index];
+  }
+
+  pair<Size, Size> PeptideDatabase::getCandidateRange(double min_mass, double max_mass) const
+  {
+    const Candidate* end = candidates_ + candidate_count_;
+    const Candidate* first = std::lower_bound(candidates_, end, min_mass, [](const Candidate& c, double mass) { return c.mono_mass < mass; });
+    const Candidate* last = std::upper_bound(first, end, max_mass, [](double mass, const Candidate& c) { return mass < c.mono_mass; });
+    return { Size(first - candidates_), Size(last - candidates_) };
+  }
+
+  StringView PeptideDatabase::getModifiedSequence(Size index) const
+  {
+    return StringView(text_ + candidates_[index].sequence_offset, candidates_[index].sequence_length);
+  }
+
+  Size PeptideDatabase::getPeptideCount() const
+  {
+    return peptide_count_;
+  }
+
+  const PeptideDatabase::Peptide& PeptideDatabase::getPeptide(Size index) const
+  {
+    return peptides_[index];
+  }
+
+  StringView PeptideDatabase::getPeptideSequence(Size index) const
+  {
+    return StringView(text_ + peptides_[index].sequence_offset, peptides_[index].sequence_length);
+  }
+
+  Size PeptideDatabase::getProteinCount() const
+  {
+    return protein_count_;
+  }
+
+  Size PeptideDatabase::getProteinIndex(const Peptide& peptide, Size i) const
+  {
+    return protein_refs_[peptide.protein_offset + i];
+  }
+
+  StringView PeptideDatabase::getProteinAccession(Size index) const
+  {
+    return StringView(text_ + accession_offsets_[index], accession_offsets_[index + 1] - accession_offsets_[index]);
+  }
+
+} // namespace OpenMS
@@ -44,6 +44,7 @@
 #include <atomic>
 #include <map>
 #include <array>
+#include <numeric>
 
 
 #ifdef _OPENMP 
@@ -192,6 +193,76 @@ using namespace std;
     }
   }
 
+  // free function (not exported) used to search a (preprocessed) protein; long stretches of 'X' are skipped, unless a peptide contains 'X'
+  void searchProtein(ACTrie& trie, ACTrieState& state, const String& prot, Hit::T idx_prot, const bool peptide_has_X, const std::string& jumpX,
+                     FoundProteinFunctor& func_threads, const bool allow_nterm_protein_cleavage)
+  {
+    // check if there are stretches of 'X' in the protein, but not in the peptide
+    if (!peptide_has_X && prot.has('X'))
+    {
+      // create chunks of the protein (splitting it at stretches of 'X..X') and feed them to AC one by one
+      size_t offset = -1, start = 0;
+      while ((offset = prot.find(jumpX, offset + 1)) != std::string::npos)
+      {
+        //std::cout << "found X..X at " << offset << " in protein " << proteins[i].identifier << "\n";
+        search(trie, state, prot.substr(start, offset + jumpX.size() - start), prot, start, idx_prot, func_threads,
+               allow_nterm_protein_cleavage);
+        // skip ahead while we encounter more X...
+        while (offset + jumpX.size() < prot.size() && prot[offset + jumpX.size()] == 'X') ++offset;
+        start = offset;
+        //std::cout << "  new start: " << start << "\n";
+      }
+      // last chunk
+      if (start < prot.size())
+      {
+        search(trie, state, prot.substr(start), prot, start, idx_prot, func_threads, allow_nterm_protein_cleavage);
+      }
+    }
+    else // search the whole protein at once
+    {
+      search(trie, state, prot, prot, 0, idx_prot, func_threads, allow_nterm_protein_cleavage);
+    }
+  }
+
+  // free function (not exported) which returns the sequences of all peptide hits (in order), as used for searching
+  std::vector<String> getPeptideSequences(const std::vector<PeptideIdentification>& pep_ids, const bool IL_equivalent)
+  {
+    std::vector<String> sequences;
+    for (const auto& pep : pep_ids)
+    {
+      for (const auto& hit : pep.getHits())
+      {
+        //
+        // Warning:
+        // do not skip over peptides here, since the results are iterated in the same way
+        //
+        String seq = hit.getSequence().toUnmodifiedString().remove('*'); // make a copy, i.e. do NOT change the peptide sequence!
+        if (IL_equivalent)                                               // convert L to I;
+        {
+          seq.substitute('L', 'I');
+        }
+        sequences.push_back(std::move(seq));
+      }
+    }
+    return sequences;
+  }
+
+  // search results, shared by the database scan and the index lookup
+  struct PeptideIndexing::SearchResult_
+  {
+    SearchResult_(const ProteaseDigestion& enzyme, bool xtandem) :
+      func(enzyme, xtandem), xtandem_fix_parameters(xtandem)
+    {
+    }
+
+    FoundProteinFunctor func; ///< store the matches
+    std::map<String, Size> acc_to_prot; ///< map: accessions --> FASTA protein index
+    std::vector<bool> protein_is_decoy; ///< protein index -> is decoy?
+    std::vector<std::string> protein_accessions; ///< protein index -> accession
+    bool invalid_protein_sequence = false; ///< check for proteins with modifications, i.e. '[' or '(', and throw an exception
+    bool xtandem_fix_parameters = false; ///< X!Tandem cleavage rules were applied
+  };
+
   PeptideIndexing::PeptideIndexing()
     : DefaultParamHandler("PeptideIndexing")
   {
@@ -299,8 +370,154 @@ bool PeptideIndexing::isPrefix() const
   return prefix_;
 }
 
+PeptideIndexing::ExitCodes PeptideIndexing::run(const ProteinSequenceIndex& index, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids)
+{
+  if (index.isILEquivalent() != IL_equivalent_)
+  {
+    throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+      String("The protein sequence index was built ") + (index.isILEquivalent() ? "with" : "without") + " IL_equivalent, which does not match the current settings. Please rebuild the index.");
+  }
+
+  FASTAContainer<TFI_Vector> proteins(index.getEntries());
+  ProteaseDigestion enzyme;
+  bool xtandem_fix_parameters = false;
+  prepare_(proteins, prot_ids, enzyme, xtandem_fix_parameters);
+
+  if (index.empty()) // we do not allow an empty database
+  {
+    OPENMS_LOG_ERROR << "Error: An empty database was provided. Mapping makes no sense. Aborting..." << std::endl;
+    return DATABASE_EMPTY;
+  }
+
+  if (pep_ids.empty())
+  {
+    return emptyPeptideIds_(prot_ids);
+  }
+
+  SearchResult_ result(enzyme, xtandem_fix_parameters);
+  result.invalid_protein_sequence = index.hasInvalidSequences();
+  const Size protein_count = index.size();
+  result.protein_accessions.resize(protein_count);
+  result.protein_is_decoy.resize(protein_count);
+  for (Size i = 0; i < protein_count; ++i)
+  {
+    const String& acc = index.getEntries()[i].identifier;
+    result.protein_is_decoy[i] = (prefix_ ? acc.hasPrefix(decoy_string_) : acc.hasSuffix(decoy_string_));
+  }
+
+  StopWatch s;
+  s.start();
+  // the trie is always built, since it validates the peptide sequences just like a database scan does
+  const std::vector<String> peptides = getPeptideSequences(pep_ids, IL_equivalent_);
+  ACTrie ac_trie(aaa_max_, mm_max_);
+  bool peptide_has_X {false}; // if any peptide contains an 'X', we switch off protein-X splitting
+  for (const auto& seq : peptides)
+  {
+    peptide_has_X |= seq.has('X');
+    ac_trie.addNeedle(seq);
+  }
+  if (ac_trie.getNeedleCount() == 0)
+  {
+    OPENMS_LOG_WARN << "Warning: Peptide identifications have no hits inside! Output will be empty as well." << std::endl;
+    return PEPTIDE_IDS_EMPTY;
+  }
+
+  // the suffix array only answers exact matches; proteins with ambiguous AAs (or all of them, if mismatches are allowed) are searched with Aho-Corasick
+  std::vector<Hit::T> scan_proteins;
+  if (mm_max_ > 0)
+  {
+    scan_proteins.resize(protein_count);
+    std::iota(scan_proteins.begin(), scan_proteins.end(), Hit::T(0));
+  }
+  else
+  {
+    scan_proteins = index.getAmbiguousProteins();
+  }
+  if (!scan_proteins.empty())
+  {
+    ac_trie.compressTrie();
+  }
+
+  OPENMS_LOG_INFO << "Mapping " << peptides.size() << " peptides to " << protein_count << " proteins using the protein sequence index ("
+                  << scan_proteins.size() << " proteins are searched with up to " << aaa_max_ << " ambiguous amino acid(s) and " << mm_max_ << " mismatch(es))." << std::endl;
+
+  uint16_t count_j_proteins(0);
+  const std::string jumpX(aaa_max_ + mm_max_ + 1, 'X'); // see run_()
+
+  #pragma omp parallel
+  {
+    FoundProteinFunctor func_threads(enzyme, xtandem_fix_parameters);
+    std::vector<Hit::T> found_proteins;
+
+    // exact matches: peptides are sharded across threads, which all query the same (read-only) suffix array
+    if (mm_max_ == 0)
+    {
+      std::vector<ProteinSequenceIndex::Occurrence> occurrences;
+      #pragma omp for schedule(dynamic, 1000) nowait
+      for (SignedSize i = 0; i < (SignedSize)peptides.size(); ++i)
+      {
+        occurrences.clear();
+        index.findExact(peptides[i], occurrences);
+        const Hit::T len_pep = Hit::T(peptides[i].size());
+        for (const auto& occ : occurrences)
+        {
+          const String& prot = index.getSearchSequence(occ.protein_index);
+          const bool is_valid = func_threads.validate(prot, occ.position, len_pep, allow_nterm_protein_cleavage_);
+          func_threads.addHit(is_valid, Hit::T(i), occ.protein_index, len_pep, prot, occ.position);
+          found_proteins.push_back(occ.protein_index);
+        }
+      }
+    }
+
+    // remaining proteins: Aho-Corasick (as in run_())
+    ACTrieState ac_state;
+    #pragma omp for schedule(dynamic, 100) nowait
+    for (SignedSize i = 0; i < (SignedSize)scan_proteins.size(); ++i)
+    {
+      const Hit::T prot_idx = scan_proteins[i];
+      const String& prot = index.getSearchSequence(prot_idx);
+      if (!IL_equivalent_ && prot.has('J'))
+      {
+        #pragma omp atomic
+        ++count_j_proteins;
+      }
+      const Size hits_total = func_threads.filter_passed + func_threads.filter_rejected;
+      searchProtein(ac_trie, ac_state, prot, prot_idx, peptide_has_X, jumpX, func_threads, allow_nterm_protein_cleavage_);
+      if (hits_total < func_threads.filter_passed + func_threads.filter_rejected)
+      {
+        found_proteins.push_back(prot_idx);
+      }
+    }
+
+    // join results
+    #pragma omp critical(PeptideIndexer_joinIndex)
+    {
+      result.func.merge(func_threads);
+      for (const Hit::T prot_idx : found_proteins)
+      {
+        result.protein_accessions[prot_idx] = index.getEntries()[prot_idx].identifier;
+        result.acc_to_prot[result.protein_accessions[prot_idx]] = prot_idx;
+      }
+    }
+  }
+  // sort hits by peptide index
+  std::sort(result.func.pep_to_prot.begin(), result.func.pep_to_prot.end());
+  s.stop();
+  OPENMS_LOG_INFO << "Index lookup done (" << s.toString() << "): " << result.func.filter_passed << " hits passing and " << result.func.filter_rejected << " hits rejected by the enzyme filter." << std::endl;
+
+  if (count_j_proteins)
+  {
+    OPENMS_LOG_WARN << "PeptideIndexer found " << count_j_proteins << " protein sequences in your database containing the amino acid 'J'."
+      << "To match 'J' in a protein, an ambiguous amino acid placeholder for I/L will be used.\n"
+      << "This costs runtime and eats into the 'aaa_max' limit, leaving less opportunity for B/Z/X matches.\n"
+      << "If you want 'J' to be treated as unambiguous, enable '-IL_equivalent'!" << std::endl;
+  }
+
+  return annotate_(result, protein_count, [&index](Size protein_index, FASTAFile::FASTAEntry& fe) { fe = index.getEntries()[protein_index]; }, prot_ids, pep_ids);
+}
+
 template<typename T>
-PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids)
+void PeptideIndexing::prepare_(FASTAContainer<T>& proteins, const std::vector<ProteinIdentification>& prot_ids, ProteaseDigestion& enzyme, bool& xtandem_fix_parameters)
 {
   if ((enzyme_name_ == "Chymotrypsin" || enzyme_name_ == "Chymotrypsin/P" || enzyme_name_ == "TrypChymo")
     && IL_equivalent_)
@@ -329,7 +546,6 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
   //---------------------------------------------------------------
   // parsing parameters, correcting XTandem and MSGFPlus parameters
   //---------------------------------------------------------------
-  ProteaseDigestion enzyme;
   if (!enzyme_name_.empty() && (enzyme_name_.compare(AUTO_MODE) != 0))
   { // use param (not empty, not 'auto')
     enzyme.setEnzyme(enzyme_name_);
@@ -345,7 +561,6 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
     enzyme.setEnzyme("Trypsin");
   } 
 
-  bool xtandem_fix_parameters = false;
   bool msgfplus_fix_parameters = false;
 
   // determine if at least one search engine was XTandem or MSGFPlus to enable special rules
@@ -386,6 +601,29 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
     OPENMS_LOG_WARN << "Warning: Enzyme specificity neither given nor present in the input file. Defaulting to 'full'!" << std::endl;
     enzyme.setSpecificity(ProteaseDigestion::SPEC_FULL);
   }
+}
+
+PeptideIndexing::ExitCodes PeptideIndexing::emptyPeptideIds_(std::vector<ProteinIdentification>& prot_ids) const
+{
+  OPENMS_LOG_WARN << "Warning: An empty set of peptide identifications was provided. Output will be empty as well." << std::endl;
+  if (!keep_unreferenced_proteins_)
+  {
+    // delete only protein hits, not whole ID runs incl. meta data:
+    for (std::vector<ProteinIdentification>::iterator it = prot_ids.begin();
+      it != prot_ids.end(); ++it)
+    {
+      it->getHits().clear();
+    }
+  }
+  return PEPTIDE_IDS_EMPTY;
+}
+
+template<typename T>
+PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids)
+{
+  ProteaseDigestion enzyme;
+  bool xtandem_fix_parameters = false;
+  prepare_(proteins, prot_ids, enzyme, xtandem_fix_parameters);
 
   //-------------------------------------------------------------
   // calculations
@@ -405,25 +643,16 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
 
   if (pep_ids.empty()) // Aho-Corasick requires non-empty input; but we allow this case, since the TOPP tool should not crash when encountering a bad raw file (with no PSMs)
   {
-    OPENMS_LOG_WARN << "Warning: An empty set of peptide identifications was provided. Output will be empty as well." << std::endl;
-    if (!keep_unreferenced_proteins_)
-    {
-      // delete only protein hits, not whole ID runs incl. meta data:
-      for (std::vector<ProteinIdentification>::iterator it = prot_ids.begin();
-        it != prot_ids.end(); ++it)
-      {
-        it->getHits().clear();
-      }
-    }
-    return PEPTIDE_IDS_EMPTY;
+    return emptyPeptideIds_(prot_ids);
   }
 
-  FoundProteinFunctor func(enzyme, xtandem_fix_parameters); // store the matches
-  std::map<String, Size> acc_to_prot; // map: accessions --> FASTA protein index
-  std::vector<bool> protein_is_decoy; // protein index -> is decoy?
-  std::vector<std::string> protein_accessions; // protein index -> accession
+  SearchResult_ result(enzyme, xtandem_fix_parameters);
+  FoundProteinFunctor& func = result.func; // store the matches
+  std::map<String, Size>& acc_to_prot = result.acc_to_prot; // map: accessions --> FASTA protein index
+  std::vector<bool>& protein_is_decoy = result.protein_is_decoy; // protein index -> is decoy?
+  std::vector<std::string>& protein_accessions = result.protein_accessions; // protein index -> accession
 
-  bool invalid_protein_sequence = false; // check for proteins with modifications, i.e. '[' or '(', and throw an exception
+  bool& invalid_protein_sequence = result.invalid_protein_sequence; // check for proteins with modifications, i.e. '[' or '(', and throw an exception
 
   { // new scope - forget data after search
     /*
@@ -435,22 +664,10 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
     StopWatch s;
     s.start();
     bool peptide_has_X {false}; // if any peptide contains an 'X', we switch off protein-X splitting (see below)
-    for (const auto& pep : pep_ids)
+    for (const auto& seq : getPeptideSequences(pep_ids, IL_equivalent_))
     {
-      for (const auto& hit : pep.getHits())
-      {
-        //
-        // Warning:
-        // do not skip over peptides here, since the results are iterated in the same way
-        //
-        String seq = hit.getSequence().toUnmodifiedString().remove('*'); // make a copy, i.e. do NOT change the peptide sequence!
-        if (IL_equivalent_)                                              // convert L to I;
-        {
-          seq.substitute('L', 'I');
-        }
-        peptide_has_X |= seq.has('X');
-        ac_trie.addNeedle(seq);
-      }
+      peptide_has_X |= seq.has('X');
+      ac_trie.addNeedle(seq);
     }
     s.stop();
     OPENMS_LOG_INFO << " done (" << int(s.getClockTime()) << "s)" << std::endl;
@@ -549,31 +766,8 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
           // grab #hits before searching protein; we know its a hit if this number changes
           const Size hits_total = func_threads.filter_passed + func_threads.filter_rejected;
 
-          // check if there are stretches of 'X' in the protein, but not in the peptide
-          if (!peptide_has_X && prot.has('X'))
-          {
-            // create chunks of the protein (splitting it at stretches of 'X..X') and feed them to AC one by one
-            size_t offset = -1, start = 0;
-            while ((offset = prot.find(jumpX, offset + 1)) != std::string::npos)
-            {
-              //std::cout << "found X..X at " << offset << " in protein " << proteins[i].identifier << "\n";
-              search(ac_trie, ac_state, prot.substr(start, offset + jumpX.size() - start), prot, start, prot_idx, func_threads,
-                     allow_nterm_protein_cleavage_);
-              // skip ahead while we encounter more X...
-              while (offset + jumpX.size() < prot.size() && prot[offset + jumpX.size()] == 'X') ++offset;
-              start = offset;
-              //std::cout << "  new start: " << start << "\n";
-            }
-            // last chunk
-            if (start < prot.size())
-            {
-              search(ac_trie, ac_state, prot.substr(start), prot, start, prot_idx, func_threads, allow_nterm_protein_cleavage_);
-            }
-          }
-          else // search the whole protein at once
-          {
-            search(ac_trie, ac_state, prot, prot, 0, prot_idx, func_threads, allow_nterm_protein_cleavage_);
-          }
+          searchProtein(ac_trie, ac_state, prot, prot_idx, peptide_has_X, jumpX, func_threads, allow_nterm_protein_cleavage_);
+
           // was protein found?
           if (hits_total < func_threads.filter_passed + func_threads.filter_rejected)
           {
@@ -633,6 +827,17 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
 
   } // end local scope
 
+  return annotate_(result, proteins.size(), [&proteins](Size protein_index, FASTAFile::FASTAEntry& fe) { proteins.readAt(fe, protein_index); }, prot_ids, pep_ids);
+}
+
+PeptideIndexing::ExitCodes PeptideIndexing::annotate_(SearchResult_& result, const Size protein_count, const std::function<void(Size, FASTAFile::FASTAEntry&)>& read_protein,
+                                                      std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids)
+{
+  const FoundProteinFunctor& func = result.func;
+  const std::map<String, Size>& acc_to_prot = result.acc_to_prot;
+  const std::vector<bool>& protein_is_decoy = result.protein_is_decoy;
+  const std::vector<std::string>& protein_accessions = result.protein_accessions;
+
   //
   //   do mapping 
   //
@@ -807,7 +1012,7 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
       
       if (write_protein_sequence_ || write_protein_description_)
       {
-        proteins.readAt(fe, *it);
+        read_protein(*it, fe);
         if (write_protein_sequence_)
         {
           hit.setSequence(fe.sequence);
@@ -837,7 +1042,7 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
   OPENMS_LOG_INFO << "-----------------------------------\n";
   OPENMS_LOG_INFO << "Protein statistics\n";
   OPENMS_LOG_INFO << "\n";
-  OPENMS_LOG_INFO << "  total proteins searched: " << proteins.size() << "\n";
+  OPENMS_LOG_INFO << "  total proteins searched: " << protein_count << "\n";
   OPENMS_LOG_INFO << "  matched proteins       : " << stats_matched_proteins << " (" << stats_matched_new_proteins << " new)\n";
   if (stats_matched_proteins)
   { // prevent Division-by-0 Exception
@@ -851,7 +1056,7 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
   /// exit if no peptides were matched to decoy
   bool has_error = false;
 
-  if (invalid_protein_sequence)
+  if (result.invalid_protein_sequence)
   {
     OPENMS_LOG_ERROR << "Error: One or more protein sequences contained the characters '[' or '(', which are illegal in protein sequences."
               << "\nPeptide hits might be masked by these characters (which usually indicate presence of modifications).\n";
@@ -899,7 +1104,7 @@ PeptideIndexing::ExitCodes PeptideIndexing::run_(FASTAContainer<T>& proteins, st
     {
       OPENMS_LOG_ERROR << "  Warning: " << stats_unmatched <<" unmatched hits have been removed!\n"
                         << "Make sure that these hits are actually a violation of the cutting rules by inspecting the database!\n";
-      if (xtandem_fix_parameters) OPENMS_LOG_ERROR << "Since the results are from X!Tandem, this is probably ok (check anyways).\n";
+      if (result.xtandem_fix_parameters) OPENMS_LOG_ERROR << "Since the results are from X!Tandem, this is probably ok (check anyways).\n";
     }
     else
     {
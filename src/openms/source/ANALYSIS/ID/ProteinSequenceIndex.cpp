@@ -0,0 +1,368 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/ANALYSIS/ID/ProteinSequenceIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const uint64_t INDEX_FILE_IDENTIFIER = 0x5844495350534d4f; // "OMSPSIDX"
+    const int32_t INDEX_FILE_VERSION = 1;
+
+    template<typename T>
+    void writeValue(std::ofstream& ofs, const T& value)
+    {
+      ofs.write((const char*)&value, sizeof(T));
+    }
+
+    template<typename T>
+    void readValue(std::ifstream& ifs, T& value)
+    {
+      ifs.read((char*)&value, sizeof(T));
+    }
+
+    void writeString(std::ofstream& ofs, const std::string& s)
+    {
+      writeValue(ofs, (uint64_t)s.size());
+      ofs.write(s.data(), s.size());
+    }
+
+    void readString(std::ifstream& ifs, std::string& s)
+    {
+      uint64_t size = 0;
+      readValue(ifs, size);
+      s.resize(size);
+      ifs.read(&s[0], size);
+    }
+
+    template<typename T>
+    void writeVector(std::ofstream& ofs, const std::vector<T>& v)
+    {
+      writeValue(ofs, (uint64_t)v.size());
+      ofs.write((const char*)v.data(), v.size() * sizeof(T));
+    }
+
+    template<typename T>
+    void readVector(std::ifstream& ifs, std::vector<T>& v)
+    {
+      uint64_t size = 0;
+      readValue(ifs, size);
+      v.resize(size);
+      ifs.read((char*)v.data(), size * sizeof(T));
+    }
+  }
+
+  void ProteinSequenceIndex::build(FASTAContainer<TFI_File>& proteins, bool IL_equivalent, const String& checksum)
+  {
+    build_(proteins, IL_equivalent, checksum);
+  }
+
+  void ProteinSequenceIndex::build(FASTAContainer<TFI_Vector>& proteins, bool IL_equivalent, const String& checksum)
+  {
+    build_(proteins, IL_equivalent, checksum);
+  }
+
+  template<typename T>
+  void ProteinSequenceIndex::build_(FASTAContainer<T>& proteins, bool IL_equivalent, const String& checksum)
+  {
+    checksum_ = checksum;
+    IL_equivalent_ = IL_equivalent;
+    has_invalid_sequences_ = false;
+    entries_.clear();
+    text_.clear();
+    offsets_.clear();
+    search_sequences_.clear();
+    ambiguous_.clear();
+    sa_.clear();
+
+    constexpr size_t PROTEIN_CACHE_SIZE = 4e5;
+    proteins.reset();
+    while (true)
+    {
+      proteins.cacheChunk(PROTEIN_CACHE_SIZE);
+      if (!proteins.activateCache()) break;
+
+      for (Size i = 0; i < proteins.chunkSize(); ++i)
+      {
+        const FASTAFile::FASTAEntry& entry = proteins.chunkAt(i);
+        // same preprocessing as in PeptideIndexing
+        String prot = entry.sequence;
+        prot.remove('*');
+        if (IL_equivalent_)
+        {
+          prot.substitute('L', 'I');
+          prot.substitute('J', 'I');
+        }
+        has_invalid_sequences_ |= (prot.has('[') || prot.has('('));
+
+        // only proteins made of unambiguous, uppercase letters can be matched exactly
+        const bool regular = std::all_of(prot.begin(), prot.end(), [](char c) {
+          return c >= 'A' && c <= 'Z' && c != 'B' && c != 'J' && c != 'Z' && c != 'X';
+        });
+        if (!regular)
+        {
+          ambiguous_.push_back(Hit::T(entries_.size()));
+        }
+
+        if (text_.size() + prot.size() + 1 >= std::numeric_limits<Hit::T>::max())
+        {
+          throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, text_.size() + prot.size() + 1);
+        }
+        offsets_.push_back(Hit::T(text_.size()));
+        text_ += prot;
+        text_ += '$';
+        search_sequences_.push_back(std::move(prot));
+        entries_.push_back(entry);
+      }
+    }
+    offsets_.push_back(Hit::T(text_.size()));
+    proteins.reset();
+
+    buildSuffixArray_();
+  }
+
+  void ProteinSequenceIndex::buildSuffixArray_()
+  {
+    const unsigned char* txt = (const unsigned char*)text_.data();
+
+    // bucket all suffixes of regular proteins by their first two characters (counting sort) ...
+    std::vector<Size> bucket_begin(65536 + 1, 0);
+    auto for_each_suffix = [&](auto f)
+    {
+      auto it_amb = ambiguous_.cbegin();
+      for (Hit::T p = 0; p + 1 < offsets_.size(); ++p)
+      {
+        if (it_amb != ambiguous_.cend() && *it_amb == p)
+        {
+          ++it_amb;
+          continue;
+        }
+        for (Hit::T pos = offsets_[p]; pos + 1 < offsets_[p + 1]; ++pos) // skip the trailing '$'
+        {
+          f(pos, (Size(txt[pos]) << 8) | txt[pos + 1]);
+        }
+      }
+    };
+    for_each_suffix([&](Hit::T, Size key) { ++bucket_begin[key + 1]; });
+    for (Size b = 1; b < bucket_begin.size(); ++b)
+    {
+      bucket_begin[b] += bucket_begin[b - 1];
+    }
+    sa_.resize(bucket_begin.back());
+    std::vector<Size> fill(bucket_begin.begin(), bucket_begin.end() - 1);
+    for_each_suffix([&](Hit::T pos, Size key) { sa_[fill[key]++] = pos; });
+
+    // ... and sort each bucket. Suffixes are compared up to the end of their protein ('$' sorts before all letters);
+    // suffixes which are equal up to there are ordered by position.
+    auto suffix_less = [txt](Hit::T a, Hit::T b)
+    {
+      for (Size k = 0; ; ++k)
+      {
+        const unsigned char ca = txt[a + k], cb = txt[b + k];
+        if (ca != cb) return ca < cb;
+        if (ca == '$') return a < b;
+      }
+    };
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (SignedSize b = 0; b < 65536; ++b)
+    {
+      if (bucket_begin[b + 1] - bucket_begin[b] > 1)
+      {
+        std::sort(sa_.begin() + bucket_begin[b], sa_.begin() + bucket_begin[b + 1], suffix_less);
+      }
+    }
+  }
+
+  void ProteinSequenceIndex::findExact(const std::string& peptide, std::vector<Occurrence>& result) const
+  {
+    if (peptide.empty() || sa_.empty()) return;
+
+    const unsigned char* txt = (const unsigned char*)text_.data();
+    const unsigned char* pep = (const unsigned char*)peptide.data();
+    const Size m = peptide.size();
+    // compare the first m characters of the suffix at @p pos with the peptide; a suffix ending early (at '$') is smaller
+    auto compare = [&](Hit::T pos)
+    {
+      for (Size k = 0; k < m; ++k)
+      {
+        const unsigned char c = txt[pos + k];
+        if (c == '$') return -1;
+        if (c != pep[k]) return c < pep[k] ? -1 : 1;
+      }
+      return 0;
+    };
+    auto first = std::partition_point(sa_.cbegin(), sa_.cend(), [&](Hit::T pos) { return compare(pos) < 0; });
+    auto last = std::partition_point(first, sa_.cend(), [&](Hit::T pos) { return compare(pos) == 0; });
+
+    for (; first != last; ++first)
+    {
+      const Hit::T protein_index = Hit::T(std::upper_bound(offsets_.cbegin(), offsets_.cend(), *first) - offsets_.cbegin() - 1);
+      result.push_back({protein_index, *first - offsets_[protein_index]});
+    }
+  }
+
+  void ProteinSequenceIndex::store(const String& filename) const
+  {
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    writeValue(ofs, INDEX_FILE_IDENTIFIER);
+    writeValue(ofs, INDEX_FILE_VERSION);
+    writeString(ofs, checksum_);
+    writeValue(ofs, (uint8_t)IL_equivalent_);
+    writeValue(ofs, (uint8_t)has_invalid_sequences_);
+    writeValue(ofs, (uint64_t)entries_.size());
+    for (const auto& entry : entries_)
+    {
+      writeString(ofs, entry.identifier);
+      writeString(ofs, entry.description);
+      writeString(ofs, entry.sequence);
+    }
+    writeString(ofs, text_);
+    writeVector(ofs, offsets_);
+    writeVector(ofs, ambiguous_);
+    writeVector(ofs, sa_);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error while writing the protein sequence index.");
+    }
+  }
+
+  void ProteinSequenceIndex::load(const String& filename)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if (!ifs)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    uint64_t identifier = 0;
+    int32_t version = 0;
+    readValue(ifs, identifier);
+    readValue(ifs, version);
+    if (identifier != INDEX_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a protein sequence index (wrong file magic number). Aborting!", filename);
+    }
+    if (version != INDEX_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Unsupported protein sequence index version " + String(version) + " (expected " + String(INDEX_FILE_VERSION) + "). Aborting!", filename);
+    }
+    readString(ifs, checksum_);
+    uint8_t flag = 0;
+    readValue(ifs, flag);
+    IL_equivalent_ = flag;
+    readValue(ifs, flag);
+    has_invalid_sequences_ = flag;
+    uint64_t entry_count = 0;
+    readValue(ifs, entry_count);
+    entries_.resize(entry_count);
+    for (auto& entry : entries_)
+    {
+      readString(ifs, entry.identifier);
+      readString(ifs, entry.description);
+      readString(ifs, entry.sequence);
+    }
+    readString(ifs, text_);
+    readVector(ifs, offsets_);
+    readVector(ifs, ambiguous_);
+    readVector(ifs, sa_);
+    if (!ifs || offsets_.size() != entries_.size() + 1)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Protein sequence index is truncated or corrupt. Aborting!", filename);
+    }
+    search_sequences_.clear();
+    search_sequences_.reserve(entries_.size());
+    for (Size i = 0; i < entries_.size(); ++i)
+    {
+      search_sequences_.push_back(text_.substr(offsets_[i], offsets_[i + 1] - offsets_[i] - 1));
+    }
+  }
+
+  const String& ProteinSequenceIndex::getChecksum() const
+  {
+    return checksum_;
+  }
+
+  bool ProteinSequenceIndex::isILEquivalent() const
+  {
+    return IL_equivalent_;
+  }
+
+  Size ProteinSequenceIndex::size() const
+  {
+    return entries_.size();
+  }
+
+  bool ProteinSequenceIndex::empty() const
+  {
+    return entries_.empty();
+  }
+
+  const std::vector<FASTAFile::FASTAEntry>& ProteinSequenceIndex::getEntries() const
+  {
+    return entries_;
+  }
+
+  const String& ProteinSequenceIndex::getSearchSequence(Size protein_index) const
+  {
+    return search_sequences_[protein_index];
+  }
+
+  const std::vector<Hit::T>& ProteinSequenceIndex::getAmbiguousProteins() const
+  {
+    return ambiguous_;
+  }
+
+  bool ProteinSequenceIndex::hasInvalidSequences() const
+  {
+    return has_invalid_sequences_;
+  }
+
+} // namespace OpenMS
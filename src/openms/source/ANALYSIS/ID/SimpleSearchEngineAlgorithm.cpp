@@ -34,6 +34,7 @@
 
 #include <OpenMS/ANALYSIS/ID/SimpleSearchEngineAlgorithm.h>
 
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
 #include <OpenMS/ANALYSIS/RNPXL/HyperScore.h>
 #include <OpenMS/CHEMISTRY/DecoyGenerator.h>
@@ -44,6 +45,7 @@
 #include <OpenMS/COMPARISON/SPECTRA/SpectrumAlignment.h>
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/CONCEPT/VersionInfo.h>
+#include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/DATASTRUCTURES/Param.h>
 #include <OpenMS/DATASTRUCTURES/StringView.h>
 #include <OpenMS/FILTERING/DATAREDUCTION/Deisotoper.h>
@@ -53,6 +55,7 @@
 #include <OpenMS/FILTERING/TRANSFORMERS/ThresholdMower.h>
 #include <OpenMS/FILTERING/TRANSFORMERS/WindowMower.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/KERNEL/MSSpectrum.h>
@@ -146,6 +149,21 @@ namespace OpenMS
     defaults_.setValue("report:top_hits", 1, "Maximum number of top scoring hits per spectrum that are reported.");
     defaults_.setSectionDescription("report", "Reporting Options");
 
+    defaults_.setValue("search_mode", "classic", "'classic' scores every candidate peptide against all spectra with a matching precursor mass. "
+      "'fragment_index' indexes the fragment ions of all candidates once and only scores the candidates sharing most fragments with a spectrum "
+      "(much faster for large databases, many variable modifications or wide precursor tolerances).");
+    defaults_.setValidStrings("search_mode", {"classic", "fragment_index"});
+
+    defaults_.setValue("fragment_index:candidates", 50, "Number of candidates (with most matched fragments) per spectrum that are scored in 'fragment_index' mode.");
+    defaults_.setMinInt("fragment_index:candidates", 1);
+    defaults_.setValue("fragment_index:min_matched_peaks", 3, "Minimum number of matched fragment ions for a candidate to be scored in 'fragment_index' mode.");
+    defaults_.setMinInt("fragment_index:min_matched_peaks", 1);
+    defaults_.setSectionDescription("fragment_index", "Fragment ion index options (only used with search_mode 'fragment_index')");
+
+    defaults_.setValue("database_cache", "", "Peptide database file with the digested and modified candidate peptides. "
+      "If set, candidates are loaded from this file instead of digesting the database on every run. "
+      "The file is (re-)created if it is missing or was built from a different database or with different digestion or modification settings.");
+
     defaultsToParam_();
   }
 
@@ -190,6 +208,11 @@ namespace OpenMS
 
     report_top_hits_ = param_.getValue("report:top_hits");
 
+    search_mode_ = param_.getValue("search_mode").toString();
+    fragment_index_candidates_ = param_.getValue("fragment_index:candidates");
+    fragment_index_min_matched_peaks_ = param_.getValue("fragment_index:min_matched_peaks");
+    database_cache_ = param_.getValue("database_cache").toString();
+
     decoys_ = param_.getValue("decoys") == "true";
     annotate_psm_ = ListUtils::toStringList<std::string>(param_.getValue("annotate:PSM"));
   }
@@ -420,9 +443,6 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
 
   SimpleSearchEngineAlgorithm::ExitCodes SimpleSearchEngineAlgorithm::search(const String& in_mzML, const String& in_db, vector<ProteinIdentification>& protein_ids, vector<PeptideIdentification>& peptide_ids) const
   {
-    boost::regex peptide_motif_regex(peptide_motif_);
-
-    bool precursor_mass_tolerance_unit_ppm = (precursor_mass_tolerance_unit_ == "ppm");
     bool fragment_mass_tolerance_unit_ppm = (fragment_mass_tolerance_unit_ == "ppm");
 
     ModifiedPeptideGenerator::MapToResidueType fixed_modifications = ModifiedPeptideGenerator::getModifications(modifications_fixed_);
@@ -444,6 +464,130 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     preprocessSpectra_(spectra, fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm);
     endProgress();
 
+    // preallocate storage for PSMs
+    vector<vector<AnnotatedHit_> > annotated_hits(spectra.size(), vector<AnnotatedHit_>());
+    for (auto & a : annotated_hits) { a.reserve(2 * report_top_hits_); }
+
+    vector<FASTAFile::FASTAEntry> fasta_db;
+    FASTAFile().load(in_db, fasta_db);
+
+    ProteaseDigestion digestor;
+    digestor.setEnzyme(enzyme_);
+    // generate decoy protein sequences by reversing them
+    if (decoys_)
+    {
+      digestor.setMissedCleavages(0);
+      startProgress(0, 1, "Generate decoys...");
+
+      DecoyGenerator decoy_generator;
+
+      // append decoy proteins
+      const size_t old_size = fasta_db.size();
+      for (size_t i = 0; i != old_size; ++i)
+      {
+        FASTAFile::FASTAEntry e = fasta_db[i];
+        e.sequence = decoy_generator.reversePeptides(AASequence::fromString(e.sequence), enzyme_).toString();
+        e.identifier = "DECOY_" + e.identifier;
+        fasta_db.push_back(e);
+      }
+      // randomize order of targets and decoys to introduce no global bias in the case that
+      // many targets have the same score as their decoy. (As we always take the first best scoring one)
+      Math::RandomShuffler shuffler;
+      shuffler.portable_random_shuffle(fasta_db.begin(), fasta_db.end());
+      endProgress();
+      digestor.setMissedCleavages(peptide_missed_cleavages_);
+    }
+
+    // candidates of previous runs with the same database and settings (must stay loaded until post-processing)
+    PeptideDatabase peptide_db;
+    if (!database_cache_.empty())
+    {
+      loadPeptideDatabase_(in_db, fasta_db, digestor, peptide_db);
+    }
+
+    if (search_mode_ == "fragment_index")
+    {
+      searchFragmentIndex_(spectra, fasta_db, peptide_db.isLoaded() ? &peptide_db : nullptr, digestor, fixed_modifications, variable_modifications, annotated_hits);
+    }
+    else if (peptide_db.isLoaded())
+    {
+      searchPeptideDatabase_(spectra, peptide_db, annotated_hits);
+    }
+    else
+    {
+      searchClassic_(spectra, fasta_db, digestor, fixed_modifications, variable_modifications, annotated_hits);
+    }
+
+    startProgress(0, 1, "Post-processing PSMs...");
+    SimpleSearchEngineAlgorithm::postProcessHits_(spectra, 
+      annotated_hits, 
+      protein_ids, 
+      peptide_ids, 
+      report_top_hits_,
+      fixed_modifications, 
+      variable_modifications, 
+      modifications_max_variable_mods_per_peptide_,
+      modifications_fixed_,
+      modifications_variable_,
+      peptide_missed_cleavages_,
+      precursor_mass_tolerance_,
+      fragment_mass_tolerance_,
+      precursor_mass_tolerance_unit_,
+      fragment_mass_tolerance_unit_,
+      precursor_min_charge_,
+      precursor_max_charge_,
+      enzyme_,
+      in_db
+      );
+    endProgress();
+
+    // add meta data on spectra file
+    protein_ids[0].setPrimaryMSRunPath({in_mzML}, spectra);
+
+    // reindex peptides to proteins
+    PeptideIndexing indexer;
+    Param param_pi = indexer.getParameters();
+    param_pi.setValue("decoy_string", "DECOY_");
+    param_pi.setValue("decoy_string_position", "prefix");
+    param_pi.setValue("enzyme:name", enzyme_);
+    param_pi.setValue("enzyme:specificity", "full");
+    param_pi.setValue("missing_decoy_action", "silent");
+    indexer.setParameters(param_pi);
+
+    PeptideIndexing::ExitCodes indexer_exit = indexer.run(fasta_db, protein_ids, peptide_ids);
+
+    if ((indexer_exit != PeptideIndexing::EXECUTION_OK) &&
+        (indexer_exit != PeptideIndexing::PEPTIDE_IDS_EMPTY))
+    {
+      if (indexer_exit == PeptideIndexing::DATABASE_EMPTY)
+      {
+        return ExitCodes::INPUT_FILE_EMPTY;       
+      }
+      else if (indexer_exit == PeptideIndexing::UNEXPECTED_RESULT)
+      {
+        return ExitCodes::UNEXPECTED_RESULT;
+      }
+      else
+      {
+        return ExitCodes::UNKNOWN_ERROR;
+      }
+    } 
+
+    return ExitCodes::EXECUTION_OK;
+  }
+
+  void SimpleSearchEngineAlgorithm::searchClassic_(const PeakMap& spectra,
+    const vector<FASTAFile::FASTAEntry>& fasta_db,
+    const ProteaseDigestion& digestor,
+    const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+    const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+    vector<vector<AnnotatedHit_> >& annotated_hits) const
+  {
+    boost::regex peptide_motif_regex(peptide_motif_);
+
+    bool precursor_mass_tolerance_unit_ppm = (precursor_mass_tolerance_unit_ == "ppm");
+    bool fragment_mass_tolerance_unit_ppm = (fragment_mass_tolerance_unit_ == "ppm");
+
     // build multimap of precursor mass to scan index
     multimap<double, Size> multimap_mass_2_scan_index;
     for (PeakMap::ConstIterator s_it = spectra.begin(); s_it != spectra.end(); ++s_it)
@@ -484,10 +628,6 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     param.setValue("add_metainfo", "true");
     spectrum_generator.setParameters(param);
 
-    // preallocate storage for PSMs
-    vector<vector<AnnotatedHit_> > annotated_hits(spectra.size(), vector<AnnotatedHit_>());
-    for (auto & a : annotated_hits) { a.reserve(2 * report_top_hits_); }
-
 #ifdef _OPENMP
     // we want to do locking at the spectrum level so we get good parallelization
     vector<omp_lock_t> annotated_hits_lock(annotated_hits.size());
@@ -497,35 +637,6 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     }
 #endif
 
-    vector<FASTAFile::FASTAEntry> fasta_db;
-    FASTAFile().load(in_db, fasta_db);
-
-    ProteaseDigestion digestor;
-    digestor.setEnzyme(enzyme_);
-    // generate decoy protein sequences by reversing them
-    if (decoys_)
-    {
-      digestor.setMissedCleavages(0);
-      startProgress(0, 1, "Generate decoys...");
-
-      DecoyGenerator decoy_generator;
-
-      // append decoy proteins
-      const size_t old_size = fasta_db.size();
-      for (size_t i = 0; i != old_size; ++i)
-      {
-        FASTAFile::FASTAEntry e = fasta_db[i];
-        e.sequence = decoy_generator.reversePeptides(AASequence::fromString(e.sequence), enzyme_).toString();
-        e.identifier = "DECOY_" + e.identifier;
-        fasta_db.push_back(e);
-      }
-      // randomize order of targets and decoys to introduce no global bias in the case that
-      // many targets have the same score as their decoy. (As we always take the first best scoring one)
-      Math::RandomShuffler shuffler;
-      shuffler.portable_random_shuffle(fasta_db.begin(), fasta_db.end());
-      endProgress();
-      digestor.setMissedCleavages(peptide_missed_cleavages_);
-    }
     startProgress(0, fasta_db.size(), "Scoring peptide models against spectra...");
 
     // lookup for processed peptides. must be defined outside of omp section and synchronized
@@ -674,70 +785,462 @@ void SimpleSearchEngineAlgorithm::postProcessHits_(const PeakMap& exp,
     OPENMS_LOG_INFO << "Peptides: " << count_peptides << endl;
     OPENMS_LOG_INFO << "Processed peptides: " << processed_petides.size() << endl;
 
-    startProgress(0, 1, "Post-processing PSMs...");
-    SimpleSearchEngineAlgorithm::postProcessHits_(spectra, 
-      annotated_hits, 
-      protein_ids, 
-      peptide_ids, 
-      report_top_hits_,
-      fixed_modifications, 
-      variable_modifications, 
-      modifications_max_variable_mods_per_peptide_,
-      modifications_fixed_,
-      modifications_variable_,
-      peptide_missed_cleavages_,
-      precursor_mass_tolerance_,
-      fragment_mass_tolerance_,
-      precursor_mass_tolerance_unit_,
-      fragment_mass_tolerance_unit_,
-      precursor_min_charge_,
-      precursor_max_charge_,
-      enzyme_,
-      in_db
-      );
-    endProgress();
+#ifdef _OPENMP
+    // free locks
+    for (size_t i = 0; i != annotated_hits_lock.size(); i++) 
+    {
+      omp_destroy_lock(&(annotated_hits_lock[i]));
+    }
+#endif
 
-    // add meta data on spectra file
-    protein_ids[0].setPrimaryMSRunPath({in_mzML}, spectra);
+  }
 
-    // reindex peptides to proteins
-    PeptideIndexing indexer;
-    Param param_pi = indexer.getParameters();
-    param_pi.setValue("decoy_string", "DECOY_");
-    param_pi.setValue("decoy_string_position", "prefix");
-    param_pi.setValue("enzyme:name", enzyme_);
-    param_pi.setValue("enzyme:specificity", "full");
-    param_pi.setValue("missing_decoy_action", "silent");
-    indexer.setParameters(param_pi);
+  // static
+  void SimpleSearchEngineAlgorithm::getFragmentMZs_(const TheoreticalSpectrumGenerator& generator,
+    const AASequence& peptide,
+    vector<TheoreticalSpectrumGenerator::FragmentIon>& ions,
+    vector<double>& prefix_mz,
+    vector<double>& suffix_mz)
+  {
+    prefix_mz.clear();
+    suffix_mz.clear();
+    generator.getFragmentIons(peptide, 1, 1, ions);
+    for (const TheoreticalSpectrumGenerator::FragmentIon& ion : ions)
+    {
+      (ion.type == Residue::BIon ? prefix_mz : suffix_mz).push_back(ion.mz);
+    }
+  }
 
-    PeptideIndexing::ExitCodes indexer_exit = indexer.run(fasta_db, protein_ids, peptide_ids);
+  bool SimpleSearchEngineAlgorithm::getCandidateMassRanges_(const PeakSpectrum& spectrum, vector<pair<double, double> >& mass_ranges) const
+  {
+    mass_ranges.clear();
+    const vector<Precursor>& precursor = spectrum.getPrecursors();
 
-    if ((indexer_exit != PeptideIndexing::EXECUTION_OK) &&
-        (indexer_exit != PeptideIndexing::PEPTIDE_IDS_EMPTY))
+    // there should only one precursor and MS2 should contain at least a few peaks to be considered (e.g. at least for every AA in the peptide)
+    if (precursor.size() != 1 || spectrum.size() < peptide_min_size_) { return false; }
+
+    Size precursor_charge = precursor[0].getCharge();
+    if (precursor_charge < precursor_min_charge_ || precursor_charge > precursor_max_charge_) { return false; }
+
+    for (int isotope_number : precursor_isotopes_)
     {
-      if (indexer_exit == PeptideIndexing::DATABASE_EMPTY)
+      double precursor_mass = (double) precursor_charge * precursor[0].getMZ() - (double) precursor_charge * Constants::PROTON_MASS_U;
+
+      // correct for monoisotopic misassignments of the precursor annotation
+      if (isotope_number != 0) { precursor_mass -= isotope_number * Constants::C13C12_MASSDIFF_U; }
+
+      // the tolerance refers to the candidate mass (as in the classic search)
+      if (precursor_mass_tolerance_unit_ == "ppm")
       {
-        return ExitCodes::INPUT_FILE_EMPTY;       
+        mass_ranges.emplace_back(precursor_mass / (1.0 + precursor_mass_tolerance_ * 1e-6), precursor_mass / (1.0 - precursor_mass_tolerance_ * 1e-6));
       }
-      else if (indexer_exit == PeptideIndexing::UNEXPECTED_RESULT)
+      else
       {
-        return ExitCodes::UNEXPECTED_RESULT;
+        mass_ranges.emplace_back(precursor_mass - precursor_mass_tolerance_, precursor_mass + precursor_mass_tolerance_);
+      }
+    }
+
+    // merge overlapping ranges, so each candidate is scored only once
+    std::sort(mass_ranges.begin(), mass_ranges.end());
+    Size merged = 0;
+    for (Size i = 1; i < mass_ranges.size(); ++i)
+    {
+      if (mass_ranges[i].first <= mass_ranges[merged].second)
+      {
+        mass_ranges[merged].second = std::max(mass_ranges[merged].second, mass_ranges[i].second);
       }
       else
       {
-        return ExitCodes::UNKNOWN_ERROR;
+        mass_ranges[++merged] = mass_ranges[i];
       }
-    } 
+    }
+    if (!mass_ranges.empty()) { mass_ranges.resize(merged + 1); }
+    return true;
+  }
+
+  void SimpleSearchEngineAlgorithm::addHit_(vector<AnnotatedHit_>& hits, const StringView& sequence, SignedSize peptide_mod_index, double score, const HyperScore::PSMDetail& detail) const
+  {
+    AnnotatedHit_ ah;
+    ah.sequence = sequence;
+    ah.peptide_mod_index = peptide_mod_index;
+    ah.score = score;
+    ah.prefix_fraction = (double)detail.matched_b_ions/(double)sequence.size();
+    ah.suffix_fraction = (double)detail.matched_y_ions/(double)sequence.size();
+    ah.mean_error = detail.mean_error;
+    hits.push_back(ah);
+
+    // prevent vector from growing indefinitely (memory) but don't shrink the vector every time
+    if (hits.size() >= 2 * report_top_hits_)
+    {
+      std::partial_sort(hits.begin(), hits.begin() + report_top_hits_, hits.end(), AnnotatedHit_::hasBetterScore);
+      hits.resize(report_top_hits_);
+    }
+  }
+
+  void SimpleSearchEngineAlgorithm::searchFragmentIndex_(const PeakMap& spectra,
+    const vector<FASTAFile::FASTAEntry>& fasta_db,
+    const PeptideDatabase* peptide_db,
+    const ProteaseDigestion& digestor,
+    const ModifiedPeptideGenerator::MapToResidueType& fixed_modifications,
+    const ModifiedPeptideGenerator::MapToResidueType& variable_modifications,
+    vector<vector<AnnotatedHit_> >& annotated_hits) const
+  {
+    boost::regex peptide_motif_regex(peptide_motif_);
+
+    bool fragment_mass_tolerance_unit_ppm = (fragment_mass_tolerance_unit_ == "ppm");
+
+    // a (modified) candidate peptide; its position in the sorted vector is its index in the fragment index
+    struct Candidate
+    {
+      StringView sequence;
+      SignedSize peptide_mod_index;
+      double mass;
+      Size fragment_offset; ///< start of the fragments in 'fragments'
+      Size prefix_count;
+      Size suffix_count;
+    };
+    vector<Candidate> candidates;
+    vector<double> fragments;
+    vector<double> prefix_mz, suffix_mz;
+    Size count_peptides(0);
+
+    // b (including b1) and y ions
+    TheoreticalSpectrumGenerator fragment_generator;
+    Param param(fragment_generator.getParameters());
+    param.setValue("add_first_prefix_ion", "true");
+    fragment_generator.setParameters(param);
+    vector<TheoreticalSpectrumGenerator::FragmentIon> fragment_ions;
+
+    if (peptide_db != nullptr)
+    {
+      startProgress(0, peptide_db->size(), "Loading candidate peptides...");
+      for (Size i = 0; i < peptide_db->size(); ++i)
+      {
+        setProgress(i);
+        const PeptideDatabase::Candidate& c = peptide_db->getCandidate(i);
+        const StringView sequence = peptide_db->getPeptideSequence(c.peptide_index);
+
+        // if a peptide motif is provided skip all peptides without match
+        if (!peptide_motif_.empty() && !boost::regex_match(sequence.getString(), peptide_motif_regex))
+        {
+          continue;
+        }
+
+        getFragmentMZs_(fragment_generator, AASequence::fromString(peptide_db->getModifiedSequence(i).getString()), fragment_ions, prefix_mz, suffix_mz);
+        candidates.push_back({sequence, (SignedSize)c.mod_index, c.mono_mass, fragments.size(), prefix_mz.size(), suffix_mz.size()});
+        fragments.insert(fragments.end(), prefix_mz.begin(), prefix_mz.end());
+        fragments.insert(fragments.end(), suffix_mz.begin(), suffix_mz.end());
+      }
+      count_peptides = peptide_db->getPeptideCount();
+      endProgress();
+    }
+    else
+    {
+      startProgress(0, fasta_db.size(), "Generating candidate peptides...");
+      set<StringView> processed_peptides;
+      vector<StringView> current_digest;
+      vector<AASequence> all_modified_peptides;
+      for (Size fasta_index = 0; fasta_index < fasta_db.size(); ++fasta_index)
+      {
+        setProgress(fasta_index);
+
+        current_digest.clear();
+        digestor.digestUnmodified(fasta_db[fasta_index].sequence, current_digest, peptide_min_size_, peptide_max_size_);
+
+        for (auto const & c : current_digest)
+        {
+          const String current_peptide = c.getString();
+          if (current_peptide.find_first_of("XBZ") != std::string::npos)
+          {
+            continue;
+          }
+
+          // if a peptide motif is provided skip all peptides without match
+          if (!peptide_motif_.empty() && !boost::regex_match(current_peptide, peptide_motif_regex))
+          {
+            continue;
+          }
+
+          // peptide (and all modified variants) already processed so skip it
+          if (!processed_peptides.insert(c).second) { continue; }
+
+          AASequence aas = AASequence::fromString(current_peptide);
+          all_modified_peptides.clear();
+          ModifiedPeptideGenerator::applyFixedModifications(fixed_modifications, aas);
+          ModifiedPeptideGenerator::applyVariableModifications(variable_modifications, aas, modifications_max_variable_mods_per_peptide_, all_modified_peptides);
+
+          for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
+          {
+            const AASequence& candidate = all_modified_peptides[mod_pep_idx];
+            getFragmentMZs_(fragment_generator, candidate, fragment_ions, prefix_mz, suffix_mz);
+            candidates.push_back({c, mod_pep_idx, candidate.getMonoWeight(), fragments.size(), prefix_mz.size(), suffix_mz.size()});
+            fragments.insert(fragments.end(), prefix_mz.begin(), prefix_mz.end());
+            fragments.insert(fragments.end(), suffix_mz.begin(), suffix_mz.end());
+          }
+        }
+      }
+      count_peptides = processed_peptides.size();
+      endProgress();
+    }
+
+    startProgress(0, 1, "Building fragment index...");
+    // the index needs the candidates in order of their mass (stable, so the result does not depend on sorting details)
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.mass < b.mass; });
+
+    FragmentIndex index(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm);
+    for (const Candidate& c : candidates)
+    {
+      auto first = fragments.begin() + c.fragment_offset;
+      prefix_mz.assign(first, first + c.prefix_count);
+      suffix_mz.assign(first + c.prefix_count, first + c.prefix_count + c.suffix_count);
+      index.addPeptide(c.mass, prefix_mz, suffix_mz);
+    }
+    vector<double>().swap(fragments);
+    index.build();
+    endProgress();
+
+    OPENMS_LOG_INFO << "Proteins: " << fasta_db.size() << endl;
+    OPENMS_LOG_INFO << "Processed peptides: " << count_peptides << endl;
+    OPENMS_LOG_INFO << "Indexed candidates: " << index.size() << " (" << index.getFragmentCount() << " fragments)" << endl;
+
+    startProgress(0, spectra.size(), "Scoring spectra against fragment index...");
+    Size count_spectra(0);
+
+#pragma omp parallel default(none) shared(annotated_hits, index, candidates, spectra, count_spectra, fragment_mass_tolerance_unit_ppm)
+    {
+      // scratch space of the fragment index, reused for all spectra of this thread
+      FragmentIndex::QueryBuffer query_buffer;
+
+#pragma omp for schedule(dynamic, 10)
+      for (SignedSize scan_index = 0; scan_index < (SignedSize)spectra.size(); ++scan_index)
+      {
+        #pragma omp atomic
+        ++count_spectra;
+
+        IF_MASTERTHREAD
+        {
+          setProgress(count_spectra);
+        }
+
+        const PeakSpectrum& exp_spectrum = spectra[scan_index];
+        vector<pair<double, double> > mass_ranges;
+        if (!getCandidateMassRanges_(exp_spectrum, mass_ranges)) { continue; }
+
+        vector<FragmentIndex::Match> matches, range_matches;
+        for (const auto& mass_range : mass_ranges)
+        {
+          pair<Size, Size> r = index.getPeptideRange(mass_range.first, mass_range.second);
+          index.query(exp_spectrum, r.first, r.second, fragment_index_min_matched_peaks_, fragment_index_candidates_, range_matches, query_buffer);
+          matches.insert(matches.end(), range_matches.begin(), range_matches.end());
+        }
+
+        // keep the candidates with most matched fragments over all ranges
+        if (matches.size() > fragment_index_candidates_)
+        {
+          std::partial_sort(matches.begin(), matches.begin() + fragment_index_candidates_, matches.end(),
+            [](const FragmentIndex::Match& a, const FragmentIndex::Match& b)
+            {
+              if (a.matched() != b.matched()) { return a.matched() > b.matched(); }
+              return a.peptide_index < b.peptide_index;
+            });
+          matches.resize(fragment_index_candidates_);
+        }
+
+        // score the selected candidates in detail
+        PeakSpectrum theo_spectrum;
+        for (const FragmentIndex::Match& m : matches)
+        {
+          const Candidate& c = candidates[m.peptide_index];
+          index.getSpectrum(m.peptide_index, theo_spectrum);
+
+          HyperScore::PSMDetail detail;
+          const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum, detail);
+
+          if (score == 0)
+          {
+            continue; // no hit?
+          }
+
+          // each spectrum is processed by one thread, so no locking is needed
+          addHit_(annotated_hits[scan_index], c.sequence, c.peptide_mod_index, score, detail);
+        }
+      }
+    }
+    endProgress();
+  }
+
+  void SimpleSearchEngineAlgorithm::searchPeptideDatabase_(const PeakMap& spectra,
+    const PeptideDatabase& peptide_db,
+    vector<vector<AnnotatedHit_> >& annotated_hits) const
+  {
+    boost::regex peptide_motif_regex(peptide_motif_);
+
+    bool fragment_mass_tolerance_unit_ppm = (fragment_mass_tolerance_unit_ == "ppm");
+
+    // create spectrum generator
+    TheoreticalSpectrumGenerator spectrum_generator;
+    Param param(spectrum_generator.getParameters());
+    param.setValue("add_first_prefix_ion", "true");
+    param.setValue("add_metainfo", "true");
+    spectrum_generator.setParameters(param);
+
+    OPENMS_LOG_INFO << "Peptides: " << peptide_db.getPeptideCount() << endl;
+    OPENMS_LOG_INFO << "Candidates: " << peptide_db.size() << endl;
+
+    // candidate mass ranges of all spectra, sorted by their lower bound
+    struct MassRange
+    {
+      double low;
+      double high;
+      Size scan_index;
+    };
+    vector<MassRange> spectrum_ranges;
+    double max_range_width(0);
+    vector<pair<double, double> > mass_ranges;
+    for (Size scan_index = 0; scan_index < spectra.size(); ++scan_index)
+    {
+      if (!getCandidateMassRanges_(spectra[scan_index], mass_ranges)) { continue; }
+      for (const auto& mass_range : mass_ranges)
+      {
+        spectrum_ranges.push_back({mass_range.first, mass_range.second, scan_index});
+        max_range_width = std::max(max_range_width, mass_range.second - mass_range.first);
+      }
+    }
+    std::sort(spectrum_ranges.begin(), spectrum_ranges.end(), [](const MassRange& a, const MassRange& b) { return a.low < b.low; });
+
+#ifdef _OPENMP
+    // we want to do locking at the spectrum level so we get good parallelization
+    vector<omp_lock_t> annotated_hits_lock(annotated_hits.size());
+    for (size_t i = 0; i != annotated_hits_lock.size(); i++)
+    {
+      omp_init_lock(&(annotated_hits_lock[i]));
+    }
+#endif
+
+    // Each candidate is scored against all spectra with a matching precursor mass, so its theoretical spectrum is
+    // generated once (candidates without a matching spectrum are skipped).
+    startProgress(0, peptide_db.size(), "Scoring peptide database against spectra...");
+    Size count_candidates(0);
+
+#pragma omp parallel default(none) shared(annotated_hits, spectrum_generator, peptide_db, spectra, spectrum_ranges, max_range_width, count_candidates, fragment_mass_tolerance_unit_ppm, peptide_motif_regex, annotated_hits_lock)
+    {
+      vector<Size> scan_indices;
+      PeakSpectrum theo_spectrum;
+
+#pragma omp for schedule(dynamic, 1000)
+      for (SignedSize i = 0; i < (SignedSize)peptide_db.size(); ++i)
+      {
+        #pragma omp atomic
+        ++count_candidates;
+
+        IF_MASTERTHREAD
+        {
+          setProgress(count_candidates);
+        }
+
+        const PeptideDatabase::Candidate& c = peptide_db.getCandidate(i);
+
+        // spectra whose candidate mass range contains the candidate mass
+        scan_indices.clear();
+        auto range_it = std::lower_bound(spectrum_ranges.begin(), spectrum_ranges.end(), c.mono_mass - max_range_width,
+          [](const MassRange& r, double mass) { return r.low < mass; });
+        for (; range_it != spectrum_ranges.end() && range_it->low <= c.mono_mass; ++range_it)
+        {
+          if (range_it->high >= c.mono_mass) { scan_indices.push_back(range_it->scan_index); }
+        }
+        if (scan_indices.empty()) { continue; }
+
+        const StringView sequence = peptide_db.getPeptideSequence(c.peptide_index);
+
+        // if a peptide motif is provided skip all peptides without match
+        if (!peptide_motif_.empty() && !boost::regex_match(sequence.getString(), peptide_motif_regex))
+        {
+          continue;
+        }
+
+        // this critical section is because ResidueDB is not thread safe and new residues are created based on the PTMs
+        AASequence candidate;
+        #pragma omp critical (residuedb_access)
+        {
+          candidate = AASequence::fromString(peptide_db.getModifiedSequence(i).getString());
+        }
+
+        // add peaks for b and y ions with charge 1
+        theo_spectrum.clear(true);
+        spectrum_generator.getSpectrum(theo_spectrum, candidate, 1, 1);
+
+        // sort by mz
+        theo_spectrum.sortByPosition();
+
+        for (Size scan_index : scan_indices)
+        {
+          HyperScore::PSMDetail detail;
+          const double& score = HyperScore::computeWithDetail(fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm, spectra[scan_index], theo_spectrum, detail);
+
+          if (score == 0)
+          {
+            continue; // no hit?
+          }
+
+#ifdef _OPENMP
+          omp_set_lock(&(annotated_hits_lock[scan_index]));
+#endif
+          addHit_(annotated_hits[scan_index], sequence, c.mod_index, score, detail);
+#ifdef _OPENMP
+          omp_unset_lock(&(annotated_hits_lock[scan_index]));
+#endif
+        }
+      }
+    }
+    endProgress();
 
 #ifdef _OPENMP
     // free locks
-    for (size_t i = 0; i != annotated_hits_lock.size(); i++) 
+    for (size_t i = 0; i != annotated_hits_lock.size(); i++)
     {
       omp_destroy_lock(&(annotated_hits_lock[i]));
     }
 #endif
+  }
 
-    return ExitCodes::EXECUTION_OK;
+  void SimpleSearchEngineAlgorithm::loadPeptideDatabase_(const String& in_db,
+    const vector<FASTAFile::FASTAEntry>& fasta_db,
+    const ProteaseDigestion& digestor,
+    PeptideDatabase& peptide_db) const
+  {
+    PeptideDatabase::Settings settings;
+    // decoys are appended to (and shuffled with) the database, which is deterministic
+    settings.checksum = FileHandler::computeFileHash(in_db) + (decoys_ ? ";decoys" : "");
+    settings.enzyme = enzyme_;
+    settings.missed_cleavages = digestor.getMissedCleavages();
+    settings.min_length = peptide_min_size_;
+    settings.max_length = peptide_max_size_;
+    settings.fixed_modifications = modifications_fixed_;
+    settings.variable_modifications = modifications_variable_;
+    settings.max_variable_mods_per_peptide = modifications_max_variable_mods_per_peptide_;
+
+    if (File::exists(database_cache_))
+    {
+      try
+      {
+        peptide_db.load(database_cache_);
+      }
+      catch (Exception::BaseException& e) // unreadable (FileNotFound) or corrupt/outdated (ParseError) database
+      {
+        OPENMS_LOG_WARN << "Could not read peptide database: " << e.what() << endl;
+      }
+      if (peptide_db.isCompatible(settings))
+      {
+        return;
+      }
+      OPENMS_LOG_INFO << "Peptide database '" << database_cache_ << "' does not match the database (or settings). Rebuilding it ..." << endl;
+    }
+
+    startProgress(0, 1, "Building peptide database...");
+    peptide_db.clear(); // unmap before replacing the file
+    PeptideDatabase::build(fasta_db, settings, database_cache_); // replaces the file atomically
+    peptide_db.load(database_cache_);
+    endProgress();
   }
 
 } // namespace OpenMS
@@ -0,0 +1,411 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace
+  {
+    const uint64_t INDEX_FILE_IDENTIFIER = 0x42494c5053534d4f; // "OMSSPLIB"
+    const int32_t INDEX_FILE_VERSION = 1;
+
+    /// size of @p bytes rounded up to the next multiple of 8
+    Size padded(Size bytes)
+    {
+      return (bytes + 7) & ~Size(7);
+    }
+
+    template<typename T>
+    void writeValue(std::ofstream& ofs, const T& value)
+    {
+      ofs.write((const char*)&value, sizeof(T));
+    }
+
+    /// write the element count, the elements and zero padding up to the next 8 byte boundary
+    void writeSection(std::ofstream& ofs, const void* data, Size count, Size element_size)
+    {
+      static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      writeValue(ofs, (uint64_t)count);
+      ofs.write((const char*)data, count * element_size);
+      ofs.write(zeros, padded(count * element_size) - count * element_size);
+    }
+  }
+
+  SpectralLibraryIndex::SpectralLibraryIndex() = default;
+
+  SpectralLibraryIndex::~SpectralLibraryIndex() = default;
+
+  void SpectralLibraryIndex::build(const PeakMap& library, const vector<String>& labels, const String& key, const String& filename)
+  {
+    if (!labels.empty() && labels.size() != library.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Number of labels (" + String(labels.size()) + ") does not match the number of library spectra (" + String(library.size()) + ").");
+    }
+    if (library.size() > numeric_limits<UInt32>::max())
+    {
+      throw Exception::InvalidSize(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, library.size());
+    }
+
+    // order of the entries: by precursor m/z (stable, so entries with equal m/z keep their library order)
+    vector<Size> order;
+    order.reserve(library.size());
+    for (Size i = 0; i < library.size(); ++i)
+    {
+      if (!library[i].getPrecursors().empty()) { order.push_back(i); }
+    }
+    std::stable_sort(order.begin(), order.end(), [&library](Size a, Size b)
+    {
+      return library[a].getPrecursors()[0].getMZ() < library[b].getPrecursors()[0].getMZ();
+    });
+
+    vector<Entry> entries;
+    entries.reserve(order.size());
+    vector<double> peak_mz;
+    vector<float> peak_intensities;
+    String text;
+    for (Size i : order)
+    {
+      const PeakSpectrum& spectrum = library[i];
+      Entry e;
+      e.precursor_mz = spectrum.getPrecursors()[0].getMZ();
+      e.rt = spectrum.getRT();
+      e.charge = spectrum.getPrecursors()[0].getCharge();
+      e.library_index = (UInt32)i;
+      e.peak_offset = peak_mz.size();
+      e.peak_count = (UInt32)spectrum.size();
+      e.label_offset = text.size();
+      e.label_length = labels.empty() ? 0 : (UInt32)labels[i].size();
+
+      double squared_norm(0);
+      for (const Peak1D& p : spectrum)
+      {
+        squared_norm += double(p.getIntensity()) * p.getIntensity();
+      }
+      e.norm = std::sqrt(squared_norm);
+      for (const Peak1D& p : spectrum)
+      {
+        peak_mz.push_back(p.getMZ());
+        peak_intensities.push_back(e.norm > 0 ? float(p.getIntensity() / e.norm) : 0.0f);
+      }
+      if (!labels.empty()) { text += labels[i]; }
+      entries.push_back(e);
+    }
+
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    writeValue(ofs, INDEX_FILE_IDENTIFIER);
+    writeValue(ofs, INDEX_FILE_VERSION);
+    writeValue(ofs, int32_t(0)); // padding
+    writeSection(ofs, key.data(), key.size(), 1);
+    writeSection(ofs, entries.data(), entries.size(), sizeof(Entry));
+    writeSection(ofs, peak_mz.data(), peak_mz.size(), sizeof(double));
+    writeSection(ofs, peak_intensities.data(), peak_intensities.size(), sizeof(float));
+    writeSection(ofs, text.data(), text.size(), 1);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Error while writing the spectral library index.");
+    }
+  }
+
+  void SpectralLibraryIndex::load(const String& filename)
+  {
+    clear();
+    filename_ = filename;
+
+    std::unique_ptr<boost::iostreams::mapped_file_source> file;
+    try
+    {
+      file.reset(new boost::iostreams::mapped_file_source(filename));
+    }
+    catch (std::exception&)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    data_ = file->data();
+    size_ = file->size();
+
+    Size offset = 0;
+    const UInt64 identifier = readSize_(offset);
+    if (identifier != INDEX_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a spectral library index (wrong file magic number). Aborting!", filename);
+    }
+    const UInt64 version_and_padding = readSize_(offset);
+    int32_t version;
+    std::memcpy(&version, &version_and_padding, sizeof(version));
+    if (version != INDEX_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Unsupported spectral library index version " + String(version) + " (expected " + String(INDEX_FILE_VERSION) + "). Aborting!", filename);
+    }
+
+    // read all sections first, so a truncated file leaves no partially loaded index
+    Size count = readSize_(offset);
+    const char* key = readSection_(offset, count, 1);
+    String file_key(key, key + count);
+
+    const Size entry_count = readSize_(offset);
+    const char* entries = readSection_(offset, entry_count, sizeof(Entry));
+    const Size peak_count = readSize_(offset);
+    const char* peak_mz = readSection_(offset, peak_count, sizeof(double));
+    const Size intensity_count = readSize_(offset);
+    const char* peak_intensities = readSection_(offset, intensity_count, sizeof(float));
+    const Size text_size = readSize_(offset);
+    const char* text = readSection_(offset, text_size, 1);
+    if (intensity_count != peak_count)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Spectral library index file is corrupt. Aborting!", filename);
+    }
+
+    file_ = std::move(file);
+    key_ = file_key;
+    entries_ = reinterpret_cast<const Entry*>(entries);
+    entry_count_ = entry_count;
+    peak_mz_ = reinterpret_cast<const double*>(peak_mz);
+    peak_intensities_ = reinterpret_cast<const float*>(peak_intensities);
+    peak_count_ = peak_count;
+    text_ = text;
+    text_size_ = text_size;
+  }
+
+  UInt64 SpectralLibraryIndex::readSize_(Size& offset) const
+  {
+    if (offset + sizeof(UInt64) > size_)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Spectral library index file is truncated. Aborting!", filename_);
+    }
+    UInt64 value;
+    std::memcpy(&value, data_ + offset, sizeof(UInt64));
+    offset += sizeof(UInt64);
+    return value;
+  }
+
+  const char* SpectralLibraryIndex::readSection_(Size& offset, Size count, Size element_size) const
+  {
+    if (count > (size_ - offset) / element_size || offset + padded(count * element_size) > size_)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Spectral library index file is truncated. Aborting!", filename_);
+    }
+    const char* section = data_ + offset;
+    offset += padded(count * element_size);
+    return section;
+  }
+
+  void SpectralLibraryIndex::clear()
+  {
+    file_.reset();
+    filename_.clear();
+    key_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    entries_ = nullptr;
+    peak_mz_ = nullptr;
+    peak_intensities_ = nullptr;
+    text_ = nullptr;
+    entry_count_ = peak_count_ = text_size_ = 0;
+  }
+
+  bool SpectralLibraryIndex::isLoaded() const
+  {
+    return file_ != nullptr;
+  }
+
+  const String& SpectralLibraryIndex::getKey() const
+  {
+    return key_;
+  }
+
+  Size SpectralLibraryIndex::size() const
+  {
+    return entry_count_;
+  }
+
+  const SpectralLibraryIndex::Entry& SpectralLibraryIndex::getEntry(Size index) const
+  {
+    return entries_[index];
+  }
+
+  pair<Size, Size> SpectralLibraryIndex::getPrecursorRange(double min_mz, double max_mz) const
+  {
+    const Entry* end = entries_ + entry_count_;
+    const Entry* first = std::lower_bound(entries_, end, min_mz, [](const Entry& e, double mz) { return e.precursor_mz < mz; });
+    const Entry* last = std::upper_bound(first, end, max_mz, [](double mz, const Entry& e) { return mz < e.precursor_mz; });
+    return { Size(first - entries_), Size(last - entries_) };
+  }
+
+  StringView SpectralLibraryIndex::getLabel(Size index) const
+  {
+    return StringView(text_ + entries_[index].label_offset, entries_[index].label_length);
+  }
+
+  void SpectralLibraryIndex::getSpectrum(Size index, PeakSpectrum& spectrum) const
+  {
+    const Entry& e = entries_[index];
+    spectrum.clear(true);
+    spectrum.setRT(e.rt);
+    spectrum.setMSLevel(2);
+    Precursor precursor;
+    precursor.setMZ(e.precursor_mz);
+    precursor.setCharge(e.charge);
+    spectrum.getPrecursors().push_back(precursor);
+
+    spectrum.reserve(e.peak_count);
+    for (Size i = e.peak_offset; i < e.peak_offset + e.peak_count; ++i)
+    {
+      spectrum.emplace_back(peak_mz_[i], peak_intensities_[i] * e.norm);
+    }
+  }
+
+  void SpectralLibraryIndex::normalizeIntensities_(const PeakSpectrum& query, vector<double>& intensities)
+  {
+    intensities.resize(query.size());
+    double squared_norm(0);
+    for (Size i = 0; i < query.size(); ++i)
+    {
+      intensities[i] = query[i].getIntensity();
+      squared_norm += intensities[i] * intensities[i];
+    }
+    const double norm = std::sqrt(squared_norm);
+    if (norm == 0) { return; }
+    for (double& intensity : intensities) { intensity /= norm; }
+  }
+
+  double SpectralLibraryIndex::score(const PeakSpectrum& query, Size index, double fragment_mass_tolerance, bool fragment_mass_tolerance_ppm) const
+  {
+    vector<double> query_intensities;
+    normalizeIntensities_(query, query_intensities);
+    return score_(query, query_intensities, index, fragment_mass_tolerance, fragment_mass_tolerance_ppm);
+  }
+
+  double SpectralLibraryIndex::score_(const PeakSpectrum& query, const vector<double>& query_intensities, Size index, double fragment_mass_tolerance, bool fragment_mass_tolerance_ppm) const
+  {
+    OPENMS_PRECONDITION(query.isSorted(), "Query spectrum needs to be sorted by m/z.");
+
+    const Entry& e = entries_[index];
+    const double* mz = peak_mz_ + e.peak_offset;
+    const float* intensities = peak_intensities_ + e.peak_offset;
+
+    // match peaks one-to-one in order of m/z
+    double dot(0);
+    Size i(0), j(0);
+    while (i < query.size() && j < e.peak_count)
+    {
+      const double query_mz = query[i].getMZ();
+      const double tolerance = fragment_mass_tolerance_ppm ? query_mz * fragment_mass_tolerance * 1e-6 : fragment_mass_tolerance;
+      if (mz[j] < query_mz - tolerance) { ++j; }
+      else if (mz[j] > query_mz + tolerance) { ++i; }
+      else
+      {
+        dot += query_intensities[i] * intensities[j];
+        ++i;
+        ++j;
+      }
+    }
+    return dot;
+  }
+
+  void SpectralLibraryIndex::search(const vector<PeakSpectrum>& queries, const SearchParameters& params, vector<vector<Match> >& results) const
+  {
+    results.assign(queries.size(), vector<Match>());
+
+#pragma omp parallel
+    {
+      // thread local scratch buffer
+      vector<double> query_intensities;
+
+#pragma omp for schedule(dynamic, 10)
+      for (SignedSize q = 0; q < (SignedSize)queries.size(); ++q)
+      {
+        const PeakSpectrum& query = queries[q];
+        if (query.empty() || query.getPrecursors().empty()) { continue; }
+
+        normalizeIntensities_(query, query_intensities);
+        const double query_mz = query.getPrecursors()[0].getMZ();
+        const Int query_charge = query.getPrecursors()[0].getCharge();
+        vector<Match>& matches = results[q];
+
+        for (Int isotope : params.isotopes)
+        {
+          // isotopic misassignments can only be corrected for a known charge
+          if (isotope != 0 && query_charge == 0) { continue; }
+
+          const double corrected_mz = isotope == 0 ? query_mz : query_mz - isotope * Constants::C13C12_MASSDIFF_U / std::abs(query_charge);
+          const double tolerance = params.precursor_mass_tolerance_ppm ? corrected_mz * params.precursor_mass_tolerance * 1e-6 : params.precursor_mass_tolerance;
+
+          // skip isotopic misassignments whose windows overlap (the same entry would be reported twice)
+          if (isotope != 0 && tolerance >= 0.5 * Constants::C13C12_MASSDIFF_U / std::abs(query_charge)) { continue; }
+
+          const pair<Size, Size> range = getPrecursorRange(corrected_mz - tolerance, corrected_mz + tolerance);
+          for (Size e = range.first; e < range.second; ++e)
+          {
+            const Int charge = entries_[e].charge;
+            if (params.match_charge && query_charge != 0 && charge != 0 && charge != query_charge) { continue; }
+
+            const double s = score_(query, query_intensities, e, params.fragment_mass_tolerance, params.fragment_mass_tolerance_ppm);
+            matches.push_back({e, s, isotope});
+          }
+        }
+
+        std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b)
+        {
+          return a.score > b.score || (a.score == b.score && a.entry_index < b.entry_index);
+        });
+        if (params.top_hits != 0 && matches.size() > params.top_hits) { matches.resize(params.top_hits); }
+      }
+    }
+  }
+
+} // namespace OpenMS
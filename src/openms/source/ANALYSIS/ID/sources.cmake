@@ -19,6 +19,7 @@ ConsensusIDAlgorithmSimilarity.cpp
 ConsensusIDAlgorithmWorst.cpp
 ConsensusMapMergerAlgorithm.cpp
 FalseDiscoveryRate.cpp
+FragmentIndex.cpp
 FIAMSDataProcessor.cpp
 FIAMSScheduler.cpp
 HiddenMarkovModel.cpp
@@ -36,11 +37,14 @@ MetaboliteSpectralMatching.cpp
 PeptideProteinResolution.cpp
 PrecursorPurity.cpp
 ProtonDistributionModel.cpp
+PeptideDatabase.cpp
 PeptideIndexing.cpp
+ProteinSequenceIndex.cpp
 PercolatorFeatureSetHelper.cpp
 SimpleSearchEngineAlgorithm.cpp
 SiriusAdapterAlgorithm.cpp
 SiriusMSConverter.cpp
+SpectralLibraryIndex.cpp
 )
 
 ### add path to the filenames
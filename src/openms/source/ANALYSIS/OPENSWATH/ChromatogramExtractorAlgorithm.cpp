@@ -37,7 +37,9 @@
 #include <OpenMS/DATASTRUCTURES/String.h>
 
 #include <OpenMS/CONCEPT/Exception.h>
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 namespace OpenMS
 {
@@ -296,36 +298,45 @@ namespace OpenMS
         "Input to extractChromatogram needs to be sorted by m/z");
     }
 
+    // compute all extraction windows once, they are the same for each spectrum
+    const bool has_im = (im_extraction_window > 0.0);
+    const ExtractionWindows windows = prepareExtractionWindows(extraction_coordinates, mz_extraction_window, ppm, im_extraction_window);
+    std::vector<Size> indices;
+    std::vector<double> integrated_intensities;
+    indices.reserve(extraction_coordinates.size());
+
     //go through all spectra
     startProgress(0, input_size, "Extracting chromatograms");
     for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
     {
       setProgress(scan_idx);
 
-      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
       OpenSwath::SpectrumMeta s_meta = input->getSpectrumMetaById(scan_idx);
 
-      OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
-      OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
-      std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
-      std::vector<double>::const_iterator mz_end = mz_arr->data.end();
-      std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
-      std::vector<double>::const_iterator int_it = int_arr->data.begin();
-      std::vector<double>::const_iterator im_it;
+      // without ion mobility, read the data in place if the input supports it
+      OpenSwath::SpectrumPtr sptr;
+      OpenSwath::SpectrumView view;
+      if (has_im || !input->getSpectrumViewById(scan_idx, view))
+      {
+        sptr = input->getSpectrumById(scan_idx);
+        view.mz = sptr->getMZArray()->data.data();
+        view.intensity = sptr->getIntensityArray()->data.data();
+        view.size = sptr->getMZArray()->data.size();
+      }
 
-      if (sptr->getMZArray()->data.empty())
+      if (view.size == 0)
       {
         continue;
       }
 
       // Look for ion mobility array
-      bool has_im = (im_extraction_window > 0.0);
+      const double* im = nullptr;
       if (has_im)
       {
         OpenSwath::BinaryDataArrayPtr im_arr = sptr->getDriftTimeArray();
         if (im_arr != nullptr)
         {
-          im_it = im_arr->data.begin();
+          im = im_arr->data.data();
         }
         else
         {
@@ -334,47 +345,147 @@ namespace OpenMS
         }
       }
 
-      // go through all transitions / chromatograms which are sorted by
-      // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
+      // collect all transitions / chromatograms which cover the current
+      // retention time (extracts everything if rt_end - rt_start <= 0)
+      double current_rt = s_meta.RT;
+      indices.clear();
       for (Size k = 0; k < extraction_coordinates.size(); ++k)
       {
-        double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
         if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 &&
              (current_rt < extraction_coordinates[k].rt_start ||
               current_rt > extraction_coordinates[k].rt_end) )
         {
           continue;
         }
+        indices.push_back(k);
+      }
+
+      if (used_filter == 1)
+      {
+        extract_values_tophat(view.mz, view.intensity, im, view.size,
+                              windows, indices, integrated_intensities);
+      }
+      else if (used_filter == 2)
+      {
+        throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+      }
+
+      for (Size j = 0; j < indices.size(); ++j)
+      {
+        output[indices[j]]->getTimeArray()->data.push_back(current_rt);
+        output[indices[j]]->getIntensityArray()->data.push_back(integrated_intensities[j]);
+      }
+    }
+    endProgress();
+  }
 
-        const bool use_im = (extraction_coordinates[k].ion_mobility >= 0.0 && has_im);
-        if (!use_im && used_filter == 1)
+  ChromatogramExtractorAlgorithm::ExtractionWindows ChromatogramExtractorAlgorithm::prepareExtractionWindows(
+      const std::vector<ExtractionCoordinates>& extraction_coordinates,
+      double mz_extraction_window,
+      bool ppm,
+      double im_extraction_window)
+  {
+    ExtractionWindows windows;
+    const Size n = extraction_coordinates.size();
+    windows.mz.resize(n);
+    windows.mz_left.resize(n);
+    windows.mz_right.resize(n);
+    windows.im_left.resize(n, -std::numeric_limits<double>::infinity());
+    windows.im_right.resize(n, std::numeric_limits<double>::infinity());
+
+    for (Size k = 0; k < n; ++k)
+    {
+      const double mz = extraction_coordinates[k].mz;
+      windows.mz[k] = mz;
+      // same computation as in extract_value_tophat
+      if (ppm)
+      {
+        windows.mz_left[k]  = mz - mz * mz_extraction_window / 2.0 * 1.0e-6;
+        windows.mz_right[k] = mz + mz * mz_extraction_window / 2.0 * 1.0e-6;
+      }
+      else
+      {
+        windows.mz_left[k]  = mz - mz_extraction_window / 2.0;
+        windows.mz_right[k] = mz + mz_extraction_window / 2.0;
+      }
+
+      const double im = extraction_coordinates[k].ion_mobility;
+      if (im_extraction_window > 0.0 && im >= 0.0)
+      {
+        windows.im_left[k]  = im - im_extraction_window / 2.0;
+        windows.im_right[k] = im + im_extraction_window / 2.0;
+      }
+    }
+    return windows;
+  }
+
+  void ChromatogramExtractorAlgorithm::extract_values_tophat(
+      const double* mz,
+      const double* intensity,
+      const double* im,
+      Size size,
+      const ExtractionWindows& windows,
+      const std::vector<Size>& indices,
+      std::vector<double>& integrated_intensities)
+  {
+    integrated_intensities.assign(indices.size(), 0.0);
+    if (size == 0)
+    {
+      return;
+    }
+
+    // Positions in the spectrum: first data point inside the m/z window,
+    // first data point right of the m/z window and first data point at or
+    // above the target m/z. They only move forward since the windows are
+    // sorted by m/z, such that all windows are found in a single pass.
+    Size lower = 0, upper = 0, target = 0;
+    for (Size j = 0; j < indices.size(); ++j)
+    {
+      const Size k = indices[j];
+      while (lower < size && mz[lower] <= windows.mz_left[k]) ++lower;
+      upper = std::max(upper, lower);
+      while (upper < size && mz[upper] < windows.mz_right[k]) ++upper;
+      while (target < size && mz[target] < windows.mz[k]) ++target;
+
+      const double left_im = windows.im_left[k];
+      const double right_im = windows.im_right[k];
+
+      // Reproduce the boundary handling of extract_value_tophat: the first
+      // data point is only included if the target is at most one data point
+      // away and the last data point is counted twice if the target is past
+      // the end of the spectrum.
+      const Size first = (lower == 0 && target >= 2) ? 1 : lower;
+      const bool repeat_last = (target == size && upper == size && lower < size);
+
+      double integrated_intensity = 0;
+      const bool use_im = (im != nullptr && (left_im > -std::numeric_limits<double>::infinity() ||
+                                             right_im < std::numeric_limits<double>::infinity()));
+      if (!use_im)
+      {
+#pragma omp simd reduction(+:integrated_intensity)
+        for (Size i = first; i < upper; ++i)
+        {
+          integrated_intensity += intensity[i];
+        }
+        if (repeat_last)
         {
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it,
-                               extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+          integrated_intensity += intensity[size - 1];
         }
-        else if (use_im && used_filter == 1)
+      }
+      else
+      {
+#pragma omp simd reduction(+:integrated_intensity)
+        for (Size i = first; i < upper; ++i)
         {
-          if (extraction_coordinates[k].ion_mobility < 0)
-          {
-            std::cerr << "WARNING : Drift time of ion is negative!" << std::endl;
-          }
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it, im_it,
-                               extraction_coordinates[k].mz, extraction_coordinates[k].ion_mobility,
-                               integrated_intensity, mz_extraction_window, im_extraction_window, ppm);
+          integrated_intensity += (im[i] > left_im && im[i] < right_im) ? intensity[i] : 0.0;
         }
-        else if (used_filter == 2)
+        if (repeat_last && im[size - 1] > left_im && im[size - 1] < right_im)
         {
-          throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+          integrated_intensity += intensity[size - 1];
         }
-
-        output[k]->getTimeArray()->data.push_back(current_rt);
-        output[k]->getIntensityArray()->data.push_back(integrated_intensity);
       }
+      integrated_intensities[j] = integrated_intensity;
     }
-    endProgress();
   }
 
   int ChromatogramExtractorAlgorithm::getFilterNr_(const String& filter)
@@ -34,15 +34,39 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
 
+#include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
 
 namespace OpenMS
 {
 
-  SpectrumAccessOpenMSCached::SpectrumAccessOpenMSCached(const String& filename) :
-    CachedmzML(filename)
+  SpectrumAccessOpenMSCached::SpectrumAccessOpenMSCached(const String& filename, bool memory_mapped) :
+    CachedmzML()
   {
+    if (memory_mapped)
+    {
+      try
+      {
+        mapped_file_.reset(new Internal::CachedMzMLMappedFile(filename + ".cached"));
+      }
+      catch (Exception::FileNotFound&)
+      {
+        OPENMS_LOG_WARN << "Could not memory-map '" << filename << ".cached', falling back to file stream access." << std::endl;
+      }
+    }
+
+    if (mapped_file_)
+    {
+      // the mapping already walked through the file, re-use its index
+      spectra_index_.assign(mapped_file_->getSpectraIndex().begin(), mapped_file_->getSpectraIndex().end());
+      chrom_index_.assign(mapped_file_->getChromatogramIndex().begin(), mapped_file_->getChromatogramIndex().end());
+      loadMetaData_(filename);
+    }
+    else
+    {
+      load_(filename);
+    }
   }
 
   SpectrumAccessOpenMSCached::~SpectrumAccessOpenMSCached()
@@ -50,7 +74,8 @@ namespace OpenMS
   }
 
   SpectrumAccessOpenMSCached::SpectrumAccessOpenMSCached(const SpectrumAccessOpenMSCached & rhs) :
-    CachedmzML(rhs)
+    CachedmzML(rhs),
+    mapped_file_(rhs.mapped_file_)
   {
     // this only copies the indices and meta-data
   }
@@ -68,6 +93,13 @@ namespace OpenMS
     int ms_level = -1;
     double rt = -1.0;
 
+    if (mapped_file_)
+    {
+      OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+      sptr->getDataArrays() = mapped_file_->getSpectrumData(id, ms_level, rt);
+      return sptr;
+    }
+
     if ( !ifs_.seekg(spectra_index_[id]) )
     {
       std::cerr << "Error while reading spectrum " << id << " - seekg created an error when trying to change position to " << spectra_index_[id] << "." << std::endl;
@@ -93,11 +125,39 @@ namespace OpenMS
     return meta;
   }
 
+  bool SpectrumAccessOpenMSCached::isMemoryMapped() const
+  {
+    return mapped_file_ != nullptr;
+  }
+
+  bool SpectrumAccessOpenMSCached::getSpectrumViewById(int id, OpenSwath::SpectrumView& view) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    if (!mapped_file_)
+    {
+      return false;
+    }
+    Internal::CachedMzMLMappedFile::DataView data = mapped_file_->getSpectrumView(id);
+    view.mz = data.position;
+    view.intensity = data.intensity;
+    view.size = data.size;
+    return true;
+  }
+
   OpenSwath::ChromatogramPtr SpectrumAccessOpenMSCached::getChromatogramById(int id)
   {
     OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
     OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
 
+    if (mapped_file_)
+    {
+      OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
+      cptr->getDataArrays() = mapped_file_->getChromatogramData(id);
+      return cptr;
+    }
+
     if ( !ifs_.seekg(chrom_index_[id]) )
     {
       std::cerr << "Error while reading chromatogram " << id << " - seekg created an error when trying to change position to " << chrom_index_[id] << "." << std::endl;
@@ -0,0 +1,183 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSColumnar.h>
+
+namespace OpenMS
+{
+  SpectrumAccessOpenMSColumnar::SpectrumAccessOpenMSColumnar(boost::shared_ptr<const ColumnarMSExperiment> ms_experiment) :
+    ms_experiment_(ms_experiment)
+  {
+  }
+
+  SpectrumAccessOpenMSColumnar::~SpectrumAccessOpenMSColumnar()
+  {
+  }
+
+  SpectrumAccessOpenMSColumnar::SpectrumAccessOpenMSColumnar(const SpectrumAccessOpenMSColumnar& rhs) :
+    ms_experiment_(rhs.ms_experiment_)
+  {
+    // this only copies the pointers and not the actual data ...
+  }
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessOpenMSColumnar::lightClone() const
+  {
+    return boost::shared_ptr<SpectrumAccessOpenMSColumnar>(new SpectrumAccessOpenMSColumnar(*this));
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessOpenMSColumnar::getSpectrumById(int id)
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+
+    std::vector<float> intensity, ion_mobility;
+    ms_experiment_->decodeSpectrum(id, mz_array->data, intensity, ion_mobility);
+    intensity_array->data.assign(intensity.begin(), intensity.end());
+    sptr->setMZArray(mz_array);
+    sptr->setIntensityArray(intensity_array);
+
+    // additional data arrays are part of the meta data
+    const MSSpectrum& meta = ms_experiment_->getMetaData()[id];
+    for (Size i = 0; i < meta.getFloatDataArrays().size(); ++i)
+    {
+      const MSSpectrum::FloatDataArray& fda = meta.getFloatDataArrays()[i];
+      OpenSwath::BinaryDataArrayPtr tmp(new OpenSwath::BinaryDataArray);
+      if (!ion_mobility.empty() && i == meta.getIMData().first)
+      {
+        tmp->data.assign(ion_mobility.begin(), ion_mobility.end());
+      }
+      else
+      {
+        tmp->data.assign(fda.begin(), fda.end());
+      }
+      tmp->description = fda.getName();
+      sptr->getDataArrays().push_back(tmp);
+    }
+    for (const auto& ida : meta.getIntegerDataArrays())
+    {
+      OpenSwath::BinaryDataArrayPtr tmp(new OpenSwath::BinaryDataArray);
+      tmp->data.assign(ida.begin(), ida.end());
+      tmp->description = ida.getName();
+      sptr->getDataArrays().push_back(tmp);
+    }
+    return sptr;
+  }
+
+  OpenSwath::SpectrumMeta SpectrumAccessOpenMSColumnar::getSpectrumMetaById(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    OpenSwath::SpectrumMeta meta;
+    meta.RT = ms_experiment_->getMetaData()[id].getRT();
+    meta.ms_level = ms_experiment_->getMetaData()[id].getMSLevel();
+    return meta;
+  }
+
+  OpenSwath::ChromatogramPtr SpectrumAccessOpenMSColumnar::getChromatogramById(int id)
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    Interfaces::ChromatogramPtr data = ms_experiment_->getChromatogramById(id);
+    OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
+    OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    rt_array->data.swap(data->getTimeArray()->data);
+    intensity_array->data.swap(data->getIntensityArray()->data);
+    cptr->setTimeArray(rt_array);
+    cptr->setIntensityArray(intensity_array);
+    return cptr;
+  }
+
+  std::vector<std::size_t> SpectrumAccessOpenMSColumnar::getSpectraByRT(double RT, double deltaRT) const
+  {
+    OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
+
+    // we first perform a search for the spectrum that is past the
+    // beginning of the RT domain. Then we add this spectrum and try to add
+    // further spectra as long as they are below RT + deltaRT.
+    const PeakMap& meta = ms_experiment_->getMetaData();
+    std::vector<std::size_t> result;
+    auto spectrum = meta.RTBegin(RT - deltaRT);
+    if (spectrum == meta.end()) return result;
+
+    result.push_back(std::distance(meta.begin(), spectrum));
+    spectrum++;
+
+    while (spectrum != meta.end() && spectrum->getRT() <= RT + deltaRT)
+    {
+      result.push_back(spectrum - meta.begin());
+      spectrum++;
+    }
+    return result;
+  }
+
+  size_t SpectrumAccessOpenMSColumnar::getNrSpectra() const
+  {
+    return ms_experiment_->getNrSpectra();
+  }
+
+  SpectrumSettings SpectrumAccessOpenMSColumnar::getSpectraMetaInfo(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
+    return ms_experiment_->getMetaData()[id];
+  }
+
+  size_t SpectrumAccessOpenMSColumnar::getNrChromatograms() const
+  {
+    return ms_experiment_->getNrChromatograms();
+  }
+
+  ChromatogramSettings SpectrumAccessOpenMSColumnar::getChromatogramMetaInfo(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    return ms_experiment_->getMetaData().getChromatograms()[id];
+  }
+
+  std::string SpectrumAccessOpenMSColumnar::getChromatogramNativeID(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+    return ms_experiment_->getMetaData().getChromatograms()[id].getNativeID();
+  }
+
+} //end namespace OpenMS
@@ -42,12 +42,16 @@ namespace OpenMS
     /// Constructor
   SpectrumAccessSqMass::SpectrumAccessSqMass(const OpenMS::Internal::MzMLSqliteHandler& handler) :
       handler_(handler)
-    {}
+    {
+      buildRTIndex_(handler_.getSpectraRT(sidx_));
+    }
 
     SpectrumAccessSqMass::SpectrumAccessSqMass(const OpenMS::Internal::MzMLSqliteHandler& handler, const std::vector<int> & indices) :
       handler_(handler),
       sidx_(indices)
-    {}
+    {
+      buildRTIndex_(handler_.getSpectraRT(sidx_));
+    }
 
 
     SpectrumAccessSqMass::SpectrumAccessSqMass(const SpectrumAccessSqMass& sp, const std::vector<int>& indices) :
@@ -56,6 +60,8 @@ namespace OpenMS
       if (indices.empty())
       {
         sidx_ = sp.sidx_;
+        rt_index_ = sp.rt_index_;
+        return;
       }
       else if (sp.sidx_.empty())
       {
@@ -71,6 +77,37 @@ namespace OpenMS
           sidx_.push_back( sp.sidx_[ indices[k] ] );
         }
       }
+
+      // derive the retention times from the parent instead of querying the file again
+      std::vector<double> parent_rts(sp.rt_index_->size());
+      for (const auto& entry : *sp.rt_index_)
+      {
+        parent_rts[entry.second] = entry.first;
+      }
+      std::vector<double> rts;
+      rts.reserve(indices.size());
+      for (int idx : indices)
+      {
+        if (idx < 0 || idx >= (int)parent_rts.size())
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Error creating SpectrumAccessSqMass with an index ") + idx + " that exceeds the number of available data " + parent_rts.size());
+        }
+        rts.push_back(parent_rts[idx]);
+      }
+      buildRTIndex_(rts);
+    }
+
+    void SpectrumAccessSqMass::buildRTIndex_(const std::vector<double>& rts)
+    {
+      auto rt_index = std::make_shared<std::vector<std::pair<double, std::size_t> > >();
+      rt_index->reserve(rts.size());
+      for (Size k = 0; k < rts.size(); k++)
+      {
+        rt_index->emplace_back(rts[k], k);
+      }
+      std::sort(rt_index->begin(), rt_index->end());
+      rt_index_ = rt_index;
     }
 
     /// Destructor
@@ -79,7 +116,8 @@ namespace OpenMS
     /// Copy constructor
     SpectrumAccessSqMass::SpectrumAccessSqMass(const SpectrumAccessSqMass & rhs) :
       handler_(rhs.handler_),
-      sidx_(rhs.sidx_)
+      sidx_(rhs.sidx_),
+      rt_index_(rhs.rt_index_)
     {
     }
 
@@ -192,25 +230,30 @@ namespace OpenMS
     std::vector<std::size_t> SpectrumAccessSqMass::getSpectraByRT(double RT, double deltaRT) const
     {
       OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
-      std::vector<std::size_t> res = handler_.getSpectraIndicesbyRT(RT, deltaRT, sidx_);
+      typedef std::pair<double, std::size_t> RTEntry;
+      const std::vector<RTEntry>& rt_index = *rt_index_;
+      auto rt_less = [](const RTEntry& entry, double rt) { return entry.first < rt; };
 
-      if (sidx_.empty())
+      std::vector<std::size_t> res;
+      if (deltaRT > 0.0)
       {
-        return res;
+        auto it = std::lower_bound(rt_index.begin(), rt_index.end(), RT - deltaRT, rt_less);
+        for (; it != rt_index.end() && it->first <= RT + deltaRT; ++it)
+        {
+          res.push_back(it->second);
+        }
+        std::sort(res.begin(), res.end());
       }
       else
       {
-        // we need to map the resulting indices back to the external indices
-        std::vector<std::size_t> res_mapped;
-        for (Size k = 0; k < res.size(); k++)
+        // only take the first spectrum larger than RT
+        auto it = std::lower_bound(rt_index.begin(), rt_index.end(), RT, rt_less);
+        if (it != rt_index.end())
         {
-          for (Size s_it = 0; s_it < sidx_.size(); s_it++)
-          {
-            if (res[k] == (size_t)sidx_[s_it]) {res_mapped.push_back(s_it);}
-          }
+          res.push_back(it->second);
         }
-        return res_mapped;
       }
+      return res;
     }
 
     size_t SpectrumAccessSqMass::getNrSpectra() const
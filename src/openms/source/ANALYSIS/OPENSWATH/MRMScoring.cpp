@@ -45,51 +45,88 @@
 namespace OpenSwath
 {
 
-    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrMatrix() const
+    /// Fills @p peaks with the highest cross-correlation peaks of traces 0..rows-1 vs. traces col_offset..col_offset+cols-1
+    void fillXCorrPeaks(const XCorrEngine& engine, std::size_t rows, std::size_t cols, std::size_t col_offset, bool upper_triangle,
+                        MRMScoring::XCorrPeakMatrixType& peaks)
     {
-      return xcorr_matrix_;
+      peaks.resize(rows, cols);
+      for (std::size_t i = 0; i < rows; i++)
+      {
+        for (std::size_t j = (upper_triangle ? i : 0); j < cols; j++)
+        {
+          peaks.setValue(i, j, engine.maxPeak(i, col_offset + j));
+        }
+      }
     }
 
-    void MRMScoring::initializeXCorrMatrix(const std::vector< std::vector< double > >& data)
+    /// Fills @p xcorr_matrix with the full cross-correlation arrays for the entries of @p peaks (see fillXCorrPeaks()), unless it was filled before
+    const MRMScoring::XCorrMatrixType& cacheXCorrArrays(const XCorrEngine& engine, const MRMScoring::XCorrPeakMatrixType& peaks, std::size_t col_offset, bool upper_triangle,
+                                                       MRMScoring::XCorrMatrixType& xcorr_matrix)
     {
-      xcorr_matrix_.resize(data.size(), data.size());
-      xcorr_matrix_max_peak_.resize(data.size(), data.size());
-      xcorr_matrix_max_peak_sec_.resize(data.size(), data.size());
-
-      std::vector< std::vector< double > > tmp_data = data;
-      for (std::size_t i = 0; i < tmp_data.size(); i++)
+      if (xcorr_matrix.rows() == peaks.rows() && xcorr_matrix.cols() == peaks.cols())
       {
-        Scoring::standardize_data(tmp_data[i]);
+        return xcorr_matrix;
       }
-
-      for (std::size_t i = 0; i < data.size(); i++)
+      xcorr_matrix.resize(peaks.rows(), peaks.cols());
+      for (std::size_t i = 0; i < peaks.rows(); i++)
       {
-        for (std::size_t j = i; j < data.size(); j++)
+        for (std::size_t j = (upper_triangle ? i : 0); j < peaks.cols(); j++)
         {
-          // compute normalized cross correlation
-          xcorr_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(tmp_data[i], tmp_data[j], static_cast<int>(data[i].size()), 1));
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_.getValue(i, j));
-          xcorr_matrix_max_peak_.setValue(i, j, std::abs(x->first));
-          xcorr_matrix_max_peak_sec_.setValue(i, j, x->second);
+          xcorr_matrix.setValue(i, j, engine.crossCorrelationArray(i, col_offset + j));
         }
       }
+      return xcorr_matrix;
     }
 
-    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrContrastMatrix() const
+    const MRMScoring::XCorrPeakMatrixType& MRMScoring::getXCorrPeakMatrix() const
+    {
+      return xcorr_matrix_;
+    }
+
+    const MRMScoring::XCorrPeakMatrixType& MRMScoring::getXCorrContrastPeakMatrix() const
     {
       return xcorr_contrast_matrix_;
     }
 
-    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrPrecursorContrastMatrix() const
+    const MRMScoring::XCorrPeakMatrixType& MRMScoring::getXCorrPrecursorContrastPeakMatrix() const
     {
       return xcorr_precursor_contrast_matrix_;
     }
 
-    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrPrecursorCombinedMatrix() const
+    const MRMScoring::XCorrPeakMatrixType& MRMScoring::getXCorrPrecursorCombinedPeakMatrix() const
     {
       return xcorr_precursor_combined_matrix_;
     }
 
+    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrMatrix() const
+    {
+      return cacheXCorrArrays(xcorr_engine_, xcorr_matrix_, 0, true, xcorr_matrix_arrays_);
+    }
+
+    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrContrastMatrix() const
+    {
+      return cacheXCorrArrays(xcorr_contrast_engine_, xcorr_contrast_matrix_, xcorr_contrast_matrix_.rows(), false, xcorr_contrast_matrix_arrays_);
+    }
+
+    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrPrecursorContrastMatrix() const
+    {
+      return cacheXCorrArrays(xcorr_precursor_contrast_engine_, xcorr_precursor_contrast_matrix_, xcorr_precursor_contrast_matrix_.rows(), false,
+                              xcorr_precursor_contrast_matrix_arrays_);
+    }
+
+    const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrPrecursorCombinedMatrix() const
+    {
+      return cacheXCorrArrays(xcorr_precursor_combined_engine_, xcorr_precursor_combined_matrix_, 0, true, xcorr_precursor_combined_matrix_arrays_);
+    }
+
+    void MRMScoring::initializeXCorrMatrix(const std::vector< std::vector< double > >& data)
+    {
+      xcorr_matrix_arrays_.clear();
+      xcorr_engine_.clear();
+      xcorr_engine_.addTraces(data);
+      fillXCorrPeaks(xcorr_engine_, data.size(), data.size(), 0, true, xcorr_matrix_);
+    }
+
     void fillIntensityFromFeature(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& ids, std::vector<std::vector<double>>& intensity)
     {
       intensity.resize(ids.size());
@@ -114,125 +151,47 @@ namespace OpenSwath
     {
       std::vector<std::vector<double>> intensity;
       fillIntensityFromFeature(mrmfeature, native_ids, intensity);
-      for (std::size_t i = 0; i < intensity.size(); i++)
-      {
-        Scoring::standardize_data(intensity[i]);
-      }
-
-      xcorr_matrix_.resize(native_ids.size(), native_ids.size());
-      xcorr_matrix_max_peak_.resize(native_ids.size(), native_ids.size());
-      xcorr_matrix_max_peak_sec_.resize(native_ids.size(), native_ids.size());
-      for (std::size_t i = 0; i < native_ids.size(); i++)
-      {
-        for (std::size_t j = i; j < native_ids.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensity[i], intensity[j], static_cast<int>(intensity[i].size()), 1));
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_.getValue(i, j));
-          xcorr_matrix_max_peak_.setValue(i, j, std::abs(x->first));
-          xcorr_matrix_max_peak_sec_.setValue(i, j, x->second);
-        }
-      }
+      initializeXCorrMatrix(intensity);
     }
 
     void MRMScoring::initializeXCorrContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2)
     {
       std::vector<std::vector<double>> intensityi, intensityj;
       fillIntensityFromFeature(mrmfeature, native_ids_set1, intensityi);
-      for (std::size_t i = 0; i < intensityi.size(); i++)
-      {
-        Scoring::standardize_data(intensityi[i]);
-      }
       fillIntensityFromFeature(mrmfeature, native_ids_set2, intensityj);
-      for (std::size_t i = 0; i < intensityj.size(); i++)
-      {
-        Scoring::standardize_data(intensityj[i]);
-      }
 
-      xcorr_contrast_matrix_.resize(native_ids_set1.size(), native_ids_set2.size());
-      xcorr_contrast_matrix_max_peak_sec_.resize(native_ids_set1.size(), native_ids_set2.size());
-      for (std::size_t i = 0; i < native_ids_set1.size(); i++)
-      {
-        for (std::size_t j = 0; j < native_ids_set2.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_contrast_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensityi[i], intensityj[j], static_cast<int>(intensityi[i].size()), 1));
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_contrast_matrix_.getValue(i, j));
-          xcorr_contrast_matrix_max_peak_sec_.setValue(i, j, x->second);
-        }
-      }
+      xcorr_contrast_matrix_arrays_.clear();
+      xcorr_contrast_engine_.clear();
+      xcorr_contrast_engine_.addTraces(intensityi);
+      const std::size_t offset = xcorr_contrast_engine_.addTraces(intensityj);
+      fillXCorrPeaks(xcorr_contrast_engine_, native_ids_set1.size(), native_ids_set2.size(), offset, false, xcorr_contrast_matrix_);
     }
 
     void MRMScoring::initializeXCorrPrecursorMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids)
     {
       std::vector<std::vector<double>> intensity;
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensity);
-      for (std::size_t i = 0; i < intensity.size(); i++)
-      {
-        Scoring::standardize_data(intensity[i]);
-      }
 
-      xcorr_precursor_matrix_.resize(precursor_ids.size(), precursor_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = i; j < precursor_ids.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_precursor_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensity[i], intensity[j], static_cast<int>(intensity[i].size()), 1));
-        }
-      }
+      xcorr_precursor_engine_.clear();
+      xcorr_precursor_engine_.addTraces(intensity);
+      fillXCorrPeaks(xcorr_precursor_engine_, precursor_ids.size(), precursor_ids.size(), 0, true, xcorr_precursor_matrix_);
     }
 
     void MRMScoring::initializeXCorrPrecursorContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
     {
       std::vector<std::vector<double>> intensityi, intensityj;
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensityi);
-      for (std::size_t i = 0; i < intensityi.size(); i++)
-      {
-        Scoring::standardize_data(intensityi[i]);
-      }
       fillIntensityFromFeature(mrmfeature, native_ids, intensityj);
-      for (std::size_t i = 0; i < intensityj.size(); i++)
-      {
-        Scoring::standardize_data(intensityj[i]);
-      }
-
-      xcorr_precursor_contrast_matrix_.resize(precursor_ids.size(), native_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = 0; j < native_ids.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_precursor_contrast_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(intensityi[i], intensityj[j], static_cast<int>(intensityi[i].size()), 1));
-        }
-      }
+      initializeXCorrPrecursorContrastMatrix(intensityi, intensityj);
     }
 
     void MRMScoring::initializeXCorrPrecursorContrastMatrix(const std::vector< std::vector< double > >& data_precursor, const std::vector< std::vector< double > >& data_fragments)
     {
-      xcorr_precursor_contrast_matrix_.resize(data_precursor.size(), data_fragments.size());
-      std::vector< std::vector< double > > tmp_data_precursor = data_precursor;
-      std::vector< std::vector< double > > tmp_data_fragments = data_fragments;
-      for (std::size_t i = 0; i < tmp_data_precursor.size(); i++)
-      {
-        Scoring::standardize_data(tmp_data_precursor[i]);
-      }
-      for (std::size_t i = 0; i < tmp_data_fragments.size(); i++)
-      {
-        Scoring::standardize_data(tmp_data_fragments[i]);
-      }
-
-      for (std::size_t i = 0; i < data_precursor.size(); i++)
-      {
-        for (std::size_t j = 0; j < data_fragments.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_precursor_contrast_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(tmp_data_precursor[i], tmp_data_fragments[j], static_cast<int>(tmp_data_precursor[i].size()), 1));
-#ifdef MRMSCORING_TESTING
-          std::cout << " fill xcorr_precursor_contrast_matrix_ "<< tmp_data_precursor[i].size() << " / " << tmp_data_fragments[j].size() << " : " << xcorr_precursor_contrast_matrix_[i][j].data.size() << std::endl;
-#endif
-        }
-      }
+      xcorr_precursor_contrast_matrix_arrays_.clear();
+      xcorr_precursor_contrast_engine_.clear();
+      xcorr_precursor_contrast_engine_.addTraces(data_precursor);
+      const std::size_t offset = xcorr_precursor_contrast_engine_.addTraces(data_fragments);
+      fillXCorrPeaks(xcorr_precursor_contrast_engine_, data_precursor.size(), data_fragments.size(), offset, false, xcorr_precursor_contrast_matrix_);
     }
 
     void MRMScoring::initializeXCorrPrecursorCombinedMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
@@ -240,29 +199,13 @@ namespace OpenSwath
       std::vector<std::vector<double>> intensityi, intensityj;
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensityi);
       fillIntensityFromFeature(mrmfeature, native_ids, intensityj);
-      std::vector<std::vector<double>> combined_intensity;
-      for (std::size_t i = 0; i < intensityi.size(); i++)
-      {
-        combined_intensity.push_back(intensityi[i]);
-      }
-      for (std::size_t j = 0; j < intensityj.size(); j++)
-      {
-        combined_intensity.push_back(intensityj[j]);
-      }
-      for (std::size_t i = 0; i < combined_intensity.size(); i++)
-      {
-        Scoring::standardize_data(combined_intensity[i]);
-      }
 
-      xcorr_precursor_combined_matrix_.resize(combined_intensity.size(), combined_intensity.size());
-      for (std::size_t i = 0; i < combined_intensity.size(); i++)
-      {
-        for (std::size_t j = i; j < combined_intensity.size(); j++)
-        {
-          // compute normalized cross correlation
-          xcorr_precursor_combined_matrix_.setValue(i, j, Scoring::normalizedCrossCorrelationPost(combined_intensity[i], combined_intensity[j], static_cast<int>(combined_intensity[i].size()), 1));
-        }
-      }
+      xcorr_precursor_combined_matrix_arrays_.clear();
+      xcorr_precursor_combined_engine_.clear();
+      xcorr_precursor_combined_engine_.addTraces(intensityi);
+      xcorr_precursor_combined_engine_.addTraces(intensityj);
+      const std::size_t n_traces = xcorr_precursor_combined_engine_.size();
+      fillXCorrPeaks(xcorr_precursor_combined_engine_, n_traces, n_traces, 0, true, xcorr_precursor_combined_matrix_);
     }
 
     // see /IMSB/users/reiterl/bin/code/biognosys/trunk/libs/mrm_libs/MRM_pgroup.pm
@@ -273,16 +216,15 @@ namespace OpenSwath
     // return $deltascore_mean + $deltascore_stdev
     double MRMScoring::calcXcorrCoelutionScore()
     {
-      OPENSWATH_PRECONDITION(xcorr_matrix_max_peak_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
+      OPENSWATH_PRECONDITION(xcorr_matrix_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
     
       OpenSwath::mean_and_stddev msc;
-      for (std::size_t i = 0; i < xcorr_matrix_max_peak_.rows(); i++)
+      for (std::size_t i = 0; i < xcorr_matrix_.rows(); i++)
       {
-        for (std::size_t  j = i; j < xcorr_matrix_max_peak_.rows(); j++)
+        for (std::size_t  j = i; j < xcorr_matrix_.rows(); j++)
         {
           // first is the X value (RT), should be an int
-          //deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_.getValue(i, j))->first));
-          msc(xcorr_matrix_max_peak_.getValue(i,j));
+          msc(std::abs(xcorr_matrix_.getValue(i, j).first));
 #ifdef MRMSCORING_TESTING
           std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first) << std::endl;
 #endif
@@ -299,15 +241,15 @@ namespace OpenSwath
     double MRMScoring::calcXcorrCoelutionWeightedScore(
             const std::vector<double>& normalized_library_intensity)
     {
-      OPENSWATH_PRECONDITION(xcorr_matrix_max_peak_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
+      OPENSWATH_PRECONDITION(xcorr_matrix_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
 
 #ifdef MRMSCORING_TESTING
       double weights = 0;
 #endif
       double deltas{0};
-      for (std::size_t i = 0; i < xcorr_matrix_max_peak_.rows(); i++)
+      for (std::size_t i = 0; i < xcorr_matrix_.rows(); i++)
       {
-        deltas += (xcorr_matrix_max_peak_.getValue(i, i)//std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_.getValue(i, i))->first)
+        deltas += (std::abs(xcorr_matrix_.getValue(i, i).first)
                    * normalized_library_intensity[i]
                    * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
@@ -315,10 +257,10 @@ namespace OpenSwath
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
       weights += normalized_library_intensity[i] * normalized_library_intensity[i];
 #endif
-        for (std::size_t j = i + 1; j < xcorr_matrix_max_peak_.rows(); j++)
+        for (std::size_t j = i + 1; j < xcorr_matrix_.rows(); j++)
         {
           // first is the X value (RT), should be an int
-          deltas += (xcorr_matrix_max_peak_.getValue(i, j)//std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_.getValue(i, j))->first)
+          deltas += (std::abs(xcorr_matrix_.getValue(i, j).first)
                      * normalized_library_intensity[i]
                      * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
@@ -342,10 +284,10 @@ namespace OpenSwath
       OPENSWATH_PRECONDITION(xcorr_contrast_matrix_.rows() > 0 && xcorr_contrast_matrix_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
 
       OpenSwath::mean_and_stddev msc;
-      for (auto e : xcorr_contrast_matrix_)
+      for (const auto& e : xcorr_contrast_matrix_)
       {
         // first is the X value (RT), should be an int
-        msc(std::abs(Scoring::xcorrArrayGetMaxPeak(e)->first));  
+        msc(std::abs(e.first));
 #ifdef MRMSCORING_TESTING
         std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_contrast_matrix_[i][j])->first) << std::endl;
 #endif
@@ -369,8 +311,7 @@ namespace OpenSwath
         for (std::size_t  j = 0; j < xcorr_contrast_matrix_.cols(); j++)
         {
           // first is the X value (RT), should be an int
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_contrast_matrix_.getValue(i, j));
-          deltas_id += std::abs(x->first);
+          deltas_id += std::abs(xcorr_contrast_matrix_.getValue(i, j).first);
 #ifdef MRMSCORING_TESTING
           std::cout << "&&_xcoel append " << xcorr_contrast_matrix_max_peak_getValue(i, j) << std::endl;
 #endif
@@ -391,8 +332,7 @@ namespace OpenSwath
         for (std::size_t  j = i; j < xcorr_precursor_matrix_.rows(); j++)
         {
           // first is the X value (RT), should be an int
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_matrix_.getValue(i, j));
-          msc(std::abs(x->first));
+          msc(std::abs(xcorr_precursor_matrix_.getValue(i, j).first));
 #ifdef MRMSCORING_TESTING
           std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_matrix_[i][j])->first) << std::endl;
 #endif
@@ -411,10 +351,10 @@ namespace OpenSwath
       OPENSWATH_PRECONDITION(xcorr_precursor_contrast_matrix_.rows() > 0 && xcorr_precursor_contrast_matrix_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
 
       OpenSwath::mean_and_stddev msc;
-      for (auto e : xcorr_precursor_contrast_matrix_)
+      for (const auto& e : xcorr_precursor_contrast_matrix_)
       {
         // first is the X value (RT), should be an int
-        msc(std::abs(Scoring::xcorrArrayGetMaxPeak(e)->first));
+        msc(std::abs(e.first));
 #ifdef MRMSCORING_TESTING
         std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_contrast_matrix_[i][j])->first) << std::endl;
 #endif
@@ -432,10 +372,10 @@ namespace OpenSwath
       OPENSWATH_PRECONDITION(xcorr_precursor_contrast_matrix_.rows() > 0 && xcorr_precursor_contrast_matrix_.cols() > 0, "Expect cross-correlation matrix of at least 1x1");
 
       OpenSwath::mean_and_stddev msc;
-      for (auto e : xcorr_precursor_contrast_matrix_)
+      for (const auto& e : xcorr_precursor_contrast_matrix_)
       {
         // first is the X value (RT), should be an int
-        msc(std::abs(Scoring::xcorrArrayGetMaxPeak(e)->first)); 
+        msc(std::abs(e.first)); 
 #ifdef MRMSCORING_TESTING
         std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_contrast_matrix_[i][j])->first) << std::endl;
 #endif
@@ -458,8 +398,7 @@ namespace OpenSwath
         for (std::size_t  j = i; j < xcorr_precursor_combined_matrix_.rows(); j++)
         {
           // first is the X value (RT), should be an int
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_combined_matrix_.getValue(i, j));
-          msc(std::abs(x->first));
+          msc(std::abs(xcorr_precursor_combined_matrix_.getValue(i, j).first));
 #ifdef MRMSCORING_TESTING
           std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_combined_matrix_[i][j])->first) << std::endl;
 #endif
@@ -481,16 +420,16 @@ namespace OpenSwath
     ///
     double MRMScoring::calcXcorrShapeScore()
     {
-      OPENSWATH_PRECONDITION(xcorr_matrix_max_peak_sec_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
+      OPENSWATH_PRECONDITION(xcorr_matrix_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
 
       size_t element_number{0};
       double intensities{0};
-      for (std::size_t i = 0; i < xcorr_matrix_max_peak_sec_.rows(); i++)
+      for (std::size_t i = 0; i < xcorr_matrix_.rows(); i++)
       {
-        for (std::size_t j = i; j < xcorr_matrix_max_peak_sec_.rows(); j++)
+        for (std::size_t j = i; j < xcorr_matrix_.rows(); j++)
         {
           // second is the Y value (intensity)
-          intensities += xcorr_matrix_max_peak_sec_.getValue(i, j);
+          intensities += xcorr_matrix_.getValue(i, j).second;
           element_number++;
         }
       }
@@ -500,24 +439,24 @@ namespace OpenSwath
     double MRMScoring::calcXcorrShapeWeightedScore(
             const std::vector<double>& normalized_library_intensity)
     {
-      OPENSWATH_PRECONDITION(xcorr_matrix_max_peak_sec_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
+      OPENSWATH_PRECONDITION(xcorr_matrix_.rows() > 1, "Expect cross-correlation matrix of at least 2x2");
 
       // TODO (hroest) : check implementation
       //         see _calc_weighted_xcorr_shape_score in MRM_pgroup.pm
       //         -- they only multiply up the intensity once
       double intensities{0};
-      for (std::size_t i = 0; i < xcorr_matrix_max_peak_sec_.rows(); i++)
+      for (std::size_t i = 0; i < xcorr_matrix_.rows(); i++)
       {
-        intensities += (xcorr_matrix_max_peak_sec_.getValue(i, i)
+        intensities += (xcorr_matrix_.getValue(i, i).second
                         * normalized_library_intensity[i]
                         * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
         std::cout << "_xcorr_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->second << " weight " <<
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
 #endif
-        for (std::size_t j = i + 1; j < xcorr_matrix_max_peak_sec_.rows(); j++)
+        for (std::size_t j = i + 1; j < xcorr_matrix_.rows(); j++)
         {
-          intensities += (xcorr_matrix_max_peak_sec_.getValue(i, j)
+          intensities += (xcorr_matrix_.getValue(i, j).second
                           * normalized_library_intensity[i]
                           * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
@@ -531,30 +470,30 @@ namespace OpenSwath
 
     double MRMScoring::calcXcorrContrastShapeScore()
     {
-      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_max_peak_sec_.rows() > 0 && xcorr_contrast_matrix_max_peak_sec_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
+      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_.rows() > 0 && xcorr_contrast_matrix_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
 
       double intensities{0};
-      for(auto e : xcorr_contrast_matrix_max_peak_sec_)
+      for (const auto& e : xcorr_contrast_matrix_)
       {
-        intensities += e;
+        intensities += e.second;
       }
       return intensities;
     }
 
     std::vector<double> MRMScoring::calcSeparateXcorrContrastShapeScore()
     {
-      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_max_peak_sec_.rows() > 0 && xcorr_contrast_matrix_max_peak_sec_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
+      OPENSWATH_PRECONDITION(xcorr_contrast_matrix_.rows() > 0 && xcorr_contrast_matrix_.cols() > 1, "Expect cross-correlation matrix of at least 1x2");
 
       std::vector<double> intensities;
-      for (std::size_t i = 0; i < xcorr_contrast_matrix_max_peak_sec_.rows(); i++)
+      for (std::size_t i = 0; i < xcorr_contrast_matrix_.rows(); i++)
       {
         double intensities_id = 0;
-        for (std::size_t j = 0; j < xcorr_contrast_matrix_max_peak_sec_.cols(); j++)
+        for (std::size_t j = 0; j < xcorr_contrast_matrix_.cols(); j++)
         {
           // second is the Y value (intensity)
-          intensities_id += xcorr_contrast_matrix_max_peak_sec_.getValue(i,j);
+          intensities_id += xcorr_contrast_matrix_.getValue(i, j).second;
         }
-        intensities.push_back(intensities_id / xcorr_contrast_matrix_max_peak_sec_.cols());
+        intensities.push_back(intensities_id / xcorr_contrast_matrix_.cols());
       }
 
       return intensities;
@@ -569,8 +508,7 @@ namespace OpenSwath
       {
         for(size_t j = i; j < xcorr_precursor_matrix_.cols(); j++)
         {
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_matrix_.getValue(i, j));
-          intensities += x->second;
+          intensities += xcorr_precursor_matrix_.getValue(i, j).second;
         }
       }
       //xcorr_precursor_matrix_ is a triangle matrix
@@ -584,9 +522,9 @@ namespace OpenSwath
 
 
       double intensities{0};
-      for(auto e : xcorr_precursor_contrast_matrix_)
+      for (const auto& e : xcorr_precursor_contrast_matrix_)
       {
-        intensities += Scoring::xcorrArrayGetMaxPeak(e)->second;
+        intensities += e.second;
       }
       return intensities / xcorr_precursor_contrast_matrix_.size();
     }
@@ -597,9 +535,9 @@ namespace OpenSwath
 
 
       double intensities{0};
-      for(auto e : xcorr_precursor_contrast_matrix_)
+      for (const auto& e : xcorr_precursor_contrast_matrix_)
       {
-        intensities += Scoring::xcorrArrayGetMaxPeak(e)->second;
+        intensities += e.second;
       }
       return intensities / xcorr_precursor_contrast_matrix_.size();
     }
@@ -614,8 +552,7 @@ namespace OpenSwath
       {
         for(size_t j = i; j < xcorr_precursor_combined_matrix_.cols(); j++)
         {
-          auto x = Scoring::xcorrArrayGetMaxPeak(xcorr_precursor_combined_matrix_.getValue(i, j));
-          intensities += x->second;
+          intensities += xcorr_precursor_combined_matrix_.getValue(i, j).second;
         }
       }
       //xcorr_precursor-combined_matrix_ is a triangle matrix
@@ -754,105 +691,86 @@ namespace OpenSwath
       return mi_precursor_combined_matrix_;
     }
 
-    void MRMScoring::initializeMIMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids)
+    /// Fills @p mi_matrix with the mutual information of traces 0..rows-1 vs. traces col_offset..col_offset+cols-1
+    void fillMIMatrix(MIEngine& engine, std::size_t rows, std::size_t cols, std::size_t col_offset, bool upper_triangle,
+                      OpenMS::Matrix<double>& mi_matrix)
     {
-      std::vector<std::vector<double>> intensity;
-      std::vector<std::vector<unsigned int>> rank_vec{};
-      fillIntensityFromFeature(mrmfeature, native_ids, intensity);
-      std::vector<unsigned int> max_rank_vec = Scoring::computeRankVector(intensity, rank_vec);
-
-      mi_matrix_.resize(native_ids.size(),native_ids.size());  
-      for (std::size_t i = 0; i < native_ids.size(); i++)
+      mi_matrix.resize(rows, cols);
+      for (std::size_t i = 0; i < rows; i++)
       {
-        for (std::size_t j = i; j < native_ids.size(); j++)
+        for (std::size_t j = (upper_triangle ? i : 0); j < cols; j++)
         {
           // compute ranked mutual information
-          mi_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec[i], rank_vec[j], max_rank_vec[i], max_rank_vec[j]));
+          mi_matrix.setValue(i, j, engine.mutualInformation(i, col_offset + j));
         }
       }
     }
+
+    void MRMScoring::initializeMIMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids)
+    {
+      std::vector<std::vector<double>> intensity;
+      fillIntensityFromFeature(mrmfeature, native_ids, intensity);
+
+      mi_engine_.clear();
+      mi_engine_.addTraces(intensity);
+      fillMIMatrix(mi_engine_, native_ids.size(), native_ids.size(), 0, true, mi_matrix_);
+    }
+
     void MRMScoring::initializeMIContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& native_ids_set1, const std::vector<std::string>& native_ids_set2)
-    { 
+    {
       std::vector<std::vector<double>> intensityi, intensityj;
-      std::vector<std::vector<unsigned int>> rank_vec1{}, rank_vec2{};
       fillIntensityFromFeature(mrmfeature, native_ids_set1, intensityi);
       fillIntensityFromFeature(mrmfeature, native_ids_set2, intensityj);
-      std::vector<unsigned int> max_rank_vec1 = Scoring::computeRankVector(intensityi, rank_vec1);
-      std::vector<unsigned int> max_rank_vec2 = Scoring::computeRankVector(intensityj, rank_vec2);
 
-      mi_contrast_matrix_.resize(native_ids_set1.size(), native_ids_set2.size());
-      for (std::size_t i = 0; i < native_ids_set1.size(); i++)
-      {
-        for (std::size_t j = 0; j < native_ids_set2.size(); j++)
-        {
-          // compute ranked mutual information
-          mi_contrast_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec1[i], rank_vec2[j], max_rank_vec1[i], max_rank_vec2[j]));
-        }
-      }
+      mi_engine_.clear();
+      mi_engine_.addTraces(intensityi);
+      const std::size_t offset = mi_engine_.addTraces(intensityj);
+      fillMIMatrix(mi_engine_, native_ids_set1.size(), native_ids_set2.size(), offset, false, mi_contrast_matrix_);
     }
 
     void MRMScoring::initializeMIPrecursorMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids)
     {
       std::vector<std::vector<double>> intensity;
-      std::vector<std::vector<unsigned int>> rank_vec{};
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensity);
-      std::vector<unsigned int> max_rank_vec = Scoring::computeRankVector(intensity, rank_vec);
 
-      mi_precursor_matrix_.resize(precursor_ids.size(),precursor_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = i; j < precursor_ids.size(); j++)
-        {
-          // compute ranked mutual information
-          mi_precursor_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec[i], rank_vec[j], max_rank_vec[i], max_rank_vec[j]));
-        }
-      }
+      mi_engine_.clear();
+      mi_engine_.addTraces(intensity);
+      fillMIMatrix(mi_engine_, precursor_ids.size(), precursor_ids.size(), 0, true, mi_precursor_matrix_);
     }
 
     void MRMScoring::initializeMIPrecursorContrastMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
     {
       std::vector<std::vector<double>> intensityi, intensityj;
-      std::vector<std::vector<unsigned int>> rank_vec1{}, rank_vec2{};
       fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensityi);
       fillIntensityFromFeature(mrmfeature, native_ids, intensityj);
-      std::vector<unsigned int> max_rank_vec1 = Scoring::computeRankVector(intensityi, rank_vec1);
-      std::vector<unsigned int> max_rank_vec2 = Scoring::computeRankVector(intensityj, rank_vec2);
 
-      mi_precursor_contrast_matrix_.resize(precursor_ids.size(), native_ids.size());
-      for (std::size_t i = 0; i < precursor_ids.size(); i++)
-      {
-        for (std::size_t j = 0; j < native_ids.size(); j++)
-        {
-          // compute ranked mutual information
-          mi_precursor_contrast_matrix_.setValue(i, j, Scoring::rankedMutualInformation(rank_vec1[i], rank_vec2[j], max_rank_vec1[i], max_rank_vec2[j]));
-        }
-      }
+      mi_engine_.clear();
+      mi_engine_.addTraces(intensityi);
+      const std::size_t offset = mi_engine_.addTraces(intensityj);
+      fillMIMatrix(mi_engine_, precursor_ids.size(), native_ids.size(), offset, false, mi_precursor_contrast_matrix_);
     }
 
     void MRMScoring::initializeMIPrecursorCombinedMatrix(OpenSwath::IMRMFeature* mrmfeature, const std::vector<std::string>& precursor_ids, const std::vector<std::string>& native_ids)
     {
-      std::vector<std::vector<unsigned int>> rank_vec{};
-      std::vector<std::vector<double>> intensity;
-      fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensity);
-      std::vector<unsigned int> max_rank_vec = Scoring::computeRankVector(intensity, rank_vec);
-      intensity.clear();
-      fillIntensityFromFeature(mrmfeature, native_ids, intensity);
-      std::vector<unsigned int> max_rank_vec_tmp = Scoring::computeRankVector(intensity, rank_vec);
-      max_rank_vec.reserve(max_rank_vec.size() + native_ids.size());
-      max_rank_vec.insert(max_rank_vec.end(), max_rank_vec_tmp.begin(), max_rank_vec_tmp.end());
-      
-      mi_precursor_combined_matrix_.resize(rank_vec.size(), rank_vec.size());
-      for (std::size_t i = 0; i < rank_vec.size(); i++)
-      { 
-        for (std::size_t j = i; j < rank_vec.size(); j++)
+      std::vector<std::vector<double>> intensityi, intensityj;
+      fillIntensityFromPrecursorFeature(mrmfeature, precursor_ids, intensityi);
+      fillIntensityFromFeature(mrmfeature, native_ids, intensityj);
+
+      mi_engine_.clear();
+      mi_engine_.addTraces(intensityi);
+      mi_engine_.addTraces(intensityj);
+      const std::size_t n_traces = mi_engine_.size();
+      fillMIMatrix(mi_engine_, n_traces, n_traces, 0, true, mi_precursor_combined_matrix_);
+      // the combined matrix is stored symmetric
+      for (std::size_t i = 0; i < n_traces; i++)
+      {
+        for (std::size_t j = i + 1; j < n_traces; j++)
         {
-          // compute ranked mutual information
-          double curr_mutual_score = Scoring::rankedMutualInformation(rank_vec[i], rank_vec[j], max_rank_vec[i], max_rank_vec[j]);
-          mi_precursor_combined_matrix_.setValue(i ,j, curr_mutual_score);
-          mi_precursor_combined_matrix_.setValue(j ,i, curr_mutual_score);
+          mi_precursor_combined_matrix_.setValue(j, i, mi_precursor_combined_matrix_.getValue(i, j));
         }
       }
     }
+
     double MRMScoring::calcMIScore()
     {
       OPENSWATH_PRECONDITION(mi_matrix_.rows() > 1, "Expect mutual information matrix of at least 2x2");
@@ -34,6 +34,19 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
 
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // OpenSwathCalibrationWorkflow
 namespace OpenMS
 {
@@ -438,6 +451,119 @@ namespace OpenMS
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// Data of a SWATH window shared by all tasks (batches) of the window
+    struct SwathWindowState
+    {
+      std::mutex mutex; ///< protects swath_map
+      OpenSwath::SpectrumAccessPtr swath_map; ///< created by the first task of the window
+      OpenSwath::LightTargetedExperiment transitions; ///< transitions selected for the window
+      int batch_size = 0; ///< number of compounds per batch
+      std::atomic<Size> remaining_batches{0}; ///< number of batches not yet finished
+    };
+
+    /**
+      @brief Hands out the work of performExtraction() to the threads
+
+      Windows are opened in order: opening a window means selecting its
+      transitions, which yields the batches (tasks) of the window. Threads
+      first work on the pending batches of the open windows and only open the
+      next window if there are none, such that the transitions are selected
+      lazily and only few windows are held in memory at the same time. At most
+      @p max_open_windows windows are open at the same time.
+    */
+    template <typename TaskT>
+    class ExtractionScheduler
+    {
+    public:
+      ExtractionScheduler(Size nr_windows, Size max_open_windows) :
+        nr_windows_(nr_windows),
+        max_open_windows_(std::max(Size(1), max_open_windows))
+      {
+      }
+
+      /**
+        @brief Wait for the next work item of the calling thread
+
+        @return false if all work is done. Otherwise, either @p task points
+        to the next batch to process, or @p task is nullptr and the caller has
+        to select the transitions of window @p window and report its batches
+        through addWindow().
+      */
+      bool next(Size& window, TaskT*& task)
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+          if (!pending_.empty())
+          {
+            task = pending_.front();
+            pending_.pop_front();
+            return true;
+          }
+          if (next_window_ < nr_windows_ && open_windows_ < max_open_windows_)
+          {
+            window = next_window_++;
+            ++open_windows_;
+            ++selecting_;
+            task = nullptr;
+            return true;
+          }
+          if (next_window_ == nr_windows_ && selecting_ == 0)
+          {
+            return false; // no more tasks will be created
+          }
+          // wait for a window to be selected or closed
+          changed_.wait(lock);
+        }
+      }
+
+      /// Create the @p nr_batches tasks of the newly selected @p window
+      void addWindow(Size window, Size nr_batches)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --selecting_;
+        if (nr_batches == 0)
+        {
+          --open_windows_;
+        }
+        for (Size batch = 0; batch < nr_batches; ++batch)
+        {
+          tasks_.push_back(TaskT(window, batch, nr_batches));
+          pending_.push_back(&tasks_.back());
+        }
+        changed_.notify_all();
+      }
+
+      /// Report that all batches of a window are done
+      void closeWindow()
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --open_windows_;
+        changed_.notify_all();
+      }
+
+      /// All tasks created so far, in the order in which they were created
+      std::vector<TaskT> getTasks() const
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::vector<TaskT>(tasks_.begin(), tasks_.end());
+      }
+
+    private:
+      const Size nr_windows_;
+      const Size max_open_windows_;
+      mutable std::mutex mutex_;
+      std::condition_variable changed_;
+      Size next_window_ = 0; ///< next window to open
+      Size open_windows_ = 0; ///< windows opened and not yet closed
+      Size selecting_ = 0; ///< windows whose transitions are being selected
+      std::deque<TaskT> tasks_; ///< all tasks (a deque keeps the pointers in pending_ valid)
+      std::deque<TaskT*> pending_; ///< tasks not yet handed out
+    };
+  }
+
   void OpenSwathWorkflow::performExtraction(
     const std::vector< OpenSwath::SwathMap > & swath_maps,
     const TransformationDescription trafo,
@@ -586,207 +712,263 @@ namespace OpenMS
     };
 
     // (iv) Perform extraction and scoring of fragment ion chromatograms (MS2)
-    // We set dynamic scheduling such that the maps are worked on in the order
-    // in which they were given to the program / acquired. This gives much
-    // better load balancing than static allocation.
+    // The work is split into tasks, each task is one batch of assays from one
+    // SWATH window. All tasks are distributed over all threads as they become
+    // available, such that a thread which is done with a window continues
+    // with the batches of the remaining windows instead of idling until the
+    // largest windows are done. Windows are opened (their transitions
+    // selected and split into batches) in the order in which they were given
+    // to the program / acquired, and only when no batches of the open windows
+    // are pending, therefore only few windows are worked on at the same time.
+    // If threads_outer_loop_ is set, at most threads_outer_loop_ windows are
+    // open at the same time (e.g. to limit memory usage when loading windows
+    // into memory).
+    std::vector<SwathWindowState> window_states(swath_maps.size());
+    const Size max_open_windows = threads_outer_loop_ > 0 ? threads_outer_loop_ : std::max(Size(1), swath_maps.size());
+    ExtractionScheduler<ExtractionTask_> scheduler(swath_maps.size(), max_open_windows);
+
+    int nr_threads = 1;
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    int total_nr_threads = omp_get_max_threads(); // store total number of threads we are allowed to use
-    if (threads_outer_loop_ > -1)
-    {
-      std::cout << "Setting up nested loop with " << std::min(threads_outer_loop_, omp_get_max_threads()) << " threads out of "<< omp_get_max_threads() << std::endl;
-      omp_set_nested(1);
-      omp_set_dynamic(0);
-      omp_set_num_threads(std::min(threads_outer_loop_, omp_get_max_threads()) ); // use at most threads_outer_loop_ threads here
-    }
-    else
+    nr_threads = omp_get_max_threads();
+#endif
+    std::cout << "Distributing the batches of " << swath_maps.size() << " SWATH windows over " << nr_threads << " threads";
+    if (threads_outer_loop_ > 0)
     {
-      std::cout << "Use non-nested loop with " << total_nr_threads << " threads." << std::endl;
+      std::cout << ", working on at most " << max_open_windows << " SWATH windows at once";
     }
-#endif
-#pragma omp parallel for schedule(dynamic,1)
-#endif
-    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
+    std::cout << "." << std::endl;
+
+    StopWatch total_time;
+    total_time.start();
+#pragma omp parallel
     {
-      if (!swath_maps[i].ms1) // skip MS1
+      Size i = 0;
+      ExtractionTask_* task_ptr = nullptr;
+      while (scheduler.next(i, task_ptr))
       {
+        SwathWindowState& window = window_states[i];
 
-        // Step 1: select which transitions to extract (proceed in batches)
-        OpenSwath::LightTargetedExperiment transition_exp_used_all;
-        if (!(prm_ || pasef_))
-        {
-          // Step 1.1: select transitions matching the window
-          OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-              cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
-        }
-        else
+        if (task_ptr == nullptr)
         {
-          // Step 1.2: select transitions based on matching PRM/PASEF window (best window)
-          std::set<std::string> matching_compounds;
-          for (Size k = 0; k < tr_win_map.size(); k++)
+          // Step 1: select which transitions to extract from the new window
+          // and split them into batches
+          Size nr_batches = 0;
+          if (!swath_maps[i].ms1) // skip MS1
           {
-            if (tr_win_map[k] == i)
+            selectTransitionsForWindow_(swath_maps, i, transition_exp, tr_win_map, cp, window.transitions);
+            const Size nr_compounds = window.transitions.getCompounds().size();
+            if (!window.transitions.getTransitions().empty() && nr_compounds > 0)
             {
-               const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
-               transition_exp_used_all.transitions.push_back(tr);
-               matching_compounds.insert(tr.getPeptideRef());
-               OPENMS_LOG_DEBUG << "Adding Precursor with m/z " << tr.getPrecursorMZ() << " and IM of " << tr.getPrecursorIM() <<  " to swath with mz upper of " << swath_maps[i].upper << " im lower of " << swath_maps[i].imLower << " and im upper of " << swath_maps[i].imUpper << std::endl;
-            }
-          }
-
-          std::set<std::string> matching_proteins;
-          for (Size i = 0; i < transition_exp.compounds.size(); i++)
-          {
-            if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
-            {
-              transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
-              for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
+              if (batchSize <= 0 || batchSize >= (int)nr_compounds)
               {
-                matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
+                window.batch_size = nr_compounds;
               }
+              else
+              {
+                window.batch_size = batchSize;
+              }
+              nr_batches = (nr_compounds + window.batch_size - 1) / window.batch_size;
             }
           }
-          for (Size i = 0; i < transition_exp.proteins.size(); i++)
+          window.remaining_batches = nr_batches;
+          if (nr_batches == 0)
           {
-            if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
-            {
-              transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
-            }
+            // nothing to do for this window
+            window.transitions = OpenSwath::LightTargetedExperiment();
+            #pragma omp critical (progress)
+            this->setProgress(++progress);
           }
+          scheduler.addWindow(i, nr_batches);
+          continue;
         }
 
-        if (!transition_exp_used_all.getTransitions().empty()) // skip if no transitions found
-        {
-
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-          if (load_into_memory)
-          {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-          }
-
-          int batch_size;
-          if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
-          {
-            batch_size = transition_exp_used_all.getCompounds().size();
-          }
-          else
-          {
-            batch_size = batchSize;
-          }
-
-          SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
+        ExtractionTask_& task = *task_ptr;
+        const OpenSwath::LightTargetedExperiment& transition_exp_used_all = window.transitions;
 
+        StopWatch task_time;
+        task_time.start();
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-          // If we have a multiple of threads_outer_loop_ here, then use nested
-          // parallelization here. E.g. if we use 8 threads for the outer loop,
-          // but we have a total of 24 cores available, each of the 8 threads
-          // will then create a team of 3 threads to work on the batches
-          // individually.
-          //
-          // We should avoid oversubscribing the CPUs, therefore we use integer division.
-          // -- see https://docs.oracle.com/cd/E19059-01/stud.10/819-0501/2_nested.html
-          int outer_thread_nr = omp_get_thread_num();
-          omp_set_num_threads(std::max(1, total_nr_threads / threads_outer_loop_) );
-#pragma omp parallel for schedule(dynamic, 1)
-#endif
+        task.thread = omp_get_thread_num();
 #endif
-          for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
-          {
-            OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map;
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-            // To ensure multi-threading safe access to the individual spectra, we
-            // need to use a light clone of the spectrum access (if multiple threads
-            // share a single filestream and call seek on it, chaos will ensue).
-            if (total_nr_threads / threads_outer_loop_ > 1)
+        // The first task of a window creates the map from which all batches
+        // are extracted. Batches of the same window may be processed by
+        // different threads at the same time, therefore each task uses a
+        // light clone of the spectrum access (if multiple threads share a
+        // single filestream and call seek on it, chaos will ensue).
+        OpenSwath::SpectrumAccessPtr current_swath_map;
+        {
+          std::lock_guard<std::mutex> lock(window.mutex);
+          if (window.swath_map == nullptr)
+          {
+            window.swath_map = swath_maps[i].sptr;
+            if (load_into_memory)
             {
-              current_swath_map_inner = current_swath_map->lightClone();
+              // This creates an InMemory object that keeps all data in memory
+              window.swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*window.swath_map) );
             }
-#endif
+          }
+          current_swath_map = window.swath_map->lightClone();
+        }
+
 #pragma omp critical (osw_write_stdout)
-#endif
-            {
-              std::cout << "Thread " <<
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-              outer_thread_nr << "_" << omp_get_thread_num() << " " <<
-#else
-              omp_get_thread_num() << "_0 " <<
-#endif
-#else
-              "0" <<
-#endif
-              "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
-              << transition_exp_used_all.getTransitions().size() <<  " transitions "
-              "from SWATH " << i << " (batch " << pep_idx << " out of " << nr_batches << ")" << std::endl;
-            }
+        {
+          std::cout << "Thread " << task.thread << " will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
+            << transition_exp_used_all.getTransitions().size() <<  " transitions "
+            "from SWATH " << i << " (batch " << task.batch << " out of " << task.nr_batches << ")" << std::endl;
+        }
 
-            // Create the new, batch-size transition experiment
-            OpenSwath::LightTargetedExperiment transition_exp_used;
-            selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
+        // Step 2: create the new, batch-size transition experiment
+        OpenSwath::LightTargetedExperiment transition_exp_used;
+        selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, window.batch_size, task.batch);
 
-            // Extract MS1 chromatograms for this batch
-            std::vector< MSChromatogram > ms1_chromatograms;
-            if (ms1_map_ != nullptr)
-            {
-              OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
-              MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
-                  transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
-            }
+        // Extract MS1 chromatograms for this batch
+        std::vector< MSChromatogram > ms1_chromatograms;
+        if (ms1_map_ != nullptr)
+        {
+          OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
+          MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
+              transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
+        }
 
-            // Step 2.1: extract these transitions
-            ChromatogramExtractor extractor;
-            std::vector< OpenSwath::ChromatogramPtr > chrom_list;
-            std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+        // Step 3.1: extract these transitions
+        ChromatogramExtractor extractor;
+        std::vector< OpenSwath::ChromatogramPtr > chrom_list;
+        std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+
+        // Step 3.2: prepare the extraction coordinates and extract chromatograms
+        // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
+        prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
+        extractor.extractChromatograms(current_swath_map, chrom_list, coordinates, cp.mz_extraction_window,
+            cp.ppm, cp.im_extraction_window, cp.extraction_function);
+
+        // Step 3.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
+        PeakMap chrom_exp;
+        extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
+                                      chrom_exp.getChromatograms(), false, cp.im_extraction_window);
+
+        // Step 4: score these extracted transitions
+        FeatureMap featureFile;
+        std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
+        tmp.back().sptr = current_swath_map;
+        scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
+            feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
+
+        // Step 5: write all chromatograms and features out into an output object / file
+        // (this needs to be done in a critical section since we only have one
+        // output file and one output map).
+        #pragma omp critical (osw_write_out)
+        {
+          writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
+        }
 
-            // Step 2.2: prepare the extraction coordinates and extract chromatograms
-            // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
-            prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
-            extractor.extractChromatograms(current_swath_map_inner, chrom_list, coordinates, cp.mz_extraction_window,
-                cp.ppm, cp.im_extraction_window, cp.extraction_function);
+        task_time.stop();
+        task.seconds = task_time.getClockTime();
 
-            // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
-            PeakMap chrom_exp;
-            extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
-                                          chrom_exp.getChromatograms(), false, cp.im_extraction_window);
+#pragma omp critical (osw_write_stdout)
+        {
+          std::cout << "Thread " << task.thread << " finished SWATH " << i << " (batch " << task.batch << " out of "
+            << task.nr_batches << ") in " << task.seconds << " s" << std::endl;
+        }
 
+        // The last batch of a window releases its data
+        if (--window.remaining_batches == 0)
+        {
+          {
+            std::lock_guard<std::mutex> lock(window.mutex);
+            window.swath_map.reset();
+            window.transitions = OpenSwath::LightTargetedExperiment();
+          }
+          scheduler.closeWindow();
 
-            // Step 3: score these extracted transitions
-            FeatureMap featureFile;
-            std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
-            tmp.back().sptr = current_swath_map_inner;
-            scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
-                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
+          #pragma omp critical (progress)
+          this->setProgress(++progress);
+        }
+      }
+    }
+    total_time.stop();
+    this->endProgress();
 
-            // Step 4: write all chromatograms and features out into an output object / file
-            // (this needs to be done in a critical section since we only have one
-            // output file and one output map).
-            #pragma omp critical (osw_write_out)
-            {
-              writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
-            }
-          }
+    printSchedulingSummary_(scheduler.getTasks(), nr_threads, total_time.getClockTime());
+  }
+
+  void OpenSwathWorkflow::selectTransitionsForWindow_(const std::vector< OpenSwath::SwathMap > & swath_maps,
+    SignedSize i,
+    const OpenSwath::LightTargetedExperiment& transition_exp,
+    const std::vector<int>& tr_win_map,
+    const ChromExtractParams & cp,
+    OpenSwath::LightTargetedExperiment& transition_exp_used_all) const
+  {
+    if (!(prm_ || pasef_))
+    {
+      // Select transitions matching the window
+      OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
+          cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+      return;
+    }
 
-        } // continue 2 (no continue due to OpenMP)
-      } // continue 1 (no continue due to OpenMP)
+    // Select transitions based on matching PRM/PASEF window (best window)
+    std::set<std::string> matching_compounds;
+    for (Size k = 0; k < tr_win_map.size(); k++)
+    {
+      if (tr_win_map[k] == i)
+      {
+         const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
+         transition_exp_used_all.transitions.push_back(tr);
+         matching_compounds.insert(tr.getPeptideRef());
+         OPENMS_LOG_DEBUG << "Adding Precursor with m/z " << tr.getPrecursorMZ() << " and IM of " << tr.getPrecursorIM() <<  " to swath with mz upper of " << swath_maps[i].upper << " im lower of " << swath_maps[i].imLower << " and im upper of " << swath_maps[i].imUpper << std::endl;
+      }
+    }
 
-      #pragma omp critical (progress)
-      this->setProgress(++progress);
+    std::set<std::string> matching_proteins;
+    for (Size i = 0; i < transition_exp.compounds.size(); i++)
+    {
+      if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
+      {
+        transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
+        for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
+        {
+          matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
+        }
+      }
+    }
+    for (Size i = 0; i < transition_exp.proteins.size(); i++)
+    {
+      if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
+      {
+        transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
+      }
+    }
+  }
 
+  void OpenSwathWorkflow::printSchedulingSummary_(const std::vector<ExtractionTask_>& tasks, int nr_threads, double wall_time) const
+  {
+    if (tasks.empty())
+    {
+      return;
     }
-    this->endProgress();
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    if (threads_outer_loop_ > -1)
+    // Time spent per window and longest task
+    double busy_time = 0;
+    std::map<Size, double> window_time;
+    const ExtractionTask_* longest = &tasks[0];
+    for (const ExtractionTask_& task : tasks)
     {
-      omp_set_num_threads(total_nr_threads); // set number of available threads back to initial value
+      busy_time += task.seconds;
+      window_time[task.window] += task.seconds;
+      if (task.seconds > longest->seconds)
+      {
+        longest = &task;
+      }
     }
-#endif
-#endif
+    auto longest_window = std::max_element(window_time.begin(), window_time.end(),
+      [](const std::pair<const Size, double>& a, const std::pair<const Size, double>& b) { return a.second < b.second; });
+
+    std::cout << "Processed " << tasks.size() << " tasks from " << window_time.size() << " SWATH windows in "
+      << wall_time << " s using " << nr_threads << " threads (busy " << busy_time << " s, utilization "
+      << (wall_time > 0 ? 100.0 * busy_time / (wall_time * nr_threads) : 100.0) << " %)." << std::endl;
+    std::cout << "Longest SWATH window: " << longest_window->first << " (" << longest_window->second << " s), longest task: SWATH "
+      << longest->window << " batch " << longest->batch << " (" << longest->seconds << " s)." << std::endl;
   }
 
   void OpenSwathWorkflow::writeOutFeaturesAndChroms_(
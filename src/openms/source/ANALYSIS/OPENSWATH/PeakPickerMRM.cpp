@@ -125,6 +125,66 @@ namespace OpenMS
       gauss_.filter(smoothed_chrom);
     }
 
+    pickSmoothedChromatogram_(chromatogram, smoothed_chrom, picked_chrom);
+  }
+
+  void PeakPickerMRM::pickChromatograms(const std::vector<const MSChromatogram*>& chromatograms,
+                                        std::vector<MSChromatogram>& picked_chroms,
+                                        std::vector<MSChromatogram>& smoothed_chroms)
+  {
+    const Size n = chromatograms.size();
+    picked_chroms.assign(n, MSChromatogram());
+    smoothed_chroms.assign(n, MSChromatogram());
+
+    // Crawdad does not use our smoothing
+    if (method_ == "crawdad")
+    {
+      for (Size k = 0; k < n; ++k)
+      {
+        pickChromatogram(*chromatograms[k], picked_chroms[k], smoothed_chroms[k]);
+      }
+      return;
+    }
+
+    // Smooth all chromatograms in one batch
+    for (Size k = 0; k < n; ++k)
+    {
+      if (!chromatograms[k]->isSorted())
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                         "Chromatogram must be sorted by position");
+      }
+      if (!chromatograms[k]->empty())
+      {
+        smoothed_chroms[k] = *chromatograms[k];
+      }
+    }
+    if (!use_gauss_)
+    {
+      sgolay_.filterChromatograms(smoothed_chroms);
+    }
+    else
+    {
+      gauss_.filterChromatograms(smoothed_chroms);
+    }
+
+    for (Size k = 0; k < n; ++k)
+    {
+      const MSChromatogram& chromatogram = *chromatograms[k];
+      if (chromatogram.empty())
+      {
+        OPENMS_LOG_DEBUG << " ====  Chromatogram " << chromatogram.getNativeID() << "empty. Skip picking.";
+        continue;
+      }
+      OPENMS_LOG_DEBUG << " ====  Picking chromatogram " << chromatogram.getNativeID() <<
+        " with " << chromatogram.size() << " peaks (start at RT " << chromatogram[0].getRT() << " to RT " << chromatogram.back().getRT() << ") "
+        "using method \'" << method_ << "\'" << std::endl;
+      pickSmoothedChromatogram_(chromatogram, smoothed_chroms[k], picked_chroms[k]);
+    }
+  }
+
+  void PeakPickerMRM::pickSmoothedChromatogram_(const MSChromatogram& chromatogram, const MSChromatogram& smoothed_chrom, MSChromatogram& picked_chrom)
+  {
     // Find initial seeds (peak picking)
     pp_.pick(smoothed_chrom, picked_chrom);
     OPENMS_LOG_DEBUG << "Picked " << picked_chrom.size() << " chromatographic peaks." << std::endl;
@@ -43,12 +43,32 @@
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/CONCEPT/RAIICleanup.h>
 
+#include <array>
 #include <unordered_set>
 
 using namespace std;
 
 namespace OpenMS
 {
+  namespace
+  {
+    /// offsets from the sum of internal residue masses to the neutral ion mass, indexed by Residue::ResidueType
+    const std::array<double, Residue::SizeOfResidueType>& getIonOffsetTable()
+    {
+      static const std::array<double, Residue::SizeOfResidueType> table = []()
+      {
+        std::array<double, Residue::SizeOfResidueType> offsets{};
+        offsets[Residue::AIon] = Residue::getInternalToAIon().getMonoWeight();
+        offsets[Residue::BIon] = Residue::getInternalToBIon().getMonoWeight();
+        offsets[Residue::CIon] = Residue::getInternalToCIon().getMonoWeight();
+        offsets[Residue::XIon] = Residue::getInternalToXIon().getMonoWeight();
+        offsets[Residue::YIon] = Residue::getInternalToYIon().getMonoWeight();
+        offsets[Residue::ZIon] = Residue::getInternalToZIon().getMonoWeight();
+        return offsets;
+      }();
+      return table;
+    }
+  }
 
   TheoreticalSpectrumGenerator::TheoreticalSpectrumGenerator() :
     DefaultParamHandler("TheoreticalSpectrumGenerator")
@@ -131,12 +151,17 @@ namespace OpenMS
   TheoreticalSpectrumGenerator::TheoreticalSpectrumGenerator(const TheoreticalSpectrumGenerator& rhs) :
     DefaultParamHandler(rhs)
   {
+    updateMembers_();
   }
 
 
   TheoreticalSpectrumGenerator& TheoreticalSpectrumGenerator::operator=(const TheoreticalSpectrumGenerator& rhs)
   {
-    DefaultParamHandler::operator=(rhs);
+    if (this != &rhs)
+    {
+      DefaultParamHandler::operator=(rhs);
+      updateMembers_();
+    }
     return *this;
   }
 
@@ -303,6 +328,83 @@ namespace OpenMS
   }
 
 
+  template <typename EmitFunction>
+  void TheoreticalSpectrumGenerator::forEachFragment_(const AASequence& peptide, Int min_charge, Int max_charge, EmitFunction emit) const
+  {
+    if (min_charge < 1)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Fragment charges must be positive.");
+    }
+    // the full peptide is not a fragment (see addPeaks_)
+    if (peptide.size() < 2) { return; }
+
+    const std::array<double, Residue::SizeOfResidueType>& ion_offsets = getIonOffsetTable();
+    const Size n = peptide.size();
+
+    Residue::ResidueType prefix_types[3];
+    Size n_prefix_types(0);
+    if (add_a_ions_) { prefix_types[n_prefix_types++] = Residue::AIon; }
+    if (add_b_ions_) { prefix_types[n_prefix_types++] = Residue::BIon; }
+    if (add_c_ions_) { prefix_types[n_prefix_types++] = Residue::CIon; }
+
+    if (n_prefix_types > 0)
+    {
+      double mono_weight = peptide.hasNTerminalModification() ? peptide.getNTerminalModification()->getDiffMonoMass() : 0.0;
+      for (Size i = 0; i < n - 1; ++i)
+      {
+        mono_weight += peptide[i].getMonoWeight(Residue::Internal);
+        if (i == 0 && !add_first_prefix_ion_) { continue; }
+        for (Size t = 0; t < n_prefix_types; ++t)
+        {
+          const double ion_weight = mono_weight + ion_offsets[prefix_types[t]];
+          for (Int z = min_charge; z <= max_charge; ++z)
+          {
+            emit((ion_weight + Constants::PROTON_MASS_U * z) / z, prefix_types[t], i + 1, z);
+          }
+        }
+      }
+    }
+
+    Residue::ResidueType suffix_types[3];
+    Size n_suffix_types(0);
+    if (add_x_ions_) { suffix_types[n_suffix_types++] = Residue::XIon; }
+    if (add_y_ions_) { suffix_types[n_suffix_types++] = Residue::YIon; }
+    if (add_z_ions_) { suffix_types[n_suffix_types++] = Residue::ZIon; }
+
+    if (n_suffix_types > 0)
+    {
+      double mono_weight = peptide.hasCTerminalModification() ? peptide.getCTerminalModification()->getDiffMonoMass() : 0.0;
+      for (Size i = n - 1; i > 0; --i)
+      {
+        mono_weight += peptide[i].getMonoWeight(Residue::Internal);
+        for (Size t = 0; t < n_suffix_types; ++t)
+        {
+          const double ion_weight = mono_weight + ion_offsets[suffix_types[t]];
+          for (Int z = min_charge; z <= max_charge; ++z)
+          {
+            emit((ion_weight + Constants::PROTON_MASS_U * z) / z, suffix_types[t], n - i, z);
+          }
+        }
+      }
+    }
+  }
+
+  void TheoreticalSpectrumGenerator::getFragmentMZs(const AASequence& peptide, Int min_charge, Int max_charge, std::vector<double>& mz) const
+  {
+    mz.clear();
+    forEachFragment_(peptide, min_charge, max_charge,
+      [&mz](double pos, Residue::ResidueType, Size, Int) { mz.push_back(pos); });
+    std::sort(mz.begin(), mz.end());
+  }
+
+  void TheoreticalSpectrumGenerator::getFragmentIons(const AASequence& peptide, Int min_charge, Int max_charge, std::vector<FragmentIon>& ions) const
+  {
+    ions.clear();
+    forEachFragment_(peptide, min_charge, max_charge,
+      [&ions](double pos, Residue::ResidueType type, Size ordinal, Int charge) { ions.push_back({pos, type, UInt32(ordinal), charge}); });
+    std::sort(ions.begin(), ions.end(), [](const FragmentIon& a, const FragmentIon& b) { return a.mz < b.mz; });
+  }
+
   void TheoreticalSpectrumGenerator::addAbundantImmoniumIons_(PeakSpectrum& spectrum, const AASequence& peptide, DataArrays::StringDataArray& ion_names, DataArrays::IntegerDataArray& charges) const
   {
     // Proline immonium ion (C4H8N)
@@ -79,14 +79,30 @@ namespace OpenMS
   {
     OPENMS_PRECONDITION(BinnedSpectrum::isCompatible(spec1, spec2), "Binned spectra have different bin size or spread");
 
-    size_t denominator(max(spec1.getBins()->nonZeros(), spec2.getBins()->nonZeros()));
+    const BinnedSpectrum::SparseVectorType& bins1 = *spec1.getBins();
+    const BinnedSpectrum::SparseVectorType& bins2 = *spec2.getBins();
+    const size_t n1 = bins1.nonZeros();
+    const size_t n2 = bins2.nonZeros();
+    size_t denominator(max(n1, n2));
+
+    // count shared bins by merging the sorted bin indices (avoids creating the coefficient-wise product)
+    const int* idx1 = bins1.innerIndexPtr();
+    const int* idx2 = bins2.innerIndexPtr();
+    size_t shared(0);
+    for (size_t i = 0, j = 0; i < n1 && j < n2;)
+    {
+      if (idx1[i] < idx2[j]) { ++i; }
+      else if (idx2[j] < idx1[i]) { ++j; }
+      else
+      {
+        shared += (bins1.valuePtr()[i] != 0.0f && bins2.valuePtr()[j] != 0.0f);
+        ++i;
+        ++j;
+      }
+    }
 
-    // Note: keep in single expression for faster computation via expression templates
-    // Calculate coefficient-wise product and count non-zero entries
-    BinnedSpectrum::SparseVectorType s = spec1.getBins()->cwiseProduct(*spec2.getBins());
-    
     // resulting score normalized to interval [0,1]
-    return static_cast<double>(s.nonZeros()) / denominator;
+    return static_cast<double>(shared) / denominator;
   }
 
 }
@@ -0,0 +1,235 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSpectrumBlock.h>
+
+#include <Eigen/Sparse>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+using namespace std;
+
+namespace OpenMS
+{
+
+  Size BinnedSpectrumBlock::add(const BinnedSpectrum& spectrum)
+  {
+    if (size() == 0)
+    {
+      bin_size_ = spectrum.getBinSize();
+      offset_ = spectrum.getOffset();
+      unit_ppm_ = spectrum.isUnitPpm();
+    }
+    else if (!isCompatible_(spectrum))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Binned spectrum has a different bin size or offset than the block.");
+    }
+
+    const BinnedSpectrum::SparseVectorType& bins = *spectrum.getBins();
+    const int* indices = bins.innerIndexPtr();
+    const float* values = bins.valuePtr();
+    const Size n = bins.nonZeros();
+
+    bin_indices_.insert(bin_indices_.end(), indices, indices + n);
+    intensities_.insert(intensities_.end(), values, values + n);
+    offsets_.push_back(bin_indices_.size());
+
+    double squared_norm(0), intensity_sum(0);
+    for (Size i = 0; i < n; ++i)
+    {
+      squared_norm += double(values[i]) * values[i];
+      intensity_sum += values[i];
+    }
+    squared_norms_.push_back(squared_norm);
+    intensity_sums_.push_back(intensity_sum);
+    return size() - 1;
+  }
+
+  void BinnedSpectrumBlock::clear()
+  {
+    offsets_.assign(1, 0);
+    bin_indices_.clear();
+    intensities_.clear();
+    squared_norms_.clear();
+    intensity_sums_.clear();
+  }
+
+  void BinnedSpectrumBlock::reserve(Size spectra, Size bins)
+  {
+    offsets_.reserve(spectra + 1);
+    squared_norms_.reserve(spectra);
+    intensity_sums_.reserve(spectra);
+    bin_indices_.reserve(bins);
+    intensities_.reserve(bins);
+  }
+
+  Size BinnedSpectrumBlock::size() const
+  {
+    return offsets_.size() - 1;
+  }
+
+  Size BinnedSpectrumBlock::getNonZeros(Size index) const
+  {
+    return offsets_[index + 1] - offsets_[index];
+  }
+
+  bool BinnedSpectrumBlock::isCompatible_(const BinnedSpectrum& spectrum) const
+  {
+    return std::tie(unit_ppm_, bin_size_, offset_) == std::make_tuple(spectrum.isUnitPpm(), spectrum.getBinSize(), spectrum.getOffset());
+  }
+
+  void BinnedSpectrumBlock::densify_(const BinnedSpectrum& query, DenseQuery_& dense) const
+  {
+    if (size() != 0 && !isCompatible_(query))
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Query has a different bin size or offset than the block.");
+    }
+    const BinnedSpectrum::SparseVectorType& bins = *query.getBins();
+    const int* indices = bins.innerIndexPtr();
+    const float* values = bins.valuePtr();
+    const Size n = bins.nonZeros();
+
+    dense.intensities.clear();
+    dense.first_bin = 0;
+    dense.squared_norm = 0;
+    dense.intensity_sum = 0;
+    dense.non_zeros = n;
+    if (n == 0) { return; }
+
+    // bins of a sparse vector are sorted by index
+    dense.first_bin = indices[0];
+    dense.intensities.assign(indices[n - 1] - indices[0] + 1, 0.0f);
+    for (Size i = 0; i < n; ++i)
+    {
+      dense.intensities[indices[i] - dense.first_bin] = values[i];
+      dense.squared_norm += double(values[i]) * values[i];
+      dense.intensity_sum += values[i];
+    }
+  }
+
+  std::pair<Size, Size> BinnedSpectrumBlock::getOverlap_(Size index, const DenseQuery_& dense) const
+  {
+    auto begin = bin_indices_.begin() + offsets_[index];
+    auto end = bin_indices_.begin() + offsets_[index + 1];
+    if (dense.intensities.empty()) { return {offsets_[index], offsets_[index]}; }
+
+    const int last_bin = dense.first_bin + int(dense.intensities.size()) - 1;
+    begin = std::lower_bound(begin, end, dense.first_bin);
+    end = std::upper_bound(begin, end, last_bin);
+    return {Size(begin - bin_indices_.begin()), Size(end - bin_indices_.begin())};
+  }
+
+  void BinnedSpectrumBlock::compareContrastAngle(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const
+  {
+    OPENMS_PRECONDITION(first <= last && last <= size(), "Invalid range of block spectra");
+
+    DenseQuery_ dense;
+    densify_(query, dense);
+    scores.resize(last - first);
+
+    const float* q = dense.intensities.data();
+    const int* idx = bin_indices_.data();
+    const float* val = intensities_.data();
+    const int q_first = dense.first_bin;
+    for (Size s = first; s < last; ++s)
+    {
+      const std::pair<Size, Size> overlap = getOverlap_(s, dense);
+      double dot(0);
+#pragma omp simd reduction(+: dot)
+      for (Size k = overlap.first; k < overlap.second; ++k)
+      {
+        dot += double(q[idx[k] - q_first]) * val[k];
+      }
+      scores[s - first] = dot / std::sqrt(dense.squared_norm * squared_norms_[s]);
+    }
+  }
+
+  void BinnedSpectrumBlock::compareSharedPeakCount(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const
+  {
+    OPENMS_PRECONDITION(first <= last && last <= size(), "Invalid range of block spectra");
+
+    DenseQuery_ dense;
+    densify_(query, dense);
+    scores.resize(last - first);
+
+    const float* q = dense.intensities.data();
+    const int* idx = bin_indices_.data();
+    const float* val = intensities_.data();
+    const int q_first = dense.first_bin;
+    for (Size s = first; s < last; ++s)
+    {
+      const std::pair<Size, Size> overlap = getOverlap_(s, dense);
+      Size shared(0);
+#pragma omp simd reduction(+: shared)
+      for (Size k = overlap.first; k < overlap.second; ++k)
+      {
+        shared += Size(q[idx[k] - q_first] != 0.0f && val[k] != 0.0f);
+      }
+      const Size denominator = std::max(dense.non_zeros, getNonZeros(s));
+      scores[s - first] = static_cast<double>(shared) / denominator;
+    }
+  }
+
+  void BinnedSpectrumBlock::compareSumAgreeingIntensities(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const
+  {
+    OPENMS_PRECONDITION(first <= last && last <= size(), "Invalid range of block spectra");
+
+    DenseQuery_ dense;
+    densify_(query, dense);
+    scores.resize(last - first);
+
+    const float* q = dense.intensities.data();
+    const int* idx = bin_indices_.data();
+    const float* val = intensities_.data();
+    const int q_first = dense.first_bin;
+    for (Size s = first; s < last; ++s)
+    {
+      // bins filled in only one of the spectra have a negative agreement (a / 2 - a) and are truncated to zero,
+      // so only the shared bins contribute
+      const std::pair<Size, Size> overlap = getOverlap_(s, dense);
+      double sum_nn(0);
+#pragma omp simd reduction(+: sum_nn)
+      for (Size k = overlap.first; k < overlap.second; ++k)
+      {
+        const float a = q[idx[k] - q_first];
+        const float b = val[k];
+        sum_nn += std::max(0.0f, (a + b) * 0.5f - std::fabs(a - b));
+      }
+      scores[s - first] = std::min(sum_nn / ((dense.intensity_sum + intensity_sums_[s]) / 2.0), 1.0);
+    }
+  }
+
+}
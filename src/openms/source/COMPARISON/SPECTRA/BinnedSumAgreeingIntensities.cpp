@@ -82,12 +82,29 @@ namespace OpenMS
     const double sum1 = spec1.getBins()->sum();
     const double sum2 = spec2.getBins()->sum();
 
-    // For maximum speed, keep in single expression
-    // 1. calculate mean minus difference: x = mean(a,b) - abs(a-b)
-    // 2. truncate negative values:        y = max(0, x)
-    // 3. calculate sum of entries:   sum_nn = y.sum()
-    BinnedSpectrum::SparseVectorType s = ((*spec1.getBins() + *spec2.getBins()) * 0.5) - ((*spec1.getBins() - *spec2.getBins()).cwiseAbs());
-    double sum_nn = s.coeffs().cwiseMax(0).sum();
+    // agreement per bin: max(0, mean(a,b) - abs(a-b))
+    // Bins filled in only one spectrum have a negative agreement (a / 2 - a) and are truncated to zero,
+    // so it suffices to merge the sorted bin indices and sum up the shared bins (no temporary vectors).
+    const BinnedSpectrum::SparseVectorType& bins1 = *spec1.getBins();
+    const BinnedSpectrum::SparseVectorType& bins2 = *spec2.getBins();
+    const int* idx1 = bins1.innerIndexPtr();
+    const int* idx2 = bins2.innerIndexPtr();
+    const float* val1 = bins1.valuePtr();
+    const float* val2 = bins2.valuePtr();
+    const size_t n1 = bins1.nonZeros();
+    const size_t n2 = bins2.nonZeros();
+    double sum_nn(0);
+    for (size_t i = 0, j = 0; i < n1 && j < n2;)
+    {
+      if (idx1[i] < idx2[j]) { ++i; }
+      else if (idx2[j] < idx1[i]) { ++j; }
+      else
+      {
+        sum_nn += max(0.0f, (val1[i] + val2[j]) * 0.5f - fabs(val1[i] - val2[j]));
+        ++i;
+        ++j;
+      }
+    }
 
     // resulting score normalized to interval [0,1]
     return min(sum_nn / ((sum1 + sum2) / 2.0), 1.0);
@@ -38,6 +38,11 @@
 #include <OpenMS/KERNEL/MSExperiment.h>
 
 #include <cmath>
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace OpenMS
 {
@@ -69,6 +74,11 @@ namespace OpenMS
   }
 
   void GaussFilter::filter(MSSpectrum & spectrum)
+  {
+    filter_(spectrum, gauss_algo_);
+  }
+
+  void GaussFilter::filter_(MSSpectrum & spectrum, GaussFilterAlgorithm & algo) const
   {
     // make sure the right data type is set
     spectrum.setType(SpectrumSettings::PROFILE);
@@ -86,7 +96,7 @@ namespace OpenMS
     // apply filter
     auto mz_out_it = mz_out.begin();
     auto int_out_it = int_out.begin();
-    found_signal = gauss_algo_.filter(mz_in.begin(), mz_in.end(), int_in.begin(), mz_out_it, int_out_it);
+    found_signal = algo.filter(mz_in.begin(), mz_in.end(), int_in.begin(), mz_out_it, int_out_it);
 
     // If all intensities are zero in the scan and the scan has a reasonable size, throw an exception.
     // This is the case if the Gaussian filter is smaller than the spacing of raw data
@@ -168,20 +178,69 @@ namespace OpenMS
 
   void GaussFilter::filterExperiment(PeakMap & map)
   {
+    const Size n_spectra = map.size();
+    const Size n_total = n_spectra + map.getChromatograms().size();
     Size progress = 0;
-    startProgress(0, map.size() + map.getChromatograms().size(), "smoothing data");
-    for (Size i = 0; i < map.size(); ++i)
+    startProgress(0, n_total, "smoothing data");
+
+    std::exception_ptr error;
+#pragma omp parallel
     {
-      filter(map[i]);
-      setProgress(++progress);
+      // the algorithm is re-initialized per data point in ppm mode, so every thread needs its own copy
+      GaussFilterAlgorithm algo(gauss_algo_);
+
+#pragma omp for schedule(dynamic)
+      for (SignedSize i = 0; i < (SignedSize)n_total; ++i)
+      {
+        try
+        {
+          if ((Size)i < n_spectra)
+          {
+            filter_(map[i], algo);
+          }
+          else
+          {
+            filter(map.getChromatogram(i - n_spectra));
+          }
+        }
+        catch (...)
+        {
+#pragma omp critical (GaussFilter_error)
+          if (!error) error = std::current_exception();
+        }
+
+#pragma omp atomic
+        ++progress;
+        IF_MASTERTHREAD setProgress(progress);
+      }
     }
+    if (error) std::rethrow_exception(error);
+    endProgress();
+  }
 
-    for (Size i = 0; i < map.getChromatograms().size(); ++i)
+  void GaussFilter::filterChromatograms(std::vector<MSChromatogram> & chromatograms)
+  {
+    // a thread team does not pay off for the few chromatograms of a transition group, nor when
+    // the caller already runs in parallel
+    bool parallel = chromatograms.size() >= 16;
+#ifdef _OPENMP
+    parallel = parallel && !omp_in_parallel();
+#endif
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic) if (parallel)
+    for (SignedSize i = 0; i < (SignedSize)chromatograms.size(); ++i)
     {
-      filter(map.getChromatogram(i));
-      setProgress(++progress);
+      try
+      {
+        filter(chromatograms[i]);
+      }
+      catch (...)
+      {
+#pragma omp critical (GaussFilter_error)
+        if (!error) error = std::current_exception();
+      }
     }
-    endProgress();
+    if (error) std::rethrow_exception(error);
   }
 
 }
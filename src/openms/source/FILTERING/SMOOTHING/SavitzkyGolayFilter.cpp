@@ -38,6 +38,12 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 
+#include <exception>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   SavitzkyGolayFilter::SavitzkyGolayFilter() :
@@ -105,4 +111,65 @@ namespace OpenMS
       }
     }
   }
+
+  void SavitzkyGolayFilter::filterExperiment(PeakMap & map)
+  {
+    const Size n_spectra = map.size();
+    const Size n_total = n_spectra + map.getChromatograms().size();
+    Size progress = 0;
+    startProgress(0, n_total, "smoothing data");
+
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)n_total; ++i)
+    {
+      try
+      {
+        if ((Size)i < n_spectra)
+        {
+          filter(map[i]);
+        }
+        else
+        {
+          filter(map.getChromatogram(i - n_spectra));
+        }
+      }
+      catch (...)
+      {
+#pragma omp critical (SavitzkyGolayFilter_error)
+        if (!error) error = std::current_exception();
+      }
+
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    }
+    if (error) std::rethrow_exception(error);
+    endProgress();
+  }
+
+  void SavitzkyGolayFilter::filterChromatograms(std::vector<MSChromatogram> & chromatograms)
+  {
+    // a thread team does not pay off for the few chromatograms of a transition group, nor when
+    // the caller already runs in parallel
+    bool parallel = chromatograms.size() >= 16;
+#ifdef _OPENMP
+    parallel = parallel && !omp_in_parallel();
+#endif
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic) if (parallel)
+    for (SignedSize i = 0; i < (SignedSize)chromatograms.size(); ++i)
+    {
+      try
+      {
+        filter(chromatograms[i]);
+      }
+      catch (...)
+      {
+#pragma omp critical (SavitzkyGolayFilter_error)
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+  }
 }
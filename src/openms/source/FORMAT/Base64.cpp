@@ -37,6 +37,14 @@
 #include <QtCore/QList>
 #include <QtCore/QString>
 
+#include <algorithm>
+
+// SIMD kernels are selected at runtime, so they can be built without raising the baseline instruction set
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OPENMS_BASE64_X86_SIMD
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace OpenMS
@@ -44,7 +52,7 @@ namespace OpenMS
 
   /*
 
-   Background in the following two encoding / decoding mapping arrays.
+   Background on the encoding / decoding mapping.
 
    While encoding we have to map a binary value to its character value using
    the base 64 mapping:
@@ -81,48 +89,336 @@ namespace OpenMS
      +   = 43       ->       62
      /   = 47       ->       63
 
+  Decoding uses this mapping directly through a table of 256 entries indexed
+  by the character value (characters outside the alphabet map to 0). The SIMD
+  kernels compute the same mapping with range comparisons and a per-range
+  offset: 'A'-'Z' -> -65, 'a'-'z' -> -71, '0'-'9' -> +4, '+' -> +19 and
+  '/' -> +16.
 
-  this can be done by first subtracting 43 from each value
-  and then looking up a value in a table as found in the code,
-  e.g. lookup[char - 43] - 62
+  */
 
-  The following string can be produced by this Python snippet:
+  namespace
+  {
+    const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-offset = 62
-s = ""
-s += chr(62 + offset)
-s += '$' * 3
-s += "".join([ chr(52 + i + offset) for i in range(10) ])
-s += '$' * 7
-s += "".join([ chr(i + offset) for i in range(26) ])
-s += '$' * 6
-s += "".join([ chr(26 + i + offset) for i in range(26) ])
-print s
+    /// Maps every character to its 6 bit Base64 value (characters outside the alphabet map to zero)
+    struct Base64DecodeTable
+    {
+      Byte value[256] = {};
 
-"|$$$rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\]^_`abcdefghijklmnopq"
+      Base64DecodeTable()
+      {
+        for (Byte i = 0; i < 64; ++i)
+        {
+          value[static_cast<unsigned char>(alphabet[i])] = i;
+        }
+      }
+    };
 
-  however, this is basically just convenience to produce printable characters.
-  We could also go for a direct mapping:
+    const Base64DecodeTable decode_table;
 
-s = '$' * 42
-s += hex(62)
-s += '$' * 3
-s += "".join([ hex(52 + i) for i in range(10) ])
-s += '$' * 7
-s += "".join([ hex(i) for i in range(26) ])
-s += '$' * 6
-s += "".join([ hex(26 + i) for i in range(26) ])
-print s
+    /// Scalar decoding of complete (unpadded) groups of 4 characters
+    void decodeBlocksScalar(const char* in, Size n_chars, Byte* out)
+    {
+      const Byte* table = decode_table.value;
+      for (const char* end = in + n_chars; in != end; in += 4, out += 3)
+      {
+        const UInt32 v = (UInt32(table[static_cast<unsigned char>(in[0])]) << 18) |
+                         (UInt32(table[static_cast<unsigned char>(in[1])]) << 12) |
+                         (UInt32(table[static_cast<unsigned char>(in[2])]) << 6) |
+                          UInt32(table[static_cast<unsigned char>(in[3])]);
+        out[0] = Byte(v >> 16);
+        out[1] = Byte(v >> 8);
+        out[2] = Byte(v);
+      }
+    }
 
-"$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$0x3e$$$0x340x350x360x370x380x390x3a0x3b0x3c0x3d$$$$$$$0x00x10x20x30x40x50x60x70x80x90xa0xb0xc0xd0xe0xf0x100x110x120x130x140x150x160x170x180x19$$$$$$0x1a0x1b0x1c0x1d0x1e0x1f0x200x210x220x230x240x250x260x270x280x290x2a0x2b0x2c0x2d0x2e0x2f0x300x310x320x33"
+    /// Scalar encoding of complete groups of 3 bytes
+    void encodeBlocksScalar(const Byte* in, Size n_bytes, char* out)
+    {
+      for (const Byte* end = in + n_bytes; in != end; in += 3, out += 4)
+      {
+        const UInt32 v = (UInt32(in[0]) << 16) | (UInt32(in[1]) << 8) | UInt32(in[2]);
+        out[0] = alphabet[(v >> 18) & 0x3F];
+        out[1] = alphabet[(v >> 12) & 0x3F];
+        out[2] = alphabet[(v >> 6) & 0x3F];
+        out[3] = alphabet[v & 0x3F];
+      }
+    }
 
-  which would allow lookup[char] without any adding or subtraction step (but
-  needs a 42 byte extra memory in the local cache).
+    void swapBytesScalar(void* data, Size count, Size element_size)
+    {
+      if (element_size == 4)
+      {
+        UInt32* p = static_cast<UInt32*>(data);
+        std::transform(p, p + count, p, endianize32);
+      }
+      else if (element_size == 8)
+      {
+        UInt64* p = static_cast<UInt64*>(data);
+        std::transform(p, p + count, p, endianize64);
+      }
+    }
 
-  */
+#ifdef OPENMS_BASE64_X86_SIMD
+    /*
+      SIMD kernels (see W. Mula and D. Lemire, "Faster Base64 Encoding and
+      Decoding Using AVX2 Instructions", ACM TOW 2018). They are compiled for
+      their target instruction set via function attributes and only called
+      after a runtime check of the CPU features, so the library itself stays
+      compatible with any x86-64 CPU.
+    */
+
+    bool cpuHasSSSE3()
+    {
+      static const bool has = __builtin_cpu_supports("ssse3");
+      return has;
+    }
+
+    bool cpuHasAVX2()
+    {
+      static const bool has = __builtin_cpu_supports("avx2");
+      return has;
+    }
+
+    /// Translates 16 Base64 characters into their 6 bit values, returns false if an invalid character is found
+    __attribute__((target("ssse3")))
+    inline bool translate16(const __m128i input, __m128i& values)
+    {
+      const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(input, _mm_set1_epi8('Z' + 1)));
+      const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(input, _mm_set1_epi8('z' + 1)));
+      const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(input, _mm_set1_epi8('9' + 1)));
+      const __m128i plus = _mm_cmpeq_epi8(input, _mm_set1_epi8('+'));
+      const __m128i slash = _mm_cmpeq_epi8(input, _mm_set1_epi8('/'));
+
+      const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+      if (_mm_movemask_epi8(valid) != 0xFFFF)
+      {
+        return false;
+      }
+
+      __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-65));
+      shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+      shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(4)));
+      shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(19)));
+      shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(16)));
+      values = _mm_add_epi8(input, shift);
+      return true;
+    }
+
+    /// Decodes blocks of 16 characters, returns the number of characters consumed (writes 4 bytes past the decoded data)
+    __attribute__((target("ssse3")))
+    Size decodeBlocksSSSE3(const char* in, Size n_chars, Byte* out)
+    {
+      Size i = 0;
+      // keep enough decoded bytes behind the current block so the 16 byte store stays inside the output
+      for (; i + 24 <= n_chars; i += 16, out += 12)
+      {
+        __m128i values;
+        if (!translate16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), values))
+        {
+          break;
+        }
+        // merge 4 x 6 bits into 3 bytes per 32 bit lane and bring them into big endian order
+        const __m128i merged_ab_cd = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i merged = _mm_madd_epi16(merged_ab_cd, _mm_set1_epi32(0x00011000));
+        const __m128i packed = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+      }
+      return i;
+    }
+
+    /// Decodes blocks of 32 characters, returns the number of characters consumed (writes 8 bytes past the decoded data)
+    __attribute__((target("avx2")))
+    Size decodeBlocksAVX2(const char* in, Size n_chars, Byte* out)
+    {
+      Size i = 0;
+      for (; i + 48 <= n_chars; i += 32, out += 24)
+      {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(input, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), input));
+        const __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(input, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), input));
+        const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(input, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), input));
+        const __m256i plus = _mm256_cmpeq_epi8(input, _mm256_set1_epi8('+'));
+        const __m256i slash = _mm256_cmpeq_epi8(input, _mm256_set1_epi8('/'));
+
+        const __m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, plus)), slash);
+        if (_mm256_movemask_epi8(valid) != -1)
+        {
+          break;
+        }
+
+        __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(plus, _mm256_set1_epi8(19)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(16)));
+        const __m256i values = _mm256_add_epi8(input, shift);
+
+        const __m256i merged_ab_cd = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        const __m256i merged = _mm256_madd_epi16(merged_ab_cd, _mm256_set1_epi32(0x00011000));
+        const __m256i packed_lanes = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                                                  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        // move the 12 valid bytes of both 128 bit lanes next to each other
+        const __m256i packed = _mm256_permutevar8x32_epi32(packed_lanes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+      }
+      return i;
+    }
+
+    /// Encodes blocks of 12 bytes into 16 characters, returns the number of bytes consumed (reads 4 bytes past the encoded data)
+    __attribute__((target("ssse3")))
+    Size encodeBlocksSSSE3(const Byte* in, Size n_bytes, char* out)
+    {
+      Size i = 0;
+      for (; i + 16 <= n_bytes; i += 12, out += 16)
+      {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // spread 3 input bytes over each 32 bit lane and cut out the four 6 bit values
+        input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        const __m128i t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(t1, t3);
+
+        // translate 0..63 to the alphabet by adding a range dependent offset
+        __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        reduced = _mm_or_si128(reduced, _mm_and_si128(less, _mm_set1_epi8(13)));
+        const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '+' - 62, '/' - 63, 'A', 0, 0);
+        const __m128i result = _mm_add_epi8(_mm_shuffle_epi8(offsets, reduced), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), result);
+      }
+      return i;
+    }
+
+    __attribute__((target("ssse3")))
+    Size swapBytesSSSE3(Byte* data, Size count, Size element_size)
+    {
+      const __m128i mask = element_size == 4 ?
+        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+        _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+      const Size per_block = 16 / element_size;
+      Size i = 0;
+      for (; i + per_block <= count; i += per_block, data += 16)
+      {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_shuffle_epi8(v, mask));
+      }
+      return i;
+    }
+
+    __attribute__((target("avx2")))
+    Size swapBytesAVX2(Byte* data, Size count, Size element_size)
+    {
+      const __m256i mask = element_size == 4 ?
+        _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+        _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+      const Size per_block = 32 / element_size;
+      Size i = 0;
+      for (; i + per_block <= count; i += per_block, data += 32)
+      {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), _mm256_shuffle_epi8(v, mask));
+      }
+      return i;
+    }
+#endif
+  }
+
+  Size Base64::decodeRaw(const char* in, Size in_size, Byte* out)
+  {
+    if (in_size == 0)
+    {
+      return 0;
+    }
+    if (in_size % 4 != 0)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Malformed base64 input, length is not a multiple of 4.");
+    }
+
+    // the last group of 4 characters may contain one or two '=' padding characters
+    int padding = 0;
+    if (in[in_size - 1] == '=') padding++;
+    if (in[in_size - 2] == '=') padding++;
+    const Size full_chars = padding > 0 ? in_size - 4 : in_size;
+
+    Size done = 0;
+#ifdef OPENMS_BASE64_X86_SIMD
+    if (cpuHasAVX2())
+    {
+      done = decodeBlocksAVX2(in, full_chars, out);
+    }
+    if (cpuHasSSSE3())
+    {
+      done += decodeBlocksSSSE3(in + done, full_chars - done, out + done / 4 * 3);
+    }
+#endif
+    decodeBlocksScalar(in + done, full_chars - done, out + done / 4 * 3);
+    Size written = full_chars / 4 * 3;
+
+    if (padding > 0)
+    {
+      Byte last[3];
+      decodeBlocksScalar(in + full_chars, 4, last);
+      for (int i = 0; i < 3 - padding; ++i)
+      {
+        out[written++] = last[i];
+      }
+    }
+    return written;
+  }
+
+  Size Base64::encodeRaw(const Byte* in, Size in_size, char* out)
+  {
+    const Size full_bytes = in_size / 3 * 3;
+    Size done = 0;
+#ifdef OPENMS_BASE64_X86_SIMD
+    if (cpuHasSSSE3())
+    {
+      done = encodeBlocksSSSE3(in, full_bytes, out);
+    }
+#endif
+    encodeBlocksScalar(in + done, full_bytes - done, out + done / 3 * 4);
+    Size written = full_bytes / 3 * 4;
+
+    const Size rest = in_size - full_bytes;
+    if (rest > 0)
+    {
+      Byte last[3] = {0, 0, 0};
+      std::copy(in + full_bytes, in + in_size, last);
+      encodeBlocksScalar(last, 3, out + written);
+      out[written + 3] = '=';
+      if (rest == 1)
+      {
+        out[written + 2] = '=';
+      }
+      written += 4;
+    }
+    return written;
+  }
 
-  const char Base64::encoder_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-  const char Base64::decoder_[] = "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+  void Base64::swapByteOrder_(void* data, Size count, Size element_size)
+  {
+    Size done = 0;
+#ifdef OPENMS_BASE64_X86_SIMD
+    if (element_size != 4 && element_size != 8)
+    {
+      // not supported by the SIMD kernels
+    }
+    else if (cpuHasAVX2())
+    {
+      done = swapBytesAVX2(static_cast<Byte*>(data), count, element_size);
+    }
+    else if (cpuHasSSSE3())
+    {
+      done = swapBytesSSSE3(static_cast<Byte*>(data), count, element_size);
+    }
+#endif
+    swapBytesScalar(static_cast<Byte*>(data) + done * element_size, count - done, element_size);
+  }
 
   void Base64::encodeStrings(const std::vector<String>& in, String& out, bool zlib_compression, bool append_null_byte)
   {
@@ -183,48 +479,7 @@ print s
       it = reinterpret_cast<Byte*>(&str[0]);
       end = it + str.size();
     }
-    Byte* to = reinterpret_cast<Byte*>(&out[0]);
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-      {
-        to[3] = '=';
-      }
-      if (padding_count > 1)
-      {
-        to[2] = '=';
-      }
-      to += 4;
-      written += 4;
-    }
-
-    out.resize(written); //no more space is needed
+    out.resize(encodeRaw(it, end - it, &out[0])); //no more space is needed
   }
 
   void Base64::decodeStrings(const String& in, std::vector<String>& out, bool zlib_compression)
@@ -72,14 +72,19 @@ namespace OpenMS
 
   void CachedmzML::load_(const String& filename)
   {
-    filename_cached_ = filename + ".cached";
-    filename_ = filename;
-
     // Create the index from the given file
     Internal::CachedMzMLHandler cache;
-    cache.createMemdumpIndex(filename_cached_);
+    cache.createMemdumpIndex(filename + ".cached");
     spectra_index_ = cache.getSpectraIndex();
-    chrom_index_ = cache.getChromatogramIndex();;
+    chrom_index_ = cache.getChromatogramIndex();
+
+    loadMetaData_(filename);
+  }
+
+  void CachedmzML::loadMetaData_(const String& filename)
+  {
+    filename_cached_ = filename + ".cached";
+    filename_ = filename;
 
     // open the filestream
     ifs_.open(filename_cached_.c_str(), std::ios::binary);
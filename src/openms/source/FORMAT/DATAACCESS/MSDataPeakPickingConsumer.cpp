@@ -0,0 +1,162 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataPeakPickingConsumer.h>
+
+#include <OpenMS/CONCEPT/LogStream.h>
+
+#include <algorithm>
+#include <exception>
+
+namespace OpenMS
+{
+
+  MSDataPeakPickingConsumer::MSDataPeakPickingConsumer(Interfaces::IMSDataConsumer* next_consumer, const PeakPickerHiRes& pp,
+                                                       Size batch_size, bool check_spectrum_type) :
+    next_consumer_(next_consumer),
+    pp_(pp),
+    batch_size_(std::max(batch_size, Size(1))),
+    check_spectrum_type_(check_spectrum_type)
+  {
+  }
+
+  MSDataPeakPickingConsumer::~MSDataPeakPickingConsumer()
+  {
+    // flush remaining data (exceptions must not leave the destructor)
+    try
+    {
+      flush();
+    }
+    catch (const std::exception& e)
+    {
+      OPENMS_LOG_ERROR << "Error while picking the remaining data: " << e.what() << std::endl;
+    }
+  }
+
+  void MSDataPeakPickingConsumer::setExpectedSize(Size expected_spectra, Size expected_chromatograms)
+  {
+    next_consumer_->setExpectedSize(expected_spectra, expected_chromatograms);
+  }
+
+  void MSDataPeakPickingConsumer::setExperimentalSettings(const ExperimentalSettings& exp)
+  {
+    next_consumer_->setExperimentalSettings(exp);
+  }
+
+  void MSDataPeakPickingConsumer::consumeSpectrum(SpectrumType& s)
+  {
+    // keep the order in which spectra and chromatograms are passed on
+    flushChromatograms_();
+    spectra_.push_back(std::move(s));
+    if (spectra_.size() >= batch_size_)
+    {
+      flushSpectra_();
+    }
+  }
+
+  void MSDataPeakPickingConsumer::consumeChromatogram(ChromatogramType& c)
+  {
+    // keep the order in which spectra and chromatograms are passed on
+    flushSpectra_();
+    chromatograms_.push_back(std::move(c));
+    if (chromatograms_.size() >= batch_size_)
+    {
+      flushChromatograms_();
+    }
+  }
+
+  void MSDataPeakPickingConsumer::flush()
+  {
+    flushSpectra_();
+    flushChromatograms_();
+  }
+
+  void MSDataPeakPickingConsumer::flushSpectra_()
+  {
+    if (spectra_.empty()) return;
+
+    std::vector<SpectrumType> picked(spectra_.size());
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)spectra_.size(); ++i)
+    {
+      try
+      {
+        std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+        pp_.pickOrCopy(spectra_[i], picked[i], boundaries, check_spectrum_type_);
+      }
+      catch (...)
+      {
+#pragma omp critical (MSDataPeakPickingConsumer_flush)
+        if (!error) error = std::current_exception();
+      }
+    }
+    spectra_.clear();
+    if (error) std::rethrow_exception(error);
+
+    for (SpectrumType& s : picked)
+    {
+      next_consumer_->consumeSpectrum(s);
+    }
+  }
+
+  void MSDataPeakPickingConsumer::flushChromatograms_()
+  {
+    if (chromatograms_.empty()) return;
+
+    std::vector<ChromatogramType> picked(chromatograms_.size());
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)chromatograms_.size(); ++i)
+    {
+      try
+      {
+        pp_.pick(chromatograms_[i], picked[i]);
+      }
+      catch (...)
+      {
+#pragma omp critical (MSDataPeakPickingConsumer_flush)
+        if (!error) error = std::current_exception();
+      }
+    }
+    chromatograms_.clear();
+    if (error) std::rethrow_exception(error);
+
+    for (ChromatogramType& c : picked)
+    {
+      next_consumer_->consumeChromatogram(c);
+    }
+  }
+
+} // namespace OpenMS
@@ -59,13 +59,48 @@ namespace OpenMS::Internal
     return *this;
   }
 
+  void CachedMzMLHandler::checkHeader(int identifier, int version, const String& filename)
+  {
+    if (identifier == 8094)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File was written with an older, unsupported version of the cached mzML format. Please re-create the cached file. Aborting!", filename);
+    }
+    if (identifier != CACHED_MZML_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
+    }
+    if (version != CACHED_MZML_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Unsupported cached mzML format version " + String(version) + " (expected " + String(CACHED_MZML_FILE_VERSION) + "). Aborting!", filename);
+    }
+  }
+
+  void CachedMzMLHandler::writeHeader_(std::ofstream& ofs)
+  {
+    IntType file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+    IntType file_version = CACHED_MZML_FILE_VERSION;
+    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    ofs.write((char*)&file_version, sizeof(file_version));
+  }
+
+  void CachedMzMLHandler::readHeader_(std::ifstream& ifs, const String& filename)
+  {
+    IntType file_identifier = 0;
+    IntType file_version = 0;
+    ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    ifs.read((char*)&file_version, sizeof(file_version));
+    checkHeader(file_identifier, file_version, filename);
+  }
+
   void CachedMzMLHandler::writeMemdump(const MapType& exp, const String& out) const
   {
     std::ofstream ofs(out.c_str(), std::ios::binary);
     Size exp_size = exp.size();
     Size chrom_size = exp.getChromatograms().size();
-    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
-    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    writeHeader_(ofs);
 
     startProgress(0, exp.size() + exp.getChromatograms().size(), "storing binary data");
     for (Size i = 0; i < exp.size(); i++)
@@ -95,22 +130,15 @@ namespace OpenMS::Internal
     }
 
     Size exp_size, chrom_size;
-    Peak1D current_peak;
 
-    int file_identifier;
-    ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
-    {
-      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-        "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
-    }
+    readHeader_(ifs, filename);
 
     ifs.seekg(0, ifs.end); // set file pointer to end
     ifs.seekg(ifs.tellg(), ifs.beg); // set file pointer to end, in forward direction
     ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
     ifs.read((char*)&exp_size, sizeof(exp_size));
     ifs.read((char*)&chrom_size, sizeof(chrom_size));
-    ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
+    ifs.seekg(HEADER_SIZE, ifs.beg); // set file pointer to beginning (after header), start reading
 
     exp_reading.reserve(exp_size);
     startProgress(0, exp_size + chrom_size, "reading binary data");
@@ -154,21 +182,14 @@ namespace OpenMS::Internal
     }
 
     Size exp_size, chrom_size;
-    Peak1D current_peak;
 
     ifs.seekg(0, ifs.beg); // set file pointer to beginning, start reading
     spectra_index_.clear();
     chrom_index_.clear();
-    int file_identifier;
-    int extra_offset = sizeof(DoubleType) + sizeof(IntType);
+    int extra_offset = sizeof(DoubleType) + 2 * sizeof(IntType); // RT, MS level and padding
     int chrom_offset = 0;
 
-    ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
-    {
-      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-          "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
-    }
+    readHeader_(ifs, filename);
 
     // For spectra and chromatograms go through file, read the size of the
     // spectrum/chromatogram and record the starting index of the element, then
@@ -179,7 +200,7 @@ namespace OpenMS::Internal
     ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
     ifs.read((char*)&exp_size, sizeof(exp_size));
     ifs.read((char*)&chrom_size, sizeof(chrom_size));
-    ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
+    ifs.seekg(HEADER_SIZE, ifs.beg); // set file pointer to beginning (after header), start reading
 
     startProgress(0, exp_size + chrom_size, "Creating index for binary spectra");
     for (Size i = 0; i < exp_size; i++)
@@ -199,7 +220,7 @@ namespace OpenMS::Internal
         Size len, len_name;
         ifs.read((char*)&len, sizeof(len));
         ifs.read((char*)&len_name, sizeof(len_name));
-        ifs.seekg(len_name * sizeof(char), ifs.cur);
+        ifs.seekg(paddedSize(len_name), ifs.cur);
         ifs.seekg(sizeof(DatumSingleton) * len, ifs.cur);
       }
     }
@@ -221,7 +242,7 @@ namespace OpenMS::Internal
         Size len, len_name;
         ifs.read((char*)&len, sizeof(len));
         ifs.read((char*)&len_name, sizeof(len_name));
-        ifs.seekg(len_name * sizeof(char), ifs.cur);
+        ifs.seekg(paddedSize(len_name), ifs.cur);
         ifs.seekg(sizeof(DatumSingleton) * len, ifs.cur);
       }
     }
@@ -322,7 +343,9 @@ namespace OpenMS::Internal
     Size nr_float_arrays = -1;
     ifs.read((char*) &spec_size, sizeof(spec_size));
     ifs.read((char*) &nr_float_arrays, sizeof(nr_float_arrays));
+    IntType padding;
     ifs.read((char*) &ms_level, sizeof(ms_level));
+    ifs.read((char*) &padding, sizeof(padding));
     ifs.read((char*) &rt, sizeof(rt));
 
     if (static_cast<int>(spec_size) < 0)
@@ -367,15 +390,20 @@ namespace OpenMS::Internal
       if (len_name > 1023)
       {
         ifs.seekg(len_name * sizeof(char), ifs.cur);
+        buffer[0] = '\0';
       }
       else
       {
         ifs.read(buffer, len_name);
         buffer[len_name] = '\0';
       }
+      ifs.seekg(paddedSize(len_name) - len_name, ifs.cur); // skip the alignment padding
       data.back()->data.resize(len);
       data.back()->description = buffer;
-      ifs.read((char*)&(data.back()->data)[0], len * sizeof(DatumSingleton));
+      if (len > 0)
+      {
+        ifs.read((char*)&(data.back()->data)[0], len * sizeof(DatumSingleton));
+      }
     }
     delete[] buffer;
     return;
@@ -453,6 +481,25 @@ namespace OpenMS::Internal
     chromatogram.setFloatDataArrays(fdas);
   }
 
+  template <typename DataArrayType>
+  void CachedMzMLHandler::writeDataArray_(const DataArrayType& array, std::ofstream& ofs)
+  {
+    Size len = array.size();
+    ofs.write((char*)&len, sizeof(len));
+    Size len_name = array.getName().size();
+    ofs.write((char*)&len_name, sizeof(len_name));
+    ofs.write(array.getName().c_str(), len_name * sizeof(char));
+    // pad the name with zeros to keep the data aligned
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    ofs.write(padding, paddedSize(len_name) - len_name);
+    // now go to the actual data
+    Datavector tmp(array.begin(), array.end());
+    if (!tmp.empty())
+    {
+      ofs.write((char*)&tmp.front(), tmp.size() * sizeof(tmp.front()));
+    }
+  }
+
   void CachedMzMLHandler::writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs) const
   {
     Size exp_size = spectrum.size();
@@ -461,16 +508,11 @@ namespace OpenMS::Internal
     ofs.write((char*)&arr_s, sizeof(arr_s));
     IntType int_field_ = spectrum.getMSLevel();
     ofs.write((char*)&int_field_, sizeof(int_field_));
+    IntType padding_ = 0;
+    ofs.write((char*)&padding_, sizeof(padding_));
     DoubleType dbl_field_ = spectrum.getRT();
     ofs.write((char*)&dbl_field_, sizeof(dbl_field_));
 
-    // Catch empty spectrum: we do not write any data and since the "size" we
-    // just wrote is zero, no data will be read
-    if (spectrum.empty())
-    {
-      return;
-    }
-
     Datavector mz_data;
     Datavector int_data;
     mz_data.reserve(spectrum.size());
@@ -481,35 +523,21 @@ namespace OpenMS::Internal
       int_data.push_back(static_cast<double>(spectrum[j].getIntensity()));
     }
 
-    ofs.write((char*)&mz_data.front(), mz_data.size() * sizeof(mz_data.front()));
-    ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
+    // Catch empty spectrum: we do not write any data and since the "size" we
+    // just wrote is zero, no data will be read (additional arrays follow nevertheless)
+    if (!spectrum.empty())
+    {
+      ofs.write((char*)&mz_data.front(), mz_data.size() * sizeof(mz_data.front()));
+      ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
+    }
 
-    Datavector tmp;
-    for (const auto& fda : spectrum.getFloatDataArrays() )
+    for (const auto& fda : spectrum.getFloatDataArrays())
     {
-      Size len = fda.size();
-      ofs.write((char*)&len, sizeof(len));
-      Size len_name = fda.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&fda.getName().front(), len_name * sizeof(fda.getName().front()));
-      // now go to the actual data
-      tmp.clear();
-      tmp.reserve(fda.size());
-      for (const auto& val : fda) {tmp.push_back(val);}
-      ofs.write((char*)&tmp.front(), tmp.size() * sizeof(tmp.front()));
+      writeDataArray_(fda, ofs);
     }
-    for (const auto& ida : spectrum.getIntegerDataArrays() )
-    {
-      Size len = ida.size();
-      ofs.write((char*)&len, sizeof(len));
-      Size len_name = ida.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&ida.getName().front(), len_name * sizeof(ida.getName().front()));
-      // now go to the actual data
-      tmp.clear();
-      tmp.reserve(ida.size());
-      for (const auto& val : ida) {tmp.push_back(val);}
-      ofs.write((char*)&tmp.front(), tmp.size() * sizeof(tmp.front()));
+    for (const auto& ida : spectrum.getIntegerDataArrays())
+    {
+      writeDataArray_(ida, ofs);
     }
   }
 
@@ -520,13 +548,6 @@ namespace OpenMS::Internal
     Size arr_s = chromatogram.getFloatDataArrays().size() + chromatogram.getIntegerDataArrays().size();
     ofs.write((char*)&arr_s, sizeof(arr_s));
 
-    // Catch empty chromatogram: we do not write any data and since the "size" we
-    // just wrote is zero, no data will be read
-    if (chromatogram.empty())
-    {
-      return;
-    }
-
     Datavector rt_data;
     Datavector int_data;
     rt_data.reserve(chromatogram.size());
@@ -536,41 +557,21 @@ namespace OpenMS::Internal
       rt_data.push_back(chromatogram[j].getRT());
       int_data.push_back(chromatogram[j].getIntensity());
     }
-    ofs.write((char*)&rt_data.front(), rt_data.size() * sizeof(rt_data.front()));
-    ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
-
-    Datavector tmp;
-    for (const auto& fda : chromatogram.getFloatDataArrays() )
-    {
-      Size len = fda.size();
-      ofs.write((char*)&len, sizeof(len));
-      Size len_name = fda.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&fda.getName().front(), len_name * sizeof(fda.getName().front()));
-      // now go to the actual data
-      tmp.clear();
-      tmp.reserve(fda.size());
-      for (const auto& val : fda)
-      {
-        tmp.push_back(val);
-      }
-      ofs.write((char*)&tmp.front(), tmp.size() * sizeof(tmp.front()));
+    // Catch empty chromatogram: we do not write any data and since the "size" we
+    // just wrote is zero, no data will be read (additional arrays follow nevertheless)
+    if (!chromatogram.empty())
+    {
+      ofs.write((char*)&rt_data.front(), rt_data.size() * sizeof(rt_data.front()));
+      ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
     }
-    for (const auto& ida : chromatogram.getIntegerDataArrays() )
-    {
-      Size len = ida.size();
-      ofs.write((char*)&len, sizeof(len));
-      Size len_name = ida.getName().size();
-      ofs.write((char*)&len_name, sizeof(len_name));
-      ofs.write((char*)&ida.getName().front(), len_name * sizeof(ida.getName().front()));
-      // now go to the actual data
-      tmp.clear();
-      tmp.reserve(ida.size());
-      for (const auto& val : ida)
-      {
-        tmp.push_back(val);
-      }
-      ofs.write((char*)&tmp.front(), tmp.size() * sizeof(tmp.front()));
+
+    for (const auto& fda : chromatogram.getFloatDataArrays())
+    {
+      writeDataArray_(fda, ofs);
+    }
+    for (const auto& ida : chromatogram.getIntegerDataArrays())
+    {
+      writeDataArray_(ida, ofs);
     }
   }
 
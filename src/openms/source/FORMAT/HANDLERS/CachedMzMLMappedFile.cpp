@@ -0,0 +1,234 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLMappedFile.h>
+
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstring>
+
+namespace OpenMS::Internal
+{
+
+  CachedMzMLMappedFile::CachedMzMLMappedFile(const String& filename) :
+    filename_(filename)
+  {
+    try
+    {
+      file_.reset(new boost::iostreams::mapped_file_source(filename));
+    }
+    catch (std::exception&)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    data_ = file_->data();
+    size_ = file_->size();
+
+    if (size_ < CachedMzMLHandler::HEADER_SIZE + 2 * sizeof(Size))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "File is too small to be a cached mzML file. Aborting!", filename_);
+    }
+    int identifier, version;
+    std::memcpy(&identifier, data_, sizeof(identifier));
+    std::memcpy(&version, data_ + sizeof(identifier), sizeof(version));
+    CachedMzMLHandler::checkHeader(identifier, version, filename_);
+
+    // the number of spectra and chromatograms is stored at the end of the file
+    Size exp_size, chrom_size;
+    std::memcpy(&exp_size, data_ + size_ - 2 * sizeof(Size), sizeof(Size));
+    std::memcpy(&chrom_size, data_ + size_ - sizeof(Size), sizeof(Size));
+    size_ -= 2 * sizeof(Size); // data items must not extend into the trailer
+
+    // walk through the file once, record the offset of each item and skip its data
+    Size offset = CachedMzMLHandler::HEADER_SIZE;
+    spectra_index_.reserve(exp_size);
+    for (Size i = 0; i < exp_size; ++i)
+    {
+      spectra_index_.push_back(offset);
+      Size spec_size = readSize_(offset);
+      Size nr_arrays = readSize_(offset);
+      offset += sizeof(int) + sizeof(int) + sizeof(double); // MS level, padding, RT
+      offset += 2 * spec_size * sizeof(double);
+      skipDataArrays_(offset, nr_arrays);
+    }
+    chrom_index_.reserve(chrom_size);
+    for (Size i = 0; i < chrom_size; ++i)
+    {
+      chrom_index_.push_back(offset);
+      Size chrom_points = readSize_(offset);
+      Size nr_arrays = readSize_(offset);
+      offset += 2 * chrom_points * sizeof(double);
+      skipDataArrays_(offset, nr_arrays);
+    }
+    if (offset > size_)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached mzML file is truncated. Aborting!", filename_);
+    }
+  }
+
+  CachedMzMLMappedFile::~CachedMzMLMappedFile()
+  {
+  }
+
+  Size CachedMzMLMappedFile::readSize_(Size& offset) const
+  {
+    if (offset + sizeof(Size) > size_)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cached mzML file is truncated. Aborting!", filename_);
+    }
+    Size value;
+    std::memcpy(&value, data_ + offset, sizeof(Size));
+    offset += sizeof(Size);
+    return value;
+  }
+
+  void CachedMzMLMappedFile::skipDataArrays_(Size& offset, Size nr_arrays) const
+  {
+    for (Size k = 0; k < nr_arrays; ++k)
+    {
+      Size len = readSize_(offset);
+      Size len_name = readSize_(offset);
+      offset += CachedMzMLHandler::paddedSize(len_name) + len * sizeof(double);
+    }
+  }
+
+  void CachedMzMLMappedFile::copyDataArrays_(Size offset, Size nr_arrays, std::vector<OpenSwath::BinaryDataArrayPtr>& data) const
+  {
+    for (Size k = 0; k < nr_arrays; ++k)
+    {
+      Size len = readSize_(offset);
+      Size len_name = readSize_(offset);
+      OpenSwath::BinaryDataArrayPtr array(new OpenSwath::BinaryDataArray);
+      array->description.assign(data_ + offset, len_name);
+      offset += CachedMzMLHandler::paddedSize(len_name);
+      const double* values = reinterpret_cast<const double*>(data_ + offset);
+      array->data.assign(values, values + len);
+      offset += len * sizeof(double);
+      data.push_back(array);
+    }
+  }
+
+  Size CachedMzMLMappedFile::getNrSpectra() const
+  {
+    return spectra_index_.size();
+  }
+
+  Size CachedMzMLMappedFile::getNrChromatograms() const
+  {
+    return chrom_index_.size();
+  }
+
+  const std::vector<Size>& CachedMzMLMappedFile::getSpectraIndex() const
+  {
+    return spectra_index_;
+  }
+
+  const std::vector<Size>& CachedMzMLMappedFile::getChromatogramIndex() const
+  {
+    return chrom_index_;
+  }
+
+  CachedMzMLMappedFile::DataView CachedMzMLMappedFile::getSpectrumView(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    Size offset = spectra_index_[id];
+    DataView view;
+    view.size = readSize_(offset);
+    readSize_(offset); // number of additional arrays
+    std::memcpy(&view.ms_level, data_ + offset, sizeof(int));
+    offset += 2 * sizeof(int); // MS level and padding
+    std::memcpy(&view.rt, data_ + offset, sizeof(double));
+    offset += sizeof(double);
+    view.position = reinterpret_cast<const double*>(data_ + offset);
+    view.intensity = view.position + view.size;
+    return view;
+  }
+
+  CachedMzMLMappedFile::DataView CachedMzMLMappedFile::getChromatogramView(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    Size offset = chrom_index_[id];
+    DataView view;
+    view.size = readSize_(offset);
+    readSize_(offset); // number of additional arrays
+    view.position = reinterpret_cast<const double*>(data_ + offset);
+    view.intensity = view.position + view.size;
+    return view;
+  }
+
+  std::vector<OpenSwath::BinaryDataArrayPtr> CachedMzMLMappedFile::getSpectrumData(Size id, int& ms_level, double& rt) const
+  {
+    DataView view = getSpectrumView(id);
+    ms_level = view.ms_level;
+    rt = view.rt;
+
+    std::vector<OpenSwath::BinaryDataArrayPtr> data;
+    data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
+    data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
+    data[0]->data.assign(view.position, view.position + view.size);
+    data[1]->data.assign(view.intensity, view.intensity + view.size);
+
+    Size offset = spectra_index_[id] + sizeof(Size);
+    Size nr_arrays = readSize_(offset);
+    copyDataArrays_(reinterpret_cast<const char*>(view.intensity + view.size) - data_, nr_arrays, data);
+    return data;
+  }
+
+  std::vector<OpenSwath::BinaryDataArrayPtr> CachedMzMLMappedFile::getChromatogramData(Size id) const
+  {
+    DataView view = getChromatogramView(id);
+
+    std::vector<OpenSwath::BinaryDataArrayPtr> data;
+    data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
+    data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
+    data[0]->data.assign(view.position, view.position + view.size);
+    data[1]->data.assign(view.intensity, view.intensity + view.size);
+
+    Size offset = chrom_index_[id] + sizeof(Size);
+    Size nr_arrays = readSize_(offset);
+    copyDataArrays_(reinterpret_cast<const char*>(view.intensity + view.size) - data_, nr_arrays, data);
+    return data;
+  }
+
+}
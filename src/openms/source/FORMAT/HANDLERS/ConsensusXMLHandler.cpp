@@ -799,25 +799,24 @@ namespace OpenMS::Internal
 
     // write all consensus elements
     os << "\t<consensusElementList>\n";
-    for (Size i = 0; i < consensus_map.size(); ++i)
+    writeElementsInParallel_(os, consensus_map.size(), [&](std::ostream& elem_os, Size i)
     {
-      setProgress(++progress_);
       // write a consensusElement
       const ConsensusFeature& elem = consensus_map[i];
-      os << "\t\t<consensusElement id=\"e_" << elem.getUniqueId() << "\" quality=\"" << precisionWrapper(elem.getQuality()) << "\"";
+      elem_os << "\t\t<consensusElement id=\"e_" << elem.getUniqueId() << "\" quality=\"" << precisionWrapper(elem.getQuality()) << "\"";
       if (elem.getCharge() != 0)
       {
-        os << " charge=\"" << elem.getCharge() << "\"";
+        elem_os << " charge=\"" << elem.getCharge() << "\"";
       }
-      os << ">\n";
+      elem_os << ">\n";
       // write centroid
-      os << "\t\t\t<centroid rt=\"" << precisionWrapper(elem.getRT()) << "\" mz=\"" << precisionWrapper(elem.getMZ()) << "\" it=\"" << precisionWrapper(
+      elem_os << "\t\t\t<centroid rt=\"" << precisionWrapper(elem.getRT()) << "\" mz=\"" << precisionWrapper(elem.getMZ()) << "\" it=\"" << precisionWrapper(
         elem.getIntensity()) << "\"/>\n";
       // write groupedElementList
-      os << "\t\t\t<groupedElementList>\n";
+      elem_os << "\t\t\t<groupedElementList>\n";
       for (ConsensusFeature::HandleSetType::const_iterator it = elem.begin(); it != elem.end(); ++it)
       {
-        os << "\t\t\t\t<element"
+        elem_os << "\t\t\t\t<element"
               " map=\"" << it->getMapIndex() << "\""
                                                 " id=\"" << it->getUniqueId() << "\""
                                                                                  " rt=\"" << precisionWrapper(it->getRT()) << "\""
@@ -825,21 +824,23 @@ namespace OpenMS::Internal
                                                                                                                                                                            " it=\"" << precisionWrapper(it->getIntensity()) << "\"";
         if (it->getCharge() != 0)
         {
-          os << " charge=\"" << it->getCharge() << "\"";
+          elem_os << " charge=\"" << it->getCharge() << "\"";
         }
-        os << "/>\n";
+        elem_os << "/>\n";
       }
-      os << "\t\t\t</groupedElementList>\n";
+      elem_os << "\t\t\t</groupedElementList>\n";
 
       // write PeptideIdentification
       for (UInt j = 0; j < elem.getPeptideIdentifications().size(); ++j)
       {
-        writePeptideIdentification_(file_, os, elem.getPeptideIdentifications()[j], "PeptideIdentification", 3);
+        writePeptideIdentification_(file_, elem_os, elem.getPeptideIdentifications()[j], "PeptideIdentification", 3);
       }
 
-      writeUserParam_("UserParam", os, elem, 3);
-      os << "\t\t</consensusElement>\n";
-    }
+      writeUserParam_("UserParam", elem_os, elem, 3);
+      elem_os << "\t\t</consensusElement>\n";
+    },
+    [&](Size written) { setProgress(progress_ + written); });
+    progress_ += consensus_map.size();
     os << "\t</consensusElementList>\n";
 
     os << "</consensusXML>\n";
@@ -855,14 +856,16 @@ namespace OpenMS::Internal
   {
     String indent = String(indentation_level, '\t');
 
-    if (identifier_id_.find(id.getIdentifier()) == identifier_id_.end())
+    // only look up (never insert into) the maps here - consensus elements are written in parallel
+    const auto run_id = identifier_id_.find(id.getIdentifier());
+    if (run_id == identifier_id_.end())
     {
       warning(STORE, String("Omitting peptide identification because of missing ProteinIdentification with identifier '") + id.getIdentifier()
               + "' while writing '" + filename + "'!");
       return;
     }
     os << indent << "<" << tag_name << " ";
-    os << "identification_run_ref=\"" << identifier_id_[id.getIdentifier()] << "\" ";
+    os << "identification_run_ref=\"" << run_id->second << "\" ";
     os << "score_type=\"" << writeXMLEscape(id.getScoreType()) << "\" ";
     os << "higher_score_better=\"" << (id.isHigherScoreBetter() ? "true" : "false") << "\" ";
     os << "significance_threshold=\"" << id.getSignificanceThreshold() << "\" ";
@@ -909,8 +912,9 @@ namespace OpenMS::Internal
         // empty accessions are not written out (legacy code)
         if (!protein_accession.empty())
         {
+          const auto acc = accession_to_id_.find(id.getIdentifier() + "_" + protein_accession);
           accs += "PH_";
-          accs += String(accession_to_id_[id.getIdentifier() + "_" + protein_accession]);
+          accs += String(acc != accession_to_id_.end() ? acc->second : 0);
         }
       }
 
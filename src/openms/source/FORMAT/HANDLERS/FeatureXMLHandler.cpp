@@ -233,12 +233,12 @@ namespace OpenMS::Internal
     // write features with their corresponding attributes
     os << "\t<featureList count=\"" << feature_map.size() << "\">\n";
     startProgress(0, feature_map.size(), "Storing featureXML file");
-    for (Size s = 0; s < feature_map.size(); s++)
-    {
-      writeFeature_(file_, os, feature_map[s], "f_", feature_map[s].getUniqueId(), 0);
-      setProgress(s);
-      // writeFeature_(file_, os, feature_map[s], "f_", s, 0);
-    }
+    writeElementsInParallel_(os, feature_map.size(),
+      [&](std::ostream& feature_os, Size s)
+      {
+        writeFeature_(file_, feature_os, feature_map[s], "f_", feature_map[s].getUniqueId(), 0);
+      },
+      [&](Size written) { setProgress(written); });
     endProgress();
 
     os << "\t</featureList>\n";
@@ -979,13 +979,15 @@ namespace OpenMS::Internal
   {
     String indent = String(indentation_level, '\t');
 
-    if (identifier_id_.find(id.getIdentifier()) == identifier_id_.end())
+    // only look up (never insert into) the maps here - features are written in parallel
+    const auto run_id = identifier_id_.find(id.getIdentifier());
+    if (run_id == identifier_id_.end())
     {
       warning(STORE, String("Omitting peptide identification because of missing ProteinIdentification with identifier '") + id.getIdentifier() + "' while writing '" + filename + "'!");
       return;
     }
     os << indent << "<" << tag_name << " ";
-    os << "identification_run_ref=\"" << identifier_id_[id.getIdentifier()] << "\" ";
+    os << "identification_run_ref=\"" << run_id->second << "\" ";
     os << "score_type=\"" << writeXMLEscape(id.getScoreType()) << "\" ";
     os << "higher_score_better=\"" << (id.isHigherScoreBetter() ? "true" : "false") << "\" ";
     os << "significance_threshold=\"" << id.getSignificanceThreshold() << "\" ";
@@ -1033,8 +1035,9 @@ namespace OpenMS::Internal
         // empty accessions are not written out (legacy code)
         if (!protein_accession.empty())
         {
+          const auto acc = accession_to_id_.find(id.getIdentifier() + "_" + protein_accession);
           accs += "PH_";
-          accs += String(accession_to_id_[id.getIdentifier() + "_" + protein_accession]);
+          accs += String(acc != accession_to_id_.end() ? acc->second : 0);
         }
       }
 
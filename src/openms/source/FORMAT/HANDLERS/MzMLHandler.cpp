@@ -44,11 +44,36 @@
 #include <OpenMS/INTERFACES/IMSDataConsumer.h>
 #include <OpenMS/SYSTEM/File.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <map>
+#include <mutex>
+#include <thread>
 
 namespace OpenMS::Internal
 {
 
+    /**
+      @brief State of the background spectrum decoding pipeline
+
+      The parser thread queues full data pools (in file order); a single
+      worker thread decodes each pool (itself using all OpenMP threads) and
+      hands the spectra to the consumer in the same order. The encoded size
+      of all queued pools is bounded by PeakFileOptions::getMaxInFlightBytes().
+    */
+    struct MzMLHandler::SpectraPipeline_
+    {
+      std::thread worker;
+      std::mutex mutex;
+      std::condition_variable cond;
+      std::deque<std::pair<Size, std::vector<SpectrumData> > > queue; ///< pending pools and their encoded size
+      Size bytes_in_flight = 0; ///< encoded size of all queued and currently processed pools
+      bool stop = false;
+      std::exception_ptr error;
+    };
+
     /// Constructor for a read-only handler
     MzMLHandler::MzMLHandler(MapType& exp, const String& filename, const String& version, const ProgressLogger& logger)
       : MzMLHandler(filename, version, logger)
@@ -82,6 +107,17 @@ namespace OpenMS::Internal
     /// Destructor
     MzMLHandler::~MzMLHandler()
     {
+      if (spectra_pipeline_ != nullptr && spectra_pipeline_->worker.joinable())
+      {
+        // parsing was aborted: drop pending data and shut down the worker
+        {
+          std::lock_guard<std::mutex> lock(spectra_pipeline_->mutex);
+          spectra_pipeline_->stop = true;
+          spectra_pipeline_->queue.clear();
+        }
+        spectra_pipeline_->cond.notify_all();
+        spectra_pipeline_->worker.join();
+      }
     }
     /// Set the peak file options
     void MzMLHandler::setOptions(const PeakFileOptions& opt)
@@ -135,7 +171,21 @@ namespace OpenMS::Internal
 
     void MzMLHandler::populateSpectraWithData_()
     {
+      if (consumer_ != nullptr && options_.getMaxInFlightBytes() > 0 && !options_.getAlwaysAppendData())
+      {
+        submitSpectraToPipeline_();
+        return;
+      }
+
+      decodeSpectra_(spectrum_data_);
+      deliverSpectra_(spectrum_data_);
+
+      // Delete batch
+      spectrum_data_.clear();
+    }
 
+    void MzMLHandler::decodeSpectra_(std::vector<SpectrumData>& spectra)
+    {
       // Whether spectrum should be populated with data
       if (options_.getFillData())
       {
@@ -144,20 +194,20 @@ namespace OpenMS::Internal
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-        for (SignedSize i = 0; i < (SignedSize)spectrum_data_.size(); i++)
+        for (SignedSize i = 0; i < (SignedSize)spectra.size(); i++)
         {
           // parallel exception catching and re-throwing business
           if (!errCount) // no need to parse further if already an error was encountered
           {
             try
             {
-              populateSpectraWithData_(spectrum_data_[i].data,
-                                       spectrum_data_[i].default_array_length,
+              populateSpectraWithData_(spectra[i].data,
+                                       spectra[i].default_array_length,
                                        options_,
-                                       spectrum_data_[i].spectrum);
-              if (options_.getSortSpectraByMZ() && !spectrum_data_[i].spectrum.isSorted())
+                                       spectra[i].spectrum);
+              if (options_.getSortSpectraByMZ() && !spectra[i].spectrum.isSorted())
               {
-                spectrum_data_[i].spectrum.sortByPosition();
+                spectra[i].spectrum.sortByPosition();
               }
             }
 
@@ -183,30 +233,148 @@ namespace OpenMS::Internal
           throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, "Error during parsing of binary data: '" + error_message + "'");
         }
       }
+    }
 
+    void MzMLHandler::deliverSpectra_(std::vector<SpectrumData>& spectra)
+    {
       // Append all spectra to experiment / consumer
-      for (Size i = 0; i < spectrum_data_.size(); i++)
+      for (Size i = 0; i < spectra.size(); i++)
       {
         if (consumer_ != nullptr)
         {
-          consumer_->consumeSpectrum(spectrum_data_[i].spectrum);
+          consumer_->consumeSpectrum(spectra[i].spectrum);
           if (options_.getAlwaysAppendData())
           {
-            exp_->addSpectrum(std::move(spectrum_data_[i].spectrum));
+            exp_->addSpectrum(std::move(spectra[i].spectrum));
           }
         }
         else
         {
-          exp_->addSpectrum(std::move(spectrum_data_[i].spectrum));
+          exp_->addSpectrum(std::move(spectra[i].spectrum));
         }
       }
+    }
+
+    void MzMLHandler::submitSpectraToPipeline_()
+    {
+      if (spectrum_data_.empty())
+      {
+        return;
+      }
+
+      if (spectra_pipeline_ == nullptr)
+      {
+        spectra_pipeline_.reset(new SpectraPipeline_());
+      }
+      SpectraPipeline_& pipe = *spectra_pipeline_;
+
+      if (!pipe.worker.joinable())
+      {
+        pipe.stop = false;
+        pipe.worker = std::thread([this, &pipe]()
+        {
+          std::unique_lock<std::mutex> lock(pipe.mutex);
+          while (true)
+          {
+            pipe.cond.wait(lock, [&pipe]() { return pipe.stop || !pipe.queue.empty(); });
+            if (pipe.queue.empty())
+            {
+              return; // stop requested and nothing left to do
+            }
+            std::pair<Size, std::vector<SpectrumData> > batch = std::move(pipe.queue.front());
+            pipe.queue.pop_front();
+
+            lock.unlock();
+            std::exception_ptr error;
+            try
+            {
+              decodeSpectra_(batch.second);
+              deliverSpectra_(batch.second);
+            }
+            catch (...)
+            {
+              error = std::current_exception();
+            }
+            batch.second.clear();
+            lock.lock();
+
+            pipe.bytes_in_flight -= batch.first;
+            if (error)
+            {
+              // keep the first error, drop everything that was queued after it
+              pipe.error = error;
+              for (const auto& pending : pipe.queue) pipe.bytes_in_flight -= pending.first;
+              pipe.queue.clear();
+            }
+            pipe.cond.notify_all();
+          }
+        });
+      }
+
+      // encoded size of the pool (the decoded data is of the same order of magnitude)
+      Size batch_bytes(0);
+      for (const SpectrumData& sd : spectrum_data_)
+      {
+        for (const BinaryData& bd : sd.data)
+        {
+          batch_bytes += bd.base64.size();
+        }
+      }
+
+      {
+        std::unique_lock<std::mutex> lock(pipe.mutex);
+        // always accept a pool if nothing is in flight, otherwise a single
+        // large pool could never be processed
+        pipe.cond.wait(lock, [&]()
+        {
+          return pipe.error || pipe.bytes_in_flight == 0 || pipe.bytes_in_flight + batch_bytes <= options_.getMaxInFlightBytes();
+        });
+        if (pipe.error)
+        {
+          std::exception_ptr error = pipe.error;
+          pipe.error = nullptr;
+          std::rethrow_exception(error);
+        }
+        pipe.bytes_in_flight += batch_bytes;
+        pipe.queue.emplace_back(batch_bytes, std::move(spectrum_data_));
+      }
+      pipe.cond.notify_all();
 
-      // Delete batch
       spectrum_data_.clear();
+      spectrum_data_.reserve(options_.getMaxDataPoolSize());
+    }
+
+    void MzMLHandler::waitForSpectraPipeline_(bool stop)
+    {
+      if (spectra_pipeline_ == nullptr || !spectra_pipeline_->worker.joinable())
+      {
+        return;
+      }
+      SpectraPipeline_& pipe = *spectra_pipeline_;
+
+      std::exception_ptr error;
+      {
+        std::unique_lock<std::mutex> lock(pipe.mutex);
+        pipe.cond.wait(lock, [&pipe]() { return pipe.bytes_in_flight == 0; });
+        std::swap(error, pipe.error);
+        pipe.stop = stop;
+      }
+      if (stop)
+      {
+        pipe.cond.notify_all();
+        pipe.worker.join();
+      }
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
     }
 
     void MzMLHandler::populateChromatogramsWithData_()
     {
+      // never call the consumer concurrently: hand out all pending spectra first
+      waitForSpectraPipeline_(false);
+
       // Whether chromatogram should be populated with data
       if (options_.getFillData())
       {
@@ -325,6 +493,12 @@ namespace OpenMS::Internal
     {
       typedef SpectrumType::PeakType PeakType;
 
+      // the most common case (float arrays, no filtering) is decoded directly into the spectrum
+      if (populateSpectraWithDataDirect_(input_data, default_arr_length, peak_file_options, spectrum))
+      {
+        return;
+      }
+
       // decode all base64 arrays
       MzMLHandlerHelper::decodeBase64Arrays(input_data, options_.getSkipXMLChecks());
 
@@ -487,6 +661,84 @@ namespace OpenMS::Internal
       }
     }
 
+    bool MzMLHandler::populateSpectraWithDataDirect_(std::vector<MzMLHandlerHelper::BinaryData>& input_data,
+                                                     Size& default_arr_length,
+                                                     const PeakFileOptions& peak_file_options,
+                                                     SpectrumType& spectrum)
+    {
+      // range restrictions, numpress, integer and string arrays are handled by the regular path
+      if (peak_file_options.hasMZRange() || peak_file_options.hasIntensityRange() ||
+          !std::all_of(input_data.begin(), input_data.end(), MzMLHandlerHelper::isPlainFloatArray))
+      {
+        return false;
+      }
+
+      bool mz_precision_64 = true;
+      bool int_precision_64 = true;
+      SignedSize mz_index = -1;
+      SignedSize int_index = -1;
+      MzMLHandlerHelper::computeDataProperties_(input_data, mz_precision_64, mz_index, "m/z array");
+      MzMLHandlerHelper::computeDataProperties_(input_data, int_precision_64, int_index, "intensity array");
+      if (int_index == -1 || mz_index == -1)
+      {
+        return false; // the regular path issues the warnings
+      }
+
+      // m/z and intensity end up interleaved in the peaks, so they go through
+      // per-thread buffers which keep their capacity between spectra
+      static thread_local std::vector<double> mz_values;
+      static thread_local std::vector<float> int_values;
+      MzMLHandlerHelper::decodeFloatArray(input_data[mz_index], mz_values, options_.getSkipXMLChecks());
+      MzMLHandlerHelper::decodeFloatArray(input_data[int_index], int_values, options_.getSkipXMLChecks());
+
+      if (mz_values.size() != int_values.size())
+      {
+        fatalError(LOAD, String("The length of m/z and integer values of spectrum '") + spectrum.getNativeID() + "' differ (mz-size: " + mz_values.size() + ", int-size: " + int_values.size() + "! Not reading spectrum!");
+      }
+      if (default_arr_length != mz_values.size())
+      {
+        warning(LOAD, String("The m/z array of spectrum '") + spectrum.getNativeID() + "' has the size " + mz_values.size() + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
+        warning(LOAD, String("The intensity array of spectrum '") + spectrum.getNativeID() + "' has the size " + int_values.size() + ", but it should have size " + default_arr_length + " (defaultArrayLength).");
+        default_arr_length = int_values.size();
+        warning(LOAD, String("Fixing faulty defaultArrayLength to ") + default_arr_length + ".");
+      }
+
+      // all other arrays are float arrays, decode them straight into the data arrays of the spectrum
+      for (Size i = 0; i < input_data.size(); i++)
+      {
+        if (input_data[i].meta.getName() != "m/z array" && input_data[i].meta.getName() != "intensity array")
+        {
+          spectrum.getFloatDataArrays().resize(spectrum.getFloatDataArrays().size() + 1);
+          SpectrumType::FloatDataArray& float_array = spectrum.getFloatDataArrays().back();
+          float_array.MetaInfoDescription::operator=(input_data[i].meta);
+          MzMLHandlerHelper::decodeFloatArray(input_data[i], float_array, options_.getSkipXMLChecks());
+          // as in the regular path, values beyond the number of peaks are dropped
+          if (float_array.size() > default_arr_length)
+          {
+            float_array.resize(default_arr_length);
+          }
+        }
+        else
+        {
+          // Copy meta data from m/z and intensity binary
+          std::vector<UInt> keys;
+          input_data[i].meta.getKeys(keys);
+          for (Size k = 0; k < keys.size(); ++k)
+          {
+            spectrum.setMetaValue(keys[k], input_data[i].meta.getMetaValue(keys[k]));
+          }
+        }
+      }
+
+      spectrum.resize(default_arr_length);
+      for (Size n = 0; n < default_arr_length; n++)
+      {
+        spectrum[n].setMZ(mz_values[n]);
+        spectrum[n].setIntensity(int_values[n]);
+      }
+      return true;
+    }
+
     void MzMLHandler::populateChromatogramsWithData_(std::vector<MzMLHandlerHelper::BinaryData>& input_data,
                                                      Size& default_arr_length,
                                                      const PeakFileOptions& peak_file_options,
@@ -1357,6 +1609,7 @@ namespace OpenMS::Internal
 
         // Flush the remaining data
         populateSpectraWithData_();
+        waitForSpectraPipeline_(true);
         populateChromatogramsWithData_();
       }
     }
@@ -38,6 +38,8 @@
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/FORMAT/Base64.h>
 
+#include <type_traits>
+
 namespace OpenMS::Internal
 {
 
@@ -291,6 +293,75 @@ namespace OpenMS::Internal
 
   }
 
+  bool MzMLHandlerHelper::isPlainFloatArray(const BinaryData& data)
+  {
+    return data.data_type == BinaryData::DT_FLOAT &&
+           data.np_compression == MSNumpressCoder::NONE &&
+           (data.precision == BinaryData::PRE_32 || data.precision == BinaryData::PRE_64);
+  }
+
+  template <typename T>
+  void MzMLHandlerHelper::applyUnitMultiplier_(const BinaryData& bindata, std::vector<T>& values)
+  {
+    // check for unit multiplier and correct our units (e.g. seconds vs minutes)
+    if (bindata.unit_multiplier != 1.0)
+    {
+      for (auto& it : values)
+      {
+        it = it * bindata.unit_multiplier;
+      }
+    }
+  }
+
+  template <typename T>
+  void MzMLHandlerHelper::decodeFloatArray_(BinaryData& bindata, std::vector<T>& out, const bool skipXMLCheck)
+  {
+    if (!skipXMLCheck)
+    {
+      bindata.base64.removeWhitespaces();
+    }
+
+    // decode without going through the floats_32 / floats_64 arrays of bindata
+    if ((bindata.precision == BinaryData::PRE_64) == std::is_same<T, double>::value)
+    {
+      Base64::decode(bindata.base64, Base64::BYTEORDER_LITTLEENDIAN, out, bindata.compression);
+      applyUnitMultiplier_(bindata, out);
+    }
+    else if (bindata.precision == BinaryData::PRE_64)
+    {
+      // capacity of the scratch buffers is kept between calls, so steady-state decoding does not allocate
+      static thread_local std::vector<double> scratch_64;
+      Base64::decode(bindata.base64, Base64::BYTEORDER_LITTLEENDIAN, scratch_64, bindata.compression);
+      applyUnitMultiplier_(bindata, scratch_64);
+      out.assign(scratch_64.begin(), scratch_64.end());
+    }
+    else
+    {
+      static thread_local std::vector<float> scratch_32;
+      Base64::decode(bindata.base64, Base64::BYTEORDER_LITTLEENDIAN, scratch_32, bindata.compression);
+      applyUnitMultiplier_(bindata, scratch_32);
+      out.assign(scratch_32.begin(), scratch_32.end());
+    }
+    String().swap(bindata.base64);
+
+    if (bindata.size != out.size())
+    {
+      MzMLHandlerHelper::warning(0, String("Float binary data array '") + bindata.meta.getName() +
+          "' has length " + out.size() + ", but should have length " + bindata.size + ".");
+      bindata.size = out.size();
+    }
+  }
+
+  void MzMLHandlerHelper::decodeFloatArray(BinaryData& data, std::vector<float>& out, const bool skipXMLCheck)
+  {
+    decodeFloatArray_(data, out, skipXMLCheck);
+  }
+
+  void MzMLHandlerHelper::decodeFloatArray(BinaryData& data, std::vector<double>& out, const bool skipXMLCheck)
+  {
+    decodeFloatArray_(data, out, skipXMLCheck);
+  }
+
   void MzMLHandlerHelper::computeDataProperties_(const std::vector<BinaryData>& data, bool& precision_64, SignedSize& index, const String& index_name)
   {
     SignedSize i(0);
@@ -52,7 +52,10 @@
 #include <omp.h>
 #endif
 
+#include <algorithm>
 #include <cmath>
+#include <exception>
+#include <iterator>
 
 namespace OpenMS::Internal
 {
@@ -78,6 +81,82 @@ namespace OpenMS::Internal
       return tmp;
     }
 
+    /*
+     * @brief Number of chunks (each read through its own connection) in which a set of indices is read
+     *
+     * Reading in chunks only keeps the order of the result identical to a
+     * single query if the indices are sorted, since SQLite returns rows in the
+     * order of the table. Small requests are not split up either.
+     *
+     * @param indices The indices to read
+     *
+     */
+    Size numReadChunks_(const std::vector<int>& indices)
+    {
+#ifdef _OPENMP
+      const Size min_chunk_size = 64;
+      if (omp_in_parallel() || !std::is_sorted(indices.begin(), indices.end()))
+      {
+        return 1;
+      }
+      Size n_chunks = std::min(Size(omp_get_max_threads()), indices.size() / min_chunk_size);
+      return std::max(n_chunks, Size(1));
+#else
+      (void)indices;
+      return 1;
+#endif
+    }
+
+    /*
+     * @brief Decode a single binary data array as stored in the DATA table
+     *
+     * @param raw_text The (compressed) blob
+     * @param blob_bytes Size of the blob
+     * @param compression The compression used (see column DATA.COMPRESSION)
+     * @param data The decoded values (output)
+     *
+     */
+    void decodeDataArray_(const void* raw_text, size_t blob_bytes, int compression, std::vector<double>& data)
+    {
+      // compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+      data.clear();
+      String stemp;
+      if (compression == 1)
+      {
+        OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, stemp);
+
+        void* byte_buffer = reinterpret_cast<void *>(&stemp[0]);
+        Size buffer_size = stemp.size();
+        const double* float_buffer = reinterpret_cast<const double *>(byte_buffer);
+        if (buffer_size % sizeof(double) != 0)
+        {
+          throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+        }
+        Size float_count = buffer_size / sizeof(double);
+        // copy values
+        data.assign(float_buffer, float_buffer + float_count);
+      }
+      else if (compression == 5)
+      {
+        OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, stemp);
+        MSNumpressCoder::NumpressConfig config;
+        config.setCompression("linear");
+        MSNumpressCoder().decodeNPRaw(stemp, data, config);
+      }
+      else if (compression == 6)
+      {
+        OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, stemp);
+        MSNumpressCoder::NumpressConfig config;
+        config.setCompression("slof");
+        MSNumpressCoder().decodeNPRaw(stemp, data, config);
+      }
+      else
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+            "Compression not supported");
+      }
+    }
+
     /*
      *
      * This function populates a set of empty data containers (MSSpectrum or
@@ -94,18 +173,30 @@ namespace OpenMS::Internal
      * It is designed to work with containers of type MSSpectrum and
      * MSChromatogram to provide a single function for both use-cases.
      *
+     * The SQL rows are stepped through sequentially (a statement cannot be
+     * shared between threads), but decoding the blobs (zlib and numpress),
+     * which dominates the runtime, is done in parallel.
+     *
      */
     template<class ContainerT>
     void populateContainer_sub_(sqlite3_stmt *stmt, std::vector<ContainerT>& containers)
     {
+      // a single (still encoded) data array of a container
+      struct RawDataArray
+      {
+        Size container;
+        int compression;
+        int data_type;
+        std::string blob;
+      };
+      std::vector<RawDataArray> raw_arrays;
+
       // perform first step
       sqlite3_step(stmt);
 
       std::vector<int> cont_data;
       cont_data.resize(containers.size());
       std::map<Size,Size> sql_container_map;
-      std::vector<double> data;
-      String stemp;
       while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
       {
         Size id_orig = sqlite3_column_int( stmt, 0 );
@@ -135,104 +226,31 @@ namespace OpenMS::Internal
         int compression = sqlite3_column_int( stmt, 2 );
         int data_type = sqlite3_column_int( stmt, 3 );
 
-        const void * raw_text = sqlite3_column_blob(stmt, 4);
-        size_t blob_bytes = sqlite3_column_bytes(stmt, 4);
-
         // data_type is one of 0 = mz, 1 = int, 2 = rt
-        // compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
-        data.clear();
-        stemp.clear();
-        if (compression == 1)
-        {
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, stemp);
-
-          void* byte_buffer = reinterpret_cast<void *>(&stemp[0]);
-          Size buffer_size = stemp.size();
-          const double* float_buffer = reinterpret_cast<const double *>(byte_buffer);
-          if (buffer_size % sizeof(double) != 0)
-          {
-            throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
-          }
-          Size float_count = buffer_size / sizeof(double);
-          // copy values
-          data.assign(float_buffer, float_buffer + float_count);
-        }
-        else if (compression == 5)
-        {
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, stemp);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("linear");
-          MSNumpressCoder().decodeNPRaw(stemp, data, config);
-        }
-        else if (compression == 6)
-        {
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, stemp);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("slof");
-          MSNumpressCoder().decodeNPRaw(stemp, data, config);
-        }
-        else
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Compression not supported");
-        }
-
-        if (data_type == 1)
-        {
-          // intensity
-          if (containers[curr_id].empty())
-          {
-            containers[curr_id].resize(data.size());
-          }
-          std::vector< double >::iterator data_it = data.begin();
-          for (auto it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
-          {
-            it->setIntensity(*data_it);
-          }
-          cont_data[curr_id] += 1;
-        }
-        else if (data_type == 0)
+        if (data_type == 0 && boost::is_same<ContainerT, MSChromatogram>::value)
         {
           // mz (should only occur in spectra)
-          if (boost::is_same<ContainerT, MSChromatogram>::value) 
-          {
-            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-                "Found m/z data type for chromatogram (instead of retention time)");
-          }
-
-          if (containers[curr_id].empty())
-          {
-            containers[curr_id].resize(data.size());
-          }
-          std::vector< double >::iterator data_it = data.begin();
-          for (auto it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
-          {
-            it->setMZ(*data_it);
-          }
-          cont_data[curr_id] += 1;
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+              "Found m/z data type for chromatogram (instead of retention time)");
         }
-        else if (data_type == 2)
+        if (data_type == 2 && boost::is_same<ContainerT, MSSpectrum>::value)
         {
           // rt (should only occur in chromatograms)
-          if (boost::is_same<ContainerT, MSSpectrum >::value) 
-          {
-            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-                "Found retention time data type for spectrum (instead of m/z)");
-          }
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (auto it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
-          {
-            it->setMZ(*data_it);
-          }
-          cont_data[curr_id] += 1;
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+              "Found retention time data type for spectrum (instead of m/z)");
         }
-        else
+        if (data_type < 0 || data_type > 2)
         {
           throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
               "Found data type other than RT/Intensity for spectra");
         }
 
+        // copy the blob, the pointer is only valid until the next step
+        const char * raw_text = reinterpret_cast<const char*>(sqlite3_column_blob(stmt, 4));
+        size_t blob_bytes = sqlite3_column_bytes(stmt, 4);
+        raw_arrays.push_back({curr_id, compression, data_type, std::string(raw_text, blob_bytes)});
+        cont_data[curr_id] += 1;
+
         sqlite3_step( stmt );
       }
 
@@ -245,6 +263,57 @@ namespace OpenMS::Internal
               String("Spectrum/Chromatogram ") + k + " does not have 2 data arrays.");
         }
       }
+
+      // decode all data arrays in parallel
+      std::vector<std::vector<double> > decoded(raw_arrays.size());
+      std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 16)
+      for (SignedSize k = 0; k < (SignedSize)raw_arrays.size(); k++)
+      {
+        try
+        {
+          decodeDataArray_(raw_arrays[k].blob.data(), raw_arrays[k].blob.size(),
+                           raw_arrays[k].compression, decoded[k]);
+          std::string().swap(raw_arrays[k].blob); // release memory early
+        }
+        catch (...)
+        {
+#pragma omp critical (MzMLSqliteHandler_populate)
+          if (!error) error = std::current_exception();
+        }
+      }
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+
+      // fill the containers with the decoded data
+      for (Size k = 0; k < raw_arrays.size(); k++)
+      {
+        ContainerT& container = containers[raw_arrays[k].container];
+        const std::vector<double>& data = decoded[k];
+        if (container.empty())
+        {
+          container.resize(data.size());
+        }
+        Size n = std::min(data.size(), container.size());
+        if (raw_arrays[k].data_type == 1)
+        {
+          // intensity
+          for (Size i = 0; i < n; i++)
+          {
+            container[i].setIntensity(data[i]);
+          }
+        }
+        else
+        {
+          // mz (spectra) or rt (chromatograms)
+          for (Size i = 0; i < n; i++)
+          {
+            container[i].setMZ(data[i]);
+          }
+        }
+      }
     }
 
     // the cost for initialization and copy should be minimal
@@ -376,23 +445,67 @@ namespace OpenMS::Internal
     {
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index")
 
-      // creates the spectra but does not fill them with data (provides option
-      // to return meta-data only)
-      SqliteConnector conn(filename_);
-      prepareSpectra_(conn.getDB(), exp, indices);
-      if (indices.size() != exp.size())
+      Size n_chunks = meta_only ? 1 : numReadChunks_(indices);
+      if (n_chunks == 1)
       {
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-            String("Illegal spectral indices detected ") + integerConcatenateHelper(indices) + \
-            " for file of size " + getNrSpectra());
+        // creates the spectra but does not fill them with data (provides option
+        // to return meta-data only)
+        SqliteConnector conn(filename_);
+        prepareSpectra_(conn.getDB(), exp, indices);
+        if (indices.size() != exp.size())
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+              String("Illegal spectral indices detected ") + integerConcatenateHelper(indices) + \
+              " for file of size " + getNrSpectra());
+        }
+
+        if (meta_only)
+        {
+          return;
+        }
+
+        populateSpectraWithData_(conn.getDB(), exp, indices);
+        return;
       }
 
-      if (meta_only)
+      // read contiguous chunks of the (sorted) indices in parallel, each
+      // through its own connection (SQLite connections must not be shared
+      // between threads)
+      std::vector<std::vector<MSSpectrum> > chunks(n_chunks);
+      std::exception_ptr error;
+#pragma omp parallel for schedule(static, 1) num_threads(int(n_chunks))
+      for (SignedSize c = 0; c < (SignedSize)n_chunks; c++)
       {
-        return;
+        try
+        {
+          std::vector<int> chunk_indices(indices.begin() + c * indices.size() / n_chunks,
+                                         indices.begin() + (c + 1) * indices.size() / n_chunks);
+          SqliteConnector conn(filename_);
+          prepareSpectra_(conn.getDB(), chunks[c], chunk_indices);
+          if (chunk_indices.size() != chunks[c].size())
+          {
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                String("Illegal spectral indices detected ") + integerConcatenateHelper(chunk_indices));
+          }
+          populateSpectraWithData_(conn.getDB(), chunks[c], chunk_indices);
+        }
+        catch (...)
+        {
+#pragma omp critical (MzMLSqliteHandler_readSpectra)
+          if (!error) error = std::current_exception();
+        }
+      }
+      if (error)
+      {
+        std::rethrow_exception(error);
       }
 
-      populateSpectraWithData_(conn.getDB(), exp, indices);
+      exp.clear();
+      exp.reserve(indices.size());
+      for (auto& chunk : chunks)
+      {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(exp));
+      }
     }
 
     void MzMLSqliteHandler::readChromatograms(std::vector<MSChromatogram> & exp,
@@ -401,23 +514,65 @@ namespace OpenMS::Internal
     {
       OPENMS_PRECONDITION(!indices.empty(), "Need to select at least one index")
 
-      // creates the chromatograms but does not fill them with data (provides
-      // option to return meta-data only)
-      SqliteConnector conn(filename_);
-      prepareChroms_(conn.getDB(), exp, indices);
-      if (indices.size() != exp.size())
+      Size n_chunks = meta_only ? 1 : numReadChunks_(indices);
+      if (n_chunks == 1)
       {
-        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-            String("Illegal chromatogram indices detected ") + integerConcatenateHelper(indices) + \
-            " for file of size " + getNrChromatograms());
+        // creates the chromatograms but does not fill them with data (provides
+        // option to return meta-data only)
+        SqliteConnector conn(filename_);
+        prepareChroms_(conn.getDB(), exp, indices);
+        if (indices.size() != exp.size())
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+              String("Illegal chromatogram indices detected ") + integerConcatenateHelper(indices) + \
+              " for file of size " + getNrChromatograms());
+        }
+
+        if (meta_only)
+        {
+          return;
+        }
+
+        populateChromatogramsWithData_(conn.getDB(), exp, indices);
+        return;
       }
 
-      if (meta_only)
+      // see readSpectra
+      std::vector<std::vector<MSChromatogram> > chunks(n_chunks);
+      std::exception_ptr error;
+#pragma omp parallel for schedule(static, 1) num_threads(int(n_chunks))
+      for (SignedSize c = 0; c < (SignedSize)n_chunks; c++)
       {
-        return;
+        try
+        {
+          std::vector<int> chunk_indices(indices.begin() + c * indices.size() / n_chunks,
+                                         indices.begin() + (c + 1) * indices.size() / n_chunks);
+          SqliteConnector conn(filename_);
+          prepareChroms_(conn.getDB(), chunks[c], chunk_indices);
+          if (chunk_indices.size() != chunks[c].size())
+          {
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                String("Illegal chromatogram indices detected ") + integerConcatenateHelper(chunk_indices));
+          }
+          populateChromatogramsWithData_(conn.getDB(), chunks[c], chunk_indices);
+        }
+        catch (...)
+        {
+#pragma omp critical (MzMLSqliteHandler_readChromatograms)
+          if (!error) error = std::current_exception();
+        }
+      }
+      if (error)
+      {
+        std::rethrow_exception(error);
       }
 
-      populateChromatogramsWithData_(conn.getDB(), exp, indices);
+      exp.clear();
+      exp.reserve(indices.size());
+      for (auto& chunk : chunks)
+      {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(exp));
+      }
     }
 
     Size MzMLSqliteHandler::getNrSpectra() const
@@ -479,6 +634,104 @@ namespace OpenMS::Internal
       return result;
     }
 
+    std::vector<int> MzMLSqliteHandler::getSpectraIndicesByRange(double rt_start,
+                                                                  double rt_end,
+                                                                  int ms_level,
+                                                                  double isolation_target,
+                                                                  double isolation_tolerance) const
+    {
+      SqliteConnector conn(filename_);
+
+      // a spectrum with several matching precursors is joined several times: DISTINCT reports it once
+      std::string select_sql = "SELECT DISTINCT SPECTRUM.ID FROM SPECTRUM ";
+      if (isolation_target >= 0.0)
+      {
+        select_sql += "INNER JOIN PRECURSOR ON SPECTRUM.ID = PRECURSOR.SPECTRUM_ID ";
+      }
+      select_sql += "WHERE SPECTRUM.RETENTION_TIME BETWEEN :rt_start AND :rt_end ";
+      if (ms_level > 0)
+      {
+        select_sql += "AND SPECTRUM.MSLEVEL = :ms_level ";
+      }
+      if (isolation_target >= 0.0)
+      {
+        select_sql += "AND PRECURSOR.ISOLATION_TARGET BETWEEN :target_lower AND :target_upper ";
+      }
+      select_sql += "ORDER BY SPECTRUM.RETENTION_TIME, SPECTRUM.ID;";
+
+      // use bound parameters so that the (cached) query plan can use the indices
+      sqlite3_stmt* stmt;
+      conn.prepareStatement(&stmt, select_sql);
+      sqlite3_bind_double(stmt, sqlite3_bind_parameter_index(stmt, ":rt_start"), rt_start);
+      sqlite3_bind_double(stmt, sqlite3_bind_parameter_index(stmt, ":rt_end"), rt_end);
+      if (ms_level > 0)
+      {
+        sqlite3_bind_int(stmt, sqlite3_bind_parameter_index(stmt, ":ms_level"), ms_level);
+      }
+      if (isolation_target >= 0.0)
+      {
+        sqlite3_bind_double(stmt, sqlite3_bind_parameter_index(stmt, ":target_lower"), isolation_target - isolation_tolerance);
+        sqlite3_bind_double(stmt, sqlite3_bind_parameter_index(stmt, ":target_upper"), isolation_target + isolation_tolerance);
+      }
+
+      std::vector<int> result;
+      while (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        result.push_back(sqlite3_column_int(stmt, 0));
+      }
+      sqlite3_finalize(stmt);
+
+      return result;
+    }
+
+    std::vector<double> MzMLSqliteHandler::getSpectraRT(const std::vector<int>& indices) const
+    {
+      SqliteConnector conn(filename_);
+
+      std::string select_sql = "SELECT ID, RETENTION_TIME FROM SPECTRUM ";
+      if (!indices.empty())
+      {
+        select_sql += "WHERE ID IN (" + integerConcatenateHelper(indices) + ") ";
+      }
+      select_sql += "ORDER BY ID;";
+
+      sqlite3_stmt* stmt;
+      conn.prepareStatement(&stmt, select_sql);
+      std::map<int, double> rt_map;
+      std::vector<double> result;
+      while (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        if (indices.empty())
+        {
+          result.push_back(sqlite3_column_double(stmt, 1));
+        }
+        else
+        {
+          rt_map[sqlite3_column_int(stmt, 0)] = sqlite3_column_double(stmt, 1);
+        }
+      }
+      sqlite3_finalize(stmt);
+
+      if (indices.empty())
+      {
+        return result;
+      }
+
+      // return the retention times in the order of the requested indices
+      result.reserve(indices.size());
+      for (int idx : indices)
+      {
+        auto it = rt_map.find(idx);
+        if (it == rt_map.end())
+        {
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+              String("Illegal spectral index detected ") + idx + " for file of size " + getNrSpectra());
+        }
+        result.push_back(it->second);
+      }
+      return result;
+    }
+
     Size MzMLSqliteHandler::getNrChromatograms() const
     {
       SqliteConnector conn(filename_);
@@ -979,11 +1232,12 @@ namespace OpenMS::Internal
 
         "CREATE INDEX chrom_run_idx ON CHROMATOGRAM(RUN_ID);" \
 
-        "CREATE INDEX product_chr_idx ON DATA(CHROMATOGRAM_ID);" \
-        "CREATE INDEX product_sp_idx ON DATA(SPECTRUM_ID);" \
+        "CREATE INDEX product_chr_idx ON PRODUCT(CHROMATOGRAM_ID);" \
+        "CREATE INDEX product_sp_idx ON PRODUCT(SPECTRUM_ID);" \
 
-        "CREATE INDEX precursor_chr_idx ON DATA(CHROMATOGRAM_ID);" \
-        "CREATE INDEX precursor_sp_idx ON DATA(SPECTRUM_ID);";
+        "CREATE INDEX precursor_chr_idx ON PRECURSOR(CHROMATOGRAM_ID);" \
+        "CREATE INDEX precursor_sp_idx ON PRECURSOR(SPECTRUM_ID);" \
+        "CREATE INDEX precursor_target_idx ON PRECURSOR(ISOLATION_TARGET);";
 
       // Execute SQL statement
       SqliteConnector conn(filename_);
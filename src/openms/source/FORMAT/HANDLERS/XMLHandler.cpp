@@ -40,7 +40,14 @@
 #include <OpenMS/METADATA/ProteinIdentification.h>
 
 #include <algorithm>
+#include <exception>
+#include <mutex>
 #include <set>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 using namespace xercesc;
@@ -48,6 +55,10 @@ using namespace xercesc;
 namespace OpenMS::Internal
 {
 
+    /// Guards error_message_: messages may be reported concurrently from OpenMP
+    /// threads (see writeElementsInParallel_) and from the mzML decoding worker thread
+    static std::mutex xml_handler_message_mutex;
+
     // Specializations for character types, released by XMLString::release
     template<> void shared_xerces_ptr<char>::doRelease_(char* item)
     {
@@ -105,35 +116,41 @@ namespace OpenMS::Internal
 
     void XMLHandler::fatalError(ActionMode mode, const String & msg, UInt line, UInt column) const
     {
+      String message;
       if (mode == LOAD)
       {
-        error_message_ =  String("While loading '") + file_ + "': " + msg;
+        message =  String("While loading '") + file_ + "': " + msg;
 	      // test if file has the wrong extension and is therefore passed to the wrong parser
         // only makes sense if we are loading/parsing a file
 	      FileTypes::Type ft_name = FileHandler::getTypeByFileName(file_);
         FileTypes::Type ft_content = FileHandler::getTypeByContent(file_);
         if (ft_name != ft_content)
         {
-          error_message_ += String("\nProbable cause: The file suffix (") + FileTypes::typeToName(ft_name)
+          message += String("\nProbable cause: The file suffix (") + FileTypes::typeToName(ft_name)
                           + ") does not match the file content (" + FileTypes::typeToName(ft_content) + "). "
                           + "Rename the file to fix this.";
         }
       }
       else if (mode == STORE)
       {
-        error_message_ =  String("While storing '") + file_ + "': " + msg;
+        message =  String("While storing '") + file_ + "': " + msg;
       }
       if (line != 0 || column != 0)
       {
-        error_message_ += String("( in line ") + line + " column " + column + ")";
+        message += String("( in line ") + line + " column " + column + ")";
       }
 
-      OPENMS_LOG_FATAL_ERROR << error_message_ << std::endl;
-      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, error_message_);
+      {
+        std::lock_guard<std::mutex> lock(xml_handler_message_mutex);
+        error_message_ = message;
+        OPENMS_LOG_FATAL_ERROR << error_message_ << std::endl;
+      }
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, file_, message);
     }
 
     void XMLHandler::error(ActionMode mode, const String & msg, UInt line, UInt column) const
     {
+      std::lock_guard<std::mutex> lock(xml_handler_message_mutex);
       if (mode == LOAD)
       {
         error_message_ =  String("Non-fatal error while loading '") + file_ + "': " + msg;
@@ -151,6 +168,7 @@ namespace OpenMS::Internal
 
     void XMLHandler::warning(ActionMode mode, const String & msg, UInt line, UInt column) const
     {
+      std::lock_guard<std::mutex> lock(xml_handler_message_mutex);
       if (mode == LOAD)
       {
         error_message_ =  String("While loading '") + file_ + "': " + msg;
@@ -170,7 +188,6 @@ namespace OpenMS::Internal
 #else
       OPENMS_LOG_DEBUG << error_message_ << std::endl;
 #endif
-
     }
 
     void XMLHandler::characters(const XMLCh * const /*chars*/, const XMLSize_t /*length*/)
@@ -191,6 +208,7 @@ namespace OpenMS::Internal
 
     String XMLHandler::errorString()
     {
+      std::lock_guard<std::mutex> lock(xml_handler_message_mutex);
       return error_message_;
     }
 
@@ -296,6 +314,67 @@ namespace OpenMS::Internal
       }
     }
 
+    void XMLHandler::writeElementsInParallel_(std::ostream& os, Size count, const std::function<void(std::ostream&, Size)>& write_element,
+                                              const std::function<void(Size)>& progress) const
+    {
+      // number of elements formatted by one thread in one go: large enough to amortize the scheduling
+      // overhead, small enough to balance elements of very different sizes
+      const Size block_size = 256;
+
+      Size n_threads = 1;
+#ifdef _OPENMP
+      if (!omp_in_parallel()) n_threads = omp_get_max_threads();
+#endif
+      if (n_threads <= 1 || count <= block_size)
+      {
+        for (Size i = 0; i < count; ++i)
+        {
+          write_element(os, i);
+          if (progress) progress(i + 1);
+        }
+        return;
+      }
+
+      // format a bounded number of blocks per round, so the memory for the buffered output stays small
+      // compared to the data; the blocks of a round are then written to 'os' in order
+      const Size blocks_per_round = 4 * n_threads;
+      std::vector<std::string> blocks(blocks_per_round);
+      for (Size round_start = 0; round_start < count; round_start += blocks_per_round * block_size)
+      {
+        const Size n_blocks = std::min(blocks_per_round, (count - round_start + block_size - 1) / block_size);
+        std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic, 1)
+        for (SignedSize b = 0; b < (SignedSize)n_blocks; ++b)
+        {
+          try
+          {
+            std::ostringstream block_os;
+            block_os.copyfmt(os); // same precision, flags and locale as the target stream
+            const Size begin = round_start + b * block_size;
+            const Size end = std::min(begin + block_size, count);
+            for (Size i = begin; i < end; ++i)
+            {
+              write_element(block_os, i);
+            }
+            blocks[b] = block_os.str();
+          }
+          catch (...)
+          {
+#pragma omp critical (XMLHandler_writeElementsInParallel)
+            if (!error) error = std::current_exception();
+          }
+        }
+        if (error) std::rethrow_exception(error);
+
+        for (Size b = 0; b < n_blocks; ++b)
+        {
+          os << blocks[b];
+          blocks[b].clear();
+        }
+        if (progress) progress(std::min(round_start + n_blocks * block_size, count));
+      }
+    }
+
     //*******************************************************************************************************************
     
     StringManager::StringManager()
@@ -283,49 +283,50 @@ namespace OpenMS
       Size count_wrong_id(0);
       Size count_empty(0);
 
-      for (Size l = 0; l < peptide_ids.size(); ++l)
+      // PeptideIdentifications are formatted in parallel (in blocks) and written in order
+      writeElementsInParallel_(os, peptide_ids.size(), [&](std::ostream& pep_os, Size l)
       {
-        setProgress(l);
-
         if (peptide_ids[l].getIdentifier() != protein_ids[i].getIdentifier())
         {
+#pragma omp atomic
           ++count_wrong_id;
-          continue;
+          return;
         }
         else if (peptide_ids[l].getHits().empty())
         {
+#pragma omp atomic
           ++count_empty;
-          continue;
+          return;
         }
 
-        os << "\t\t<PeptideIdentification "
-           << "score_type=\"" << writeXMLEscape(peptide_ids[l].getScoreType()) << "\" ";
+        pep_os << "\t\t<PeptideIdentification "
+               << "score_type=\"" << writeXMLEscape(peptide_ids[l].getScoreType()) << "\" ";
         if (peptide_ids[l].isHigherScoreBetter())
         {
-          os << "higher_score_better=\"true\" ";
+          pep_os << "higher_score_better=\"true\" ";
         }
         else
         {
-          os << "higher_score_better=\"false\" ";
+          pep_os << "higher_score_better=\"false\" ";
         }
-        os << "significance_threshold=\"" << String(peptide_ids[l].getSignificanceThreshold()) << "\" ";
+        pep_os << "significance_threshold=\"" << String(peptide_ids[l].getSignificanceThreshold()) << "\" ";
         // mz
         if (peptide_ids[l].hasMZ())
         {
-          os << "MZ=\"" << String(peptide_ids[l].getMZ()) << "\" ";
+          pep_os << "MZ=\"" << String(peptide_ids[l].getMZ()) << "\" ";
         }
         // rt
         if (peptide_ids[l].hasRT())
         {
-          os << "RT=\"" << String(peptide_ids[l].getRT()) << "\" ";
+          pep_os << "RT=\"" << String(peptide_ids[l].getRT()) << "\" ";
         }
         // spectrum_reference
         const DataValue& dv = peptide_ids[l].getMetaValue("spectrum_reference");
         if (dv != DataValue::EMPTY)
         {
-          os << "spectrum_reference=\"" << writeXMLEscape(dv.toString()) << "\" ";
+          pep_os << "spectrum_reference=\"" << writeXMLEscape(dv.toString()) << "\" ";
         }
-        os << ">\n";
+        pep_os << ">\n";
 
         // write peptide hits
         std::vector<String> protein_accessions;
@@ -339,15 +340,15 @@ namespace OpenMS
 
         for (const PeptideHit& p_hit : pep_hits)
         {
-          os << "\t\t\t<PeptideHit"
-             << " score=\"" << String(p_hit.getScore()) << "\""
-             << " sequence=\"" << writeXMLEscape(p_hit.getSequence().toString()) << "\""
-             << " charge=\"" << String(p_hit.getCharge()) << "\"";
+          pep_os << "\t\t\t<PeptideHit"
+                 << " score=\"" << String(p_hit.getScore()) << "\""
+                 << " sequence=\"" << writeXMLEscape(p_hit.getSequence().toString()) << "\""
+                 << " charge=\"" << String(p_hit.getCharge()) << "\"";
 
           const std::vector<PeptideEvidence>& pes = p_hit.getPeptideEvidences();
 
-          createFlankingAAXMLString_(pes, os);
-          createPositionXMLString_(pes, os);
+          createFlankingAAXMLString_(pes, pep_os);
+          createPositionXMLString_(pes, pep_os);
 
           // Extract all protein accessions.
           // Note: protein accessions correspond to neighboring AAs and start/end
@@ -382,12 +383,12 @@ namespace OpenMS
 
           if (!protein_accessions.empty())
           {
-            os << " protein_refs=\"" << ListUtils::concatenate(protein_accessions, " ") << "\"";
+            pep_os << " protein_refs=\"" << ListUtils::concatenate(protein_accessions, " ") << "\"";
           }
 
-          os << " >\n";
-          writeFragmentAnnotations_("UserParam", os, p_hit.getPeakAnnotations(), 4);
-          writeUserParam_("UserParam", os, p_hit, 4);
+          pep_os << " >\n";
+          writeFragmentAnnotations_("UserParam", pep_os, p_hit.getPeakAnnotations(), 4);
+          writeUserParam_("UserParam", pep_os, p_hit, 4);
 
           // write out the (optional) peptide prophet / interprophet results as UserParams
           {
@@ -395,27 +396,28 @@ namespace OpenMS
             for (std::vector<PeptideHit::PepXMLAnalysisResult>::const_iterator ar_it = p_hit.getAnalysisResults().begin();
                 ar_it != p_hit.getAnalysisResults().end(); ++ar_it, ++k)
             {
-              os << "\t\t\t\t<UserParam type=\"string\" name=\"_ar_" << String(k) << "_score_type\" value=\"" << ar_it->score_type << "\"/>" << "\n";
-              os << "\t\t\t\t<UserParam type=\"float\" name=\"_ar_" << String(k) << "_score\" value=\"" << String(ar_it->main_score) << "\"/>" << "\n";
+              pep_os << "\t\t\t\t<UserParam type=\"string\" name=\"_ar_" << String(k) << "_score_type\" value=\"" << ar_it->score_type << "\"/>" << "\n";
+              pep_os << "\t\t\t\t<UserParam type=\"float\" name=\"_ar_" << String(k) << "_score\" value=\"" << String(ar_it->main_score) << "\"/>" << "\n";
               if (!ar_it->sub_scores.empty())
               {
                 for (std::map<String, double>::const_iterator subscore_it = ar_it->sub_scores.begin();
                     subscore_it != ar_it->sub_scores.end(); ++subscore_it)
                 {
-                  os << "\t\t\t\t<UserParam type=\"float\" name=\"_ar_" << String(k) << "_subscore_" << subscore_it->first <<"\" value=\"" << String(subscore_it->second) << "\"/>" << "\n";
+                  pep_os << "\t\t\t\t<UserParam type=\"float\" name=\"_ar_" << String(k) << "_subscore_" << subscore_it->first <<"\" value=\"" << String(subscore_it->second) << "\"/>" << "\n";
                 }
               }
             }
 
           }
-          os << "\t\t\t</PeptideHit>\n";
+          pep_os << "\t\t\t</PeptideHit>\n";
         }
 
         // do not write "spectrum_reference" since it is written as attribute already
         pep_id.removeMetaValue("spectrum_reference");
-        writeUserParam_("UserParam", os, pep_id, 3);
-        os << "\t\t</PeptideIdentification>\n";
-      }
+        writeUserParam_("UserParam", pep_os, pep_id, 3);
+        pep_os << "\t\t</PeptideIdentification>\n";
+      },
+      [&](Size written) { setProgress(written); });
 
       os << "\t</IdentificationRun>\n";
 
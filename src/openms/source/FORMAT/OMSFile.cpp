@@ -46,12 +46,27 @@ namespace OpenMS
   {
     OpenMS::Internal::OMSFileStore helper(filename, log_type_);
     helper.store(id_data);
+    helper.close();
   }
 
   void OMSFile::store(const String& filename, const FeatureMap& features)
   {
     OpenMS::Internal::OMSFileStore helper(filename, log_type_);
     helper.store(features);
+    helper.close();
+  }
+
+  void OMSFile::storeBatches(const String& filename,
+                             const function<bool(IdentificationData&)>& next_batch)
+  {
+    OpenMS::Internal::OMSFileStore helper(filename, log_type_);
+    while (true)
+    {
+      IdentificationData batch;
+      if (!next_batch(batch)) break;
+      helper.store(batch);
+    }
+    helper.close();
   }
 
   void OMSFile::load(const String& filename, IdentificationData& id_data)
@@ -34,13 +34,13 @@
 
 #include <OpenMS/FORMAT/OMSFileStore.h>
 #include <OpenMS/SYSTEM/File.h>
+#include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/CONCEPT/VersionInfo.h>
-#include <OpenMS/CONCEPT/UniqueIdGenerator.h>
 
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlError>
-// strangely, this is needed for type conversions in "QSqlQuery::bindValue":
-#include <QtSql/QSqlQueryModel>
+
+#include <sqlite3.h>
 
 using namespace std;
 
@@ -50,6 +50,51 @@ namespace OpenMS::Internal
 {
   int version_number = 2; // increase this whenever the DB schema changes!
 
+  namespace
+  {
+    // helper functions for binding values to named parameters of prepared
+    // statements (bound values persist until they are overwritten):
+    int getParameterIndex(sqlite3_stmt* query, const char* name)
+    {
+      int index = sqlite3_bind_parameter_index(query, name);
+      if (index == 0)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__,
+                                         OPENMS_PRETTY_FUNCTION,
+                                         "unknown query parameter: " + String(name));
+      }
+      return index;
+    }
+
+    void bindValue(sqlite3_stmt* query, const char* name, int value)
+    {
+      sqlite3_bind_int(query, getParameterIndex(query, name), value);
+    }
+
+    void bindValue(sqlite3_stmt* query, const char* name, Int64 value)
+    {
+      sqlite3_bind_int64(query, getParameterIndex(query, name), value);
+    }
+
+    void bindValue(sqlite3_stmt* query, const char* name, double value)
+    {
+      sqlite3_bind_double(query, getParameterIndex(query, name), value);
+    }
+
+    void bindValue(sqlite3_stmt* query, const char* name, const String& value)
+    {
+      // "SQLITE_TRANSIENT" makes SQLite copy the data, so temporaries are fine:
+      sqlite3_bind_text(query, getParameterIndex(query, name), value.c_str(),
+                        int(value.size()), SQLITE_TRANSIENT);
+    }
+
+    void bindNull(sqlite3_stmt* query, const char* name)
+    {
+      sqlite3_bind_null(query, getParameterIndex(query, name));
+    }
+  }
+
+
   void raiseDBError_(const QSqlError& error, int line,
                      const char* function, const String& context)
   {
@@ -58,6 +103,14 @@ namespace OpenMS::Internal
   }
 
 
+  void raiseDBError_(sqlite3* db, int line,
+                     const char* function, const String& context)
+  {
+    String msg = context + ": " + sqlite3_errmsg(db);
+    throw Exception::FailedAPICall(__FILE__, line, function, msg);
+  }
+
+
   bool tableExists_(const String& db_name, const String& name)
   {
     QSqlDatabase db = QSqlDatabase::database(db_name.toQString());
@@ -65,9 +118,7 @@ namespace OpenMS::Internal
   }
 
 
-  OMSFileStore::OMSFileStore(const String& filename, LogType log_type):
-    db_name_("store_" + filename.toQString() + "_" +
-             QString::number(UniqueIdGenerator::getUniqueId()))
+  OMSFileStore::OMSFileStore(const String& filename, LogType log_type)
   {
     setLogType(log_type);
 
@@ -75,84 +126,219 @@ namespace OpenMS::Internal
     File::remove(filename);
 
     // open database:
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", db_name_);
-    db.setDatabaseName(filename.toQString());
-    if (!db.open())
+    try
+    {
+      db_ = make_unique<SqliteConnector>(filename);
+    }
+    catch (Exception::SqlOperationFailed& e)
     {
-      raiseDBError_(db.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
-                    "error opening SQLite database");
-      // if d'tor doesn't get called, DB connection (db_name_) doesn't get
-      // removed, but that shouldn't be a big problem
+      throw Exception::FailedAPICall(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                     "error opening SQLite database: " +
+                                     String(e.what()));
     }
 
     // configure database settings:
-    QSqlQuery query(db);
     // foreign key constraints are disabled by default - turn them on:
     // @TODO: performance impact? (seems negligible, but should be tested more)
-    if (!query.exec("PRAGMA foreign_keys = ON"))
-    {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
-                    "error configuring database");
-    }
+    execute_("PRAGMA foreign_keys = ON", "error configuring database");
     // disable synchronous filesystem access and the rollback journal to greatly
     // increase write performance - since we write a new output file every time,
-    // we don't have to worry about database consistency:
-    if (!query.exec("PRAGMA synchronous = OFF"))
+    // we don't have to worry about database consistency (for the same reason,
+    // WAL mode would not help here):
+    execute_("PRAGMA synchronous = OFF", "error configuring database");
+    execute_("PRAGMA journal_mode = OFF", "error configuring database");
+    // nobody else should access the file while we write it; keep temporary
+    // data in memory and use a larger page cache (64 MB) for the bulk inserts:
+    execute_("PRAGMA locking_mode = EXCLUSIVE", "error configuring database");
+    execute_("PRAGMA temp_store = MEMORY", "error configuring database");
+    execute_("PRAGMA cache_size = -65536", "error configuring database");
+  }
+
+
+  OMSFileStore::~OMSFileStore()
+  {
+    try
     {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
-                    "error configuring database");
+      close();
     }
-    if (!query.exec("PRAGMA journal_mode = OFF"))
+    catch (Exception::BaseException& e)
     {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
-                    "error configuring database");
+      OPENMS_LOG_ERROR << "Error finalizing .oms file: " << e.what() << endl;
     }
   }
 
 
-  OMSFileStore::~OMSFileStore()
+  void OMSFileStore::close()
+  {
+    if (!db_) return;
+    for (auto& pair : prepared_queries_)
+    {
+      sqlite3_finalize(pair.second);
+    }
+    prepared_queries_.clear();
+    // indexes are created only now, after all data has been written:
+    if (tableExists_("ID_ObservationMatch_PeakAnnotation"))
+    {
+      execute_("CREATE INDEX PeakAnnotation_parent_id ON ID_ObservationMatch_PeakAnnotation (parent_id)",
+               "error creating database index");
+    }
+    db_.reset(); // closes the connection
+  }
+
+
+  void OMSFileStore::execute_(const String& sql, const String& context)
   {
-    QSqlDatabase::database(db_name_).close();
-    QSqlDatabase::removeDatabase(db_name_);
+    if (sqlite3_exec(db_->getDB(), sql.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+      raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION, context);
+    }
   }
 
 
-  void OMSFileStore::createTable_(const String& name,
-                                  const String& definition,
-                                  bool may_exist)
+  sqlite3_stmt* OMSFileStore::prepareQuery_(const String& name, const String& sql)
   {
-    QString sql_create = "CREATE TABLE ";
-    if (may_exist) sql_create += "IF NOT EXISTS ";
-    sql_create += name.toQString() + " (" + definition.toQString() + ")";
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    if (!query.exec(sql_create))
+    sqlite3_stmt*& query = prepared_queries_[name];
+    if (query == nullptr)
     {
-      String msg = "error creating database table " + name;
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION, msg);
+      if (sqlite3_prepare_v2(db_->getDB(), sql.c_str(), int(sql.size()), &query,
+                             nullptr) != SQLITE_OK)
+      {
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                      "error preparing database query");
+      }
     }
+    return query;
+  }
+
+
+  sqlite3_stmt* OMSFileStore::getQuery_(const String& name)
+  {
+    auto pos = prepared_queries_.find(name);
+    if (pos == prepared_queries_.end())
+    {
+      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "prepared query '" + name + "'");
+    }
+    return pos->second;
+  }
+
+
+  bool OMSFileStore::execQuery_(sqlite3_stmt* query)
+  {
+    int rc = sqlite3_step(query);
+    if ((rc != SQLITE_DONE) && (rc != SQLITE_ROW)) return false;
+    sqlite3_reset(query);
+    return true;
+  }
+
+
+  void OMSFileStore::beginTransaction_()
+  {
+    // avoid SQLite's "implicit transactions" (one per insert), improve runtime:
+    execute_("BEGIN TRANSACTION", "error starting transaction");
+  }
+
+
+  void OMSFileStore::commitTransaction_()
+  {
+    execute_("COMMIT", "error committing transaction");
+    // element addresses are only valid for the current batch:
+    keys_.clear();
+    previous_batches_ = true;
+  }
+
+
+  pair<OMSFileStore::Key, bool> OMSFileStore::registerKey_(
+    const void* element, const String& table, const String& natural_key)
+  {
+    pair<Key, bool> result(next_key_, true);
+    if (!natural_key.empty())
+    {
+      auto pos = natural_keys_.emplace(table + "\t" + natural_key, next_key_);
+      if (!pos.second) // stored previously
+      {
+        result = make_pair(pos.first->second, false);
+      }
+    }
+    if (result.second) ++next_key_;
+    keys_[element] = result;
+    return result;
+  }
+
+
+  pair<OMSFileStore::Key, bool> OMSFileStore::registerRowKey_(
+    const void* element, sqlite3_stmt* lookup_query)
+  {
+    pair<Key, bool> result(next_key_, true);
+    // elements are unique within a batch, so only rows of previous batches can match:
+    if (previous_batches_)
+    {
+      int rc = sqlite3_step(lookup_query);
+      if (rc == SQLITE_ROW)
+      {
+        result = make_pair(Key(sqlite3_column_int64(lookup_query, 0)), false);
+      }
+      else if (rc != SQLITE_DONE)
+      {
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                      "error looking up stored data");
+      }
+      sqlite3_reset(lookup_query);
+    }
+    if (result.second) ++next_key_;
+    keys_[element] = result;
+    return result;
+  }
+
+
+  const pair<OMSFileStore::Key, bool>& OMSFileStore::lookupKey_(const void* element) const
+  {
+    auto pos = keys_.find(element);
+    if (pos == keys_.end())
+    {
+      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                                       "database key for referenced element");
+    }
+    return pos->second;
+  }
+
+
+  bool OMSFileStore::tableExists_(const String& name) const
+  {
+    return tables_.count(name) > 0;
+  }
+
+
+  void OMSFileStore::createTable_(const String& name, const String& definition)
+  {
+    if (!tables_.insert(name).second) return; // already created
+    String sql_create = "CREATE TABLE " + name + " (" + definition + ")";
+    execute_(sql_create, "error creating database table " + name);
   }
 
 
   void OMSFileStore::storeVersionAndDate_()
   {
+    if (tableExists_("version")) return; // written by a previous batch
+
     createTable_("version",
                  "OMSFile INT NOT NULL, "       \
                  "date TEXT NOT NULL, "         \
                  "OpenMS TEXT, "                \
                  "build_date TEXT");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO version VALUES ("  \
-                  ":format_version, "             \
-                  "datetime('now'), "             \
-                  ":openms_version, "             \
-                  ":build_date)");
-    query.bindValue(":format_version", version_number);
-    query.bindValue(":openms_version", VersionInfo::getVersion().toQString());
-    query.bindValue(":build_date", VersionInfo::getTime().toQString());
-    if (!query.exec())
-    {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+    sqlite3_stmt* query = prepareQuery_("version",
+                                        "INSERT INTO version VALUES ("  \
+                                        ":format_version, "             \
+                                        "datetime('now'), "             \
+                                        ":openms_version, "             \
+                                        ":build_date)");
+    bindValue(query, ":format_version", version_number);
+    bindValue(query, ":openms_version", VersionInfo::getVersion());
+    bindValue(query, ":build_date", VersionInfo::getTime());
+    if (!execQuery_(query))
+    {
+      raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                     "error inserting data");
     }
   }
@@ -163,17 +349,10 @@ namespace OpenMS::Internal
     createTable_("ID_MoleculeType",
                  "id INTEGER PRIMARY KEY NOT NULL, "    \
                  "molecule_type TEXT UNIQUE NOT NULL");
-    QString sql_insert =
-      "INSERT INTO ID_MoleculeType VALUES "     \
-      "(1, 'PROTEIN'), "                        \
-      "(2, 'COMPOUND'), "                       \
-      "(3, 'RNA')";
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    if (!query.exec(sql_insert))
-    {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
-                    "error inserting data");
-    }
+    execute_("INSERT INTO ID_MoleculeType VALUES "     \
+             "(1, 'PROTEIN'), "                        \
+             "(2, 'COMPOUND'), "                       \
+             "(3, 'RNA')", "error inserting data");
   }
 
 
@@ -182,20 +361,13 @@ namespace OpenMS::Internal
     createTable_("DataValue_DataType",
                  "id INTEGER PRIMARY KEY NOT NULL, "  \
                  "data_type TEXT UNIQUE NOT NULL");
-    QString sql_insert =
-      "INSERT INTO DataValue_DataType VALUES " \
-      "(1, 'STRING_VALUE'), "                  \
-      "(2, 'INT_VALUE'), "                     \
-      "(3, 'DOUBLE_VALUE'), "                  \
-      "(4, 'STRING_LIST'), "                   \
-      "(5, 'INT_LIST'), "                      \
-      "(6, 'DOUBLE_LIST')";
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    if (!query.exec(sql_insert))
-    {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
-                    "error inserting data");
-    }
+    execute_("INSERT INTO DataValue_DataType VALUES " \
+             "(1, 'STRING_VALUE'), "                  \
+             "(2, 'INT_VALUE'), "                     \
+             "(3, 'DOUBLE_VALUE'), "                  \
+             "(4, 'STRING_LIST'), "                   \
+             "(5, 'INT_LIST'), "                      \
+             "(6, 'DOUBLE_LIST')", "error inserting data");
     createTable_(
       "DataValue",
       "id INTEGER PRIMARY KEY NOT NULL, "                               \
@@ -204,11 +376,11 @@ namespace OpenMS::Internal
       "FOREIGN KEY (data_type_id) REFERENCES DataValue_DataType (id)");
     // @TODO: add support for units
     // prepare query for inserting data:
-    query.prepare("INSERT INTO DataValue VALUES ("           \
+    prepareQuery_("DataValue",
+                  "INSERT INTO DataValue VALUES ("           \
                   "NULL, "                                   \
                   ":data_type, "                             \
                   ":value)");
-    prepared_queries_["DataValue"] = query;
   }
 
 
@@ -216,22 +388,22 @@ namespace OpenMS::Internal
   {
     // this assumes the "DataValue" table exists already!
     // @TODO: split this up and make several tables for different types?
-    QSqlQuery& query = prepared_queries_["DataValue"];
+    sqlite3_stmt* query = getQuery_("DataValue");
     if (value.isEmpty()) // use NULL as the type for empty values
     {
-      query.bindValue(":data_type", QVariant(QVariant::Int));
+      bindNull(query, ":data_type");
     }
     else
     {
-      query.bindValue(":data_type", int(value.valueType()) + 1);
+      bindValue(query, ":data_type", int(value.valueType()) + 1);
     }
-    query.bindValue(":value", value.toQString());
-    if (!query.exec())
+    bindValue(query, ":value", value.toString());
+    if (!execQuery_(query))
     {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+      raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                     "error inserting data");
     }
-    return query.lastInsertId().toLongLong();
+    return sqlite3_last_insert_rowid(db_->getDB());
   }
 
 
@@ -246,68 +418,68 @@ namespace OpenMS::Internal
                  "UNIQUE (accession, name)");
     // @TODO: add support for unit and value
     // prepare query for inserting data:
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT OR IGNORE INTO CVTerm VALUES ("   \
+    prepareQuery_("CVTerm",
+                  "INSERT OR IGNORE INTO CVTerm VALUES ("   \
                   "NULL, "                                  \
                   ":accession, "                            \
                   ":name, "                                 \
                   ":cv_identifier_ref)");
-    prepared_queries_["CVTerm"] = query;
     // alternative query if CVTerm already exists:
-    query.prepare("SELECT id FROM CVTerm "                          \
+    prepareQuery_("CVTerm_2",
+                  "SELECT id FROM CVTerm "                          \
                   "WHERE accession = :accession AND name = :name");
-    prepared_queries_["CVTerm_2"] = query;
   }
 
 
   OMSFileStore::Key OMSFileStore::storeCVTerm_(const CVTerm& cv_term)
   {
     // this assumes the "CVTerm" table exists already!
-    QSqlQuery& query = prepared_queries_["CVTerm"];
+    sqlite3_stmt* query = getQuery_("CVTerm");
     if (cv_term.getAccession().empty()) // use NULL for empty accessions
     {
-      query.bindValue(":accession", QVariant(QVariant::String));
+      bindNull(query, ":accession");
     }
     else
     {
-      query.bindValue(":accession", cv_term.getAccession().toQString());
+      bindValue(query, ":accession", cv_term.getAccession());
     }
-    query.bindValue(":name", cv_term.getName().toQString());
-    query.bindValue(":cv_identifier_ref",
-                    cv_term.getCVIdentifierRef().toQString());
-    if (!query.exec())
+    bindValue(query, ":name", cv_term.getName());
+    bindValue(query, ":cv_identifier_ref", cv_term.getCVIdentifierRef());
+    if (!execQuery_(query))
     {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+      raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                     "error updating database");
     }
-    if (query.lastInsertId().isValid())
+    if (sqlite3_changes(db_->getDB()) > 0)
     {
-      return query.lastInsertId().toLongLong();
+      return sqlite3_last_insert_rowid(db_->getDB());
     }
-    // else: insert has failed, record must already exist - get the key:
-    QSqlQuery& alt_query = prepared_queries_["CVTerm_2"];
+    // else: insert was ignored, record must already exist - get the key:
+    sqlite3_stmt* alt_query = getQuery_("CVTerm_2");
     if (cv_term.getAccession().empty()) // use NULL for empty accessions
     {
-      alt_query.bindValue(":accession", QVariant(QVariant::String));
+      bindNull(alt_query, ":accession");
     }
     else
     {
-      alt_query.bindValue(":accession", cv_term.getAccession().toQString());
+      bindValue(alt_query, ":accession", cv_term.getAccession());
     }
-    alt_query.bindValue(":name", cv_term.getName().toQString());
-    if (!alt_query.exec() || !alt_query.next())
+    bindValue(alt_query, ":name", cv_term.getName());
+    if (sqlite3_step(alt_query) != SQLITE_ROW)
     {
-      raiseDBError_(alt_query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+      raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                     "error querying database");
     }
-    return alt_query.value(0).toLongLong();
+    Key id = sqlite3_column_int64(alt_query, 0);
+    sqlite3_reset(alt_query);
+    return id;
   }
 
 
   void OMSFileStore::createTableMetaInfo_(const String& parent_table,
                                           const String& key_column)
   {
-    if (!tableExists_(db_name_, "DataValue")) createTableDataValue_();
+    if (!tableExists_("DataValue")) createTableDataValue_();
 
     String parent_ref = parent_table + " (" + key_column + ")";
     String table = parent_table + "_MetaInfo";
@@ -321,12 +493,11 @@ namespace OpenMS::Internal
       "PRIMARY KEY (parent_id, name)");
 
     // prepare query for inserting data:
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO " + table.toQString() + " VALUES ("  \
-                  ":parent_id, "                                    \
-                  ":name, "                                         \
+    prepareQuery_(table,
+                  "INSERT INTO " + table + " VALUES ("  \
+                  ":parent_id, "                        \
+                  ":name, "                             \
                   ":data_value_id)");
-    prepared_queries_[table] = query;
   }
 
 
@@ -337,19 +508,19 @@ namespace OpenMS::Internal
     if (info.isMetaEmpty()) return;
 
     // this assumes the "..._MetaInfo" and "DataValue" tables exist already!
-    QSqlQuery& query = prepared_queries_[parent_table + "_MetaInfo"];
-    query.bindValue(":parent_id", parent_id);
+    sqlite3_stmt* query = getQuery_(parent_table + "_MetaInfo");
+    bindValue(query, ":parent_id", parent_id);
     // this is inefficient, but MetaInfoInterface doesn't support iteration:
     vector<String> info_keys;
     info.getKeys(info_keys);
     for (const String& info_key : info_keys)
     {
-      query.bindValue(":name", info_key.toQString());
+      bindValue(query, ":name", info_key);
       Key value_id = storeDataValue_(info.getMetaValue(info_key));
-      query.bindValue(":data_value_id", value_id);
-      if (!query.exec())
+      bindValue(query, ":data_value_id", value_id);
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -374,14 +545,13 @@ namespace OpenMS::Internal
     // @TODO: add constraint that "processing_step_order" must match "..._id"?
     // @TODO: normalize table? (splitting into multiple tables is awkward here)
     // prepare query for inserting data:
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO " + table.toQString() + " VALUES ("  \
-                  ":parent_id, "                                    \
-                  ":processing_step_id, "                           \
-                  ":processing_step_order, "                        \
-                  ":score_type_id, "                                \
+    prepareQuery_(table,
+                  "INSERT INTO " + table + " VALUES ("  \
+                  ":parent_id, "                        \
+                  ":processing_step_id, "               \
+                  ":processing_step_order, "            \
+                  ":score_type_id, "                    \
                   ":score)");
-    prepared_queries_[table] = query;
   }
 
 
@@ -390,35 +560,35 @@ namespace OpenMS::Internal
     const String& parent_table, Key parent_id)
   {
     // this assumes the "..._AppliedProcessingStep" table exists already!
-    QSqlQuery& query = prepared_queries_[parent_table + "_AppliedProcessingStep"];
-    query.bindValue(":parent_id", parent_id);
-    query.bindValue(":processing_step_order", int(step_order));
+    sqlite3_stmt* query = getQuery_(parent_table + "_AppliedProcessingStep");
+    bindValue(query, ":parent_id", parent_id);
+    bindValue(query, ":processing_step_order", int(step_order));
     if (step.processing_step_opt)
     {
-      query.bindValue(":processing_step_id",
-                      Key(&(**step.processing_step_opt)));
+      bindValue(query, ":processing_step_id",
+                getKey_(&(**step.processing_step_opt)));
       if (step.scores.empty()) // insert processing step information only
       {
-        query.bindValue(":score_type_id", QVariant(QVariant::Int)); // NULL
-        query.bindValue(":score", QVariant(QVariant::Double)); // NULL
-        if (!query.exec())
+        bindNull(query, ":score_type_id");
+        bindNull(query, ":score");
+        if (!execQuery_(query))
         {
-          raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+          raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                         "error inserting data");
         }
       }
     }
     else // use NULL for missing processing step reference
     {
-      query.bindValue(":processing_step_id", QVariant(QVariant::Int));
+      bindNull(query, ":processing_step_id");
     }
     for (const auto& score_pair : step.scores)
     {
-      query.bindValue(":score_type_id", Key(&(*score_pair.first)));
-      query.bindValue(":score", score_pair.second);
-      if (!query.exec())
+      bindValue(query, ":score_type_id", getKey_(&(*score_pair.first)));
+      bindValue(query, ":score", score_pair.second);
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -437,20 +607,25 @@ namespace OpenMS::Internal
       "higher_better NUMERIC NOT NULL CHECK (higher_better in (0, 1)), " \
       "FOREIGN KEY (cv_term_id) REFERENCES CVTerm (id)");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_ScoreType VALUES ("       \
-                  ":id, "                                   \
-                  ":cv_term_id, "                           \
-                  ":higher_better)");
+    sqlite3_stmt* query = prepareQuery_("ID_ScoreType",
+                                        "INSERT INTO ID_ScoreType VALUES (" \
+                                        ":id, "                             \
+                                        ":cv_term_id, "                     \
+                                        ":higher_better)");
     for (const ID::ScoreType& score_type : id_data.getScoreTypes())
     {
+      // score types are compared by CV term accession and name:
+      auto key = registerKey_(&score_type, "ID_ScoreType",
+                              score_type.cv_term.getAccession() + "\t" +
+                              score_type.cv_term.getName());
+      if (!key.second) continue;
       Key cv_id = storeCVTerm_(score_type.cv_term);
-      query.bindValue(":id", Key(&score_type)); // use address as primary key
-      query.bindValue(":cv_term_id", cv_id);
-      query.bindValue(":higher_better", int(score_type.higher_better));
-      if (!query.exec())
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":cv_term_id", cv_id);
+      bindValue(query, ":higher_better", int(score_type.higher_better));
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -467,24 +642,25 @@ namespace OpenMS::Internal
                  "experimental_design_id TEXT, "      \
                  "primary_files TEXT");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_InputFile VALUES ("  \
-                  ":id, "                              \
-                  ":name, "                            \
-                  ":experimental_design_id, "          \
-                  ":primary_files)");
+    sqlite3_stmt* query = prepareQuery_("ID_InputFile",
+                                        "INSERT INTO ID_InputFile VALUES (" \
+                                        ":id, "                             \
+                                        ":name, "                           \
+                                        ":experimental_design_id, "         \
+                                        ":primary_files)");
     for (const ID::InputFile& input : id_data.getInputFiles())
     {
-      query.bindValue(":id", Key(&input));
-      query.bindValue(":name", input.name.toQString());
-      query.bindValue(":experimental_design_id",
-                      input.experimental_design_id.toQString());
+      auto key = registerKey_(&input, "ID_InputFile", input.name);
+      if (!key.second) continue;
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":name", input.name);
+      bindValue(query, ":experimental_design_id", input.experimental_design_id);
       // @TODO: what if a primary file name contains ","?
       String primary_files = ListUtils::concatenate(input.primary_files);
-      query.bindValue(":primary_files", primary_files.toQString());
-      if (!query.exec())
+      bindValue(query, ":primary_files", primary_files);
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -501,21 +677,24 @@ namespace OpenMS::Internal
                  "version TEXT, "                     \
                  "UNIQUE (name, version)");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_ProcessingSoftware VALUES ("  \
-                  ":id, "                                           \
-                  ":name, "                                         \
-                  ":version)");
-    bool any_scores = false; // does any software have assigned scores stored?
+    sqlite3_stmt* query = prepareQuery_("ID_ProcessingSoftware",
+                                        "INSERT INTO ID_ProcessingSoftware VALUES (" \
+                                        ":id, "                                      \
+                                        ":name, "                                    \
+                                        ":version)");
+    bool any_scores = false; // does any (new) software have assigned scores?
     for (const ID::ProcessingSoftware& software : id_data.getProcessingSoftwares())
     {
+      auto key = registerKey_(&software, "ID_ProcessingSoftware",
+                              software.getName() + "\t" + software.getVersion());
+      if (!key.second) continue;
       if (!software.assigned_scores.empty()) any_scores = true;
-      query.bindValue(":id", Key(&software));
-      query.bindValue(":name", software.getName().toQString());
-      query.bindValue(":version", software.getVersion().toQString());
-      if (!query.exec())
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":name", software.getName());
+      bindValue(query, ":version", software.getVersion());
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -531,22 +710,25 @@ namespace OpenMS::Internal
         "FOREIGN KEY (software_id) REFERENCES ID_ProcessingSoftware (id), " \
         "FOREIGN KEY (score_type_id) REFERENCES ID_ScoreType (id)");
 
-      query.prepare(
+      query = prepareQuery_(
+        "ID_ProcessingSoftware_AssignedScore",
         "INSERT INTO ID_ProcessingSoftware_AssignedScore VALUES ("      \
         ":software_id, "                                                \
         ":score_type_id, "                                              \
         ":score_type_order)");
       for (const ID::ProcessingSoftware& software : id_data.getProcessingSoftwares())
       {
-        query.bindValue(":software_id", Key(&software));
+        const auto& key = lookupKey_(&software);
+        if (!key.second) continue;
+        bindValue(query, ":software_id", key.first);
         Size counter = 0;
         for (ID::ScoreTypeRef score_type_ref : software.assigned_scores)
         {
-          query.bindValue(":score_type_id", Key(&(*score_type_ref)));
-          query.bindValue(":score_type_order", int(++counter));
-          if (!query.exec())
+          bindValue(query, ":score_type_id", getKey_(&(*score_type_ref)));
+          bindValue(query, ":score_type_order", int(++counter));
+          if (!execQuery_(query))
           {
-            raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+            raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                           "error inserting data");
           }
         }
@@ -559,7 +741,7 @@ namespace OpenMS::Internal
   {
     if (id_data.getDBSearchParams().empty()) return;
 
-    if (!tableExists_(db_name_, "ID_MoleculeType")) createTableMoleculeType_();
+    if (!tableExists_("ID_MoleculeType")) createTableMoleculeType_();
 
     createTable_(
       "ID_DBSearchParam",
@@ -583,65 +765,82 @@ namespace OpenMS::Internal
       "max_length NUMERIC, "                                            \
       "FOREIGN KEY (molecule_type_id) REFERENCES ID_MoleculeType (id)");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_DBSearchParam VALUES (" \
-                  ":id, "                                 \
-                  ":molecule_type_id, "                   \
-                  ":mass_type_average, "                  \
-                  ":database, "                           \
-                  ":database_version, "                   \
-                  ":taxonomy, "                           \
-                  ":charges, "                            \
-                  ":fixed_mods, "                         \
-                  ":variable_mods, "                      \
-                  ":precursor_mass_tolerance, "           \
-                  ":fragment_mass_tolerance, "            \
-                  ":precursor_tolerance_ppm, "            \
-                  ":fragment_tolerance_ppm, "             \
-                  ":digestion_enzyme, "                   \
-                  ":enzyme_term_specificity, "            \
-                  ":missed_cleavages, "                   \
-                  ":min_length, "                         \
-                  ":max_length)");
+    sqlite3_stmt* query = prepareQuery_("ID_DBSearchParam",
+                                        "INSERT INTO ID_DBSearchParam VALUES (" \
+                                        ":id, "                                 \
+                                        ":molecule_type_id, "                   \
+                                        ":mass_type_average, "                  \
+                                        ":database, "                           \
+                                        ":database_version, "                   \
+                                        ":taxonomy, "                           \
+                                        ":charges, "                            \
+                                        ":fixed_mods, "                         \
+                                        ":variable_mods, "                      \
+                                        ":precursor_mass_tolerance, "           \
+                                        ":fragment_mass_tolerance, "            \
+                                        ":precursor_tolerance_ppm, "            \
+                                        ":fragment_tolerance_ppm, "             \
+                                        ":digestion_enzyme, "                   \
+                                        ":enzyme_term_specificity, "            \
+                                        ":missed_cleavages, "                   \
+                                        ":min_length, "                         \
+                                        ":max_length)");
     for (const ID::DBSearchParam& param : id_data.getDBSearchParams())
     {
-      query.bindValue(":id", Key(&param));
-      query.bindValue(":molecule_type_id", int(param.molecule_type) + 1);
-      query.bindValue(":mass_type_average", int(param.mass_type));
-      query.bindValue(":database", param.database.toQString());
-      query.bindValue(":database_version", param.database_version.toQString());
-      query.bindValue(":taxonomy", param.taxonomy.toQString());
       String charges = ListUtils::concatenate(param.charges, ",");
-      query.bindValue(":charges", charges.toQString());
       String fixed_mods = ListUtils::concatenate(param.fixed_mods, ",");
-      query.bindValue(":fixed_mods", fixed_mods.toQString());
       String variable_mods = ListUtils::concatenate(param.variable_mods, ",");
-      query.bindValue(":variable_mods", variable_mods.toQString());
-      query.bindValue(":precursor_mass_tolerance",
-                      param.precursor_mass_tolerance);
-      query.bindValue(":fragment_mass_tolerance",
-                      param.fragment_mass_tolerance);
-      query.bindValue(":precursor_tolerance_ppm",
-                      int(param.precursor_tolerance_ppm));
-      query.bindValue(":fragment_tolerance_ppm",
-                      int(param.fragment_tolerance_ppm));
+      String enzyme = (param.digestion_enzyme != nullptr) ?
+        param.digestion_enzyme->getName() : "";
+      String specificity =
+        EnzymaticDigestion::NamesOfSpecificity[param.enzyme_term_specificity];
+      // search parameters are compared by all their fields:
+      String natural_key = ListUtils::concatenate(
+        vector<String>{String(int(param.molecule_type)),
+                       String(int(param.mass_type)), param.database,
+                       param.database_version, param.taxonomy, charges,
+                       fixed_mods, variable_mods,
+                       String(param.precursor_mass_tolerance),
+                       String(param.fragment_mass_tolerance),
+                       String(int(param.precursor_tolerance_ppm)),
+                       String(int(param.fragment_tolerance_ppm)), enzyme,
+                       specificity, String(param.missed_cleavages),
+                       String(param.min_length), String(param.max_length)},
+        "\t");
+      auto key = registerKey_(&param, "ID_DBSearchParam", natural_key);
+      if (!key.second) continue;
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":molecule_type_id", int(param.molecule_type) + 1);
+      bindValue(query, ":mass_type_average", int(param.mass_type));
+      bindValue(query, ":database", param.database);
+      bindValue(query, ":database_version", param.database_version);
+      bindValue(query, ":taxonomy", param.taxonomy);
+      bindValue(query, ":charges", charges);
+      bindValue(query, ":fixed_mods", fixed_mods);
+      bindValue(query, ":variable_mods", variable_mods);
+      bindValue(query, ":precursor_mass_tolerance",
+                param.precursor_mass_tolerance);
+      bindValue(query, ":fragment_mass_tolerance",
+                param.fragment_mass_tolerance);
+      bindValue(query, ":precursor_tolerance_ppm",
+                int(param.precursor_tolerance_ppm));
+      bindValue(query, ":fragment_tolerance_ppm",
+                int(param.fragment_tolerance_ppm));
       if (param.digestion_enzyme != nullptr)
       {
-        query.bindValue(":digestion_enzyme",
-                        param.digestion_enzyme->getName().toQString());
+        bindValue(query, ":digestion_enzyme", enzyme);
       }
       else // bind NULL value
       {
-        query.bindValue(":digestion_enzyme", QVariant(QVariant::String));
+        bindNull(query, ":digestion_enzyme");
       }
-      query.bindValue(":enzyme_term_specificity",
-                      QString::fromStdString(EnzymaticDigestion::NamesOfSpecificity[param.enzyme_term_specificity]));
-      query.bindValue(":missed_cleavages", uint(param.missed_cleavages));
-      query.bindValue(":min_length", uint(param.min_length));
-      query.bindValue(":max_length", uint(param.max_length));
-      if (!query.exec())
+      bindValue(query, ":enzyme_term_specificity", specificity);
+      bindValue(query, ":missed_cleavages", Int64(param.missed_cleavages));
+      bindValue(query, ":min_length", Int64(param.min_length));
+      bindValue(query, ":max_length", Int64(param.max_length));
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -663,34 +862,44 @@ namespace OpenMS::Internal
     // @TODO: store primary files in a separate table (like input files)?
     // @TODO: store (optional) search param reference in a separate table?
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_ProcessingStep VALUES ("  \
-                  ":id, "                                       \
-                  ":software_id, "                              \
-                  ":date_time, "                                \
-                  ":search_param_id)");
+    sqlite3_stmt* query = prepareQuery_("ID_ProcessingStep",
+                                        "INSERT INTO ID_ProcessingStep VALUES (" \
+                                        ":id, "                                  \
+                                        ":software_id, "                         \
+                                        ":date_time, "                           \
+                                        ":search_param_id)");
     bool any_input_files = false;
     // use iterator here because we need one to look up the DB search params:
     for (ID::ProcessingStepRef step_ref = id_data.getProcessingSteps().begin();
          step_ref != id_data.getProcessingSteps().end(); ++step_ref)
     {
       const ID::ProcessingStep& step = *step_ref;
-      if (!step.input_file_refs.empty()) any_input_files = true;
-      query.bindValue(":id", Key(&step));
-      query.bindValue(":software_id", Key(&(*step.software_ref)));
-      query.bindValue(":date_time", step.date_time.get().toQString());
+      Key software_id = getKey_(&(*step.software_ref));
+      String date_time = step.date_time.get();
       auto pos = id_data.getDBSearchSteps().find(step_ref);
+      // processing steps are compared by software, date/time and input files:
+      String natural_key = String(software_id) + "\t" + date_time;
+      for (ID::InputFileRef input_file_ref : step.input_file_refs)
+      {
+        natural_key += "\t" + String(getKey_(&(*input_file_ref)));
+      }
+      auto key = registerKey_(&step, "ID_ProcessingStep", natural_key);
+      if (!key.second) continue;
+      if (!step.input_file_refs.empty()) any_input_files = true;
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":software_id", software_id);
+      bindValue(query, ":date_time", date_time);
       if (pos != id_data.getDBSearchSteps().end())
       {
-        query.bindValue(":search_param_id", Key(&(*pos->second)));
+        bindValue(query, ":search_param_id", getKey_(&(*pos->second)));
       }
       else
       {
-        query.bindValue(":search_param_id", QVariant(QVariant::Int)); // NULL
+        bindNull(query, ":search_param_id");
       }
-      if (!query.exec())
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -704,19 +913,22 @@ namespace OpenMS::Internal
         "FOREIGN KEY (input_file_id) REFERENCES ID_InputFile (id), "      \
         "UNIQUE (processing_step_id, input_file_id)");
 
-      query.prepare("INSERT INTO ID_ProcessingStep_InputFile VALUES (" \
-                    ":processing_step_id, "                             \
-                    ":input_file_id)");
+      query = prepareQuery_("ID_ProcessingStep_InputFile",
+                            "INSERT INTO ID_ProcessingStep_InputFile VALUES (" \
+                            ":processing_step_id, "                            \
+                            ":input_file_id)");
 
       for (const ID::ProcessingStep& step : id_data.getProcessingSteps())
       {
-        query.bindValue(":processing_step_id", Key(&step));
+        const auto& key = lookupKey_(&step);
+        if (!key.second) continue;
+        bindValue(query, ":processing_step_id", key.first);
         for (ID::InputFileRef input_file_ref : step.input_file_refs)
         {
-          query.bindValue(":input_file_id", Key(&(*input_file_ref)));
-          if (!query.exec())
+          bindValue(query, ":input_file_id", getKey_(&(*input_file_ref)));
+          if (!execQuery_(query))
           {
-            raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+            raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                           "error inserting data");
           }
         }
@@ -739,38 +951,46 @@ namespace OpenMS::Internal
                  "UNIQUE (data_id, input_file_id), "                    \
                  "FOREIGN KEY (input_file_id) REFERENCES ID_InputFile (id)");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_Observation VALUES (" \
-                  ":id, "                             \
-                  ":data_id, "                        \
-                  ":input_file_id, "                  \
-                  ":rt, "                             \
-                  ":mz)");
+    sqlite3_stmt* query = prepareQuery_("ID_Observation",
+                                        "INSERT INTO ID_Observation VALUES (" \
+                                        ":id, "                               \
+                                        ":data_id, "                          \
+                                        ":input_file_id, "                    \
+                                        ":rt, "                               \
+                                        ":mz)");
+    sqlite3_stmt* lookup = prepareQuery_("ID_Observation_lookup",
+                                         "SELECT id FROM ID_Observation WHERE " \
+                                         "data_id = :data_id AND input_file_id = :input_file_id");
     for (const ID::Observation& obs : id_data.getObservations())
     {
-      query.bindValue(":id", Key(&obs)); // use address as primary key
-      query.bindValue(":data_id", obs.data_id.toQString());
-      query.bindValue(":input_file_id", Key(&(*obs.input_file)));
+      Key input_file_id = getKey_(&(*obs.input_file));
+      bindValue(lookup, ":data_id", obs.data_id);
+      bindValue(lookup, ":input_file_id", input_file_id);
+      auto key = registerRowKey_(&obs, lookup);
+      if (!key.second) continue;
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":data_id", obs.data_id);
+      bindValue(query, ":input_file_id", input_file_id);
 
       if (obs.rt == obs.rt)
       {
-        query.bindValue(":rt", obs.rt);
+        bindValue(query, ":rt", obs.rt);
       }
       else // NaN
       {
-        query.bindValue(":rt", QVariant(QVariant::Double)); // NULL
+        bindNull(query, ":rt");
       }
       if (obs.mz == obs.mz)
       {
-        query.bindValue(":mz", obs.mz);
+        bindValue(query, ":mz", obs.mz);
       }
       else // NaN
       {
-        query.bindValue(":mz", QVariant(QVariant::Double)); // NULL
+        bindNull(query, ":mz");
       }
-      if (!query.exec())
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -782,7 +1002,7 @@ namespace OpenMS::Internal
   {
     if (id_data.getParentSequences().empty()) return;
 
-    if (!tableExists_(db_name_, "ID_MoleculeType")) createTableMoleculeType_();
+    if (!tableExists_("ID_MoleculeType")) createTableMoleculeType_();
 
     createTable_(
       "ID_ParentSequence",
@@ -795,27 +1015,32 @@ namespace OpenMS::Internal
       "is_decoy NUMERIC NOT NULL CHECK (is_decoy in (0, 1)) DEFAULT 0, " \
       "FOREIGN KEY (molecule_type_id) REFERENCES ID_MoleculeType (id)");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_ParentSequence VALUES ("  \
-                  ":id, "                                   \
-                  ":accession, "                            \
-                  ":molecule_type_id, "                     \
-                  ":sequence, "                             \
-                  ":description, "                          \
-                  ":coverage, "                             \
-                  ":is_decoy)");
+    sqlite3_stmt* query = prepareQuery_("ID_ParentSequence",
+                                        "INSERT INTO ID_ParentSequence VALUES (" \
+                                        ":id, "                                  \
+                                        ":accession, "                           \
+                                        ":molecule_type_id, "                    \
+                                        ":sequence, "                            \
+                                        ":description, "                         \
+                                        ":coverage, "                            \
+                                        ":is_decoy)");
+    sqlite3_stmt* lookup = prepareQuery_("ID_ParentSequence_lookup",
+                                         "SELECT id FROM ID_ParentSequence WHERE accession = :accession");
     for (const ID::ParentSequence& parent : id_data.getParentSequences())
     {
-      query.bindValue(":id", Key(&parent)); // use address as primary key
-      query.bindValue(":accession", parent.accession.toQString());
-      query.bindValue(":molecule_type_id", int(parent.molecule_type) + 1);
-      query.bindValue(":sequence", parent.sequence.toQString());
-      query.bindValue(":description", parent.description.toQString());
-      query.bindValue(":coverage", parent.coverage);
-      query.bindValue(":is_decoy", int(parent.is_decoy));
-      if (!query.exec())
+      bindValue(lookup, ":accession", parent.accession);
+      auto key = registerRowKey_(&parent, lookup);
+      if (!key.second) continue;
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":accession", parent.accession);
+      bindValue(query, ":molecule_type_id", int(parent.molecule_type) + 1);
+      bindValue(query, ":sequence", parent.sequence);
+      bindValue(query, ":description", parent.description);
+      bindValue(query, ":coverage", parent.coverage);
+      bindValue(query, ":is_decoy", int(parent.is_decoy));
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -849,76 +1074,78 @@ namespace OpenMS::Internal
       "FOREIGN KEY (group_id) REFERENCES ID_ParentGroup (id), " \
       "FOREIGN KEY (parent_id) REFERENCES ID_ParentSequence (id)");
 
-    QSqlDatabase db = QSqlDatabase::database(db_name_);
-    QSqlQuery query_grouping(db);
-    query_grouping.prepare("INSERT INTO ID_ParentGroupSet VALUES (" \
-                           ":id, "                                      \
-                           ":label, "                                   \
-                           ":grouping_order)");
-
-    QSqlQuery query_group(db);
-    query_group.prepare("INSERT INTO ID_ParentGroup VALUES ("  \
-                        ":id, "                                        \
-                        ":grouping_id, "                               \
-                        ":score_type_id, "                             \
-                        ":score)");
-
-    QSqlQuery query_parent(db);
-    query_parent.prepare(
-      "INSERT INTO ID_ParentGroup_ParentSequence VALUES ("   \
-      ":group_id, "                                                  \
-      ":parent_id)");
-
-    Size counter = 0;
+    sqlite3_stmt* query_grouping =
+      prepareQuery_("ID_ParentGroupSet",
+                    "INSERT INTO ID_ParentGroupSet VALUES (" \
+                    ":id, "                                  \
+                    ":label, "                               \
+                    ":grouping_order)");
+
+    sqlite3_stmt* query_group =
+      prepareQuery_("ID_ParentGroup",
+                    "INSERT INTO ID_ParentGroup VALUES ("  \
+                    ":id, "                                \
+                    ":grouping_id, "                       \
+                    ":score_type_id, "                     \
+                    ":score)");
+
+    sqlite3_stmt* query_parent =
+      prepareQuery_("ID_ParentGroup_ParentSequence",
+                    "INSERT INTO ID_ParentGroup_ParentSequence VALUES (" \
+                    ":group_id, "                                        \
+                    ":parent_id)");
+
+    // groupings are not merged between batches - they are always appended:
     for (const ID::ParentGroupSet& grouping : id_data.getParentGroupSets())
     {
-      Key grouping_id = Key(&grouping);
-      query_grouping.bindValue(":id", grouping_id);
-      query_grouping.bindValue(":label", grouping.label.toQString());
-      query_grouping.bindValue(":grouping_order", int(++counter));
-      if (!query_grouping.exec())
+      Key grouping_id = registerKey_(&grouping, "ID_ParentGroupSet").first;
+      bindValue(query_grouping, ":id", grouping_id);
+      bindValue(query_grouping, ":label", grouping.label);
+      bindValue(query_grouping, ":grouping_order", int(++grouping_counter_));
+      if (!execQuery_(query_grouping))
       {
-        raiseDBError_(query_grouping.lastError(), __LINE__,
-                      OPENMS_PRETTY_FUNCTION, "error inserting data");
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                      "error inserting data");
       }
 
       for (const ID::ParentGroup& group : grouping.groups)
       {
-        Key group_id = Key(&group);
-        query_group.bindValue(":id", group_id);
-        query_group.bindValue(":grouping_id", grouping_id);
+        Key group_id = registerKey_(&group, "ID_ParentGroup").first;
+        bindValue(query_group, ":id", group_id);
+        bindValue(query_group, ":grouping_id", grouping_id);
         if (group.scores.empty()) // store group with an empty score
         {
-          query_group.bindValue(":score_type_id", QVariant(QVariant::Int));
-          query_group.bindValue(":score", QVariant(QVariant::Double));
-          if (!query_group.exec())
+          bindNull(query_group, ":score_type_id");
+          bindNull(query_group, ":score");
+          if (!execQuery_(query_group))
           {
-            raiseDBError_(query_group.lastError(), __LINE__,
-                          OPENMS_PRETTY_FUNCTION, "error inserting data");
+            raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                          "error inserting data");
           }
         }
         else // store group multiple times with different scores
         {
           for (const auto& score_pair : group.scores)
           {
-            query_group.bindValue(":score_type_id", Key(&(*score_pair.first)));
-            query_group.bindValue(":score", score_pair.second);
-            if (!query_group.exec())
+            bindValue(query_group, ":score_type_id",
+                      getKey_(&(*score_pair.first)));
+            bindValue(query_group, ":score", score_pair.second);
+            if (!execQuery_(query_group))
             {
-              raiseDBError_(query_group.lastError(), __LINE__,
-                            OPENMS_PRETTY_FUNCTION, "error inserting data");
+              raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                            "error inserting data");
             }
           }
         }
 
-        query_parent.bindValue(":group_id", group_id);
+        bindValue(query_parent, ":group_id", group_id);
         for (ID::ParentSequenceRef parent_ref : group.parent_refs)
         {
-          query_parent.bindValue(":parent_id", Key(&(*parent_ref)));
-          if (!query_parent.exec())
+          bindValue(query_parent, ":parent_id", getKey_(&(*parent_ref)));
+          if (!execQuery_(query_parent))
           {
-            raiseDBError_(query_parent.lastError(), __LINE__,
-                          OPENMS_PRETTY_FUNCTION, "error inserting data");
+            raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                          "error inserting data");
           }
         }
       }
@@ -930,7 +1157,7 @@ namespace OpenMS::Internal
 
   void OMSFileStore::createTableIdentifiedMolecule_()
   {
-    if (!tableExists_(db_name_, "ID_MoleculeType")) createTableMoleculeType_();
+    if (!tableExists_("ID_MoleculeType")) createTableMoleculeType_();
 
     // use one table for all types of identified molecules to allow foreign key
     // references from the input match table:
@@ -941,13 +1168,15 @@ namespace OpenMS::Internal
       "identifier TEXT NOT NULL, "                                      \
       "UNIQUE (molecule_type_id, identifier), "                         \
       "FOREIGN KEY (molecule_type_id) REFERENCES ID_MoleculeType (id)");
-    // prepare query for inserting data:
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_IdentifiedMolecule VALUES ("          \
-                  ":id, "                                               \
-                  ":molecule_type_id, "                                 \
+    // prepare queries for inserting and looking up data:
+    prepareQuery_("ID_IdentifiedMolecule",
+                  "INSERT INTO ID_IdentifiedMolecule VALUES ("  \
+                  ":id, "                                       \
+                  ":molecule_type_id, "                         \
                   ":identifier)");
-    prepared_queries_["ID_IdentifiedMolecule"] = query;
+    prepareQuery_("ID_IdentifiedMolecule_lookup",
+                  "SELECT id FROM ID_IdentifiedMolecule WHERE " \
+                  "molecule_type_id = :molecule_type_id AND identifier = :identifier");
   }
 
 
@@ -955,13 +1184,15 @@ namespace OpenMS::Internal
   {
     if (id_data.getIdentifiedCompounds().empty()) return;
 
-    if (!tableExists_(db_name_, "ID_IdentifiedMolecule"))
+    if (!tableExists_("ID_IdentifiedMolecule"))
     {
       createTableIdentifiedMolecule_();
     }
-    QSqlQuery& query_molecule = prepared_queries_["ID_IdentifiedMolecule"];
-    query_molecule.bindValue(":molecule_type_id",
-                             int(ID::MoleculeType::COMPOUND) + 1);
+    sqlite3_stmt* query_molecule = getQuery_("ID_IdentifiedMolecule");
+    sqlite3_stmt* lookup = getQuery_("ID_IdentifiedMolecule_lookup");
+    int molecule_type_id = int(ID::MoleculeType::COMPOUND) + 1;
+    bindValue(query_molecule, ":molecule_type_id", molecule_type_id);
+    bindValue(lookup, ":molecule_type_id", molecule_type_id);
 
     createTable_(
       "ID_IdentifiedCompound",
@@ -971,33 +1202,35 @@ namespace OpenMS::Internal
       "smile TEXT, "                                                    \
       "inchi TEXT, "                                                    \
       "FOREIGN KEY (molecule_id) REFERENCES ID_IdentifiedMolecule (id)");
-    QSqlQuery query_compound(QSqlDatabase::database(db_name_));
-    query_compound.prepare("INSERT INTO ID_IdentifiedCompound VALUES (" \
-                           ":molecule_id, "                             \
-                           ":formula, "                                 \
-                           ":name, "                                    \
-                           ":smile, "                                   \
-                           ":inchi)");
+    sqlite3_stmt* query_compound =
+      prepareQuery_("ID_IdentifiedCompound",
+                    "INSERT INTO ID_IdentifiedCompound VALUES (" \
+                    ":molecule_id, "                             \
+                    ":formula, "                                 \
+                    ":name, "                                    \
+                    ":smile, "                                   \
+                    ":inchi)");
     for (const ID::IdentifiedCompound& compound : id_data.getIdentifiedCompounds())
     {
-      // use address as primary key:
-      query_molecule.bindValue(":id", Key(&compound));
-      query_molecule.bindValue(":identifier", compound.identifier.toQString());
-      if (!query_molecule.exec())
+      bindValue(lookup, ":identifier", compound.identifier);
+      auto key = registerRowKey_(&compound, lookup);
+      if (!key.second) continue;
+      bindValue(query_molecule, ":id", key.first);
+      bindValue(query_molecule, ":identifier", compound.identifier);
+      if (!execQuery_(query_molecule))
       {
-        raiseDBError_(query_molecule.lastError(), __LINE__,
-                      OPENMS_PRETTY_FUNCTION, "error inserting data");
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                      "error inserting data");
       }
-      query_compound.bindValue(":molecule_id", Key(&compound));
-      query_compound.bindValue(":formula",
-                               compound.formula.toString().toQString());
-      query_compound.bindValue(":name", compound.name.toQString());
-      query_compound.bindValue(":smile", compound.name.toQString());
-      query_compound.bindValue(":inchi", compound.inchi.toQString());
-      if (!query_compound.exec())
+      bindValue(query_compound, ":molecule_id", key.first);
+      bindValue(query_compound, ":formula", compound.formula.toString());
+      bindValue(query_compound, ":name", compound.name);
+      bindValue(query_compound, ":smile", compound.name);
+      bindValue(query_compound, ":inchi", compound.inchi);
+      if (!execQuery_(query_compound))
       {
-        raiseDBError_(query_compound.lastError(), __LINE__,
-                      OPENMS_PRETTY_FUNCTION, "error inserting data");
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                      "error inserting data");
       }
     }
     storeScoredProcessingResults_(id_data.getIdentifiedCompounds(),
@@ -1010,39 +1243,51 @@ namespace OpenMS::Internal
     if (id_data.getIdentifiedPeptides().empty() &&
         id_data.getIdentifiedOligos().empty()) return;
 
-    if (!tableExists_(db_name_, "ID_IdentifiedMolecule"))
+    if (!tableExists_("ID_IdentifiedMolecule"))
     {
       createTableIdentifiedMolecule_();
     }
-    QSqlQuery& query = prepared_queries_["ID_IdentifiedMolecule"];
+    sqlite3_stmt* query = getQuery_("ID_IdentifiedMolecule");
+    sqlite3_stmt* lookup = getQuery_("ID_IdentifiedMolecule_lookup");
 
     bool any_parent_matches = false;
     // store peptides:
-    query.bindValue(":molecule_type_id", int(ID::MoleculeType::PROTEIN) + 1);
+    int molecule_type_id = int(ID::MoleculeType::PROTEIN) + 1;
+    bindValue(query, ":molecule_type_id", molecule_type_id);
+    bindValue(lookup, ":molecule_type_id", molecule_type_id);
     for (const ID::IdentifiedPeptide& peptide : id_data.getIdentifiedPeptides())
     {
+      String identifier = peptide.sequence.toString();
+      bindValue(lookup, ":identifier", identifier);
+      auto key = registerRowKey_(&peptide, lookup);
+      if (!key.second) continue;
       if (!peptide.parent_matches.empty()) any_parent_matches = true;
-      query.bindValue(":id", Key(&peptide)); // use address as primary key
-      query.bindValue(":identifier", peptide.sequence.toString().toQString());
-      if (!query.exec())
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":identifier", identifier);
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
     storeScoredProcessingResults_(id_data.getIdentifiedPeptides(),
                                   "ID_IdentifiedMolecule");
     // store RNA oligos:
-    query.bindValue(":molecule_type_id", int(ID::MoleculeType::RNA) + 1);
+    molecule_type_id = int(ID::MoleculeType::RNA) + 1;
+    bindValue(query, ":molecule_type_id", molecule_type_id);
+    bindValue(lookup, ":molecule_type_id", molecule_type_id);
     for (const ID::IdentifiedOligo& oligo : id_data.getIdentifiedOligos())
     {
+      String identifier = oligo.sequence.toString();
+      bindValue(lookup, ":identifier", identifier);
+      auto key = registerRowKey_(&oligo, lookup);
+      if (!key.second) continue;
       if (!oligo.parent_matches.empty()) any_parent_matches = true;
-      query.bindValue(":id", Key(&oligo)); // use address as primary key
-      query.bindValue(":identifier",
-                      QString::fromStdString(oligo.sequence.toString()));
-      if (!query.exec())
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":identifier", identifier);
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -1055,12 +1300,14 @@ namespace OpenMS::Internal
       for (const ID::IdentifiedPeptide& peptide : id_data.getIdentifiedPeptides())
       {
         if (peptide.parent_matches.empty()) continue;
-        storeParentMatches_(peptide.parent_matches, Key(&peptide));
+        const auto& key = lookupKey_(&peptide);
+        if (key.second) storeParentMatches_(peptide.parent_matches, key.first);
       }
       for (const ID::IdentifiedOligo& oligo : id_data.getIdentifiedOligos())
       {
         if (oligo.parent_matches.empty()) continue;
-        storeParentMatches_(oligo.parent_matches, Key(&oligo));
+        const auto& key = lookupKey_(&oligo);
+        if (key.second) storeParentMatches_(oligo.parent_matches, key.first);
       }
     }
   }
@@ -1080,15 +1327,14 @@ namespace OpenMS::Internal
       "FOREIGN KEY (parent_id) REFERENCES ID_ParentSequence (id), "     \
       "FOREIGN KEY (molecule_id) REFERENCES ID_IdentifiedMolecule (id)");
     // prepare query for inserting data:
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_ParentMatch VALUES ("         \
+    prepareQuery_("ID_ParentMatch",
+                  "INSERT INTO ID_ParentMatch VALUES ("         \
                   ":molecule_id, "                              \
                   ":parent_id, "                                \
                   ":start_pos, "                                \
                   ":end_pos, "                                  \
                   ":left_neighbor, "                            \
                   ":right_neighbor)");
-    prepared_queries_["ID_ParentMatch"] = query;
   }
 
 
@@ -1096,35 +1342,34 @@ namespace OpenMS::Internal
                                          Key molecule_id)
   {
     // this assumes the "ID_ParentMatch" table exists already!
-    QSqlQuery& query = prepared_queries_["ID_ParentMatch"];
-    // @TODO: cache the prepared query between function calls somehow?
-    query.bindValue(":molecule_id", molecule_id);
+    sqlite3_stmt* query = getQuery_("ID_ParentMatch");
+    bindValue(query, ":molecule_id", molecule_id);
     for (const auto& pair : matches)
     {
-      query.bindValue(":parent_id", Key(&(*pair.first)));
+      bindValue(query, ":parent_id", getKey_(&(*pair.first)));
       for (const auto& match : pair.second)
       {
         if (match.start_pos != ID::ParentMatch::UNKNOWN_POSITION)
         {
-          query.bindValue(":start_pos", uint(match.start_pos));
+          bindValue(query, ":start_pos", Int64(match.start_pos));
         }
         else // use NULL value
         {
-          query.bindValue(":start_pos", QVariant(QVariant::Int));
+          bindNull(query, ":start_pos");
         }
         if (match.end_pos != ID::ParentMatch::UNKNOWN_POSITION)
         {
-          query.bindValue(":end_pos", uint(match.end_pos));
+          bindValue(query, ":end_pos", Int64(match.end_pos));
         }
         else // use NULL value
         {
-          query.bindValue(":end_pos", QVariant(QVariant::Int));
+          bindNull(query, ":end_pos");
         }
-        query.bindValue(":left_neighbor", match.left_neighbor.toQString());
-        query.bindValue(":right_neighbor", match.right_neighbor.toQString());
-        if (!query.exec())
+        bindValue(query, ":left_neighbor", match.left_neighbor);
+        bindValue(query, ":right_neighbor", match.right_neighbor);
+        if (!execQuery_(query))
         {
-          raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+          raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                         "error inserting data");
         }
       }
@@ -1145,39 +1390,43 @@ namespace OpenMS::Internal
       "mol_multiplier INTEGER NOT NULL CHECK (mol_multiplier > 0) DEFAULT 1, " \
       "UNIQUE (formula, charge)");
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO AdductInfo VALUES (" \
-                  ":id, "                           \
-                  ":name, "                         \
-                  ":formula, "                      \
-                  ":charge, "                       \
-                  ":mol_multiplier)");
+    sqlite3_stmt* query = prepareQuery_("AdductInfo",
+                                        "INSERT INTO AdductInfo VALUES (" \
+                                        ":id, "                           \
+                                        ":name, "                         \
+                                        ":formula, "                      \
+                                        ":charge, "                       \
+                                        ":mol_multiplier)");
     for (const AdductInfo& adduct : id_data.getAdducts())
     {
-      query.bindValue(":id", Key(&adduct));
-      query.bindValue(":name", adduct.getName().toQString());
-      query.bindValue(":formula", adduct.getEmpiricalFormula().toString().toQString());
-      query.bindValue(":charge", adduct.getCharge());
-      query.bindValue(":mol_multiplier", adduct.getMolMultiplier());
-      if (!query.exec())
+      String formula = adduct.getEmpiricalFormula().toString();
+      auto key = registerKey_(&adduct, "AdductInfo",
+                              formula + "\t" + String(adduct.getCharge()));
+      if (!key.second) continue;
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":name", adduct.getName());
+      bindValue(query, ":formula", formula);
+      bindValue(query, ":charge", adduct.getCharge());
+      bindValue(query, ":mol_multiplier", int(adduct.getMolMultiplier()));
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
   }
 
 
-  OMSFileStore::Key OMSFileStore::getAddress_(const ID::IdentifiedMolecule& molecule_var)
+  OMSFileStore::Key OMSFileStore::getAddress_(const ID::IdentifiedMolecule& molecule_var) const
   {
     switch (molecule_var.getMoleculeType())
     {
       case ID::MoleculeType::PROTEIN:
-        return Key(&(*molecule_var.getIdentifiedPeptideRef()));
+        return getKey_(&(*molecule_var.getIdentifiedPeptideRef()));
       case ID::MoleculeType::COMPOUND:
-        return Key(&(*molecule_var.getIdentifiedCompoundRef()));
+        return getKey_(&(*molecule_var.getIdentifiedCompoundRef()));
       case ID::MoleculeType::RNA:
-        return Key(&(*molecule_var.getIdentifiedOligoRef()));
+        return getKey_(&(*molecule_var.getIdentifiedOligoRef()));
       default:
         throw Exception::NotImplemented(__FILE__, __LINE__,
                                         OPENMS_PRETTY_FUNCTION);
@@ -1195,42 +1444,64 @@ namespace OpenMS::Internal
       "observation_id INTEGER NOT NULL, "                               \
       "adduct_id INTEGER, "                                             \
       "charge INTEGER, "                                                \
+      "UNIQUE (identified_molecule_id, observation_id, adduct_id), "    \
       "FOREIGN KEY (identified_molecule_id) REFERENCES ID_IdentifiedMolecule (id), " \
       "FOREIGN KEY (observation_id) REFERENCES ID_Observation (id)";
     // add foreign key constraint if the adduct table exists (having the
     // constraint without the table would cause an error on data insertion):
-    if (tableExists_(db_name_, "AdductInfo"))
+    if (tableExists_("AdductInfo"))
     {
       table_def += ", FOREIGN KEY (adduct_id) REFERENCES AdductInfo (id)";
     }
     createTable_("ID_ObservationMatch", table_def);
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO ID_ObservationMatch VALUES ("    \
-                  ":id, "                                       \
-                  ":identified_molecule_id, "                   \
-                  ":observation_id, "                           \
-                  ":adduct_id, "                                \
-                  ":charge)");
+    sqlite3_stmt* query = prepareQuery_("ID_ObservationMatch",
+                                        "INSERT INTO ID_ObservationMatch VALUES (" \
+                                        ":id, "                                    \
+                                        ":identified_molecule_id, "                \
+                                        ":observation_id, "                        \
+                                        ":adduct_id, "                             \
+                                        ":charge)");
+    // "IS" also matches NULL (no adduct):
+    sqlite3_stmt* lookup = prepareQuery_("ID_ObservationMatch_lookup",
+                                         "SELECT id FROM ID_ObservationMatch WHERE "        \
+                                         "identified_molecule_id = :identified_molecule_id " \
+                                         "AND observation_id = :observation_id "             \
+                                         "AND adduct_id IS :adduct_id");
     bool any_peak_annotations = false;
     for (const ID::ObservationMatch& match : id_data.getObservationMatches())
     {
+      Key molecule_id = getAddress_(match.identified_molecule_var);
+      Key observation_id = getKey_(&(*match.observation_ref));
+      // matches are compared by molecule, observation and adduct:
+      bindValue(lookup, ":identified_molecule_id", molecule_id);
+      bindValue(lookup, ":observation_id", observation_id);
+      if (match.adduct_opt)
+      {
+        bindValue(lookup, ":adduct_id", getKey_(&(**match.adduct_opt)));
+      }
+      else
+      {
+        bindNull(lookup, ":adduct_id");
+      }
+      auto key = registerRowKey_(&match, lookup);
+      if (!key.second) continue;
       if (!match.peak_annotations.empty()) any_peak_annotations = true;
-      query.bindValue(":id", Key(&match)); // use address as primary key
-      query.bindValue(":identified_molecule_id", getAddress_(match.identified_molecule_var));
-      query.bindValue(":observation_id", Key(&(*match.observation_ref)));
+      bindValue(query, ":id", key.first);
+      bindValue(query, ":identified_molecule_id", molecule_id);
+      bindValue(query, ":observation_id", observation_id);
       if (match.adduct_opt)
       {
-        query.bindValue(":adduct_id", Key(&(**match.adduct_opt)));
+        bindValue(query, ":adduct_id", getKey_(&(**match.adduct_opt)));
       }
       else // bind NULL value
       {
-        query.bindValue(":adduct_id", QVariant(QVariant::Int));
+        bindNull(query, ":adduct_id");
       }
-      query.bindValue(":charge", match.charge);
-      if (!query.exec())
+      bindValue(query, ":charge", match.charge);
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
     }
@@ -1238,6 +1509,7 @@ namespace OpenMS::Internal
 
     if (any_peak_annotations)
     {
+      // index on "parent_id" is created at the end (see "close"):
       createTable_(
         "ID_ObservationMatch_PeakAnnotation",
         "parent_id INTEGER NOT NULL, "                                  \
@@ -1249,7 +1521,8 @@ namespace OpenMS::Internal
         "FOREIGN KEY (parent_id) REFERENCES ID_ObservationMatch (id), " \
         "FOREIGN KEY (processing_step_id) REFERENCES ID_ProcessingStep (id)");
 
-      query.prepare(
+      query = prepareQuery_(
+        "ID_ObservationMatch_PeakAnnotation",
         "INSERT INTO ID_ObservationMatch_PeakAnnotation VALUES (" \
         ":parent_id, "                                              \
         ":processing_step_id, "                                     \
@@ -1261,44 +1534,41 @@ namespace OpenMS::Internal
       for (const ID::ObservationMatch& match : id_data.getObservationMatches())
       {
         if (match.peak_annotations.empty()) continue;
-        query.bindValue(":parent_id", Key(&match));
+        const auto& key = lookupKey_(&match);
+        if (!key.second) continue;
+        bindValue(query, ":parent_id", key.first);
         for (const auto& pair : match.peak_annotations)
         {
           if (pair.first) // processing step given
           {
-            query.bindValue(":processing_step_id", Key(&(**pair.first)));
+            bindValue(query, ":processing_step_id", getKey_(&(**pair.first)));
           }
           else // use NULL value
           {
-            query.bindValue(":processing_step_id", QVariant(QVariant::Int));
+            bindNull(query, ":processing_step_id");
           }
           for (const auto& peak_ann : pair.second)
           {
-            query.bindValue(":peak_annotation",
-                            peak_ann.annotation.toQString());
-            query.bindValue(":peak_charge", peak_ann.charge);
-            query.bindValue(":peak_mz", peak_ann.mz);
-            query.bindValue(":peak_intensity", peak_ann.intensity);
-            if (!query.exec())
+            bindValue(query, ":peak_annotation", peak_ann.annotation);
+            bindValue(query, ":peak_charge", peak_ann.charge);
+            bindValue(query, ":peak_mz", double(peak_ann.mz));
+            bindValue(query, ":peak_intensity", double(peak_ann.intensity));
+            if (!execQuery_(query))
             {
-              raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+              raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                             "error inserting data");
             }
           }
         }
       }
     }
-    // create index on parent_id column
-    query.exec("CREATE INDEX PeakAnnotation_parent_id ON ID_ObservationMatch_PeakAnnotation (parent_id)");
   }
 
 
-  void OMSFileStore::store(const IdentificationData& id_data)
+  void OMSFileStore::storeIdentificationData_(const IdentificationData& id_data)
   {
-    QSqlDatabase db = QSqlDatabase::database(db_name_);
     startProgress(0, 13, "Writing identification data to file");
     // generally, create tables only if we have data to write - no empty ones!
-    db.transaction(); // avoid SQLite's "implicit transactions", improve runtime
     storeVersionAndDate_();
     nextProgress(); // 1
     storeInputFiles_(id_data);
@@ -1324,45 +1594,52 @@ namespace OpenMS::Internal
     storeAdducts_(id_data);
     nextProgress(); // 12
     storeObservationMatches_(id_data);
-    db.commit();
     endProgress();
     // @TODO: store input match groups
   }
 
 
+  void OMSFileStore::store(const IdentificationData& id_data)
+  {
+    beginTransaction_();
+    storeIdentificationData_(id_data);
+    commitTransaction_();
+  }
+
+
   void OMSFileStore::storeFeatureAndSubordinates_(
     const Feature& feature, int& feature_id, int parent_id)
   {
-    QSqlQuery& query_feat = prepared_queries_["FEAT_Feature"];
-    query_feat.bindValue(":id", feature_id);
-    query_feat.bindValue(":rt", feature.getRT());
-    query_feat.bindValue(":mz", feature.getMZ());
-    query_feat.bindValue(":intensity", feature.getIntensity());
-    query_feat.bindValue(":charge", feature.getCharge());
-    query_feat.bindValue(":width", feature.getWidth());
-    query_feat.bindValue(":overall_quality", feature.getOverallQuality());
-    query_feat.bindValue(":rt_quality", feature.getQuality(0));
-    query_feat.bindValue(":mz_quality", feature.getQuality(1));
-    query_feat.bindValue(":unique_id", qint64(feature.getUniqueId()));
+    sqlite3_stmt* query_feat = getQuery_("FEAT_Feature");
+    bindValue(query_feat, ":id", feature_id);
+    bindValue(query_feat, ":rt", feature.getRT());
+    bindValue(query_feat, ":mz", feature.getMZ());
+    bindValue(query_feat, ":intensity", double(feature.getIntensity()));
+    bindValue(query_feat, ":charge", feature.getCharge());
+    bindValue(query_feat, ":width", double(feature.getWidth()));
+    bindValue(query_feat, ":overall_quality", double(feature.getOverallQuality()));
+    bindValue(query_feat, ":rt_quality", double(feature.getQuality(0)));
+    bindValue(query_feat, ":mz_quality", double(feature.getQuality(1)));
+    bindValue(query_feat, ":unique_id", Int64(feature.getUniqueId()));
     if (feature.hasPrimaryID())
     {
-      query_feat.bindValue(":primary_molecule_id", getAddress_(feature.getPrimaryID()));
+      bindValue(query_feat, ":primary_molecule_id", getAddress_(feature.getPrimaryID()));
     }
     else // use NULL value
     {
-      query_feat.bindValue(":primary_molecule_id", QVariant(QVariant::Int));
+      bindNull(query_feat, ":primary_molecule_id");
     }
     if (parent_id >= 0) // feature is a subordinate
     {
-      query_feat.bindValue(":subordinate_of", parent_id);
+      bindValue(query_feat, ":subordinate_of", parent_id);
     }
     else // use NULL value
     {
-      query_feat.bindValue(":subordinate_of", QVariant(QVariant::Int));
+      bindNull(query_feat, ":subordinate_of");
     }
-    if (!query_feat.exec())
+    if (!execQuery_(query_feat))
     {
-      raiseDBError_(query_feat.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+      raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                     "error inserting data");
     }
     storeMetaInfo_(feature, "FEAT_Feature", feature_id);
@@ -1370,21 +1647,21 @@ namespace OpenMS::Internal
     const vector<ConvexHull2D>& hulls = feature.getConvexHulls();
     if (!hulls.empty())
     {
-      QSqlQuery& query_hull = prepared_queries_["FEAT_ConvexHull"];
-      query_hull.bindValue(":feature_id", feature_id);
+      sqlite3_stmt* query_hull = getQuery_("FEAT_ConvexHull");
+      bindValue(query_hull, ":feature_id", feature_id);
       for (uint i = 0; i < hulls.size(); ++i)
       {
-        query_hull.bindValue(":hull_index", i);
+        bindValue(query_hull, ":hull_index", int(i));
         for (uint j = 0; j < hulls[i].getHullPoints().size(); ++j)
         {
           const ConvexHull2D::PointType& point = hulls[i].getHullPoints()[j];
-          query_hull.bindValue(":point_index", j);
-          query_hull.bindValue(":point_x", point.getX());
-          query_hull.bindValue(":point_y", point.getY());
-          if (!query_hull.exec())
+          bindValue(query_hull, ":point_index", int(j));
+          bindValue(query_hull, ":point_x", point.getX());
+          bindValue(query_hull, ":point_y", point.getY());
+          if (!execQuery_(query_hull))
           {
-            raiseDBError_(query_hull.lastError(), __LINE__,
-                          OPENMS_PRETTY_FUNCTION, "error inserting data");
+            raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                          "error inserting data");
           }
         }
 
@@ -1393,15 +1670,15 @@ namespace OpenMS::Internal
     // store ID input items:
     if (!feature.getIDMatches().empty())
     {
-      QSqlQuery& query_match = prepared_queries_["FEAT_ObservationMatch"];
-      query_match.bindValue(":feature_id", feature_id);
+      sqlite3_stmt* query_match = getQuery_("FEAT_ObservationMatch");
+      bindValue(query_match, ":feature_id", feature_id);
       for (ID::ObservationMatchRef ref : feature.getIDMatches())
       {
-        query_match.bindValue(":observation_match_id", Key(&(*ref)));
-        if (!query_match.exec())
+        bindValue(query_match, ":observation_match_id", getKey_(&(*ref)));
+        if (!execQuery_(query_match))
         {
-          raiseDBError_(query_match.lastError(), __LINE__,
-                        OPENMS_PRETTY_FUNCTION, "error inserting data");
+          raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
+                        "error inserting data");
         }
       }
     }
@@ -1436,8 +1713,8 @@ namespace OpenMS::Internal
                  "FOREIGN KEY (subordinate_of) REFERENCES FEAT_Feature (id), " \
                  "CHECK (id > subordinate_of)"); // check to prevent cycles
 
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO FEAT_Feature VALUES ("      \
+    prepareQuery_("FEAT_Feature",
+                  "INSERT INTO FEAT_Feature VALUES ("      \
                   ":id, "                                  \
                   ":rt, "                                  \
                   ":mz, "                                  \
@@ -1450,7 +1727,6 @@ namespace OpenMS::Internal
                   ":unique_id, "                           \
                   ":primary_molecule_id, "                 \
                   ":subordinate_of)");
-    prepared_queries_["FEAT_Feature"] = query;
     // any meta infos on features?
     if (anyFeaturePredicate_(features, [](const Feature& feature) {
       return !feature.isMetaEmpty();
@@ -1470,13 +1746,13 @@ namespace OpenMS::Internal
                    "point_x REAL, "                                     \
                    "point_y REAL, "                                     \
                    "FOREIGN KEY (feature_id) REFERENCES FEAT_Feature (id)");
-      query.prepare("INSERT INTO FEAT_ConvexHull VALUES ("      \
+      prepareQuery_("FEAT_ConvexHull",
+                    "INSERT INTO FEAT_ConvexHull VALUES ("      \
                     ":feature_id, "                             \
                     ":hull_index, "                             \
                     ":point_index, "                            \
                     ":point_x, "                                \
                     ":point_y)");
-      prepared_queries_["FEAT_ConvexHull"] = query;
     }
     // any ID observations on features?
     if (anyFeaturePredicate_(features, [](const Feature& feature) {
@@ -1488,10 +1764,10 @@ namespace OpenMS::Internal
                    "observation_match_id INTEGER NOT NULL, "            \
                    "FOREIGN KEY (feature_id) REFERENCES FEAT_Feature (id), " \
                    "FOREIGN KEY (observation_match_id) REFERENCES ID_ObservationMatch (id)");
-      query.prepare("INSERT INTO FEAT_ObservationMatch VALUES (" \
+      prepareQuery_("FEAT_ObservationMatch",
+                    "INSERT INTO FEAT_ObservationMatch VALUES (" \
                     ":feature_id, "                              \
                     ":observation_match_id)");
-      prepared_queries_["FEAT_ObservationMatch"] = query;
     }
 
     // features and their subordinates are stored in DFS-like order:
@@ -1511,28 +1787,27 @@ namespace OpenMS::Internal
                  "identifier TEXT, "                \
                  "file_path TEXT, "                 \
                  "file_type TEXT");
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    // @TODO: worth using a prepared query for just one insert?
-    query.prepare("INSERT INTO FEAT_MapMetaData VALUES (" \
-                  ":unique_id, "                          \
-                  ":identifier, "                         \
-                  ":file_path, "                          \
-                  ":file_type)");
-    query.bindValue(":unique_id", qint64(features.getUniqueId()));
-    query.bindValue(":identifier", features.getIdentifier().toQString());
-    query.bindValue(":file_path", features.getLoadedFilePath().toQString());
+    sqlite3_stmt* query = prepareQuery_("FEAT_MapMetaData",
+                                        "INSERT INTO FEAT_MapMetaData VALUES (" \
+                                        ":unique_id, "                          \
+                                        ":identifier, "                         \
+                                        ":file_path, "                          \
+                                        ":file_type)");
+    bindValue(query, ":unique_id", Int64(features.getUniqueId()));
+    bindValue(query, ":identifier", features.getIdentifier());
+    bindValue(query, ":file_path", features.getLoadedFilePath());
     String file_type = FileTypes::typeToName(features.getLoadedFileType());
-    query.bindValue(":file_type", file_type.toQString());
+    bindValue(query, ":file_type", file_type);
 
-    if (!query.exec())
+    if (!execQuery_(query))
     {
-      raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+      raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                     "error inserting data");
     }
     if (!features.isMetaEmpty())
     {
       createTableMetaInfo_("FEAT_MapMetaData", "unique_id");
-      storeMetaInfo_(features, "FEAT_MapMetaData", qint64(features.getUniqueId()));
+      storeMetaInfo_(features, "FEAT_MapMetaData", Int64(features.getUniqueId()));
     }
   }
 
@@ -1550,33 +1825,33 @@ namespace OpenMS::Internal
                  "completion_time TEXT");
     // "id" is needed to connect to meta info table (see "storeMetaInfos_");
     // "position" is position in the vector ("index" is a reserved word in SQL)
-    QSqlQuery query(QSqlDatabase::database(db_name_));
-    query.prepare("INSERT INTO FEAT_DataProcessing VALUES (" \
-                  ":id, "                                    \
-                  ":position, "                              \
-                  ":software_name, "                         \
-                  ":software_version, "                      \
-                  ":processing_actions, "                    \
-                  ":completion_time)");
+    sqlite3_stmt* query = prepareQuery_("FEAT_DataProcessing",
+                                        "INSERT INTO FEAT_DataProcessing VALUES (" \
+                                        ":id, "                                    \
+                                        ":position, "                              \
+                                        ":software_name, "                         \
+                                        ":software_version, "                      \
+                                        ":processing_actions, "                    \
+                                        ":completion_time)");
 
     int index = 0;
     for (const DataProcessing& proc : features.getDataProcessing())
     {
-      query.bindValue(":id", Key(&proc));
-      query.bindValue(":position", index);
-      query.bindValue(":software_name", proc.getSoftware().getName().toQString());
-      query.bindValue(":software_version", proc.getSoftware().getVersion().toQString());
+      bindValue(query, ":id", registerKey_(&proc, "FEAT_DataProcessing").first);
+      bindValue(query, ":position", index);
+      bindValue(query, ":software_name", proc.getSoftware().getName());
+      bindValue(query, ":software_version", proc.getSoftware().getVersion());
       String actions;
       for (DataProcessing::ProcessingAction action : proc.getProcessingActions())
       {
         if (!actions.empty()) actions += ","; // @TODO: use different separator?
         actions += DataProcessing::NamesOfProcessingAction[action];
       }
-      query.bindValue(":processing_actions", actions.toQString());
-      query.bindValue(":completion_time", proc.getCompletionTime().get().toQString());
-      if (!query.exec())
+      bindValue(query, ":processing_actions", actions);
+      bindValue(query, ":completion_time", proc.getCompletionTime().get());
+      if (!execQuery_(query))
       {
-        raiseDBError_(query.lastError(), __LINE__, OPENMS_PRETTY_FUNCTION,
+        raiseDBError_(db_->getDB(), __LINE__, OPENMS_PRETTY_FUNCTION,
                       "error inserting data");
       }
       index++;
@@ -1587,15 +1862,14 @@ namespace OpenMS::Internal
 
   void OMSFileStore::store(const FeatureMap& features)
   {
-    QSqlDatabase db = QSqlDatabase::database(db_name_);
-    db.transaction(); // avoid SQLite's "implicit transactions", improve runtime
+    beginTransaction_();
     if (features.getIdentificationData().empty())
     {
       storeVersionAndDate_();
     }
     else
     {
-      store(features.getIdentificationData());
+      storeIdentificationData_(features.getIdentificationData());
     }
     startProgress(0, features.size() + 2, "Writing feature data to file");
     storeMapMetaData_(features);
@@ -1603,7 +1877,7 @@ namespace OpenMS::Internal
     storeDataProcessing_(features);
     nextProgress();
     storeFeatures_(features);
-    db.commit();
+    commitTransaction_();
     endProgress();
   }
 }
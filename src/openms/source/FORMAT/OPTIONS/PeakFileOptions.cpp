@@ -63,6 +63,7 @@ namespace OpenMS
     np_config_int_(),
     np_config_fda_(),
     maximal_data_pool_size_(100),
+    max_in_flight_bytes_(0),
     precursor_mz_selected_ion_(true)
   {
   }
@@ -92,6 +93,7 @@ namespace OpenMS
     np_config_int_(options.np_config_int_),
     np_config_fda_(options.np_config_fda_),
     maximal_data_pool_size_(options.maximal_data_pool_size_),
+    max_in_flight_bytes_(options.max_in_flight_bytes_),
     precursor_mz_selected_ion_(options.precursor_mz_selected_ion_)
   {
   }
@@ -352,6 +354,16 @@ namespace OpenMS
     maximal_data_pool_size_ = size;
   }
 
+  Size PeakFileOptions::getMaxInFlightBytes() const
+  {
+    return max_in_flight_bytes_;
+  }
+
+  void PeakFileOptions::setMaxInFlightBytes(Size bytes)
+  {
+    max_in_flight_bytes_ = bytes;
+  }
+
   bool PeakFileOptions::getPrecursorMZSelectedIon() const
   {
     return precursor_mz_selected_ion_;
@@ -0,0 +1,423 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/KERNEL/ColumnarMSExperiment.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/FORMAT/MSNumpressCoder.h>
+
+#include <cstring>
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    /// Header of the compressed peak data of a single spectrum
+    struct CompressedSpectrumHeader
+    {
+      Size size;         ///< number of peaks
+      Size raw_columns;  ///< bit mask of columns that are stored as raw doubles (1: m/z, 2: intensity, 4: ion mobility)
+      Size mz_bytes;
+      Size intensity_bytes;
+      Size ion_mobility_bytes;
+    };
+
+    enum RawColumn
+    {
+      RAW_MZ = 1,
+      RAW_INTENSITY = 2,
+      RAW_ION_MOBILITY = 4
+    };
+
+    MSNumpressCoder::NumpressConfig numpressConfig(MSNumpressCoder::NumpressCompression np_compression)
+    {
+      MSNumpressCoder::NumpressConfig config;
+      config.np_compression = np_compression;
+      config.estimate_fixed_point = true;
+      return config;
+    }
+
+    /// Encodes @p values with numpress (or stores them as raw doubles if numpress fails), returns whether the data is raw
+    bool encodeColumn(const std::vector<double>& values, MSNumpressCoder::NumpressCompression np_compression, std::string& out)
+    {
+      out.clear();
+      if (values.empty())
+      {
+        return false;
+      }
+      String encoded;
+      MSNumpressCoder().encodeNPRaw(values, encoded, numpressConfig(np_compression));
+      if (!encoded.empty())
+      {
+        out = std::move(encoded);
+        return false;
+      }
+      // numpress exceeded its error tolerance
+      out.assign(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+      return true;
+    }
+
+    void decodeColumn(const char* in, Size bytes, bool raw, MSNumpressCoder::NumpressCompression np_compression, std::vector<double>& out)
+    {
+      out.clear();
+      if (bytes == 0)
+      {
+        return;
+      }
+      if (raw)
+      {
+        out.resize(bytes / sizeof(double));
+        std::memcpy(out.data(), in, bytes);
+        return;
+      }
+      MSNumpressCoder().decodeNPRaw(std::string(in, bytes), out, numpressConfig(np_compression));
+    }
+  }
+
+  ColumnarMSExperiment::ColumnarMSExperiment(Compression compression) :
+    compression_(compression),
+    spectrum_offsets_(1, 0),
+    chromatogram_offsets_(1, 0)
+  {
+  }
+
+  ColumnarMSExperiment::ColumnarMSExperiment(const PeakMap& exp, Compression compression) :
+    ColumnarMSExperiment(compression)
+  {
+    static_cast<ExperimentalSettings&>(meta_ms_experiment_) = exp;
+
+    Size nr_peaks(0);
+    for (const MSSpectrum& spectrum : exp)
+    {
+      nr_peaks += spectrum.size();
+    }
+    if (compression_ == NONE)
+    {
+      mz_.reserve(nr_peaks);
+      intensity_.reserve(nr_peaks);
+    }
+    meta_ms_experiment_.reserveSpaceSpectra(exp.size());
+    spectrum_offsets_.reserve(exp.size() + 1);
+    has_ion_mobility_.reserve(exp.size());
+
+    for (const MSSpectrum& spectrum : exp)
+    {
+      addSpectrum(spectrum);
+    }
+    for (const MSChromatogram& chromatogram : exp.getChromatograms())
+    {
+      addChromatogram(chromatogram);
+    }
+  }
+
+  ColumnarMSExperiment::Compression ColumnarMSExperiment::getCompression() const
+  {
+    return compression_;
+  }
+
+  Size ColumnarMSExperiment::size() const
+  {
+    return getNrSpectra();
+  }
+
+  bool ColumnarMSExperiment::empty() const
+  {
+    return getNrSpectra() == 0;
+  }
+
+  Size ColumnarMSExperiment::getNrSpectra() const
+  {
+    return meta_ms_experiment_.size();
+  }
+
+  Size ColumnarMSExperiment::getNrChromatograms() const
+  {
+    return meta_ms_experiment_.getChromatograms().size();
+  }
+
+  const PeakMap& ColumnarMSExperiment::getMetaData() const
+  {
+    return meta_ms_experiment_;
+  }
+
+  Size ColumnarMSExperiment::getPeakDataSize() const
+  {
+    return mz_.size() * sizeof(double) + intensity_.size() * sizeof(float) + ion_mobility_.size() * sizeof(float) +
+           compressed_.size() + chrom_rt_.size() * sizeof(double) + chrom_intensity_.size() * sizeof(float);
+  }
+
+  void ColumnarMSExperiment::addSpectrum(const MSSpectrum& spectrum)
+  {
+    // copy the meta data only (copying the whole spectrum would copy all peaks)
+    MSSpectrum meta;
+    static_cast<SpectrumSettings&>(meta) = spectrum;
+    meta.setRT(spectrum.getRT());
+    meta.setDriftTime(spectrum.getDriftTime());
+    meta.setDriftTimeUnit(spectrum.getDriftTimeUnit());
+    meta.setMSLevel(spectrum.getMSLevel());
+    meta.setName(spectrum.getName());
+    meta.setFloatDataArrays(spectrum.getFloatDataArrays());
+    meta.setStringDataArrays(spectrum.getStringDataArrays());
+    meta.setIntegerDataArrays(spectrum.getIntegerDataArrays());
+
+    // the ion mobility array becomes a column, the (empty) array remains as a description
+    const std::vector<float>* ion_mobility = nullptr;
+    if (spectrum.containsIMData())
+    {
+      Size im_index = spectrum.getIMData().first;
+      if (spectrum.getFloatDataArrays()[im_index].size() == spectrum.size())
+      {
+        ion_mobility = &spectrum.getFloatDataArrays()[im_index];
+        std::vector<float>().swap(meta.getFloatDataArrays()[im_index]);
+      }
+    }
+    has_ion_mobility_.push_back(ion_mobility != nullptr);
+
+    if (compression_ == NUMPRESS)
+    {
+      compressSpectrum_(spectrum, ion_mobility);
+      spectrum_offsets_.push_back(compressed_.size());
+    }
+    else
+    {
+      if (ion_mobility != nullptr && ion_mobility_.size() < mz_.size())
+      {
+        // first spectrum with ion mobility data: start the column
+        ion_mobility_.resize(mz_.size(), 0.0f);
+      }
+      for (const Peak1D& peak : spectrum)
+      {
+        mz_.push_back(peak.getMZ());
+        intensity_.push_back(peak.getIntensity());
+      }
+      if (ion_mobility != nullptr)
+      {
+        ion_mobility_.insert(ion_mobility_.end(), ion_mobility->begin(), ion_mobility->end());
+      }
+      else if (!ion_mobility_.empty())
+      {
+        ion_mobility_.resize(mz_.size(), 0.0f);
+      }
+      spectrum_offsets_.push_back(mz_.size());
+    }
+
+    meta_ms_experiment_.addSpectrum(std::move(meta));
+  }
+
+  void ColumnarMSExperiment::compressSpectrum_(const MSSpectrum& spectrum, const std::vector<float>* ion_mobility)
+  {
+    CompressedSpectrumHeader header = {spectrum.size(), 0, 0, 0, 0};
+
+    std::vector<double> values;
+    values.reserve(spectrum.size());
+    std::string mz_data, intensity_data, ion_mobility_data;
+
+    for (const Peak1D& peak : spectrum) values.push_back(peak.getMZ());
+    if (encodeColumn(values, MSNumpressCoder::LINEAR, mz_data)) header.raw_columns |= RAW_MZ;
+
+    values.clear();
+    for (const Peak1D& peak : spectrum) values.push_back(peak.getIntensity());
+    if (encodeColumn(values, MSNumpressCoder::SLOF, intensity_data)) header.raw_columns |= RAW_INTENSITY;
+
+    if (ion_mobility != nullptr)
+    {
+      values.assign(ion_mobility->begin(), ion_mobility->end());
+      if (encodeColumn(values, MSNumpressCoder::LINEAR, ion_mobility_data)) header.raw_columns |= RAW_ION_MOBILITY;
+    }
+
+    header.mz_bytes = mz_data.size();
+    header.intensity_bytes = intensity_data.size();
+    header.ion_mobility_bytes = ion_mobility_data.size();
+    compressed_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    compressed_.append(mz_data);
+    compressed_.append(intensity_data);
+    compressed_.append(ion_mobility_data);
+  }
+
+  void ColumnarMSExperiment::addChromatogram(const MSChromatogram& chromatogram)
+  {
+    MSChromatogram meta;
+    static_cast<ChromatogramSettings&>(meta) = chromatogram;
+    meta.setName(chromatogram.getName());
+    meta.setFloatDataArrays(chromatogram.getFloatDataArrays());
+    meta.setStringDataArrays(chromatogram.getStringDataArrays());
+    meta.setIntegerDataArrays(chromatogram.getIntegerDataArrays());
+
+    for (const ChromatogramPeak& peak : chromatogram)
+    {
+      chrom_rt_.push_back(peak.getRT());
+      chrom_intensity_.push_back(peak.getIntensity());
+    }
+    chromatogram_offsets_.push_back(chrom_rt_.size());
+
+    meta_ms_experiment_.addChromatogram(std::move(meta));
+  }
+
+  ColumnarMSExperiment::SpectrumView ColumnarMSExperiment::getSpectrumView(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    if (compression_ != NONE)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "In-place spectrum views are not available for compressed peak data, use decodeSpectrum() instead.");
+    }
+    SpectrumView view;
+    Size begin = spectrum_offsets_[id];
+    view.size = spectrum_offsets_[id + 1] - begin;
+    view.mz = mz_.data() + begin;
+    view.intensity = intensity_.data() + begin;
+    if (has_ion_mobility_[id])
+    {
+      view.ion_mobility = ion_mobility_.data() + begin;
+    }
+    return view;
+  }
+
+  void ColumnarMSExperiment::decodeSpectrum(Size id, std::vector<double>& mz, std::vector<float>& intensity, std::vector<float>& ion_mobility) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    ion_mobility.clear();
+    if (compression_ == NONE)
+    {
+      SpectrumView view = getSpectrumView(id);
+      mz.assign(view.mz, view.mz + view.size);
+      intensity.assign(view.intensity, view.intensity + view.size);
+      if (view.ion_mobility != nullptr)
+      {
+        ion_mobility.assign(view.ion_mobility, view.ion_mobility + view.size);
+      }
+      return;
+    }
+
+    const char* data = compressed_.data() + spectrum_offsets_[id];
+    CompressedSpectrumHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    data += sizeof(header);
+
+    std::vector<double> values;
+    decodeColumn(data, header.mz_bytes, header.raw_columns & RAW_MZ, MSNumpressCoder::LINEAR, mz);
+    data += header.mz_bytes;
+    decodeColumn(data, header.intensity_bytes, header.raw_columns & RAW_INTENSITY, MSNumpressCoder::SLOF, values);
+    intensity.assign(values.begin(), values.end());
+    data += header.intensity_bytes;
+    if (has_ion_mobility_[id])
+    {
+      decodeColumn(data, header.ion_mobility_bytes, header.raw_columns & RAW_ION_MOBILITY, MSNumpressCoder::LINEAR, values);
+      ion_mobility.assign(values.begin(), values.end());
+    }
+
+    if (mz.size() != header.size || intensity.size() != header.size)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Decoded peak data of spectrum " + String(id) + " has an unexpected size.");
+    }
+  }
+
+  MSSpectrum ColumnarMSExperiment::operator[](Size n) const
+  {
+    return getSpectrum(n);
+  }
+
+  MSSpectrum ColumnarMSExperiment::getSpectrum(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    std::vector<double> mz;
+    std::vector<float> intensity, ion_mobility;
+    decodeSpectrum(id, mz, intensity, ion_mobility);
+
+    MSSpectrum spectrum(meta_ms_experiment_[id]);
+    spectrum.reserve(mz.size());
+    for (Size i = 0; i < mz.size(); ++i)
+    {
+      spectrum.emplace_back(mz[i], intensity[i]);
+    }
+    if (has_ion_mobility_[id])
+    {
+      spectrum.getFloatDataArrays()[spectrum.getIMData().first].assign(ion_mobility.begin(), ion_mobility.end());
+    }
+    return spectrum;
+  }
+
+  Interfaces::SpectrumPtr ColumnarMSExperiment::getSpectrumById(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrSpectra(), "Id cannot be larger than number of spectra");
+
+    Interfaces::SpectrumPtr sptr(new Interfaces::Spectrum);
+    std::vector<double>& mz = sptr->getMZArray()->data;
+    std::vector<double>& intensity = sptr->getIntensityArray()->data;
+    if (compression_ == NONE)
+    {
+      SpectrumView view = getSpectrumView(id);
+      mz.assign(view.mz, view.mz + view.size);
+      intensity.assign(view.intensity, view.intensity + view.size);
+    }
+    else
+    {
+      std::vector<float> float_intensity, ion_mobility;
+      decodeSpectrum(id, mz, float_intensity, ion_mobility);
+      intensity.assign(float_intensity.begin(), float_intensity.end());
+    }
+    return sptr;
+  }
+
+  MSChromatogram ColumnarMSExperiment::getChromatogram(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    MSChromatogram chromatogram(meta_ms_experiment_.getChromatograms()[id]);
+    chromatogram.reserve(chromatogram_offsets_[id + 1] - chromatogram_offsets_[id]);
+    for (Size i = chromatogram_offsets_[id]; i < chromatogram_offsets_[id + 1]; ++i)
+    {
+      chromatogram.push_back(ChromatogramPeak(chrom_rt_[i], chrom_intensity_[i]));
+    }
+    return chromatogram;
+  }
+
+  Interfaces::ChromatogramPtr ColumnarMSExperiment::getChromatogramById(Size id) const
+  {
+    OPENMS_PRECONDITION(id < getNrChromatograms(), "Id cannot be larger than number of chromatograms");
+
+    Interfaces::ChromatogramPtr cptr(new Interfaces::Chromatogram);
+    cptr->getTimeArray()->data.assign(chrom_rt_.begin() + chromatogram_offsets_[id], chrom_rt_.begin() + chromatogram_offsets_[id + 1]);
+    cptr->getIntensityArray()->data.assign(chrom_intensity_.begin() + chromatogram_offsets_[id], chrom_intensity_.begin() + chromatogram_offsets_[id + 1]);
+    return cptr;
+  }
+
+} // namespace OpenMS
@@ -18,6 +18,7 @@ MRMTransitionGroup.cpp
 MSExperiment.cpp
 MSSpectrum.cpp
 OnDiscMSExperiment.cpp
+ColumnarMSExperiment.cpp
 Peak1D.cpp
 Peak2D.cpp
 PeakIndex.cpp
@@ -40,8 +40,7 @@ using namespace std;
 
 namespace OpenMS
 {
-  void IdentificationData::checkScoreTypes_(const map<ScoreTypeRef, double>&
-                                            scores) const
+  void IdentificationData::checkScoreTypes_(const ScoreMap& scores) const
   {
     for (const auto& pair : scores)
     {
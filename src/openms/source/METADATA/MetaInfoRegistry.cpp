@@ -41,82 +41,49 @@ using namespace std;
 namespace OpenMS
 {
 
-  MetaInfoRegistry::MetaInfoRegistry() :
-    next_index_(1024), 
-    name_to_index_(), 
-    index_to_name_(), 
-    index_to_description_(), 
-    index_to_unit_()
+  namespace
   {
-    name_to_index_["isotopic_range"] = 1;
-    index_to_name_[1] = "isotopic_range";
-    index_to_description_[1] = "consecutive numbering of the peaks in an isotope pattern. 0 is the monoisotopic peak";
-    index_to_unit_[1] = "";
-
-    name_to_index_["cluster_id"] = 2;
-    index_to_name_[2] = "cluster_id";
-    index_to_description_[2] = "consecutive numbering of isotope clusters in a spectrum";
-    index_to_unit_[2] = "";
-
-    name_to_index_["label"] = 3;
-    index_to_name_[3] = "label";
-    index_to_description_[3] = "label e.g. shown in visualization";
-    index_to_unit_[3] = "";
-
-    name_to_index_["icon"] = 4;
-    index_to_name_[4] = "icon";
-    index_to_description_[4] = "icon shown in visualization";
-    index_to_unit_[4] = "";
-
-    name_to_index_["color"] = 5;
-    index_to_name_[5] = "color";
-    index_to_description_[5] = "color used for visualization e.g. #FF00FF for purple";
-    index_to_unit_[5] = "";
-
-    name_to_index_["RT"] = 6;
-    index_to_name_[6] = "RT";
-    index_to_description_[6] = "the retention time of an identification";
-    index_to_unit_[6] = "";
-
-    name_to_index_["MZ"] = 7;
-    index_to_name_[7] = "MZ";
-    index_to_description_[7] = "the MZ of an identification";
-    index_to_unit_[7] = "";
-
-    name_to_index_["predicted_RT"] = 8;
-    index_to_name_[8] = "predicted_RT";
-    index_to_description_[8] = "the predicted retention time of a peptide hit";
-    index_to_unit_[8] = "";
-
-    name_to_index_["predicted_RT_p_value"] = 9;
-    index_to_name_[9] = "predicted_RT_p_value";
-    index_to_description_[9] = "the predicted RT p-value of a peptide hit";
-    index_to_unit_[9] = "";
-
-    name_to_index_["spectrum_reference"] = 10;
-    index_to_name_[10] = "spectrum_reference";
-    index_to_description_[10] = "Reference to a spectrum or feature number";
-    index_to_unit_[10] = "";
-
-    name_to_index_["ID"] = 11;
-    index_to_name_[11] = "ID";
-    index_to_description_[11] = "Some type of identifier";
-    index_to_unit_[11] = "";
-
-    name_to_index_["low_quality"] = 12;
-    index_to_name_[12] = "low_quality";
-    index_to_description_[12] = "Flag which indicates that some entity has a low quality (e.g. a feature pair)";
-    index_to_unit_[12] = "";
+    UInt64 nextRegistryId()
+    {
+      static std::atomic<UInt64> next_id(1);
+      return next_id.fetch_add(1);
+    }
+  }
 
-    name_to_index_["charge"] = 13;
-    index_to_name_[13] = "charge";
-    index_to_description_[13] = "Charge of a feature or peak";
-    index_to_unit_[13] = "";
+  MetaInfoRegistry::MetaInfoRegistry() :
+    version_(1),
+    id_(nextRegistryId())
+  {
+    auto snapshot = std::make_shared<Snapshot>();
+    auto add = [&snapshot](UInt index, const std::string& name, const std::string& description)
+    {
+      snapshot->name_to_index[name] = index;
+      snapshot->index_to_name[index] = name;
+      snapshot->index_to_description[index] = description;
+      snapshot->index_to_unit[index] = "";
+    };
+    add(1, "isotopic_range", "consecutive numbering of the peaks in an isotope pattern. 0 is the monoisotopic peak");
+    add(2, "cluster_id", "consecutive numbering of isotope clusters in a spectrum");
+    add(3, "label", "label e.g. shown in visualization");
+    add(4, "icon", "icon shown in visualization");
+    add(5, "color", "color used for visualization e.g. #FF00FF for purple");
+    add(6, "RT", "the retention time of an identification");
+    add(7, "MZ", "the MZ of an identification");
+    add(8, "predicted_RT", "the predicted retention time of a peptide hit");
+    add(9, "predicted_RT_p_value", "the predicted RT p-value of a peptide hit");
+    add(10, "spectrum_reference", "Reference to a spectrum or feature number");
+    add(11, "ID", "Some type of identifier");
+    add(12, "low_quality", "Flag which indicates that some entity has a low quality (e.g. a feature pair)");
+    add(13, "charge", "Charge of a feature or peak");
+    current_ = snapshot;
   }
 
-  MetaInfoRegistry::MetaInfoRegistry(const MetaInfoRegistry& rhs)
+  MetaInfoRegistry::MetaInfoRegistry(const MetaInfoRegistry& rhs) :
+    version_(1),
+    id_(nextRegistryId())
   {
-    *this = rhs;
+    std::lock_guard<std::mutex> lock(rhs.write_mutex_);
+    current_ = rhs.current_; // snapshots are immutable and can be shared
   }
 
   MetaInfoRegistry::~MetaInfoRegistry()
@@ -129,204 +96,201 @@ namespace OpenMS
     {
       return *this;
     }
-#pragma omp critical (MetaInfoRegistry)
+    std::shared_ptr<const Snapshot> snapshot;
     {
-      next_index_ = rhs.next_index_;
-      name_to_index_ = rhs.name_to_index_;
-      index_to_name_ = rhs.index_to_name_;
-      index_to_description_ = rhs.index_to_description_;
-      index_to_unit_ = rhs.index_to_unit_;
+      std::lock_guard<std::mutex> lock(rhs.write_mutex_);
+      snapshot = rhs.current_;
     }
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    publish_(snapshot);
     return *this;
   }
 
-  UInt MetaInfoRegistry::registerName(const String& name, const String& description, const String& unit)
+  const MetaInfoRegistry::Snapshot& MetaInfoRegistry::snapshot_() const
   {
-    UInt rv;
-#pragma omp critical (MetaInfoRegistry)
+    struct Cache
     {
-      MapString2IndexType::iterator it = name_to_index_.find(name);
-      if (it == name_to_index_.end())
-      {
-        name_to_index_[name] = next_index_;
-        index_to_name_[next_index_] = name;
-        index_to_description_[next_index_] = description;
-        index_to_unit_[next_index_] = unit;
-        rv = next_index_++;
-      }
-      else
+      UInt64 registry_id = 0;
+      UInt64 version = 0;
+      std::shared_ptr<const Snapshot> snapshot;
+    };
+    thread_local Cache cache;
+
+    // fast path: nothing changed since this thread last looked
+    if (cache.registry_id != id_ || cache.version != version_.load(std::memory_order_acquire))
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      cache.snapshot = current_;
+      cache.version = version_.load(std::memory_order_relaxed);
+      cache.registry_id = id_;
+    }
+    return *cache.snapshot;
+  }
+
+  void MetaInfoRegistry::publish_(const std::shared_ptr<const Snapshot>& snapshot)
+  {
+    current_ = snapshot;
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  UInt MetaInfoRegistry::registerName(const String& name, const String& description, const String& unit)
+  {
+    { // already registered?
+      const Snapshot& snapshot = snapshot_();
+      MapString2IndexType::const_iterator it = snapshot.name_to_index.find(name);
+      if (it != snapshot.name_to_index.end())
       {
-        rv = it->second;
+        return it->second;
       }
     }
-    return rv;
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    // another thread may have registered the name in the meantime
+    MapString2IndexType::const_iterator it = current_->name_to_index.find(name);
+    if (it != current_->name_to_index.end())
+    {
+      return it->second;
+    }
+    auto modified = std::make_shared<Snapshot>(*current_);
+    UInt index = modified->next_index++;
+    modified->name_to_index[name] = index;
+    modified->index_to_name[index] = name;
+    modified->index_to_description[index] = description;
+    modified->index_to_unit[index] = unit;
+    publish_(modified);
+    return index;
   }
 
   void MetaInfoRegistry::setDescription(UInt index, const String& description)
   {
-    MapIndex2StringType::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (current_->index_to_description.find(index) == current_->index_to_description.end())
     {
-      pos = index_to_description_.find(index);
-      if (pos != index_to_description_.end())
-      {
-        pos->second = description;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
+    }
+    if (current_->index_to_description.at(index) == description)
+    {
+      return; // unchanged - don't invalidate the readers' snapshots
     }
+    auto modified = std::make_shared<Snapshot>(*current_);
+    modified->index_to_description[index] = description;
+    publish_(modified);
   }
 
   void MetaInfoRegistry::setDescription(const String& name, const String& description)
   {
-    MapString2IndexType::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    MapString2IndexType::const_iterator pos = current_->name_to_index.find(name);
+    if (pos == current_->name_to_index.end())
     {
-      pos = name_to_index_.find(name);
-      if (pos != name_to_index_.end())
-      {
-        index_to_description_[pos->second] = description;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
     }
+    if (current_->index_to_description.at(pos->second) == description)
+    {
+      return;
+    }
+    auto modified = std::make_shared<Snapshot>(*current_);
+    modified->index_to_description[pos->second] = description;
+    publish_(modified);
   }
 
   void MetaInfoRegistry::setUnit(UInt index, const String& unit)
   {
-    MapIndex2StringType::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (current_->index_to_unit.find(index) == current_->index_to_unit.end())
     {
-      pos = index_to_unit_.find(index);
-      if (pos != index_to_unit_.end())
-      {
-        pos->second = unit;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
+    }
+    if (current_->index_to_unit.at(index) == unit)
+    {
+      return;
     }
+    auto modified = std::make_shared<Snapshot>(*current_);
+    modified->index_to_unit[index] = unit;
+    publish_(modified);
   }
 
   void MetaInfoRegistry::setUnit(const String& name, const String& unit)
   {
-    MapString2IndexType::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    MapString2IndexType::const_iterator pos = current_->name_to_index.find(name);
+    if (pos == current_->name_to_index.end())
     {
-      pos = name_to_index_.find(name);
-      if (pos != name_to_index_.end())
-      {
-        index_to_unit_[pos->second] = unit;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered name!", name);
+    }
+    if (current_->index_to_unit.at(pos->second) == unit)
+    {
+      return;
     }
+    auto modified = std::make_shared<Snapshot>(*current_);
+    modified->index_to_unit[pos->second] = unit;
+    publish_(modified);
   }
 
   UInt MetaInfoRegistry::getIndex(const String& name) const
   {
-    UInt rv = UInt(-1);
-#pragma omp critical (MetaInfoRegistry)
+    const Snapshot& snapshot = snapshot_();
+    MapString2IndexType::const_iterator it = snapshot.name_to_index.find(name);
+    if (it != snapshot.name_to_index.end())
     {
-      MapString2IndexType::const_iterator it = name_to_index_.find(name);
-      if (it != name_to_index_.end())
-      {
-        rv = it->second;
-      }
+      return it->second;
     }
-    return rv;
+    return UInt(-1);
   }
 
   String MetaInfoRegistry::getDescription(UInt index) const
   {
-    String result;
-#pragma omp critical (MetaInfoRegistry)
+    const Snapshot& snapshot = snapshot_();
+    MapIndex2StringType::const_iterator it = snapshot.index_to_description.find(index);
+    if (it == snapshot.index_to_description.end())
     {
-      MapIndex2StringType::const_iterator it = index_to_description_.find(index);
-      if (it == index_to_description_.end())
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
-      result = it->second;
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
     }
-    return result;
+    return it->second;
   }
 
   String MetaInfoRegistry::getDescription(const String& name) const
   {
-    String rv;
-    UInt index = getIndex(name); // this has to be outside the OpenMP "critical" block!
-    if (index == UInt(-1)) // not found
+    const Snapshot& snapshot = snapshot_();
+    MapString2IndexType::const_iterator it = snapshot.name_to_index.find(name);
+    if (it == snapshot.name_to_index.end())
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered Name!", name);
     }
-    else
-    {
-#pragma omp critical (MetaInfoRegistry)
-      {
-        rv = (index_to_description_.find(index))->second;
-      }
-    }
-    return rv;
+    return snapshot.index_to_description.find(it->second)->second;
   }
 
   String MetaInfoRegistry::getUnit(UInt index) const
   {
-    String result;
-#pragma omp critical (MetaInfoRegistry)
+    const Snapshot& snapshot = snapshot_();
+    MapIndex2StringType::const_iterator it = snapshot.index_to_unit.find(index);
+    if (it == snapshot.index_to_unit.end())
     {
-      MapIndex2StringType::const_iterator it = index_to_unit_.find(index);
-      if (it == index_to_unit_.end())
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
-      result = it->second;
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
     }
-    return result;
+    return it->second;
   }
 
   String MetaInfoRegistry::getUnit(const String& name) const
   {
-    String rv;
-    UInt index = getIndex(name); // this has to be outside the OpenMP "critical" block!
-    if (index == UInt(-1)) // not found
+    const Snapshot& snapshot = snapshot_();
+    MapString2IndexType::const_iterator it = snapshot.name_to_index.find(name);
+    if (it == snapshot.name_to_index.end())
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered Name!", name);
     }
-    else
-    {
-#pragma omp critical (MetaInfoRegistry)
-      {
-        rv = (index_to_unit_.find(index))->second;
-      }
-    }
-    return rv;
+    return snapshot.index_to_unit.find(it->second)->second;
   }
 
   String MetaInfoRegistry::getName(UInt index) const
   {
-    String rv;
-#pragma omp critical (MetaInfoRegistry)
+    const Snapshot& snapshot = snapshot_();
+    MapIndex2StringType::const_iterator it = snapshot.index_to_name.find(index);
+    if (it == snapshot.index_to_name.end())
     {
-      MapIndex2StringType::const_iterator it = index_to_name_.find(index);
-      if (it != index_to_name_.end())
-      {
-        rv = it->second;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Unregistered index!", String(index));
     }
-    return rv;
+    return it->second;
   }
 
 } //namespace
-
@@ -42,6 +42,12 @@
 #include <OpenMS/MATH/MISC/CubicSpline2d.h>
 #include <OpenMS/KERNEL/SpectrumHelper.h>
 
+#include <exception>
+#include <iterator>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 
@@ -165,10 +171,9 @@ namespace OpenMS
 
     // signal-to-noise estimation
     SignalToNoiseEstimatorMedian< ContainerType > snt;
-    snt.setParameters(param_.copy("SignalToNoise:", true));
-
     if (signal_to_noise_ > 0.0)
     {
+      snt.setParameters(param_.copy("SignalToNoise:", true));
       snt.init(input);
     }
 
@@ -460,6 +465,37 @@ namespace OpenMS
     uint32_t total{0};  ///< overall number of spectra
   };
 
+  bool PeakPickerHiRes::pickOrCopy(const MSSpectrum& input, MSSpectrum& output, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type) const
+  {
+    // auto mode
+    if (ms_levels_.empty())
+    {
+      SpectrumSettings::SpectrumType spectrum_type = input.getType(true); // uses meta-info and inspects data if needed
+      if (spectrum_type == SpectrumSettings::CENTROID)
+      {
+        output = input;
+        return false;
+      }
+    }
+    // manual mode
+    else if (!ListUtils::contains(ms_levels_, input.getMSLevel()))
+    {
+      output = input;
+      return false;
+    }
+    else if (check_spectrum_type)
+    {
+      SpectrumSettings::SpectrumType spectrum_type = input.getType(true); // uses meta-info and inspects data if needed
+      if (spectrum_type == SpectrumSettings::CENTROID)
+      {
+        throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+      }
+    }
+
+    pick(input, output, boundaries);
+    return true;
+  }
+
   void PeakPickerHiRes::pickExperiment(const PeakMap& input,
                                        PeakMap& output, 
                                        std::vector<std::vector<PeakBoundary> >& boundaries_spec, 
@@ -478,64 +514,62 @@ namespace OpenMS
     Size progress = 0;
     startProgress(0, input.size() + input.getChromatograms().size(), "picking peaks");
 
+    // spectra are independent of each other - pick them in parallel, then collect the boundaries in order
+    std::vector<std::vector<PeakBoundary> > boundaries_per_scan(input.size());
+    std::vector<char> was_picked(input.size(), false);
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize scan_idx = 0; scan_idx < (SignedSize)input.size(); ++scan_idx)
+    {
+      try
+      {
+        was_picked[scan_idx] = pickOrCopy(input[scan_idx], output[scan_idx], boundaries_per_scan[scan_idx], check_spectrum_type);
+      }
+      catch (...)
+      {
+#pragma omp critical (PeakPickerHiRes_pickExperiment)
+        if (!error) error = std::current_exception();
+      }
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
+    }
+    if (error) std::rethrow_exception(error);
+
     // MSLevel -> stats
     map<int, SpectraPickInfo> pick_info;
-
-    if (input.getNrSpectra() > 0)
+    for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
     {
-      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      if (was_picked[scan_idx])
       {
-        bool was_picked{false};
-        // auto mode
-        if (ms_levels_.empty()) 
-        {
-          SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType(true); // uses meta-info and inspects data if needed
-          if (spectrum_type == SpectrumSettings::CENTROID)
-          {
-            output[scan_idx] = input[scan_idx];
-          }
-          else
-          {
-            std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
-            pick(input[scan_idx], output[scan_idx], boundaries_s);
-            was_picked = true;
-            boundaries_spec.push_back(std::move(boundaries_s));
-          }
-        }
-        // manual mode
-        else if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel())) 
-        {
-          output[scan_idx] = input[scan_idx];
-        }
-        else
-        {
-          std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
-          SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType(true); // uses meta-info and inspects data if needed
-          if (spectrum_type == SpectrumSettings::CENTROID && check_spectrum_type)
-          {
-            throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
-          }
-
-          pick(input[scan_idx], output[scan_idx], boundaries_s);
-          was_picked = true;
-          boundaries_spec.push_back(std::move(boundaries_s));
-        }
-        pick_info[input[scan_idx].getMSLevel()].picked += was_picked;
-        ++pick_info[input[scan_idx].getMSLevel()].total;
-        setProgress(++progress);
+        boundaries_spec.push_back(std::move(boundaries_per_scan[scan_idx]));
       }
+      pick_info[input[scan_idx].getMSLevel()].picked += was_picked[scan_idx];
+      ++pick_info[input[scan_idx].getMSLevel()].total;
     }
 
-
-    for (Size i = 0; i < input.getChromatograms().size(); ++i)
+    std::vector<MSChromatogram> chromatograms(input.getChromatograms().size());
+    std::vector<std::vector<PeakBoundary> > boundaries_per_chrom(chromatograms.size()); // peak boundaries of each chromatogram
+#pragma omp parallel for schedule(dynamic)
+    for (SignedSize i = 0; i < (SignedSize)chromatograms.size(); ++i)
     {
-      MSChromatogram chromatogram;
-      std::vector<PeakBoundary> boundaries_c; // peak boundaries of a single chromatogram
-      pick(input.getChromatograms()[i], chromatogram, boundaries_c);
-      output.addChromatogram(chromatogram);
-      boundaries_chrom.push_back(boundaries_c);
-      setProgress(++progress);
+      try
+      {
+        pick(input.getChromatograms()[i], chromatograms[i], boundaries_per_chrom[i]);
+      }
+      catch (...)
+      {
+#pragma omp critical (PeakPickerHiRes_pickExperiment)
+        if (!error) error = std::current_exception();
+      }
+#pragma omp atomic
+      ++progress;
+      IF_MASTERTHREAD setProgress(progress);
     }
+    if (error) std::rethrow_exception(error);
+
+    output.setChromatograms(std::move(chromatograms));
+    boundaries_chrom.insert(boundaries_chrom.end(), std::make_move_iterator(boundaries_per_chrom.begin()), std::make_move_iterator(boundaries_per_chrom.end()));
     endProgress();
 
     OPENMS_LOG_INFO << "Picked spectra by MS-level:\n";
@@ -561,47 +595,62 @@ namespace OpenMS
     // resize output with respect to input
     output.resize(input.size());
 
-    if (input.getNrSpectra() > 0)
+    // reading from disc is not thread-safe: read a batch of spectra sequentially, then pick it in parallel
+    // (the batch size bounds the number of profile spectra in memory)
+    const Size batch_size = 256;
+    std::vector<MSSpectrum> batch;
+    batch.reserve(batch_size);
+    for (Size batch_start = 0; batch_start < input.size(); batch_start += batch_size)
     {
-      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      batch.clear();
+      for (Size scan_idx = batch_start; scan_idx < std::min(batch_start + batch_size, input.size()); ++scan_idx)
       {
-        if (ms_levels_.empty()) //auto mode
-        {
-          MSSpectrum s = input[scan_idx];
-          s.sortByPosition();
+        batch.push_back(input[scan_idx]);
+      }
 
-          // determine type of spectral data (profile or centroided)
-          SpectrumSettings::SpectrumType spectrumType = s.getType();
-          if (spectrumType == SpectrumSettings::CENTROID)
+      std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic)
+      for (SignedSize i = 0; i < (SignedSize)batch.size(); ++i)
+      {
+        try
+        {
+          MSSpectrum& s = batch[i];
+          MSSpectrum& picked = output[batch_start + i];
+          if (!ms_levels_.empty() && !ListUtils::contains(ms_levels_, s.getMSLevel())) // manual mode
           {
-            output[scan_idx] = input[scan_idx];
+            picked = std::move(s);
           }
           else
           {
-            pick(s, output[scan_idx]);
+            s.sortByPosition();
+
+            // determine type of spectral data (profile or centroided)
+            SpectrumSettings::SpectrumType spectrum_type = s.getType();
+            if (spectrum_type == SpectrumSettings::CENTROID)
+            {
+              if (ms_levels_.empty()) // auto mode
+              {
+                picked = std::move(s);
+                continue;
+              }
+              if (check_spectrum_type)
+              {
+                throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+              }
+            }
+            pick(s, picked);
           }
         }
-        else if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel())) // manual mode
+        catch (...)
         {
-          output[scan_idx] = input[scan_idx];
+#pragma omp critical (PeakPickerHiRes_pickExperiment)
+          if (!error) error = std::current_exception();
         }
-        else
-        {
-          MSSpectrum s = input[scan_idx];
-          s.sortByPosition();
-
-          // determine type of spectral data (profile or centroided)
-          SpectrumSettings::SpectrumType spectrum_type = s.getType();
-
-          if (spectrum_type == SpectrumSettings::CENTROID && check_spectrum_type)
-          {
-            throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
-          }
-
-          pick(s, output[scan_idx]);
-        }
-        setProgress(++progress);
       }
+      if (error) std::rethrow_exception(error);
+
+      progress += batch.size();
+      setProgress(progress);
     }
 
     for (Size i = 0; i < input.getNrChromatograms(); ++i)
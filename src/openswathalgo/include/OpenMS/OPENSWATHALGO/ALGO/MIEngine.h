@@ -0,0 +1,106 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/OPENSWATHALGO/OpenSwathAlgoConfig.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace OpenSwath
+{
+
+  /**
+    @brief Batched computation of ranked mutual information between traces
+
+    Computes the same values as Scoring::rankedMutualInformation() for any
+    pair of added traces. Each trace is ranked once when it is added (see
+    Scoring::computeAndAppendRank()); ties share a rank and the ranks are
+    renumbered to 0 .. number of states - 1. The marginal histogram of every
+    trace is counted at that time, so its contribution to the mutual
+    information is cached and only the joint histogram is counted per pair.
+
+    The joint histogram is counted in a flat integer table indexed by
+    (rank1 * states2 + rank2), as long as it has at most
+    @ref MAX_JOINT_TABLE_SIZE cells; the table is reused across pairs. Only
+    very long traces fall back to sorting the joint states.
+
+    All traces that are compared need to have the same length.
+  */
+  class OPENSWATHALGO_DLLAPI MIEngine
+  {
+public:
+    /// Maximal number of cells of the joint histogram table
+    static constexpr std::size_t MAX_JOINT_TABLE_SIZE = 1 << 16;
+
+    /// Ranks @p trace and adds it; returns the index of the trace
+    std::size_t addTrace(const std::vector<double>& trace);
+
+    /// Adds all @p traces; returns the index of the first of them
+    std::size_t addTraces(const std::vector<std::vector<double> >& traces);
+
+    /// Number of traces
+    std::size_t size() const;
+
+    /// Removes all traces
+    void clear();
+
+    /// Ranks (0 .. number of states - 1) of trace @p i
+    const std::vector<unsigned int>& getRanks(std::size_t i) const;
+
+    /// Ranked mutual information (in bits) of traces @p i and @p j
+    double mutualInformation(std::size_t i, std::size_t j);
+
+private:
+    /// ranks of the traces, renumbered without gaps
+    std::vector<std::vector<unsigned int> > ranks_;
+
+    /// number of distinct ranks of each trace
+    std::vector<unsigned int> num_states_;
+
+    /// sum of c * log(c) over the marginal histogram of each trace
+    std::vector<double> marginal_terms_;
+
+    /// c * log(c) for all counts c up to the longest trace
+    std::vector<double> xlogx_;
+
+    /// joint histogram table (all zero between calls of mutualInformation())
+    std::vector<unsigned int> joint_counts_;
+
+    /// joint state of each data point of the current pair
+    std::vector<unsigned int> joint_states_;
+  };
+
+}
@@ -0,0 +1,135 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/OPENSWATHALGO/OpenSwathAlgoConfig.h>
+#include <OpenMS/OPENSWATHALGO/ALGO/Scoring.h>
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace OpenSwath
+{
+
+  /**
+    @brief Batched computation of normalized cross-correlations between traces
+
+    Scoring a peak group correlates every pair of its fragment (and precursor)
+    traces. This class standardizes each trace once when it is added
+    (see Scoring::standardize_data()) and computes the cross-correlation of
+    any pair of added traces for all lags from -n to n (n: trace length),
+    which is the same as Scoring::normalizedCrossCorrelation() with
+    maxdelay = n and lag = 1.
+
+    Short traces are correlated by a direct kernel (one contiguous dot
+    product per lag). For traces with at least @ref FFT_MIN_SIZE data points,
+    the Fourier transform of each trace is computed once in addTrace() and
+    every pair only needs one inverse transform.
+
+    Most scores only need the highest peak of a cross-correlation, which
+    maxPeak() returns without storing the full lag array.
+  */
+  class OPENSWATHALGO_DLLAPI XCorrEngine
+  {
+public:
+    /// Lag and value of the highest cross-correlation (as returned by Scoring::xcorrArrayGetMaxPeak())
+    typedef Scoring::XCorrEntry XCorrPeak;
+
+    /// How cross-correlations are computed
+    enum class Method
+    {
+      AUTO,   ///< FFT for traces of at least @ref FFT_MIN_SIZE data points, direct kernel otherwise
+      DIRECT, ///< always use the direct kernel
+      FFT     ///< always use the FFT (for traces of equal length)
+    };
+
+    /// Minimal trace length for which Method::AUTO uses the FFT
+    static constexpr std::size_t FFT_MIN_SIZE = 256;
+
+    /// Constructor
+    explicit XCorrEngine(Method method = Method::AUTO);
+
+    /// Standardizes @p trace and adds it; returns the index of the trace
+    std::size_t addTrace(std::vector<double> trace);
+
+    /// Adds all @p traces; returns the index of the first of them
+    std::size_t addTraces(const std::vector<std::vector<double> >& traces);
+
+    /// Number of traces
+    std::size_t size() const;
+
+    /// Removes all traces
+    void clear();
+
+    /// Standardized trace @p i
+    const std::vector<double>& getTrace(std::size_t i) const;
+
+    /**
+      @brief Normalized cross-correlation of traces @p i and @p j
+
+      Element k of the result is the correlation at lag k - n, where n is the length of trace @p i.
+    */
+    std::vector<double> crossCorrelation(std::size_t i, std::size_t j) const;
+
+    /// Normalized cross-correlation of traces @p i and @p j as (lag, correlation) pairs
+    Scoring::XCorrArrayType crossCorrelationArray(std::size_t i, std::size_t j) const;
+
+    /// Lag and value of the highest normalized cross-correlation of traces @p i and @p j
+    XCorrPeak maxPeak(std::size_t i, std::size_t j) const;
+
+private:
+    /// Whether traces @p i and @p j are correlated via FFT
+    bool useFFT_(std::size_t i, std::size_t j) const;
+
+    /// Cross-correlation by direct summation (not yet divided by the trace length)
+    void directCrossCorrelation_(const std::vector<double>& data1, const std::vector<double>& data2, std::vector<double>& result) const;
+
+    /// Cross-correlation via the precomputed spectra (not yet divided by the trace length)
+    void fftCrossCorrelation_(std::size_t i, std::size_t j, std::vector<double>& result) const;
+
+    /// In-place radix-2 FFT (the size of @p data must be a power of two)
+    static void fft_(std::vector<std::complex<double> >& data, bool inverse);
+
+    Method method_;
+
+    /// the standardized traces
+    std::vector<std::vector<double> > traces_;
+
+    /// Fourier transforms of the zero-padded traces (empty for traces correlated directly)
+    std::vector<std::vector<std::complex<double> > > spectra_;
+  };
+
+}
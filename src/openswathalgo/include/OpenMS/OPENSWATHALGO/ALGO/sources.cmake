@@ -3,8 +3,10 @@ set(directory include/OpenMS/OPENSWATHALGO/ALGO)
 
 ### list all header files of the directory here
 set(sources_list_h
+MIEngine.h
 StatsHelpers.h
 Scoring.h
+XCorrEngine.h
 )
 
 ### add path to the filenames
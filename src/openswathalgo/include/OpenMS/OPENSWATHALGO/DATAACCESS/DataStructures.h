@@ -289,5 +289,14 @@ public:
   };
   typedef OSSpectrum Spectrum;
   typedef boost::shared_ptr<Spectrum> SpectrumPtr;
+
+  /// In-place view on the m/z and intensity data of a spectrum (does not own the data)
+  struct OPENSWATHALGO_DLLAPI OSSpectrumView
+  {
+    const double* mz = nullptr;        ///< m/z values (ascending)
+    const double* intensity = nullptr; ///< intensity values
+    std::size_t size = 0;              ///< number of data points
+  };
+  typedef OSSpectrumView SpectrumView;
 } //end Namespace OpenSwath
 
@@ -76,6 +76,18 @@ public:
     /// Returns the meta information for a spectrum
     virtual SpectrumMeta getSpectrumMetaById(int id) const = 0;
 
+    /**
+      @brief Provide an in-place view on the m/z and intensity data of a spectrum
+
+      Implementations that keep the data in memory in a suitable layout can
+      expose it without copying it into a Spectrum. The view stays valid as
+      long as this object exists.
+
+      @return Whether @p view was filled; the default implementation does not
+      support views and returns false (use getSpectrumById() instead)
+    */
+    virtual bool getSpectrumViewById(int id, SpectrumView& view) const;
+
     /// Return a pointer to a chromatogram at the given id
     virtual ChromatogramPtr getChromatogramById(int id) = 0;
     /// Returns the number of chromatograms available
@@ -0,0 +1,163 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/OPENSWATHALGO/ALGO/MIEngine.h>
+#include <OpenMS/OPENSWATHALGO/ALGO/Scoring.h>
+#include <OpenMS/OPENSWATHALGO/Macros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace OpenSwath
+{
+
+  std::size_t MIEngine::addTrace(const std::vector<double>& trace)
+  {
+    std::vector<unsigned int> ranks;
+    const unsigned int max_rank = Scoring::computeAndAppendRank(trace, ranks);
+
+    // tied data points share the rank of the first of them, which leaves gaps: renumber
+    std::vector<unsigned int> counts(trace.empty() ? 0 : max_rank + 1, 0);
+    for (unsigned int r : ranks) ++counts[r];
+    std::vector<unsigned int> state(counts.size());
+    unsigned int num_states = 0;
+    for (std::size_t r = 0; r < counts.size(); ++r)
+    {
+      if (counts[r] > 0) state[r] = num_states++;
+    }
+    for (unsigned int& r : ranks) r = state[r];
+
+    for (std::size_t c = xlogx_.size(); c <= trace.size(); ++c)
+    {
+      xlogx_.push_back(c == 0 ? 0.0 : c * std::log(static_cast<double>(c)));
+    }
+    double marginal_term = 0.0;
+    for (unsigned int c : counts) marginal_term += xlogx_[c];
+
+    ranks_.push_back(std::move(ranks));
+    num_states_.push_back(num_states);
+    marginal_terms_.push_back(marginal_term);
+    return ranks_.size() - 1;
+  }
+
+  std::size_t MIEngine::addTraces(const std::vector<std::vector<double> >& traces)
+  {
+    const std::size_t first = ranks_.size();
+    for (const auto& trace : traces)
+    {
+      addTrace(trace);
+    }
+    return first;
+  }
+
+  std::size_t MIEngine::size() const
+  {
+    return ranks_.size();
+  }
+
+  void MIEngine::clear()
+  {
+    ranks_.clear();
+    num_states_.clear();
+    marginal_terms_.clear();
+  }
+
+  const std::vector<unsigned int>& MIEngine::getRanks(std::size_t i) const
+  {
+    return ranks_[i];
+  }
+
+  double MIEngine::mutualInformation(std::size_t i, std::size_t j)
+  {
+    const std::vector<unsigned int>& ranks1 = ranks_[i];
+    const std::vector<unsigned int>& ranks2 = ranks_[j];
+    OPENSWATH_PRECONDITION(!ranks1.empty() && ranks1.size() == ranks2.size(), "Both data vectors need to have the same length");
+
+    // MI = 1/n * sum_xy c_xy * log(n * c_xy / (c_x * c_y)); the sums of c_x * log(c_x) and c_y * log(c_y) are cached per trace
+    const std::size_t n = ranks1.size();
+    const unsigned int states2 = num_states_[j];
+    const std::size_t cells = static_cast<std::size_t>(num_states_[i]) * states2;
+    double joint_term = 0.0;
+    if (cells <= MAX_JOINT_TABLE_SIZE)
+    {
+      if (joint_counts_.size() < cells) joint_counts_.resize(cells, 0);
+      joint_states_.resize(n);
+
+      const unsigned int* r1 = ranks1.data();
+      const unsigned int* r2 = ranks2.data();
+      unsigned int* joint = joint_states_.data();
+#pragma omp simd
+      for (std::size_t k = 0; k < n; ++k)
+      {
+        joint[k] = r1[k] * states2 + r2[k];
+      }
+      for (std::size_t k = 0; k < n; ++k)
+      {
+        ++joint_counts_[joint[k]];
+      }
+      // visit each occupied cell once and reset it, which leaves the table zeroed for the next pair
+      for (std::size_t k = 0; k < n; ++k)
+      {
+        unsigned int& count = joint_counts_[joint[k]];
+        if (count != 0)
+        {
+          joint_term += xlogx_[count];
+          count = 0;
+        }
+      }
+    }
+    else
+    {
+      std::vector<std::uint64_t> joint(n);
+      for (std::size_t k = 0; k < n; ++k)
+      {
+        joint[k] = static_cast<std::uint64_t>(ranks1[k]) * states2 + ranks2[k];
+      }
+      std::sort(joint.begin(), joint.end());
+      for (std::size_t k = 0; k < n;)
+      {
+        std::size_t end = k + 1;
+        while (end < n && joint[end] == joint[k]) ++end;
+        joint_term += xlogx_[end - k];
+        k = end;
+      }
+    }
+
+    const double log_n = std::log(static_cast<double>(n));
+    double mutual_information = (joint_term - marginal_terms_[i] - marginal_terms_[j]) / n + log_n;
+    return mutual_information / std::log(2.0);
+  }
+
+}
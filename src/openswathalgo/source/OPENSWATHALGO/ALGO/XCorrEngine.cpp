@@ -0,0 +1,234 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/OPENSWATHALGO/ALGO/XCorrEngine.h>
+#include <OpenMS/OPENSWATHALGO/Macros.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace OpenSwath
+{
+
+  XCorrEngine::XCorrEngine(Method method) :
+    method_(method)
+  {
+  }
+
+  std::size_t XCorrEngine::addTrace(std::vector<double> trace)
+  {
+    Scoring::standardize_data(trace);
+
+    std::vector<std::complex<double> > spectrum;
+    if (!trace.empty() && (method_ == Method::FFT || (method_ == Method::AUTO && trace.size() >= FFT_MIN_SIZE)))
+    {
+      // zero-pad to at least twice the length, so the circular correlation does not wrap around
+      std::size_t fft_size = 1;
+      while (fft_size < 2 * trace.size()) fft_size <<= 1;
+      spectrum.assign(fft_size, 0.0);
+      std::copy(trace.begin(), trace.end(), spectrum.begin());
+      fft_(spectrum, false);
+    }
+
+    traces_.push_back(std::move(trace));
+    spectra_.push_back(std::move(spectrum));
+    return traces_.size() - 1;
+  }
+
+  std::size_t XCorrEngine::addTraces(const std::vector<std::vector<double> >& traces)
+  {
+    const std::size_t first = traces_.size();
+    for (const std::vector<double>& trace : traces)
+    {
+      addTrace(trace);
+    }
+    return first;
+  }
+
+  std::size_t XCorrEngine::size() const
+  {
+    return traces_.size();
+  }
+
+  void XCorrEngine::clear()
+  {
+    traces_.clear();
+    spectra_.clear();
+  }
+
+  const std::vector<double>& XCorrEngine::getTrace(std::size_t i) const
+  {
+    return traces_[i];
+  }
+
+  std::vector<double> XCorrEngine::crossCorrelation(std::size_t i, std::size_t j) const
+  {
+    OPENSWATH_PRECONDITION(i < traces_.size() && j < traces_.size(), "Trace index out of range");
+
+    std::vector<double> result;
+    if (useFFT_(i, j))
+    {
+      fftCrossCorrelation_(i, j, result);
+    }
+    else
+    {
+      directCrossCorrelation_(traces_[i], traces_[j], result);
+    }
+
+    const double size = static_cast<double>(traces_[i].size());
+    for (double& value : result)
+    {
+      value /= size;
+    }
+    return result;
+  }
+
+  Scoring::XCorrArrayType XCorrEngine::crossCorrelationArray(std::size_t i, std::size_t j) const
+  {
+    std::vector<double> xcorr = crossCorrelation(i, j);
+    const int maxdelay = static_cast<int>(traces_[i].size());
+
+    Scoring::XCorrArrayType result;
+    result.data.reserve(xcorr.size());
+    for (std::size_t k = 0; k < xcorr.size(); ++k)
+    {
+      result.data.emplace_back(static_cast<int>(k) - maxdelay, xcorr[k]);
+    }
+    return result;
+  }
+
+  XCorrEngine::XCorrPeak XCorrEngine::maxPeak(std::size_t i, std::size_t j) const
+  {
+    std::vector<double> xcorr = crossCorrelation(i, j);
+    const int maxdelay = static_cast<int>(traces_[i].size());
+
+    // first highest value, as in Scoring::xcorrArrayGetMaxPeak()
+    std::size_t max_k = 0;
+    for (std::size_t k = 1; k < xcorr.size(); ++k)
+    {
+      if (xcorr[k] > xcorr[max_k]) max_k = k;
+    }
+    return XCorrPeak(static_cast<int>(max_k) - maxdelay, xcorr[max_k]);
+  }
+
+  bool XCorrEngine::useFFT_(std::size_t i, std::size_t j) const
+  {
+    return !spectra_[i].empty() && traces_[i].size() == traces_[j].size();
+  }
+
+  void XCorrEngine::directCrossCorrelation_(const std::vector<double>& data1, const std::vector<double>& data2, std::vector<double>& result) const
+  {
+    const int size1 = static_cast<int>(data1.size());
+    const int size2 = static_cast<int>(std::min(data1.size(), data2.size()));
+    result.assign(2 * size1 + 1, 0.0);
+
+    const double* x = data1.data();
+    const double* y = data2.data();
+    for (int delay = -size1; delay <= size1; ++delay)
+    {
+      // only the overlapping part contributes: 0 <= i < size1 and 0 <= i + delay < size2
+      const int begin = std::max(0, -delay);
+      const int end = std::min(size1, size2 - delay);
+      double sxy = 0;
+#pragma omp simd reduction(+: sxy)
+      for (int i = begin; i < end; ++i)
+      {
+        sxy += x[i] * y[i + delay];
+      }
+      result[delay + size1] = sxy;
+    }
+  }
+
+  void XCorrEngine::fftCrossCorrelation_(std::size_t i, std::size_t j, std::vector<double>& result) const
+  {
+    const std::vector<std::complex<double> >& spectrum1 = spectra_[i];
+    const std::vector<std::complex<double> >& spectrum2 = spectra_[j];
+    const std::size_t fft_size = spectrum1.size();
+
+    // correlation theorem: xcorr = IFFT(conj(FFT(x)) * FFT(y))
+    std::vector<std::complex<double> > product(fft_size);
+    for (std::size_t k = 0; k < fft_size; ++k)
+    {
+      product[k] = std::conj(spectrum1[k]) * spectrum2[k];
+    }
+    fft_(product, true);
+
+    // negative lags are stored at the end; lags -n and n have no overlap
+    const int size = static_cast<int>(traces_[i].size());
+    result.assign(2 * size + 1, 0.0);
+    for (int delay = -size + 1; delay < size; ++delay)
+    {
+      const std::size_t k = (delay >= 0) ? delay : fft_size + delay;
+      result[delay + size] = product[k].real() / fft_size;
+    }
+  }
+
+  void XCorrEngine::fft_(std::vector<std::complex<double> >& data, bool inverse)
+  {
+    const std::size_t n = data.size();
+
+    // bit-reversal permutation
+    for (std::size_t i = 1, j = 0; i < n; ++i)
+    {
+      std::size_t bit = n >> 1;
+      for (; j & bit; bit >>= 1)
+      {
+        j ^= bit;
+      }
+      j ^= bit;
+      if (i < j) std::swap(data[i], data[j]);
+    }
+
+    // butterflies
+    const double pi = std::acos(-1.0);
+    for (std::size_t len = 2; len <= n; len <<= 1)
+    {
+      const double angle = 2 * pi / len * (inverse ? 1 : -1);
+      const std::complex<double> w_len(std::cos(angle), std::sin(angle));
+      for (std::size_t start = 0; start < n; start += len)
+      {
+        std::complex<double> w(1.0, 0.0);
+        for (std::size_t k = 0; k < len / 2; ++k)
+        {
+          const std::complex<double> u = data[start + k];
+          const std::complex<double> v = data[start + k + len / 2] * w;
+          data[start + k] = u + v;
+          data[start + k + len / 2] = u - v;
+          w *= w_len;
+        }
+      }
+    }
+  }
+
+}
@@ -41,4 +41,9 @@ namespace OpenSwath
   {
   }
 
+  bool ISpectrumAccess::getSpectrumViewById(int /* id */, SpectrumView& /* view */) const
+  {
+    return false;
+  }
+
 }
@@ -38,8 +38,10 @@ set(directory source/OPENSWATHALGO)
 ### list all files of the directory here
 set(sources_algo_list
 
+  ALGO/MIEngine.cpp
   ALGO/Scoring.cpp
   ALGO/StatsHelpers.cpp
+  ALGO/XCorrEngine.cpp
 )
 
 set(sources_dataaccess_list
@@ -74,8 +76,10 @@ set(header_directory include/OpenMS/OPENSWATHALGO)
 
 ## add groups for headers
 set(header_algo_list
+  ALGO/MIEngine.h
   ALGO/Scoring.h
   ALGO/StatsHelpers.h
+  ALGO/XCorrEngine.h
 )
 set(header_dataaccess_list
   DATAACCESS/DataFrameWriter.h
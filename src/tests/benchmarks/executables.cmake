@@ -0,0 +1,31 @@
+set(format_executables_list
+  Base64_benchmark
+  MzMLFile_benchmark
+)
+
+set(filtering_executables_list
+  GaussFilter_benchmark
+)
+
+set(transformations_executables_list
+  FeatureFinderAlgorithmPicked_benchmark
+  PeakPickerHiRes_benchmark
+)
+
+set(openswath_executables_list
+  ChromatogramExtractorAlgorithm_benchmark
+)
+
+set(metadata_executables_list
+  IdentificationData_benchmark
+  MetaInfo_benchmark
+)
+
+### collect benchmark executables
+set(BENCHMARK_executables
+  ${format_executables_list}
+  ${filtering_executables_list}
+  ${transformations_executables_list}
+  ${openswath_executables_list}
+  ${metadata_executables_list}
+)
@@ -0,0 +1,155 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "BenchmarkHelper.h"
+
+#include <OpenMS/FORMAT/Base64.h>
+
+#include <random>
+
+using namespace OpenMS;
+using namespace std;
+
+/*
+  Micro-benchmark for Base64 decoding / encoding of binary data arrays as
+  found in mzML files. The current implementation is compared against the
+  previous character-by-character decoder (kept here as reference,
+  see the "decode_legacy" results).
+*/
+
+namespace
+{
+  const char legacy_decoder[] = "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+
+  /// the decoder used before the SIMD kernels were introduced (little endian input on little endian machines)
+  template <typename ToType>
+  void legacyDecode(const String& in, vector<ToType>& out)
+  {
+    out.clear();
+    Size src_size = in.size();
+    int padding = 0;
+    if (in[src_size - 1] == '=') padding++;
+    if (in[src_size - 2] == '=') padding++;
+    src_size -= padding;
+
+    const Size element_size = sizeof(ToType);
+    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
+    UInt offset = 0;
+    UInt written = 0;
+    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
+
+    auto put = [&](unsigned char c)
+    {
+      element[offset] = c;
+      written++;
+      offset = (offset + 1) % element_size;
+      if (written % element_size == 0)
+      {
+        out.push_back(*reinterpret_cast<ToType*>(&element[0]));
+      }
+    };
+
+    for (Size i = 0; i < src_size; i += 4)
+    {
+      UInt a = legacy_decoder[(int)in[i] - 43] - 62;
+      UInt b = legacy_decoder[(int)in[i + 1] - 43] - 62;
+      if (i + 1 >= src_size) b = 0;
+      put((unsigned char)((a << 2) | (b >> 4)));
+      a = legacy_decoder[(int)in[i + 2] - 43] - 62;
+      if (i + 2 >= src_size) a = 0;
+      put((unsigned char)(((b & 15) << 4) | (a >> 2)));
+      b = legacy_decoder[(int)in[i + 3] - 43] - 62;
+      if (i + 3 >= src_size) b = 0;
+      put((unsigned char)(((a & 3) << 6) | b));
+    }
+  }
+
+  template <typename T>
+  void benchmarkArray(Benchmark::Runner& runner, const String& type_name, Size n)
+  {
+    // m/z like values with a fixed seed, so runs are comparable
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(100.0, 2000.0);
+    vector<T> values(n);
+    for (auto& v : values)
+    {
+      v = (T)dist(rng);
+    }
+
+    String encoded;
+    vector<T> tmp = values;
+    Base64::encode(tmp, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+
+    // process roughly 2M elements per repetition
+    const Size batch = std::max(Size(1), Size(2000000) / n);
+    Benchmark::Throughput throughput;
+    throughput.bytes = double(encoded.size()) * batch;
+    const String suffix = "/" + type_name + "/" + String(n);
+
+    vector<T> out;
+    runner.run("decode" + suffix, throughput, [&]()
+    {
+      for (Size b = 0; b < batch; ++b) Base64::decode(encoded, Base64::BYTEORDER_LITTLEENDIAN, out);
+    });
+    if (runner.enabled("decode" + suffix) && out != values)
+    {
+      runner.fail("decoded " + type_name + " array does not match the input");
+    }
+    runner.run("decode_legacy" + suffix, throughput, [&]()
+    {
+      for (Size b = 0; b < batch; ++b) legacyDecode(encoded, out);
+    });
+    runner.run("encode" + suffix, throughput, [&]()
+    {
+      for (Size b = 0; b < batch; ++b)
+      {
+        tmp = values;
+        Base64::encode(tmp, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+      }
+    });
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  Benchmark::Runner runner(argc, argv, "Base64");
+
+  // typical array lengths of MS2 spectra, MS1 spectra, profile spectra and chromatograms
+  for (Size n : {500, 5000, 50000, 500000})
+  {
+    benchmarkArray<float>(runner, "float", n);
+    benchmarkArray<double>(runner, "double", n);
+  }
+  return runner.finish();
+}
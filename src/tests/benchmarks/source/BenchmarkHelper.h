@@ -0,0 +1,396 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/CONCEPT/VersionInfo.h>
+#include <OpenMS/DATASTRUCTURES/DateTime.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/SYSTEM/SysInfo.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+  Common infrastructure of the micro-benchmarks in this directory.
+
+  Each benchmark executable creates a Benchmark::Runner and registers its
+  measurements with Runner::run(). The fastest of several repetitions is
+  reported together with the throughput (spectra/s, peaks/s, MB/s) and the
+  peak resident memory of the process so far. All benchmarks accept
+
+    --json <file>     write the results as JSON (similar to the format of
+                      Google Benchmark, so existing tooling can read it)
+    --filter <text>   only run benchmarks whose name contains <text>
+    --repeats <n>     number of timed repetitions per benchmark
+
+  Input data is generated synthetically with fixed random seeds, so
+  runs are comparable between machines and releases.
+*/
+
+namespace OpenMS
+{
+  namespace Benchmark
+  {
+    /// Amount of data processed by one iteration of a benchmark (zero entries are not reported)
+    struct Throughput
+    {
+      double spectra = 0;
+      double peaks = 0;
+      double bytes = 0;
+    };
+
+    /// Result of a single benchmark
+    struct Result
+    {
+      String name;
+      Size repeats = 0;
+      double seconds = 0; ///< fastest wall clock time of one repetition
+      Throughput throughput;
+      size_t peak_rss_kb = 0; ///< peak resident memory of the process after the benchmark
+      std::vector<std::pair<String, double>> counters; ///< additional, benchmark-specific measurements
+    };
+
+    class Runner
+    {
+    public:
+      Runner(int argc, const char** argv, const String& suite) :
+        suite_(suite)
+      {
+        for (int i = 1; i < argc; ++i)
+        {
+          const String arg(argv[i]);
+          if (i + 1 < argc && arg == "--json")
+          {
+            json_file_ = argv[++i];
+          }
+          else if (i + 1 < argc && arg == "--filter")
+          {
+            filter_ = argv[++i];
+          }
+          else if (i + 1 < argc && arg == "--repeats")
+          {
+            repeats_ = std::max(1, std::atoi(argv[++i]));
+            repeats_fixed_ = true;
+          }
+          else
+          {
+            std::cerr << "Usage: " << argv[0] << " [--json <file>] [--filter <text>] [--repeats <n>]" << std::endl;
+            std::exit(EXIT_FAILURE);
+          }
+        }
+        std::cout << std::setw(48) << std::left << suite_ << std::right << std::setw(12) << "time [s]"
+                  << std::setw(14) << "spectra/s" << std::setw(14) << "peaks/s" << std::setw(12) << "MB/s"
+                  << std::setw(14) << "peak RSS [MB]" << std::endl;
+      }
+
+      /// Sets the default number of repetitions (for expensive benchmarks; --repeats takes precedence)
+      void setRepeats(Size repeats)
+      {
+        if (!repeats_fixed_) repeats_ = std::max(Size(1), repeats);
+      }
+
+      /// Returns true if the benchmark @p name is selected by --filter (use to skip expensive data generation)
+      bool enabled(const String& name) const
+      {
+        return filter_.empty() || name.hasSubstring(filter_);
+      }
+
+      /// Times @p f, calling @p setup (untimed) before each repetition
+      template <typename Setup, typename Function>
+      void run(const String& name, const Throughput& throughput, Setup setup, Function f)
+      {
+        if (!enabled(name)) return;
+        Result result;
+        result.name = suite_ + "/" + name;
+        result.repeats = repeats_;
+        result.throughput = throughput;
+        result.seconds = std::numeric_limits<double>::max();
+        for (Size r = 0; r < repeats_; ++r)
+        {
+          setup();
+          const auto start = std::chrono::steady_clock::now();
+          f();
+          const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+          result.seconds = std::min(result.seconds, elapsed.count());
+        }
+        SysInfo::getProcessPeakMemoryConsumption(result.peak_rss_kb);
+        print_(result);
+        results_.push_back(result);
+      }
+
+      /// Times @p f
+      template <typename Function>
+      void run(const String& name, const Throughput& throughput, Function f)
+      {
+        run(name, throughput, []() {}, f);
+      }
+
+      /// Attaches an additional measurement (e.g. memory per element) to the most recent result
+      void addCounter(const String& name, double value)
+      {
+        if (results_.empty()) return;
+        results_.back().counters.emplace_back(name, value);
+        std::cout << "  " << std::setw(46) << std::left << name << std::right << std::setw(12) << String::number(value, 1) << std::endl;
+      }
+
+      /// Current resident memory of the process in KB (for measuring the memory of data structures)
+      static size_t currentMemoryKB()
+      {
+        size_t mem_kb = 0;
+        SysInfo::getProcessMemoryConsumption(mem_kb);
+        return mem_kb;
+      }
+
+      /// Reports a failed correctness check; the benchmark executable will return a non-zero exit code
+      void fail(const String& message)
+      {
+        std::cerr << "Error: " << message << std::endl;
+        failed_ = true;
+      }
+
+      /// Writes the JSON report (if requested) and returns the exit code of the benchmark executable
+      int finish() const
+      {
+        if (!json_file_.empty())
+        {
+          std::ofstream os(json_file_.c_str());
+          if (!os)
+          {
+            std::cerr << "Error: could not write '" << json_file_ << "'" << std::endl;
+            return EXIT_FAILURE;
+          }
+          writeJSON_(os);
+        }
+        return failed_ ? EXIT_FAILURE : EXIT_SUCCESS;
+      }
+
+    private:
+      static double perSecond_(double amount, double seconds)
+      {
+        return amount / std::max(seconds, std::numeric_limits<double>::min());
+      }
+
+      static String quote_(const String& s)
+      {
+        String quoted = s;
+        quoted.substitute("\\", "\\\\");
+        quoted.substitute("\"", "\\\"");
+        return "\"" + quoted + "\"";
+      }
+
+      void print_(const Result& r) const
+      {
+        auto rate = [](double amount, double seconds, double scale, int precision)
+        {
+          if (amount == 0) return String("-");
+          return String::number(perSecond_(amount, seconds) / scale, precision);
+        };
+        // the suite is printed in the header line
+        std::cout << std::setw(48) << std::left << r.name.suffix(r.name.size() - suite_.size() - 1) << std::right << std::setw(12) << String::number(r.seconds, 4)
+                  << std::setw(14) << rate(r.throughput.spectra, r.seconds, 1.0, 0)
+                  << std::setw(14) << rate(r.throughput.peaks, r.seconds, 1.0, 0)
+                  << std::setw(12) << rate(r.throughput.bytes, r.seconds, 1024.0 * 1024.0, 1)
+                  << std::setw(14) << String::number(r.peak_rss_kb / 1024.0, 1) << std::endl;
+      }
+
+      void writeJSON_(std::ostream& os) const
+      {
+        os << std::setprecision(std::numeric_limits<double>::digits10);
+        os << "{\n  \"context\": {\n"
+           << "    \"date\": " << quote_(DateTime::now().get()) << ",\n"
+           << "    \"suite\": " << quote_(suite_) << ",\n"
+           << "    \"openms_version\": " << quote_(VersionInfo::getVersion()) << ",\n"
+           << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+           << "  },\n  \"benchmarks\": [";
+        for (Size i = 0; i < results_.size(); ++i)
+        {
+          const Result& r = results_[i];
+          os << (i == 0 ? "\n" : ",\n") << "    {\n"
+             << "      \"name\": " << quote_(r.name) << ",\n"
+             << "      \"repetitions\": " << r.repeats << ",\n"
+             << "      \"real_time\": " << r.seconds << ",\n"
+             << "      \"time_unit\": \"s\",\n";
+          if (r.throughput.spectra > 0) os << "      \"spectra_per_second\": " << perSecond_(r.throughput.spectra, r.seconds) << ",\n";
+          if (r.throughput.peaks > 0) os << "      \"peaks_per_second\": " << perSecond_(r.throughput.peaks, r.seconds) << ",\n";
+          if (r.throughput.bytes > 0) os << "      \"bytes_per_second\": " << perSecond_(r.throughput.bytes, r.seconds) << ",\n";
+          for (const auto& counter : r.counters)
+          {
+            os << "      " << quote_(counter.first) << ": " << counter.second << ",\n";
+          }
+          os << "      \"peak_rss_kb\": " << r.peak_rss_kb << "\n    }";
+        }
+        os << "\n  ]\n}\n";
+      }
+
+      String suite_;
+      String json_file_;
+      String filter_;
+      Size repeats_ = 5;
+      bool repeats_fixed_ = false;
+      bool failed_ = false;
+      std::vector<Result> results_;
+    };
+
+    /// Number of peaks in all spectra of @p exp
+    inline double countPeaks(const PeakMap& exp)
+    {
+      double peaks = 0;
+      for (const MSSpectrum& s : exp)
+      {
+        peaks += s.size();
+      }
+      return peaks;
+    }
+
+    /// A synthetic peptide feature: isotope pattern at charge @p charge eluting as Gaussian in RT
+    struct SyntheticFeature
+    {
+      double mz;
+      double rt;
+      double rt_sigma;
+      double intensity;
+      int charge;
+    };
+
+    /// Generates @p nr_features peptide-like features in the given m/z and RT range (fixed seed)
+    inline std::vector<SyntheticFeature> generateFeatures(Size nr_features, double mz_min, double mz_max, double rt_max, unsigned seed = 42)
+    {
+      std::mt19937 rng(seed);
+      std::uniform_real_distribution<double> mz_dist(mz_min, mz_max);
+      std::uniform_real_distribution<double> rt_dist(0.0, rt_max);
+      std::uniform_real_distribution<double> sigma_dist(3.0, 10.0);
+      std::lognormal_distribution<double> int_dist(10.0, 1.5);
+      std::uniform_int_distribution<int> charge_dist(1, 3);
+      std::vector<SyntheticFeature> features(nr_features);
+      for (SyntheticFeature& f : features)
+      {
+        f = SyntheticFeature{mz_dist(rng), rt_dist(rng), sigma_dist(rng), int_dist(rng), charge_dist(rng)};
+      }
+      return features;
+    }
+
+    /**
+      @brief Generates an LC-MS map (MS1 only, one spectrum per @p rt_spacing seconds) of the given @p features
+
+      Each feature contributes four isotopic peaks with averagine-like decreasing intensities. For profile data,
+      each peak is sampled as Gaussian with a FWHM corresponding to the @p resolution at @p sampling points
+      per FWHM; for centroided data, one peak per isotope is created. In addition, @p noise_peaks low-intensity
+      peaks are added to each spectrum.
+    */
+    inline PeakMap generateMap(const std::vector<SyntheticFeature>& features, Size nr_spectra, double rt_spacing, bool profile,
+                               Size noise_peaks = 100, double resolution = 30000.0, Size sampling = 6, unsigned seed = 4711)
+    {
+      std::mt19937 rng(seed);
+      std::uniform_real_distribution<double> unit(0.0, 1.0);
+      const double isotope_ratio[] = {1.0, 0.8, 0.4, 0.15};
+
+      // sort by elution start so only the active features are visited per spectrum
+      std::vector<SyntheticFeature> sorted(features);
+      std::sort(sorted.begin(), sorted.end(), [](const SyntheticFeature& a, const SyntheticFeature& b)
+      {
+        return a.rt - 3 * a.rt_sigma < b.rt - 3 * b.rt_sigma;
+      });
+      double mz_min = std::numeric_limits<double>::max(), mz_max = 0;
+      for (const SyntheticFeature& f : features)
+      {
+        mz_min = std::min(mz_min, f.mz);
+        mz_max = std::max(mz_max, f.mz + 4.0);
+      }
+
+      PeakMap exp;
+      std::vector<std::pair<double, double>> peaks;
+      for (Size i = 0; i < nr_spectra; ++i)
+      {
+        const double rt = i * rt_spacing;
+        peaks.clear();
+        for (const SyntheticFeature& f : sorted)
+        {
+          if (f.rt - 3 * f.rt_sigma > rt) break;
+          const double d = (rt - f.rt) / f.rt_sigma;
+          if (std::fabs(d) > 3) continue;
+          const double height = f.intensity * std::exp(-0.5 * d * d);
+          for (Size iso = 0; iso < 4; ++iso)
+          {
+            const double mz = f.mz + iso * Constants::C13C12_MASSDIFF_U / f.charge;
+            const double intensity = height * isotope_ratio[iso] * (0.95 + 0.1 * unit(rng));
+            if (!profile)
+            {
+              peaks.emplace_back(mz + (unit(rng) - 0.5) * mz / resolution / 10, intensity);
+              continue;
+            }
+            const double fwhm = mz / resolution;
+            const double sigma = fwhm / 2.3548;
+            const double step = fwhm / sampling;
+            for (int k = -int(sampling); k <= int(sampling); ++k)
+            {
+              const double offset = k * step;
+              peaks.emplace_back(mz + offset, intensity * std::exp(-0.5 * offset * offset / (sigma * sigma)));
+            }
+          }
+        }
+        for (Size k = 0; k < noise_peaks; ++k)
+        {
+          peaks.emplace_back(mz_min + (mz_max - mz_min) * unit(rng), 50.0 * unit(rng));
+        }
+        std::sort(peaks.begin(), peaks.end());
+
+        MSSpectrum spectrum;
+        spectrum.setRT(rt);
+        spectrum.setMSLevel(1);
+        spectrum.setNativeID("scan=" + String(i + 1));
+        spectrum.setType(profile ? SpectrumSettings::PROFILE : SpectrumSettings::CENTROID);
+        spectrum.reserve(peaks.size());
+        for (const auto& p : peaks)
+        {
+          spectrum.emplace_back(p.first, p.second);
+        }
+        exp.addSpectrum(std::move(spectrum));
+      }
+      exp.updateRanges();
+      return exp;
+    }
+  }
+}
@@ -0,0 +1,176 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include "BenchmarkHelper.h"
+
+#include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractorAlgorithm.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
+
+#include <random>
+
+using namespace OpenMS;
+using namespace std;
+
+/*
+  Benchmark for the chromatogram extraction of OpenSwathWorkflow on a
+  synthetic SWATH map (random seed is fixed, so runs are comparable). The
+  batched extraction of ChromatogramExtractorAlgorithm::extractChromatograms
+  is compared against extracting each transition separately with
+  extract_value_tophat, which is what extractChromatograms did before (see
+  the "legacy" results).
+*/
+
+namespace
+{
+  typedef ChromatogramExtractorAlgorithm::ExtractionCoordinates ExtractionCoordinates;
+
+  /// the extraction loop used before the batched extraction was introduced
+  void legacyExtract(const OpenSwath::SpectrumAccessPtr& input, vector<OpenSwath::ChromatogramPtr>& output,
+                     const vector<ExtractionCoordinates>& coordinates, double mz_extraction_window, bool ppm)
+  {
+    ChromatogramExtractorAlgorithm extractor;
+    for (Size scan_idx = 0; scan_idx < input->getNrSpectra(); ++scan_idx)
+    {
+      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
+      const double current_rt = input->getSpectrumMetaById(scan_idx).RT;
+      const vector<double>& mz = sptr->getMZArray()->data;
+      vector<double>::const_iterator mz_it = mz.begin();
+      vector<double>::const_iterator int_it = sptr->getIntensityArray()->data.begin();
+      if (mz.empty()) continue;
+      for (Size k = 0; k < coordinates.size(); ++k)
+      {
+        if (coordinates[k].rt_end - coordinates[k].rt_start > 0 &&
+            (current_rt < coordinates[k].rt_start || current_rt > coordinates[k].rt_end))
+        {
+          continue;
+        }
+        double integrated_intensity = 0;
+        extractor.extract_value_tophat(mz.begin(), mz_it, mz.end(), int_it, coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+        output[k]->getTimeArray()->data.push_back(current_rt);
+        output[k]->getIntensityArray()->data.push_back(integrated_intensity);
+      }
+    }
+  }
+
+  vector<OpenSwath::ChromatogramPtr> emptyChromatograms(Size n)
+  {
+    vector<OpenSwath::ChromatogramPtr> chromatograms;
+    for (Size k = 0; k < n; ++k)
+    {
+      chromatograms.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    }
+    return chromatograms;
+  }
+
+  double maxRelativeDifference(const vector<OpenSwath::ChromatogramPtr>& a, const vector<OpenSwath::ChromatogramPtr>& b)
+  {
+    double max_diff = 0;
+    for (Size k = 0; k < a.size(); ++k)
+    {
+      const vector<double>& x = a[k]->getIntensityArray()->data;
+      const vector<double>& y = b[k]->getIntensityArray()->data;
+      if (x.size() != y.size()) return numeric_limits<double>::infinity();
+      for (Size i = 0; i < x.size(); ++i)
+      {
+        max_diff = std::max(max_diff, std::fabs(x[i] - y[i]) / std::max(1.0, std::fabs(y[i])));
+      }
+    }
+    return max_diff;
+  }
+
+  void benchmarkExtraction(Benchmark::Runner& runner, Size nr_spectra, Size nr_peaks, Size nr_transitions, double rt_window, double mz_extraction_window, bool ppm)
+  {
+    // one SWATH window of 25 Th with centroided data
+    mt19937 rng(42);
+    uniform_real_distribution<double> mz_dist(500.0, 525.0);
+    uniform_real_distribution<double> int_dist(0.0, 1000.0);
+    boost::shared_ptr<PeakMap> exp(new PeakMap);
+    vector<double> mz(nr_peaks);
+    for (Size i = 0; i < nr_spectra; ++i)
+    {
+      MSSpectrum s;
+      s.setRT(i * 3.0);
+      s.setMSLevel(2);
+      for (double& m : mz) m = mz_dist(rng);
+      std::sort(mz.begin(), mz.end());
+      for (double m : mz) s.push_back(Peak1D(m, int_dist(rng)));
+      exp->addSpectrum(s);
+    }
+    OpenSwath::SpectrumAccessPtr input(new SpectrumAccessOpenMS(exp));
+
+    // transitions spread over the SWATH window and over the gradient
+    uniform_real_distribution<double> rt_dist(0.0, nr_spectra * 3.0);
+    vector<ExtractionCoordinates> coordinates(nr_transitions);
+    for (ExtractionCoordinates& c : coordinates)
+    {
+      c.mz = mz_dist(rng);
+      const double rt = rt_dist(rng);
+      c.rt_start = rt_window > 0 ? rt - rt_window / 2 : 0;
+      c.rt_end = rt_window > 0 ? rt + rt_window / 2 : -1;
+    }
+    std::sort(coordinates.begin(), coordinates.end(), ExtractionCoordinates::SortExtractionCoordinatesByMZ);
+
+    const String name = String(nr_peaks) + "pk/" + String(nr_transitions) + "tr/rt_" + (rt_window > 0 ? String(rt_window) : String("all"))
+                        + "/" + String(mz_extraction_window) + (ppm ? "ppm" : "Th");
+    Benchmark::Throughput throughput;
+    throughput.spectra = nr_spectra;
+    throughput.peaks = double(nr_spectra) * nr_peaks;
+
+    ChromatogramExtractorAlgorithm extractor;
+    vector<OpenSwath::ChromatogramPtr> batched, legacy;
+    runner.run("batched/" + name, throughput,
+      [&]() { batched = emptyChromatograms(nr_transitions); },
+      [&]() { extractor.extractChromatograms(input, batched, coordinates, mz_extraction_window, ppm, -1, "tophat"); });
+    runner.run("legacy/" + name, throughput,
+      [&]() { legacy = emptyChromatograms(nr_transitions); },
+      [&]() { legacyExtract(input, legacy, coordinates, mz_extraction_window, ppm); });
+    if (runner.enabled("batched/" + name) && runner.enabled("legacy/" + name) && maxRelativeDifference(batched, legacy) > 1e-9)
+    {
+      runner.fail("batched and legacy extraction differ for " + name);
+    }
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  Benchmark::Runner runner(argc, argv, "ChromatogramExtractorAlgorithm");
+  runner.setRepeats(3);
+
+  benchmarkExtraction(runner, 200, 20000, 10000, 0, 0.05, false);
+  benchmarkExtraction(runner, 200, 20000, 10000, 0, 50, true);
+  benchmarkExtraction(runner, 200, 20000, 100000, 120, 50, true);
+  benchmarkExtraction(runner, 200, 50000, 100000, 0, 50, true);
+  return runner.finish();
+}
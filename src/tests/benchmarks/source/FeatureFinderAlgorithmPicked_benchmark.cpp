@@ -0,0 +1,84 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "BenchmarkHelper.h"
+
+#include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinder.h>
+#include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPicked.h>
+
+using namespace OpenMS;
+using namespace std;
+
+/*
+  Benchmark for the feature detection of FeatureFinderCentroided
+  (FeatureFinderAlgorithmPicked) on synthetic centroided LC-MS maps of
+  peptide-like isotope patterns.
+*/
+
+int main(int argc, const char** argv)
+{
+  Benchmark::Runner runner(argc, argv, "FeatureFinderAlgorithmPicked");
+  runner.setRepeats(1);
+
+  for (Size nr_features : {1000, 5000})
+  {
+    const String name = "run/" + String(nr_features) + "_features";
+    if (!runner.enabled(name)) continue;
+
+    // 20 min gradient with one MS1 spectrum per second
+    const vector<Benchmark::SyntheticFeature> features = Benchmark::generateFeatures(nr_features, 400.0, 1600.0, 1200.0);
+    PeakMap exp = Benchmark::generateMap(features, 1200, 1.0, false);
+    exp.updateRanges(1);
+
+    Benchmark::Throughput throughput;
+    throughput.spectra = exp.size();
+    throughput.peaks = Benchmark::countPeaks(exp);
+
+    FeatureMap output;
+    runner.run(name, throughput,
+      [&]() { output.clear(true); },
+      [&]()
+      {
+        FeatureFinder ff;
+        FeatureFinderAlgorithmPicked algorithm;
+        algorithm.setData(exp, output, ff);
+        algorithm.run();
+      });
+    if (output.empty())
+    {
+      runner.fail("no features found");
+    }
+  }
+  return runner.finish();
+}
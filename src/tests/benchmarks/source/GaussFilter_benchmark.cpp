@@ -0,0 +1,73 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "BenchmarkHelper.h"
+
+#include <OpenMS/FILTERING/SMOOTHING/GaussFilter.h>
+
+using namespace OpenMS;
+using namespace std;
+
+/*
+  Benchmark for smoothing synthetic profile LC-MS maps with GaussFilter,
+  using a fixed width in Th and a width relative to m/z (ppm).
+*/
+
+int main(int argc, const char** argv)
+{
+  Benchmark::Runner runner(argc, argv, "GaussFilter");
+
+  const vector<Benchmark::SyntheticFeature> features = Benchmark::generateFeatures(10000, 400.0, 1600.0, 1800.0);
+  const PeakMap exp = Benchmark::generateMap(features, 900, 2.0, true);
+
+  Benchmark::Throughput throughput;
+  throughput.spectra = exp.size();
+  throughput.peaks = Benchmark::countPeaks(exp);
+
+  for (bool ppm : {false, true})
+  {
+    GaussFilter filter;
+    Param param = filter.getParameters();
+    param.setValue("gaussian_width", 0.02);
+    param.setValue("use_ppm_tolerance", ppm ? "true" : "false");
+    param.setValue("ppm_tolerance", 20.0);
+    filter.setParameters(param);
+
+    PeakMap smoothed;
+    runner.run(String("filterExperiment/") + (ppm ? "ppm" : "Th"), throughput,
+      [&]() { smoothed = exp; },
+      [&]() { filter.filterExperiment(smoothed); });
+  }
+  return runner.finish();
+}
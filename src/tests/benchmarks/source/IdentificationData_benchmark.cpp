@@ -0,0 +1,125 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "BenchmarkHelper.h"
+
+#include <OpenMS/METADATA/ID/IdentificationData.h>
+
+#include <memory>
+
+using namespace OpenMS;
+using namespace std;
+
+/*
+  Benchmark for building IdentificationData with many peptide-spectrum
+  matches (two candidates per spectrum, two scores per match). Besides the
+  time, the memory growth of the process per registered match is reported
+  ("bytes_per_match"), to compare the memory layout between versions.
+*/
+
+int main(int argc, const char** argv)
+{
+  Benchmark::Runner runner(argc, argv, "IdentificationData");
+  runner.setRepeats(1);
+
+  for (Size nr_matches : {100000, 1000000})
+  {
+    const String name = "registerObservationMatch/" + String(nr_matches) + "_matches";
+    if (!runner.enabled(name)) continue;
+
+    // random peptide sequences (fixed seed), each identified in four spectra on average
+    const Size nr_peptides = nr_matches / 4;
+    const String residues = "ACDEFGHIKLMNPQRSTVWY";
+    mt19937 rng(42);
+    uniform_int_distribution<Size> length_dist(7, 20);
+    uniform_int_distribution<Size> residue_dist(0, residues.size() - 1);
+    uniform_int_distribution<Size> peptide_dist(0, nr_peptides - 1);
+    vector<AASequence> sequences;
+    sequences.reserve(nr_peptides);
+    for (Size i = 0; i < nr_peptides; ++i)
+    {
+      String seq(length_dist(rng), 'A');
+      for (char& c : seq) c = residues[residue_dist(rng)];
+      sequences.push_back(AASequence::fromString(seq + "K"));
+    }
+    vector<Size> match_peptides(nr_matches);
+    for (Size& p : match_peptides) p = peptide_dist(rng);
+
+    Benchmark::Throughput throughput;
+    throughput.spectra = nr_matches / 2;
+
+    unique_ptr<IdentificationData> ids;
+    size_t mem_before_kb = 0;
+    runner.run(name, throughput,
+      [&]()
+      {
+        ids.reset();
+        mem_before_kb = Benchmark::Runner::currentMemoryKB();
+        ids.reset(new IdentificationData());
+      },
+      [&]()
+      {
+        IdentificationData::InputFileRef file_ref = ids->registerInputFile(IdentificationData::InputFile("benchmark.mzML"));
+        IdentificationData::ProcessingSoftwareRef sw_ref = ids->registerProcessingSoftware(IdentificationData::ProcessingSoftware("SearchEngine", "1.0"));
+        IdentificationData::ProcessingStepRef step_ref = ids->registerProcessingStep(IdentificationData::ProcessingStep(sw_ref, {file_ref}));
+        IdentificationData::ScoreTypeRef evalue_ref = ids->registerScoreType(IdentificationData::ScoreType("E-value", false));
+        IdentificationData::ScoreTypeRef qvalue_ref = ids->registerScoreType(IdentificationData::ScoreType("q-value", false));
+
+        for (Size i = 0; i < nr_matches; i += 2)
+        {
+          IdentificationData::Observation obs("controllerType=0 controllerNumber=1 scan=" + String(i / 2 + 1), file_ref,
+                                              i * 0.01, 400.0 + (i % 1200));
+          IdentificationData::ObservationRef obs_ref = ids->registerObservation(obs);
+          for (Size j = i; j < min(i + 2, nr_matches); ++j)
+          {
+            IdentificationData::IdentifiedPeptideRef pep_ref =
+              ids->registerIdentifiedPeptide(IdentificationData::IdentifiedPeptide(sequences[match_peptides[j]]));
+            IdentificationData::ObservationMatch match(pep_ref, obs_ref, 2);
+            IdentificationData::AppliedProcessingStep applied(step_ref);
+            applied.scores[evalue_ref] = 1.0 / (j + 1);
+            applied.scores[qvalue_ref] = 0.01;
+            match.steps_and_scores.push_back(applied);
+            ids->registerObservationMatch(match);
+          }
+        }
+      });
+    runner.addCounter("bytes_per_match", (double(Benchmark::Runner::currentMemoryKB()) - mem_before_kb) * 1024.0 / nr_matches);
+
+    if (ids->getObservationMatches().size() != nr_matches)
+    {
+      runner.fail("unexpected number of observation matches");
+    }
+  }
+  return runner.finish();
+}
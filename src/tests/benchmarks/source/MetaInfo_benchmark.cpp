@@ -0,0 +1,179 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "BenchmarkHelper.h"
+
+#include <OpenMS/FORMAT/FeatureXMLFile.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+#include <OpenMS/SYSTEM/File.h>
+
+using namespace OpenMS;
+using namespace std;
+
+/*
+  Benchmark for meta value handling (MetaInfo/MetaInfoRegistry): loading
+  featureXML and idXML files in which every feature/hit carries a few meta
+  values, and concurrent access to meta values by name from all threads.
+*/
+
+namespace
+{
+  /// Peptide identifications with five hits each, and typical meta values at the identification and hit level
+  void generateIDs(Size nr_spectra, vector<ProteinIdentification>& proteins, vector<PeptideIdentification>& peptides)
+  {
+    mt19937 rng(42);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    const String residues = "ACDEFGHIKLMNPQRSTVWY";
+
+    proteins.assign(1, ProteinIdentification());
+    proteins[0].setIdentifier("run");
+    proteins[0].setSearchEngine("SearchEngine");
+    peptides.clear();
+    peptides.reserve(nr_spectra);
+    for (Size i = 0; i < nr_spectra; ++i)
+    {
+      PeptideIdentification pep;
+      pep.setIdentifier("run");
+      pep.setRT(i * 0.5);
+      pep.setMZ(400.0 + 1200.0 * unit(rng));
+      pep.setScoreType("E-value");
+      pep.setHigherScoreBetter(false);
+      pep.setMetaValue("spectrum_reference", "scan=" + String(i + 1));
+      for (Size h = 0; h < 5; ++h)
+      {
+        String seq(8 + h, 'A');
+        for (char& c : seq) c = residues[Size(unit(rng) * residues.size()) % residues.size()];
+        PeptideHit hit(unit(rng), UInt(h + 1), 2, AASequence::fromString(seq + "K"));
+        hit.setMetaValue("target_decoy", unit(rng) < 0.5 ? "target" : "decoy");
+        hit.setMetaValue("MS:1002252", unit(rng) * 100.0); // Comet:xcorr
+        hit.setMetaValue("num_matched_peptides", Int(unit(rng) * 1000));
+        hit.setMetaValue("isotope_error", 0);
+        pep.insertHit(hit);
+      }
+      peptides.push_back(pep);
+    }
+  }
+
+  /// Features with typical meta values
+  FeatureMap generateFeatureMap(const vector<Benchmark::SyntheticFeature>& synthetic)
+  {
+    FeatureMap features;
+    features.reserve(synthetic.size());
+    for (Size i = 0; i < synthetic.size(); ++i)
+    {
+      const Benchmark::SyntheticFeature& s = synthetic[i];
+      Feature f;
+      f.setRT(s.rt);
+      f.setMZ(s.mz);
+      f.setIntensity(s.intensity);
+      f.setCharge(s.charge);
+      f.setOverallQuality(0.9);
+      f.setUniqueId(i + 1);
+      f.setMetaValue("FWHM", 2.3548 * s.rt_sigma);
+      f.setMetaValue("spectrum_index", Int(i));
+      f.setMetaValue("label", "feature_" + String(i));
+      f.setMetaValue("score_fit", 0.95);
+      features.push_back(f);
+    }
+    return features;
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  Benchmark::Runner runner(argc, argv, "MetaInfo");
+  runner.setRepeats(3);
+
+  if (runner.enabled("FeatureXMLFile"))
+  {
+    const FeatureMap features = generateFeatureMap(Benchmark::generateFeatures(100000, 400.0, 1600.0, 3600.0));
+    const String filename = File::getTemporaryFile();
+    FeatureXMLFile().store(filename, features);
+
+    Benchmark::Throughput throughput;
+    throughput.spectra = features.size(); // features per second
+    FeatureMap loaded;
+    runner.run("FeatureXMLFile/load", throughput, [&]() { FeatureXMLFile().load(filename, loaded); });
+    if (loaded.size() != features.size() || !loaded[0].metaValueExists("FWHM"))
+    {
+      runner.fail("featureXML file does not contain the stored features");
+    }
+  }
+
+  if (runner.enabled("IdXMLFile"))
+  {
+    vector<ProteinIdentification> proteins;
+    vector<PeptideIdentification> peptides;
+    generateIDs(50000, proteins, peptides);
+    const String filename = File::getTemporaryFile();
+    IdXMLFile().store(filename, proteins, peptides);
+
+    Benchmark::Throughput throughput;
+    throughput.spectra = peptides.size(); // peptide identifications per second
+    vector<ProteinIdentification> loaded_proteins;
+    vector<PeptideIdentification> loaded_peptides;
+    runner.run("IdXMLFile/load", throughput, [&]() { IdXMLFile().load(filename, loaded_proteins, loaded_peptides); });
+    if (loaded_peptides.size() != peptides.size() || !loaded_peptides[0].getHits()[0].metaValueExists("target_decoy"))
+    {
+      runner.fail("idXML file does not contain the stored identifications");
+    }
+  }
+
+  // all threads read and write meta values by name (each access looks up the name in the registry)
+  if (runner.enabled("parallel_access"))
+  {
+    FeatureMap features = generateFeatureMap(Benchmark::generateFeatures(200000, 400.0, 1600.0, 3600.0));
+    Benchmark::Throughput throughput;
+    throughput.spectra = features.size();
+    double sum = 0;
+    runner.run("parallel_access", throughput, [&]()
+    {
+      sum = 0;
+#pragma omp parallel for reduction(+: sum)
+      for (SignedSize i = 0; i < (SignedSize)features.size(); ++i)
+      {
+        Feature& f = features[i];
+        sum += double(f.getMetaValue("FWHM")) + double(f.getMetaValue("score_fit"));
+        f.setMetaValue("normalized_intensity", f.getIntensity() / double(f.getMetaValue("FWHM")));
+        if (f.metaValueExists("not_there")) sum += 1.0;
+      }
+    });
+    if (!(sum > 0))
+    {
+      runner.fail("unexpected result of parallel meta value access");
+    }
+  }
+  return runner.finish();
+}
@@ -0,0 +1,113 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "BenchmarkHelper.h"
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/SYSTEM/File.h>
+
+using namespace OpenMS;
+using namespace std;
+
+/*
+  Benchmark for reading and writing mzML files of synthetic profile and
+  centroided LC-MS maps with the common binary encodings (uncompressed,
+  zlib and numpress). Throughput in MB/s refers to the size of the file.
+*/
+
+namespace
+{
+  double fileSize(const String& filename)
+  {
+    ifstream is(filename.c_str(), ios::binary | ios::ate);
+    return double(is.tellg());
+  }
+
+  void benchmarkFile(Benchmark::Runner& runner, const String& name, const PeakMap& exp, const String& encoding)
+  {
+    const String load_name = "load/" + name + "/" + encoding;
+    const String store_name = "store/" + name + "/" + encoding;
+    if (!runner.enabled(load_name) && !runner.enabled(store_name)) return;
+
+    MzMLFile file;
+    PeakFileOptions& options = file.getOptions();
+    if (encoding == "zlib")
+    {
+      options.setCompression(true);
+    }
+    else if (encoding == "numpress")
+    {
+      MSNumpressCoder::NumpressConfig config;
+      config.np_compression = MSNumpressCoder::LINEAR;
+      config.estimate_fixed_point = true;
+      options.setNumpressConfigurationMassTime(config);
+      config.np_compression = MSNumpressCoder::SLOF;
+      options.setNumpressConfigurationIntensity(config);
+    }
+
+    const String filename = File::getTemporaryFile();
+    Benchmark::Throughput throughput;
+    throughput.spectra = exp.size();
+    throughput.peaks = Benchmark::countPeaks(exp);
+
+    file.store(filename, exp);
+    throughput.bytes = fileSize(filename);
+    runner.run(store_name, throughput, [&]() { file.store(filename, exp); });
+
+    PeakMap loaded;
+    runner.run(load_name, throughput, [&]() { file.load(filename, loaded); });
+    if (runner.enabled(load_name) && (loaded.size() != exp.size() || Benchmark::countPeaks(loaded) != throughput.peaks))
+    {
+      runner.fail("mzML file " + load_name + " does not contain the stored data");
+    }
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  Benchmark::Runner runner(argc, argv, "MzMLFile");
+  runner.setRepeats(3);
+
+  // one hour gradient with one MS1 spectrum every three seconds
+  const vector<Benchmark::SyntheticFeature> features = Benchmark::generateFeatures(10000, 400.0, 1600.0, 3600.0);
+  const PeakMap profile = Benchmark::generateMap(features, 1200, 3.0, true);
+  const PeakMap centroided = Benchmark::generateMap(features, 1200, 3.0, false);
+
+  for (const String& encoding : {"none", "zlib", "numpress"})
+  {
+    benchmarkFile(runner, "profile", profile, encoding);
+    benchmarkFile(runner, "centroided", centroided, encoding);
+  }
+  return runner.finish();
+}
@@ -156,6 +156,7 @@ set(kernel_executables_list
   MSChromatogram_test
   MSExperiment_test
   OnDiscMSExperiment_test
+  ColumnarMSExperiment_test
   MSSpectrum_test
   Peak1D_test
   Peak2D_test
@@ -271,6 +272,7 @@ set(format_executables_list
   MSDataChainingConsumer_test
   MSDataStoringConsumer_test
   MSDataAggregatingConsumer_test
+  MSDataPeakPickingConsumer_test
   SpectrumAccessQuadMZTransforming_test
   SpectrumAccessSqMass_test
   SiriusFragmentAnnotation_test
@@ -369,6 +371,7 @@ set(comparison_executables_list
   AverageLinkage_test
   BinnedSharedPeakCount_test
   BinnedSpectralContrastAngle_test
+  BinnedSpectrumBlock_test
   BinnedSpectrumCompareFunctor_test
   BinnedSpectrum_test
   BinnedSumAgreeingIntensities_test
@@ -485,6 +488,7 @@ set(analysis_executables_list
   FeatureHandle_test
   FIAMSDataProcessor_test
   FIAMSScheduler_test
+  FragmentIndex_test
   HiddenMarkovModel_test
   IDBoostGraph_test
   IDMapper_test
@@ -533,7 +537,9 @@ set(analysis_executables_list
   ModifiedPeptideGenerator_test
   NeedlemanWunsch_test
   OfflinePrecursorIonSelection_test
+  PeptideDatabase_test
   PeptideIndexing_test
+  ProteinSequenceIndex_test
   PeptideAndProteinQuant_test
   PeptideProteinResolution_test
   PeakIntensityPredictor_test
@@ -559,6 +565,7 @@ set(analysis_executables_list
   RNPxlModificationsGenerator_test
   SVMWrapper_test
   SimpleSearchEngineAlgorithm_test
+  SpectralLibraryIndex_test
   SimplePairFinder_test
   SimpleSVM_test
   StablePairFinder_test
@@ -699,6 +706,7 @@ if(NOT DISABLE_OPENSWATH)
     IonMobilityScoring_test
     CachedMzML_test
     CachedMzMLHandler_test
+    CachedMzMLMappedFile_test
     HDF5_test
   )
 endif(NOT DISABLE_OPENSWATH)
@@ -500,6 +500,61 @@ START_SECTION((template <typename FromType> void encodeIntegers(std::vector<From
 }
 END_SECTION
 
+START_SECTION((static Size decodeRaw(const char* in, Size in_size, Byte* out)))
+{
+  std::vector<Byte> out(12);
+  String src = "SGVsbG8gV29ybGQ=";
+  TEST_EQUAL(Base64::decodeRaw(src.c_str(), src.size(), &out[0]), 11)
+  TEST_EQUAL(String(out.begin(), out.begin() + 11), "Hello World")
+
+  src = "SGVsbG8gV29ybGQh";
+  TEST_EQUAL(Base64::decodeRaw(src.c_str(), src.size(), &out[0]), 12)
+  TEST_EQUAL(String(out.begin(), out.end()), "Hello World!")
+
+  src = "SGVsbG8gV29ybA==";
+  TEST_EQUAL(Base64::decodeRaw(src.c_str(), src.size(), &out[0]), 10)
+  TEST_EQUAL(String(out.begin(), out.begin() + 10), "Hello Worl")
+
+  TEST_EQUAL(Base64::decodeRaw(src.c_str(), 0, &out[0]), 0)
+  TEST_EXCEPTION(Exception::ConversionError, Base64::decodeRaw(src.c_str(), 6, &out[0]))
+
+  // long input (covers the SIMD code paths) with all possible byte values
+  std::vector<Byte> data(3000);
+  for (Size i = 0; i < data.size(); ++i)
+  {
+    data[i] = (Byte)((i * 7) % 256);
+  }
+  for (Size len : {0, 1, 2, 3, 47, 48, 100, 1000, 2999, 3000})
+  {
+    String encoded(((len + 2) / 3) * 4, ' ');
+    TEST_EQUAL(Base64::encodeRaw(&data[0], len, &encoded[0]), encoded.size())
+    std::vector<Byte> decoded(encoded.size() / 4 * 3 + 1, 0);
+    TEST_EQUAL(Base64::decodeRaw(encoded.c_str(), encoded.size(), &decoded[0]), len)
+    TEST_EQUAL(std::equal(data.begin(), data.begin() + len, decoded.begin()), true)
+  }
+}
+END_SECTION
+
+START_SECTION((static Size encodeRaw(const Byte* in, Size in_size, char* out)))
+{
+  String in = "Hello World!";
+  String out(16, ' ');
+  TEST_EQUAL(Base64::encodeRaw(reinterpret_cast<const Byte*>(in.c_str()), 12, &out[0]), 16)
+  TEST_EQUAL(out, "SGVsbG8gV29ybGQh")
+  TEST_EQUAL(Base64::encodeRaw(reinterpret_cast<const Byte*>(in.c_str()), 11, &out[0]), 16)
+  TEST_EQUAL(out, "SGVsbG8gV29ybGQ=")
+  TEST_EQUAL(Base64::encodeRaw(reinterpret_cast<const Byte*>(in.c_str()), 10, &out[0]), 16)
+  TEST_EQUAL(out, "SGVsbG8gV29ybA==")
+  TEST_EQUAL(Base64::encodeRaw(reinterpret_cast<const Byte*>(in.c_str()), 0, &out[0]), 0)
+
+  // the SIMD kernel works on blocks of 12 bytes, compare against a known encoding
+  in = "The quick brown fox jumps over the lazy dog, again and again.";
+  out = String(((in.size() + 2) / 3) * 4, ' ');
+  Base64::encodeRaw(reinterpret_cast<const Byte*>(in.c_str()), in.size(), &out[0]);
+  TEST_EQUAL(out, "VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVyIHRoZSBsYXp5IGRvZywgYWdhaW4gYW5kIGFnYWluLg==")
+}
+END_SECTION
+
 ptr = new Base64;
 
 START_SECTION(inline UInt32 endianize32(const UInt32& n))
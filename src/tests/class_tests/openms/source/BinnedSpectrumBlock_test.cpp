@@ -0,0 +1,186 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSpectrumBlock.h>
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSharedPeakCount.h>
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSpectralContrastAngle.h>
+#include <OpenMS/COMPARISON/SPECTRA/BinnedSumAgreeingIntensities.h>
+#include <OpenMS/FORMAT/DTAFile.h>
+
+#include <Eigen/Sparse>
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(BinnedSpectrumBlock, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeakSpectrum s1;
+DTAFile().load(OPENMS_GET_TEST_DATA_PATH("PILISSequenceDB_DFPIANGER_1.dta"), s1);
+
+// library: the spectrum itself, one with a missing peak, one with scaled and shifted peaks and an empty one
+vector<BinnedSpectrum> library;
+{
+  PeakSpectrum s2 = s1;
+  s2.pop_back();
+  PeakSpectrum s3 = s1;
+  for (Size i = 0; i < s3.size(); ++i)
+  {
+    s3[i].setIntensity(s3[i].getIntensity() * (1.0 + 0.1 * (i % 3)));
+    if (i % 4 == 0) { s3[i].setMZ(s3[i].getMZ() + 3.0); }
+  }
+  s3.sortByPosition();
+  library.emplace_back(s1, 1.5, false, 2, 0.0);
+  library.emplace_back(s2, 1.5, false, 2, 0.0);
+  library.emplace_back(s3, 1.5, false, 2, 0.0);
+  library.emplace_back(PeakSpectrum(), 1.5, false, 2, 0.0);
+}
+const BinnedSpectrum query(s1, 1.5, false, 2, 0.0);
+
+BinnedSpectrumBlock* ptr = nullptr;
+BinnedSpectrumBlock* null_ptr = nullptr;
+START_SECTION(BinnedSpectrumBlock())
+{
+  ptr = new BinnedSpectrumBlock();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+  delete ptr;
+}
+END_SECTION
+
+BinnedSpectrumBlock block;
+
+START_SECTION(Size add(const BinnedSpectrum& spectrum))
+{
+  for (Size i = 0; i < library.size(); ++i)
+  {
+    TEST_EQUAL(block.add(library[i]), i)
+  }
+  TEST_EQUAL(block.size(), 4)
+  TEST_EXCEPTION(Exception::IllegalArgument, block.add(BinnedSpectrum(s1, 1.0, false, 2, 0.0)))
+  TEST_EQUAL(block.size(), 4)
+}
+END_SECTION
+
+START_SECTION(Size getNonZeros(Size index) const)
+{
+  for (Size i = 0; i < library.size(); ++i)
+  {
+    TEST_EQUAL(block.getNonZeros(i), Size(library[i].getBins()->nonZeros()))
+  }
+}
+END_SECTION
+
+START_SECTION(void compareContrastAngle(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const)
+{
+  BinnedSpectralContrastAngle functor;
+  vector<double> scores;
+  block.compareContrastAngle(query, 0, 3, scores);
+  TEST_EQUAL(scores.size(), 3)
+  for (Size i = 0; i < scores.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(scores[i], functor(query, library[i]))
+  }
+  TEST_REAL_SIMILAR(scores[0], 1.0)
+
+  block.compareContrastAngle(query, 1, 2, scores);
+  TEST_EQUAL(scores.size(), 1)
+  TEST_REAL_SIMILAR(scores[0], functor(query, library[1]))
+
+  TEST_EXCEPTION(Exception::IllegalArgument, block.compareContrastAngle(BinnedSpectrum(s1, 1.5, true, 2, 0.0), 0, 1, scores))
+}
+END_SECTION
+
+START_SECTION(void compareSharedPeakCount(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const)
+{
+  BinnedSharedPeakCount functor;
+  vector<double> scores;
+  block.compareSharedPeakCount(query, 0, 3, scores);
+  TEST_EQUAL(scores.size(), 3)
+  for (Size i = 0; i < scores.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(scores[i], functor(query, library[i]))
+  }
+  TEST_REAL_SIMILAR(scores[0], 1.0)
+
+  // empty library spectrum: no shared bins
+  block.compareSharedPeakCount(query, 3, 4, scores);
+  TEST_REAL_SIMILAR(scores[0], 0.0)
+}
+END_SECTION
+
+START_SECTION(void compareSumAgreeingIntensities(const BinnedSpectrum& query, Size first, Size last, std::vector<double>& scores) const)
+{
+  BinnedSumAgreeingIntensities functor;
+  vector<double> scores;
+  block.compareSumAgreeingIntensities(query, 0, 4, scores);
+  TEST_EQUAL(scores.size(), 4)
+  for (Size i = 0; i < 3; ++i)
+  {
+    TEST_REAL_SIMILAR(scores[i], functor(query, library[i]))
+  }
+  TEST_REAL_SIMILAR(scores[0], 1.0)
+  TEST_REAL_SIMILAR(scores[1], 0.99707)
+  TEST_REAL_SIMILAR(scores[3], 0.0)
+}
+END_SECTION
+
+START_SECTION(void reserve(Size spectra, Size bins))
+{
+  BinnedSpectrumBlock b;
+  b.reserve(10, 1000);
+  TEST_EQUAL(b.size(), 0)
+}
+END_SECTION
+
+START_SECTION(void clear())
+{
+  block.clear();
+  TEST_EQUAL(block.size(), 0)
+  // the binning of the next spectrum defines the block layout
+  block.add(BinnedSpectrum(s1, 1.0, false, 2, 0.0));
+  TEST_EQUAL(block.size(), 1)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
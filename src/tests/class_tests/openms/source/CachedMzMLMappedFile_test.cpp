@@ -0,0 +1,246 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLMappedFile.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>
+#include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+using namespace OpenMS;
+using namespace OpenMS::Internal;
+using namespace std;
+
+START_TEST(CachedMzMLMappedFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+PeakMap exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+CachedMzMLHandler cache;
+cache.writeMemdump(exp, tmp_filename);
+
+CachedMzMLMappedFile* ptr = nullptr;
+CachedMzMLMappedFile* nullPointer = nullptr;
+
+START_SECTION(explicit CachedMzMLMappedFile(const String& filename))
+{
+  ptr = new CachedMzMLMappedFile(tmp_filename);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+
+  std::string unused_tmp_filename;
+  NEW_TMP_FILE(unused_tmp_filename);
+  TEST_EXCEPTION(Exception::FileNotFound, CachedMzMLMappedFile mapped_unused(unused_tmp_filename))
+  TEST_EXCEPTION(Exception::ParseError, CachedMzMLMappedFile mapped_mzml(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML")))
+}
+END_SECTION
+
+START_SECTION(~CachedMzMLMappedFile())
+{
+  delete ptr;
+}
+END_SECTION
+
+CachedMzMLMappedFile mapped(tmp_filename);
+
+START_SECTION(Size getNrSpectra() const)
+{
+  TEST_EQUAL(mapped.getNrSpectra(), 4)
+}
+END_SECTION
+
+START_SECTION(Size getNrChromatograms() const)
+{
+  TEST_EQUAL(mapped.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(const std::vector<Size>& getSpectraIndex() const)
+{
+  // the offsets have to agree with the file stream based index
+  cache.createMemdumpIndex(tmp_filename);
+  TEST_EQUAL(mapped.getSpectraIndex().size(), cache.getSpectraIndex().size())
+  for (Size i = 0; i < mapped.getSpectraIndex().size(); ++i)
+  {
+    TEST_EQUAL(mapped.getSpectraIndex()[i], static_cast<Size>(cache.getSpectraIndex()[i]))
+  }
+}
+END_SECTION
+
+START_SECTION(const std::vector<Size>& getChromatogramIndex() const)
+{
+  cache.createMemdumpIndex(tmp_filename);
+  TEST_EQUAL(mapped.getChromatogramIndex().size(), cache.getChromatogramIndex().size())
+  for (Size i = 0; i < mapped.getChromatogramIndex().size(); ++i)
+  {
+    TEST_EQUAL(mapped.getChromatogramIndex()[i], static_cast<Size>(cache.getChromatogramIndex()[i]))
+  }
+}
+END_SECTION
+
+START_SECTION(DataView getSpectrumView(Size id) const)
+{
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    CachedMzMLMappedFile::DataView view = mapped.getSpectrumView(i);
+    TEST_EQUAL(view.size, exp[i].size())
+    TEST_EQUAL(view.ms_level, exp[i].getMSLevel())
+    TEST_REAL_SIMILAR(view.rt, exp[i].getRT())
+    // data is accessed in place and has to be properly aligned
+    TEST_EQUAL(reinterpret_cast<size_t>(view.position) % alignof(double), 0)
+    for (Size k = 0; k < view.size; ++k)
+    {
+      TEST_REAL_SIMILAR(view.position[k], exp[i][k].getMZ())
+      TEST_REAL_SIMILAR(view.intensity[k], exp[i][k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(DataView getChromatogramView(Size id) const)
+{
+  for (Size i = 0; i < exp.getNrChromatograms(); ++i)
+  {
+    CachedMzMLMappedFile::DataView view = mapped.getChromatogramView(i);
+    TEST_EQUAL(view.size, exp.getChromatogram(i).size())
+    for (Size k = 0; k < view.size; ++k)
+    {
+      TEST_REAL_SIMILAR(view.position[k], exp.getChromatogram(i)[k].getRT())
+      TEST_REAL_SIMILAR(view.intensity[k], exp.getChromatogram(i)[k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(std::vector<OpenSwath::BinaryDataArrayPtr> getSpectrumData(Size id, int& ms_level, double& rt) const)
+{
+  // has to agree with the file stream based access
+  cache.createMemdumpIndex(tmp_filename);
+  std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    int ms_level = -1, ms_level_stream = -1;
+    double rt = -1.0, rt_stream = -1.0;
+    std::vector<OpenSwath::BinaryDataArrayPtr> data = mapped.getSpectrumData(i, ms_level, rt);
+    ifs.seekg(cache.getSpectraIndex()[i]);
+    std::vector<OpenSwath::BinaryDataArrayPtr> data_stream = CachedMzMLHandler::readSpectrumFast(ifs, ms_level_stream, rt_stream);
+    TEST_EQUAL(ms_level, ms_level_stream)
+    TEST_REAL_SIMILAR(rt, rt_stream)
+    TEST_EQUAL(data.size(), data_stream.size())
+    for (Size k = 0; k < data.size(); ++k)
+    {
+      TEST_EQUAL(data[k]->description, data_stream[k]->description)
+      TEST_EQUAL(data[k]->data == data_stream[k]->data, true)
+    }
+  }
+
+  int ms_level;
+  double rt;
+  std::vector<OpenSwath::BinaryDataArrayPtr> data = mapped.getSpectrumData(1, ms_level, rt);
+  TEST_EQUAL(data.size(), 4)
+  TEST_EQUAL(data[2]->description, "signal to noise array")
+  TEST_EQUAL(data[3]->description, "user-defined name")
+}
+END_SECTION
+
+START_SECTION(std::vector<OpenSwath::BinaryDataArrayPtr> getChromatogramData(Size id) const)
+{
+  cache.createMemdumpIndex(tmp_filename);
+  std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+  for (Size i = 0; i < exp.getNrChromatograms(); ++i)
+  {
+    std::vector<OpenSwath::BinaryDataArrayPtr> data = mapped.getChromatogramData(i);
+    ifs.seekg(cache.getChromatogramIndex()[i]);
+    std::vector<OpenSwath::BinaryDataArrayPtr> data_stream = CachedMzMLHandler::readChromatogramFast(ifs);
+    TEST_EQUAL(data.size(), data_stream.size())
+    for (Size k = 0; k < data.size(); ++k)
+    {
+      TEST_EQUAL(data[k]->description, data_stream[k]->description)
+      TEST_EQUAL(data[k]->data == data_stream[k]->data, true)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION([EXTRA] in-place access through OpenSwath::ISpectrumAccess)
+{
+  std::string cached_filename;
+  NEW_TMP_FILE(cached_filename);
+  CachedmzML::store(cached_filename, exp);
+
+  OpenSwath::SpectrumAccessPtr mapped_access(new SpectrumAccessOpenMSCached(cached_filename, true));
+  OpenSwath::SpectrumAccessPtr stream_access(new SpectrumAccessOpenMSCached(cached_filename, false));
+  TEST_EQUAL(mapped_access->getNrSpectra(), exp.size())
+  TEST_EQUAL(mapped_access->getNrChromatograms(), exp.getNrChromatograms())
+
+  OpenSwath::SpectrumView view;
+  TEST_EQUAL(stream_access->getSpectrumViewById(0, view), false)
+
+  // light clones share the mapping and provide the same views
+  OpenSwath::SpectrumAccessPtr clone = mapped_access->lightClone();
+  for (Size i = 0; i < exp.size(); ++i)
+  {
+    TEST_EQUAL(clone->getSpectrumViewById(i, view), true)
+    OpenSwath::SpectrumPtr sptr = stream_access->getSpectrumById(i);
+    TEST_EQUAL(view.size, sptr->getMZArray()->data.size())
+    for (Size k = 0; k < view.size; ++k)
+    {
+      TEST_EQUAL(view.mz[k], sptr->getMZArray()->data[k])
+      TEST_EQUAL(view.intensity[k], sptr->getIntensityArray()->data[k])
+    }
+    // copies from the mapping and from the stream agree as well
+    OpenSwath::SpectrumPtr mapped_sptr = mapped_access->getSpectrumById(i);
+    TEST_EQUAL(mapped_sptr->getDataArrays().size(), sptr->getDataArrays().size())
+  }
+  for (Size i = 0; i < exp.getNrChromatograms(); ++i)
+  {
+    TEST_EQUAL(mapped_access->getChromatogramById(i)->getIntensityArray()->data == stream_access->getChromatogramById(i)->getIntensityArray()->data, true)
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
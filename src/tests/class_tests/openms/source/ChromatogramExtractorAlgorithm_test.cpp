@@ -540,6 +540,103 @@ START_SECTION([EXTRA]void extract_value_tophat(const std::vector< double >::cons
 }
 END_SECTION
 
+START_SECTION(static ExtractionWindows prepareExtractionWindows(const std::vector<ExtractionCoordinates>& extraction_coordinates, double mz_extraction_window, bool ppm, double im_extraction_window))
+{
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates(2);
+  coordinates[0].mz = 400.0; coordinates[0].ion_mobility = 100.0;
+  coordinates[1].mz = 500.0; coordinates[1].ion_mobility = -1.0;
+
+  ChromatogramExtractorAlgorithm::ExtractionWindows windows = ChromatogramExtractorAlgorithm::prepareExtractionWindows(coordinates, 0.2, false, 0.3);
+  TEST_EQUAL(windows.mz.size(), 2)
+  TEST_REAL_SIMILAR(windows.mz_left[0], 399.9)
+  TEST_REAL_SIMILAR(windows.mz_right[0], 400.1)
+  TEST_REAL_SIMILAR(windows.im_left[0], 99.85)
+  TEST_REAL_SIMILAR(windows.im_right[0], 100.15)
+  // negative ion mobility: no filter
+  TEST_EQUAL(windows.im_left[1] < -1e300, true)
+  TEST_EQUAL(windows.im_right[1] > 1e300, true)
+
+  windows = ChromatogramExtractorAlgorithm::prepareExtractionWindows(coordinates, 500, true, -1);
+  TEST_REAL_SIMILAR(windows.mz_left[0], 399.9)
+  TEST_REAL_SIMILAR(windows.mz_right[1], 500.125)
+  TEST_EQUAL(windows.im_left[0] < -1e300, true)
+}
+END_SECTION
+
+START_SECTION(static void extract_values_tophat(const double* mz, const double* intensity, const double* im, Size size, const ExtractionWindows& windows, const std::vector<Size>& indices, std::vector<double>& integrated_intensities))
+{
+  std::vector<double> mz (mz_arr, mz_arr + sizeof(mz_arr) / sizeof(mz_arr[0]) );
+  std::vector<double> intensities (int_arr, int_arr + sizeof(int_arr) / sizeof(int_arr[0]) );
+  std::vector<double> ion_mobility (im_arr, im_arr + sizeof(im_arr) / sizeof(im_arr[0]) );
+
+  // targets including the boundaries of the spectrum
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+  for (double target : {399.805, 399.91, 400.0, 400.01, 400.05, 400.1, 400.28, 499.95, 500.0, 500.05, 600.0})
+  {
+    ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+    coord.mz = target;
+    coord.ion_mobility = 100.0;
+    coordinates.push_back(coord);
+  }
+  std::vector<Size> indices;
+  for (Size k = 0; k < coordinates.size(); ++k) indices.push_back(k);
+
+  ChromatogramExtractorAlgorithm extractor;
+  std::vector<double> integrated_intensities;
+  for (Size n : {Size(1), Size(2), mz.size()})
+  {
+    for (bool ppm : {false, true})
+    {
+      const double extract_window = ppm ? 500 : 0.2;
+
+      // without ion mobility, the result has to be the same as extract_value_tophat
+      ChromatogramExtractorAlgorithm::ExtractionWindows windows =
+        ChromatogramExtractorAlgorithm::prepareExtractionWindows(coordinates, extract_window, ppm, -1);
+      ChromatogramExtractorAlgorithm::extract_values_tophat(&mz[0], &intensities[0], nullptr, n, windows, indices, integrated_intensities);
+      TEST_EQUAL(integrated_intensities.size(), coordinates.size())
+
+      std::vector<double>::const_iterator mz_it = mz.begin();
+      std::vector<double>::const_iterator int_it = intensities.begin();
+      for (Size k = 0; k < coordinates.size(); ++k)
+      {
+        double integrated_intensity = 0;
+        extractor.extract_value_tophat(mz.begin(), mz_it, mz.begin() + n, int_it, coordinates[k].mz, integrated_intensity, extract_window, ppm);
+        TEST_REAL_SIMILAR(integrated_intensities[k], integrated_intensity)
+      }
+
+      // with ion mobility
+      windows = ChromatogramExtractorAlgorithm::prepareExtractionWindows(coordinates, extract_window, ppm, 0.3);
+      ChromatogramExtractorAlgorithm::extract_values_tophat(&mz[0], &intensities[0], &ion_mobility[0], n, windows, indices, integrated_intensities);
+
+      mz_it = mz.begin();
+      int_it = intensities.begin();
+      std::vector<double>::const_iterator im_it = ion_mobility.begin();
+      for (Size k = 0; k < coordinates.size(); ++k)
+      {
+        double integrated_intensity = 0;
+        extractor.extract_value_tophat(mz.begin(), mz_it, mz.begin() + n, int_it, im_it, coordinates[k].mz, coordinates[k].ion_mobility,
+                                       integrated_intensity, extract_window, 0.3, ppm);
+        TEST_REAL_SIMILAR(integrated_intensities[k], integrated_intensity)
+      }
+    }
+  }
+
+  // only a subset of the windows
+  ChromatogramExtractorAlgorithm::ExtractionWindows windows =
+    ChromatogramExtractorAlgorithm::prepareExtractionWindows(coordinates, 0.2, false, -1);
+  indices = {4, 5};
+  ChromatogramExtractorAlgorithm::extract_values_tophat(&mz[0], &intensities[0], nullptr, mz.size(), windows, indices, integrated_intensities);
+  TEST_EQUAL(integrated_intensities.size(), 2)
+  TEST_REAL_SIMILAR(integrated_intensities[0], 8400.0)
+  TEST_REAL_SIMILAR(integrated_intensities[1], 9000.0)
+
+  // empty spectrum
+  ChromatogramExtractorAlgorithm::extract_values_tophat(&mz[0], &intensities[0], nullptr, 0, windows, indices, integrated_intensities);
+  TEST_EQUAL(integrated_intensities.size(), 2)
+  TEST_REAL_SIMILAR(integrated_intensities[0], 0.0)
+}
+END_SECTION
+
 START_SECTION( [ChromatogramExtractorAlgorithm::ExtractionCoordinates] static bool SortExtractionCoordinatesByMZ(const ChromatogramExtractorAlgorithm::ExtractionCoordinates &left, const ChromatogramExtractorAlgorithm::ExtractionCoordinates &right))    
 {
   NOT_TESTABLE
@@ -0,0 +1,229 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/KERNEL/ColumnarMSExperiment.h>
+///////////////////////////
+
+START_TEST(ColumnarMSExperiment, "$Id$");
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+PeakMap exp;
+{
+  for (Size i = 0; i < 3; ++i)
+  {
+    MSSpectrum s;
+    s.setRT(10.0 * (i + 1));
+    s.setMSLevel(i == 0 ? 1 : 2);
+    s.setNativeID(String("spectrum=") + i);
+    for (Size k = 0; k < 5 * i; ++k)
+    {
+      s.push_back(Peak1D(100.0 + 0.5 * k, 1000.0f + 10.0f * k));
+    }
+    exp.addSpectrum(s);
+  }
+  // spectrum with ion mobility data and an additional data array
+  MSSpectrum s;
+  s.setRT(40.0);
+  s.setNativeID("spectrum=3");
+  s.getFloatDataArrays().resize(2);
+  s.getFloatDataArrays()[0].setName("other");
+  s.getFloatDataArrays()[1].setName("Ion Mobility");
+  for (Size k = 0; k < 4; ++k)
+  {
+    s.push_back(Peak1D(200.0 + k, 50.0f * (k + 1)));
+    s.getFloatDataArrays()[0].push_back(k);
+    s.getFloatDataArrays()[1].push_back(0.8f + 0.1f * k);
+  }
+  exp.addSpectrum(s);
+
+  MSChromatogram c;
+  c.setNativeID("chrom");
+  c.push_back(ChromatogramPeak(1.0, 10.0));
+  c.push_back(ChromatogramPeak(2.0, 20.0));
+  exp.addChromatogram(c);
+}
+
+ColumnarMSExperiment* ptr = nullptr;
+ColumnarMSExperiment* nullPointer = nullptr;
+START_SECTION((ColumnarMSExperiment(Compression compression = NONE)))
+{
+  ptr = new ColumnarMSExperiment();
+  TEST_NOT_EQUAL(ptr, nullPointer);
+  TEST_EQUAL(ptr->getCompression(), ColumnarMSExperiment::NONE)
+  TEST_EQUAL(ptr->empty(), true)
+  TEST_EQUAL(ptr->getPeakDataSize(), 0)
+}
+END_SECTION
+
+START_SECTION((~ColumnarMSExperiment()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((ColumnarMSExperiment(const PeakMap& exp, Compression compression = NONE)))
+{
+  ColumnarMSExperiment columnar(exp);
+  TEST_EQUAL(columnar.size(), 4)
+  TEST_EQUAL(columnar.getNrSpectra(), 4)
+  TEST_EQUAL(columnar.getNrChromatograms(), 1)
+  // 19 peaks (12 byte each), an ion mobility column aligned with the peaks (the
+  // last spectrum is the first with IM data) and 2 chromatogram peaks
+  TEST_EQUAL(columnar.getPeakDataSize(), 19 * 12 + 19 * 4 + 2 * 12)
+  TEST_EQUAL(columnar.getMetaData().size(), 4)
+  TEST_EQUAL(columnar.getMetaData()[2].size(), 0)
+  TEST_EQUAL(columnar.getMetaData()[2].getNativeID(), "spectrum=2")
+}
+END_SECTION
+
+START_SECTION((MSSpectrum getSpectrum(Size id) const))
+{
+  // numpress slof encoding of the intensities is accurate to about 1e-4
+  TOLERANCE_RELATIVE(1.0001)
+  for (int c = 0; c < (int)ColumnarMSExperiment::SIZE_OF_COMPRESSION; ++c)
+  {
+    ColumnarMSExperiment columnar(exp, ColumnarMSExperiment::Compression(c));
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      MSSpectrum s = columnar.getSpectrum(i);
+      TEST_EQUAL(s.size(), exp[i].size())
+      TEST_REAL_SIMILAR(s.getRT(), exp[i].getRT())
+      TEST_EQUAL(s.getMSLevel(), exp[i].getMSLevel())
+      TEST_EQUAL(s.getNativeID(), exp[i].getNativeID())
+      TEST_EQUAL(s.getFloatDataArrays().size(), exp[i].getFloatDataArrays().size())
+      for (Size k = 0; k < s.size(); ++k)
+      {
+        TEST_REAL_SIMILAR(s[k].getMZ(), exp[i][k].getMZ())
+        TEST_REAL_SIMILAR(s[k].getIntensity(), exp[i][k].getIntensity())
+      }
+    }
+    MSSpectrum im = columnar[3];
+    TEST_EQUAL(im.getFloatDataArrays()[1].getName(), "Ion Mobility")
+    TEST_EQUAL(im.getFloatDataArrays()[1].size(), 4)
+    TEST_EQUAL(im.getFloatDataArrays()[0].size(), 4)
+    TEST_REAL_SIMILAR(im.getFloatDataArrays()[1][3], 1.1)
+    TEST_REAL_SIMILAR(im.getFloatDataArrays()[0][3], 3.0)
+  }
+}
+END_SECTION
+
+START_SECTION((SpectrumView getSpectrumView(Size id) const))
+{
+  ColumnarMSExperiment columnar(exp);
+  ColumnarMSExperiment::SpectrumView view = columnar.getSpectrumView(2);
+  TEST_EQUAL(view.size, 10)
+  TEST_REAL_SIMILAR(view.mz[9], 104.5)
+  TEST_REAL_SIMILAR(view.intensity[9], 1090.0)
+  TEST_EQUAL(view.ion_mobility == nullptr, true)
+  view = columnar.getSpectrumView(3);
+  TEST_EQUAL(view.size, 4)
+  TEST_REAL_SIMILAR(view.ion_mobility[0], 0.8)
+  TEST_EQUAL(columnar.getSpectrumView(0).size, 0)
+
+  ColumnarMSExperiment compressed(exp, ColumnarMSExperiment::NUMPRESS);
+  TEST_EXCEPTION(Exception::IllegalArgument, compressed.getSpectrumView(0))
+}
+END_SECTION
+
+START_SECTION((void decodeSpectrum(Size id, std::vector<double>& mz, std::vector<float>& intensity, std::vector<float>& ion_mobility) const))
+{
+  ColumnarMSExperiment compressed(exp, ColumnarMSExperiment::NUMPRESS);
+  std::vector<double> mz;
+  std::vector<float> intensity, ion_mobility;
+  compressed.decodeSpectrum(1, mz, intensity, ion_mobility);
+  TEST_EQUAL(mz.size(), 5)
+  TEST_EQUAL(intensity.size(), 5)
+  TEST_EQUAL(ion_mobility.size(), 0)
+  TEST_REAL_SIMILAR(mz[4], 102.0)
+  TEST_REAL_SIMILAR(intensity[4], 1040.0)
+  compressed.decodeSpectrum(3, mz, intensity, ion_mobility);
+  TEST_EQUAL(ion_mobility.size(), 4)
+  TEST_REAL_SIMILAR(ion_mobility[2], 1.0)
+}
+END_SECTION
+
+START_SECTION((Interfaces::SpectrumPtr getSpectrumById(Size id) const))
+{
+  TOLERANCE_RELATIVE(1.0001)
+  ColumnarMSExperiment columnar(exp, ColumnarMSExperiment::NUMPRESS);
+  Interfaces::SpectrumPtr s = columnar.getSpectrumById(2);
+  TEST_EQUAL(s->getMZArray()->data.size(), 10)
+  TEST_EQUAL(s->getIntensityArray()->data.size(), 10)
+  TEST_REAL_SIMILAR(s->getMZArray()->data[0], 100.0)
+  TEST_REAL_SIMILAR(s->getIntensityArray()->data[0], 1000.0)
+}
+END_SECTION
+
+START_SECTION((void addSpectrum(const MSSpectrum& spectrum)))
+{
+  ColumnarMSExperiment columnar(ColumnarMSExperiment::NUMPRESS);
+  columnar.addSpectrum(exp[3]);
+  columnar.addSpectrum(exp[2]);
+  TEST_EQUAL(columnar.size(), 2)
+  TEST_EQUAL(columnar.getSpectrum(0).size(), 4)
+  TEST_EQUAL(columnar.getSpectrum(1).size(), 10)
+  TEST_EQUAL(columnar.getSpectrum(1).getFloatDataArrays().size(), 0)
+  // numpress needs less space than the plain columns
+  TEST_EQUAL(columnar.getPeakDataSize() < ColumnarMSExperiment(exp).getPeakDataSize(), true)
+}
+END_SECTION
+
+START_SECTION((MSChromatogram getChromatogram(Size id) const))
+{
+  ColumnarMSExperiment columnar(exp, ColumnarMSExperiment::NUMPRESS);
+  MSChromatogram c = columnar.getChromatogram(0);
+  TEST_EQUAL(c.getNativeID(), "chrom")
+  TEST_EQUAL(c.size(), 2)
+  TEST_REAL_SIMILAR(c[1].getRT(), 2.0)
+  TEST_REAL_SIMILAR(c[1].getIntensity(), 20.0)
+
+  Interfaces::ChromatogramPtr cptr = columnar.getChromatogramById(0);
+  TEST_EQUAL(cptr->getTimeArray()->data.size(), 2)
+  TEST_REAL_SIMILAR(cptr->getIntensityArray()->data[0], 10.0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
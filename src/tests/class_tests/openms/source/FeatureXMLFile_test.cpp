@@ -44,6 +44,9 @@
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#include <fstream>
+#include <sstream>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -387,6 +390,66 @@ START_SECTION([EXTRA])
 }
 END_SECTION
 
+START_SECTION([EXTRA] storing many features (formatted in parallel))
+{
+  // enough features for several blocks, so the parallel writer is used (if OpenMP is enabled)
+  FeatureMap features;
+  for (Size i = 0; i < 2000; ++i)
+  {
+    Feature f;
+    f.setRT(100.0 + i * 0.5);
+    f.setMZ(400.0 + i * 0.01);
+    f.setIntensity(1000.0 * (i % 7 + 1));
+    f.setCharge(i % 4 + 1);
+    f.setUniqueId(i + 1);
+    ConvexHull2D hull;
+    hull.addPoint(DPosition<2>(f.getRT() - 1, f.getMZ()));
+    hull.addPoint(DPosition<2>(f.getRT() + 1, f.getMZ() + 1));
+    f.getConvexHulls().push_back(hull);
+    if (i % 3 == 0)
+    {
+      Feature sub(f);
+      sub.getConvexHulls().clear();
+      sub.setUniqueId(100000 + i);
+      f.getSubordinates().push_back(sub);
+    }
+    f.setMetaValue("index", i);
+    features.push_back(f);
+  }
+
+  String parallel_file, sequential_file;
+  NEW_TMP_FILE(parallel_file);
+  NEW_TMP_FILE(sequential_file);
+  FeatureXMLFile().store(parallel_file, features);
+  // inside a parallel region, the features are written sequentially:
+#pragma omp parallel num_threads(2)
+  {
+#pragma omp single
+    FeatureXMLFile().store(sequential_file, features);
+  }
+
+  // output must be identical, independent of the number of threads
+  ifstream parallel_in(parallel_file.c_str()), sequential_in(sequential_file.c_str());
+  stringstream parallel_content, sequential_content;
+  parallel_content << parallel_in.rdbuf();
+  sequential_content << sequential_in.rdbuf();
+  TEST_EQUAL(parallel_content.str().empty(), false);
+  TEST_EQUAL(parallel_content.str() == sequential_content.str(), true);
+
+  FeatureMap loaded;
+  FeatureXMLFile().load(parallel_file, loaded);
+  ABORT_IF(loaded.size() != features.size());
+  bool same_order = true;
+  for (Size i = 0; i < loaded.size(); ++i)
+  {
+    same_order &= (loaded[i].getUniqueId() == features[i].getUniqueId()) &&
+      (loaded[i].getSubordinates().size() == features[i].getSubordinates().size()) &&
+      (int(loaded[i].getMetaValue("index")) == int(i));
+  }
+  TEST_EQUAL(same_order, true);
+}
+END_SECTION
+
 
 
 /////////////////////////////////////////////////////////////
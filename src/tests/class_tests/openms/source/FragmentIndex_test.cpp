@@ -0,0 +1,216 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/FragmentIndex.h>
+///////////////////////////
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(FragmentIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+FragmentIndex* ptr = nullptr;
+FragmentIndex* null_ptr = nullptr;
+START_SECTION(FragmentIndex())
+{
+  ptr = new FragmentIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->size(), 0)
+}
+END_SECTION
+
+START_SECTION(~FragmentIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// three peptides (ascending mass) with two b and two y ions each
+FragmentIndex index(0.05, false);
+START_SECTION((Size addPeptide(double precursor_mass, const std::vector<double>& prefix_mz, const std::vector<double>& suffix_mz)))
+{
+  TEST_EQUAL(index.addPeptide(500.0, {100.0, 200.0}, {150.0, 250.0}), 0)
+  TEST_EQUAL(index.addPeptide(600.0, {100.0, 300.0}, {175.0, 350.0}), 1)
+  TEST_EQUAL(index.addPeptide(600.5, {120.0, 200.0}, {150.0, 450.0}), 2)
+  TEST_EXCEPTION(Exception::IllegalArgument, index.addPeptide(400.0, {100.0}, {200.0}))
+  TEST_EQUAL(index.size(), 3)
+  TEST_EQUAL(index.getFragmentCount(), 12)
+  TEST_REAL_SIMILAR(index.getPrecursorMass(1), 600.0)
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPeptideRange(double min_mass, double max_mass) const))
+{
+  auto r = index.getPeptideRange(599.0, 601.0);
+  TEST_EQUAL(r.first, 1)
+  TEST_EQUAL(r.second, 3)
+  r = index.getPeptideRange(0.0, 500.0);
+  TEST_EQUAL(r.first, 0)
+  TEST_EQUAL(r.second, 1)
+  r = index.getPeptideRange(700.0, 800.0);
+  TEST_EQUAL(r.first, r.second)
+}
+END_SECTION
+
+START_SECTION((void build()))
+{
+  index.build();
+  TEST_EXCEPTION(Exception::IllegalArgument, index.addPeptide(700.0, {100.0}, {200.0}))
+}
+END_SECTION
+
+START_SECTION((void query(const PeakSpectrum& spectrum, Size first, Size last, Size min_matched, Size max_matches, std::vector<Match>& matches) const))
+{
+  PeakSpectrum spec;
+  for (double mz : {100.01, 150.02, 200.0, 350.0, 1000.0}) spec.emplace_back(mz, 1.0f);
+
+  vector<FragmentIndex::Match> matches;
+  index.query(spec, 0, index.size(), 1, 0, matches);
+  TEST_EQUAL(matches.size(), 3)
+  // peptide 0: b 100, b 200, y 150
+  TEST_EQUAL(matches[0].peptide_index, 0)
+  TEST_EQUAL(matches[0].matched_prefix, 2)
+  TEST_EQUAL(matches[0].matched_suffix, 1)
+  // peptide 1 (b 100, y 350) and 2 (b 200, y 150) tie, ordered by index
+  TEST_EQUAL(matches[1].peptide_index, 1)
+  TEST_EQUAL(matches[1].matched(), 2)
+  TEST_EQUAL(matches[2].peptide_index, 2)
+  TEST_EQUAL(matches[2].matched_prefix, 1)
+  TEST_EQUAL(matches[2].matched_suffix, 1)
+
+  // restricted to a precursor range
+  index.query(spec, 1, 3, 1, 0, matches);
+  TEST_EQUAL(matches.size(), 2)
+  TEST_EQUAL(matches[0].peptide_index, 1)
+
+  // minimum number of matches and maximum number of results
+  index.query(spec, 0, 3, 3, 0, matches);
+  TEST_EQUAL(matches.size(), 1)
+  index.query(spec, 0, 3, 1, 2, matches);
+  TEST_EQUAL(matches.size(), 2)
+  TEST_EQUAL(matches[1].peptide_index, 1)
+
+  // outside of the tolerance
+  PeakSpectrum far;
+  far.emplace_back(100.2, 1.0f);
+  index.query(far, 0, 3, 1, 0, matches);
+  TEST_EQUAL(matches.size(), 0)
+
+  // ppm binning
+  FragmentIndex ppm_index(10.0, true);
+  ppm_index.addPeptide(500.0, {1000.0}, {1500.0});
+  ppm_index.build();
+  PeakSpectrum ppm_spec;
+  ppm_spec.emplace_back(1000.005, 1.0f); // 5 ppm
+  ppm_spec.emplace_back(1500.1, 1.0f);   // 67 ppm
+  ppm_index.query(ppm_spec, 0, 1, 1, 0, matches);
+  TEST_EQUAL(matches.size(), 1)
+  TEST_EQUAL(matches[0].matched_prefix, 1)
+  TEST_EQUAL(matches[0].matched_suffix, 0)
+}
+END_SECTION
+
+START_SECTION((void query(const PeakSpectrum& spectrum, Size first, Size last, Size min_matched, Size max_matches, std::vector<Match>& matches, QueryBuffer& buffer) const))
+{
+  PeakSpectrum spec;
+  for (double mz : {100.01, 150.02, 200.0, 350.0, 1000.0}) spec.emplace_back(mz, 1.0f);
+
+  // reusing the buffer gives the same results as a fresh buffer, independent of previous queries
+  FragmentIndex::QueryBuffer buffer;
+  vector<FragmentIndex::Match> matches, expected;
+  for (int repeat = 0; repeat < 2; ++repeat)
+  {
+    index.query(spec, 0, index.size(), 1, 0, matches, buffer);
+    index.query(spec, 0, index.size(), 1, 0, expected);
+    TEST_EQUAL(matches.size(), expected.size())
+    for (Size i = 0; i < matches.size(); ++i)
+    {
+      TEST_EQUAL(matches[i].peptide_index, expected[i].peptide_index)
+      TEST_EQUAL(matches[i].matched_prefix, expected[i].matched_prefix)
+      TEST_EQUAL(matches[i].matched_suffix, expected[i].matched_suffix)
+    }
+
+    index.query(spec, 1, 3, 1, 0, matches, buffer);
+    TEST_EQUAL(matches.size(), 2)
+    TEST_EQUAL(matches[0].peptide_index, 1)
+    TEST_EQUAL(matches[0].matched(), 2)
+    TEST_EQUAL(matches[1].peptide_index, 2)
+    TEST_EQUAL(matches[1].matched(), 2)
+  }
+  // the buffer is left with all counts at zero
+  TEST_EQUAL(buffer.counts.size(), index.size())
+  for (const FragmentIndex::Match& m : buffer.counts)
+  {
+    TEST_EQUAL(m.matched(), 0)
+  }
+}
+END_SECTION
+
+START_SECTION((void getSpectrum(Size peptide_index, PeakSpectrum& spectrum) const))
+{
+  PeakSpectrum spec;
+  index.getSpectrum(2, spec);
+  TEST_EQUAL(spec.size(), 4)
+  TEST_EQUAL(spec.isSorted(), true)
+  TEST_REAL_SIMILAR(spec[0].getMZ(), 120.0)
+  TEST_REAL_SIMILAR(spec[1].getMZ(), 150.0)
+  TEST_REAL_SIMILAR(spec[3].getMZ(), 450.0)
+  TEST_EQUAL(spec.getStringDataArrays().size(), 1)
+  TEST_EQUAL(spec.getStringDataArrays()[0][0], "b1+")
+  TEST_EQUAL(spec.getStringDataArrays()[0][1], "y1+")
+  TEST_EQUAL(spec.getStringDataArrays()[0][2], "b2+")
+  TEST_EQUAL(spec.getStringDataArrays()[0][3], "y2+")
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  index.clear();
+  TEST_EQUAL(index.size(), 0)
+  TEST_EQUAL(index.getFragmentCount(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -199,6 +199,77 @@ START_SECTION((template <typename PeakType> void filterExperiment(MSExperiment<P
 
 END_SECTION
 
+START_SECTION((void filterChromatograms(std::vector<MSChromatogram>& chromatograms)))
+{
+  std::vector<MSChromatogram> chromatograms(3);
+  for (Size i = 0; i < 50; ++i)
+  {
+    ChromatogramPeak peak;
+    // equally spaced
+    peak.setRT(100.0 + 0.5 * i);
+    peak.setIntensity(100.0 * exp(-0.05 * (i - 20.0) * (i - 20.0)) + 1.0);
+    chromatograms[0].push_back(peak);
+    // not equally spaced
+    peak.setRT(100.0 + 0.5 * i + 0.1 * (i % 3));
+    chromatograms[1].push_back(peak);
+  }
+  // chromatograms[2] stays empty
+
+  GaussFilter gauss;
+  Param param;
+  param.setValue("gaussian_width", 2.0);
+  gauss.setParameters(param);
+
+  std::vector<MSChromatogram> expected = chromatograms;
+  for (MSChromatogram& chrom : expected)
+  {
+    gauss.filter(chrom);
+  }
+  gauss.filterChromatograms(chromatograms);
+
+  TEST_EQUAL(chromatograms.size(), 3)
+  TEST_EQUAL(chromatograms[2].size(), 0)
+  for (Size c = 0; c < 2; ++c)
+  {
+    TEST_EQUAL(chromatograms[c].size(), expected[c].size())
+    for (Size i = 0; i < chromatograms[c].size(); ++i)
+    {
+      TEST_REAL_SIMILAR(chromatograms[c][i].getRT(), expected[c][i].getRT())
+      TEST_REAL_SIMILAR(chromatograms[c][i].getIntensity(), expected[c][i].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(([EXTRA] equally spaced data gives a result equal (up to rounding) to (almost) equally spaced data))
+{
+  // the tiny shifts in the second spectrum make it fall back to the point-wise integration
+  MSSpectrum uniform, shifted;
+  for (Size i = 0; i < 200; ++i)
+  {
+    const double mz = 500.0 + 0.004 * i;
+    Peak1D peak(mz, 100.0 * exp(-0.002 * (i - 100.0) * (i - 100.0)) + 1.0);
+    uniform.push_back(peak);
+    peak.setMZ(mz + ((i % 2) ? 1e-7 : 0.0));
+    shifted.push_back(peak);
+  }
+
+  GaussFilter gauss;
+  Param param;
+  param.setValue("gaussian_width", 0.07);
+  gauss.setParameters(param);
+  gauss.filter(uniform);
+  gauss.filter(shifted);
+
+  TEST_EQUAL(uniform.size(), shifted.size())
+  TOLERANCE_RELATIVE(1.001)
+  for (Size i = 0; i < uniform.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(uniform[i].getIntensity(), shifted[i].getIntensity())
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -258,6 +258,13 @@ mean(xcorr_max) # shape score
           TEST_REAL_SIMILAR(cross_correlation.data[ 9].second,  0.13012441)   // find(-2)->second,
           TEST_REAL_SIMILAR(cross_correlation.data[ 8].second,  0.39698322)   // find(-3)->second,
           TEST_REAL_SIMILAR(cross_correlation.data[ 7].second,  0.16608774)   // find(-4)->second,
+
+          // the arrays are computed once and cached until the matrix is initialized again
+          TEST_EQUAL(&mrmscore.getXCorrMatrix(), &mrmscore.getXCorrMatrix())
+          mrmscore.initializeXCorrMatrix(std::vector<std::vector<double> >(1, std::vector<double>{1.0, 3.0, 5.0, 2.0}));
+          TEST_EQUAL(mrmscore.getXCorrMatrix().rows(), 1)
+          TEST_EQUAL(mrmscore.getXCorrMatrix().cols(), 1)
+          TEST_EQUAL(mrmscore.getXCorrMatrix().getValue(0, 0).data.size(), 7)
         }
     END_SECTION
 
@@ -398,6 +405,60 @@ END_SECTION*/
         }
     END_SECTION
 
+    BOOST_AUTO_TEST_CASE(getXCorrPeakMatrix)
+        {
+          MockMRMFeature * imrmfeature = new MockMRMFeature();
+          MRMScoring mrmscore;
+
+          std::vector<std::string> precursor_ids;
+          std::vector<std::string> native_ids;
+          fill_mock_objects2(imrmfeature, precursor_ids, native_ids);
+
+          mrmscore.initializeXCorrMatrix(imrmfeature, native_ids);
+          mrmscore.initializeXCorrContrastMatrix(imrmfeature, native_ids, native_ids);
+          mrmscore.initializeXCorrPrecursorContrastMatrix(imrmfeature, precursor_ids, native_ids);
+          mrmscore.initializeXCorrPrecursorCombinedMatrix(imrmfeature, precursor_ids, native_ids);
+          delete imrmfeature;
+
+          // the peak matrices hold the highest peak of each full cross-correlation array
+          const MRMScoring::XCorrPeakMatrixType& peaks = mrmscore.getXCorrPeakMatrix();
+          const MRMScoring::XCorrMatrixType xcorr = mrmscore.getXCorrMatrix();
+          TEST_EQUAL(peaks.rows(), 2)
+          TEST_EQUAL(peaks.cols(), 2)
+          TEST_EQUAL(peaks.getValue(0, 1).first, OpenSwath::Scoring::xcorrArrayGetMaxPeak(xcorr.getValue(0, 1))->first)
+          TEST_REAL_SIMILAR(peaks.getValue(0, 1).second, OpenSwath::Scoring::xcorrArrayGetMaxPeak(xcorr.getValue(0, 1))->second)
+          TEST_EQUAL(peaks.getValue(0, 0).first, 0)
+          TEST_REAL_SIMILAR(peaks.getValue(0, 0).second, 1.0)
+
+          const MRMScoring::XCorrPeakMatrixType& contrast_peaks = mrmscore.getXCorrContrastPeakMatrix();
+          TEST_EQUAL(contrast_peaks.rows(), 2)
+          TEST_EQUAL(contrast_peaks.cols(), 2)
+          TEST_EQUAL(contrast_peaks.getValue(0, 1).first, peaks.getValue(0, 1).first)
+          TEST_REAL_SIMILAR(contrast_peaks.getValue(0, 1).second, peaks.getValue(0, 1).second)
+
+          const MRMScoring::XCorrPeakMatrixType& precursor_contrast_peaks = mrmscore.getXCorrPrecursorContrastPeakMatrix();
+          const MRMScoring::XCorrMatrixType precursor_contrast = mrmscore.getXCorrPrecursorContrastMatrix();
+          TEST_EQUAL(precursor_contrast_peaks.rows(), 3)
+          TEST_EQUAL(precursor_contrast_peaks.cols(), 2)
+          for (std::size_t i = 0; i < 2; ++i)
+          {
+            for (std::size_t j = 0; j < 2; ++j)
+            {
+              TEST_EQUAL(precursor_contrast_peaks.getValue(i, j).first,
+                         OpenSwath::Scoring::xcorrArrayGetMaxPeak(precursor_contrast.getValue(i, j))->first)
+              TEST_REAL_SIMILAR(precursor_contrast_peaks.getValue(i, j).second,
+                                OpenSwath::Scoring::xcorrArrayGetMaxPeak(precursor_contrast.getValue(i, j))->second)
+            }
+          }
+
+          const MRMScoring::XCorrPeakMatrixType& combined_peaks = mrmscore.getXCorrPrecursorCombinedPeakMatrix();
+          TEST_EQUAL(combined_peaks.rows(), 5)
+          TEST_EQUAL(combined_peaks.cols(), 5)
+          TEST_EQUAL(combined_peaks.getValue(0, 3).first, precursor_contrast_peaks.getValue(0, 0).first)
+          TEST_REAL_SIMILAR(combined_peaks.getValue(0, 3).second, precursor_contrast_peaks.getValue(0, 0).second)
+        }
+    END_SECTION
+
     BOOST_AUTO_TEST_CASE(test_calcXcorrCoelutionScore)
         {
           MockMRMFeature * imrmfeature = new MockMRMFeature();
@@ -0,0 +1,172 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/DATAACCESS/MSDataPeakPickingConsumer.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataStoringConsumer.h>
+
+START_TEST(MSDataPeakPickingConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+
+PeakPickerHiRes pp;
+Param pp_param;
+pp_param.setValue("signal_to_noise", 1.0);
+pp.setParameters(pp_param);
+
+MSDataPeakPickingConsumer* pp_consumer_ptr = nullptr;
+MSDataPeakPickingConsumer* pp_consumer_nullPointer = nullptr;
+
+START_SECTION((MSDataPeakPickingConsumer(Interfaces::IMSDataConsumer* next_consumer, const PeakPickerHiRes& pp, Size batch_size = 256, bool check_spectrum_type = false)))
+  pp_consumer_ptr = new MSDataPeakPickingConsumer(nullptr, pp); // don't do that ...
+  TEST_NOT_EQUAL(pp_consumer_ptr, pp_consumer_nullPointer)
+END_SECTION
+
+START_SECTION((~MSDataPeakPickingConsumer()))
+  delete pp_consumer_ptr;
+END_SECTION
+
+START_SECTION((void consumeSpectrum(SpectrumType& s)))
+{
+  PeakMap input;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_orbitrap.mzML"), input);
+  PeakMap expected;
+  pp.pickExperiment(input, expected);
+
+  // batch sizes smaller and larger than the number of spectra
+  for (Size batch_size : {Size(1), Size(2), Size(1000)})
+  {
+    MSDataStoringConsumer storage;
+    {
+      MSDataPeakPickingConsumer pp_consumer(&storage, pp, batch_size);
+      for (Size i = 0; i < input.size(); ++i)
+      {
+        MSSpectrum s = input[i];
+        pp_consumer.consumeSpectrum(s);
+      }
+      pp_consumer.flush();
+    }
+
+    ABORT_IF(storage.getData().size() != expected.size())
+    for (Size i = 0; i < expected.size(); ++i)
+    {
+      TEST_EQUAL(storage.getData()[i].getNativeID(), expected[i].getNativeID())
+      TEST_EQUAL(storage.getData()[i] == expected[i], true)
+    }
+  }
+
+  // the remaining data is passed on when the consumer is destroyed
+  MSDataStoringConsumer storage;
+  {
+    MSDataPeakPickingConsumer pp_consumer(&storage, pp, 1000);
+    MSSpectrum s = input[0];
+    pp_consumer.consumeSpectrum(s);
+    TEST_EQUAL(storage.getData().size(), 0)
+  }
+  TEST_EQUAL(storage.getData().size(), 1)
+
+  // centroided spectrum, selected for picking
+  Param manual_param = pp_param;
+  manual_param.setValue("ms_levels", ListUtils::create<Int>("1"));
+  PeakPickerHiRes pp_manual;
+  pp_manual.setParameters(manual_param);
+  MSDataStoringConsumer storage_checked;
+  MSDataPeakPickingConsumer pp_consumer_checked(&storage_checked, pp_manual, 1000, true);
+  MSSpectrum centroided = input[0];
+  centroided.setMSLevel(1);
+  centroided.setType(SpectrumSettings::CENTROID);
+  pp_consumer_checked.consumeSpectrum(centroided);
+  TEST_EXCEPTION(Exception::IllegalArgument, pp_consumer_checked.flush())
+  TEST_EQUAL(storage_checked.getData().size(), 0)
+}
+END_SECTION
+
+START_SECTION((void consumeChromatogram(ChromatogramType& c)))
+{
+  MSChromatogram chrom;
+  for (Size i = 0; i < 20; ++i)
+  {
+    chrom.push_back(ChromatogramPeak(100.0 + i, 1000.0 - 10.0 * (double(i) - 10.0) * (double(i) - 10.0)));
+  }
+  chrom.setNativeID("chrom");
+  MSChromatogram expected;
+  pp.pick(chrom, expected);
+
+  MSDataStoringConsumer storage;
+  {
+    MSDataPeakPickingConsumer pp_consumer(&storage, pp, 2);
+    MSSpectrum s;
+    s.setNativeID("spec");
+    MSChromatogram c = chrom;
+    pp_consumer.consumeChromatogram(c);
+    pp_consumer.consumeSpectrum(s);
+    c = chrom;
+    pp_consumer.consumeChromatogram(c);
+    pp_consumer.flush();
+  }
+
+  TEST_EQUAL(storage.getData().getNrChromatograms(), 2)
+  TEST_EQUAL(storage.getData().getNrSpectra(), 1)
+  ABORT_IF(storage.getData().getNrChromatograms() != 2)
+  TEST_EQUAL(storage.getData().getChromatograms()[0] == expected, true)
+  TEST_EQUAL(storage.getData().getChromatograms()[1] == expected, true)
+}
+END_SECTION
+
+START_SECTION((void setExpectedSize(Size expected_spectra, Size expected_chromatograms)))
+  NOT_TESTABLE // only forwarded to the next consumer
+END_SECTION
+
+START_SECTION((void setExperimentalSettings(const ExperimentalSettings& exp)))
+  NOT_TESTABLE // only forwarded to the next consumer
+END_SECTION
+
+START_SECTION((void flush()))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -234,6 +234,27 @@ START_SECTION([EXTRA] multithreaded example)
 }
 END_SECTION
 
+START_SECTION([EXTRA] concurrent registration and lookup)
+{
+  // lookups must always see a consistent state while other threads register new names
+  MetaInfoRegistry registry;
+  int errors = 0;
+#pragma omp parallel for reduction(+: errors)
+  for (int k = 0; k < 10000; k++)
+  {
+    String name = "concurrent_" + String(k % 500);
+    UInt index = registry.registerName(name, "description");
+    if (registry.getName(index) != name) ++errors;
+    if (registry.getIndex(name) != index) ++errors;
+    if (registry.getDescription(index) != "description") ++errors;
+  }
+  TEST_EQUAL(errors, 0)
+  TEST_EQUAL(registry.getIndex("concurrent_0") >= 1024, true)
+  TEST_EQUAL(registry.getIndex("concurrent_499") < 1024 + 500, true)
+  TEST_EQUAL(registry.getIndex("isotopic_range"), 1)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -42,6 +42,8 @@
 #include <OpenMS/FORMAT/FileTypes.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 
+#include <limits>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -95,6 +97,28 @@ public:
   void setExperimentalSettings(const ExperimentalSettings& /* exp */) override {}
 };
 
+/// stores all spectra it receives; throws when the spectrum with index @p throw_at arrives
+class CollectingConsumer :
+    public Interfaces::IMSDataConsumer
+{
+public:
+  std::vector<MSSpectrum> spectra;
+  Size throw_at = std::numeric_limits<Size>::max();
+
+  void consumeSpectrum(MSSpectrum& s) override
+  {
+    if (spectra.size() == throw_at)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "consumer failed");
+    }
+    spectra.push_back(s);
+  }
+
+  void consumeChromatogram(MSChromatogram& /* c */) override {}
+  void setExpectedSize(Size /* expectedSpectra */, Size /* expectedChromatograms */) override {}
+  void setExperimentalSettings(const ExperimentalSettings& /* exp */) override {}
+};
+
 //Note: This code generates the test files for meta data arrays of different types. Do not delete it!
 #if 0
 {
@@ -1233,6 +1257,45 @@ START_SECTION(void transform(const String& filename_in, Interfaces::IMSDataConsu
 }
 END_SECTION
 
+START_SECTION([EXTRA] void transform(const String& filename_in, Interfaces::IMSDataConsumer * consumer, bool skip_full_count = false, bool skip_first_pass = false) with bounded in-flight memory)
+{
+  String in = OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML");
+  PeakMap reference;
+  MzMLFile().load(in, reference);
+
+  MzMLFile mzml;
+  PeakFileOptions opt = mzml.getOptions();
+  opt.setMaxDataPoolSize(1); // every spectrum is its own pool
+  opt.setMaxInFlightBytes(1); // only one pool may be decoded at a time
+  opt.setAlwaysAppendData(false);
+  mzml.setOptions(opt);
+
+  // spectra arrive in file order and with the same peaks as when loading the whole file
+  CollectingConsumer consumer;
+  mzml.transform(in, &consumer);
+  TEST_EQUAL(consumer.spectra.size(), reference.size())
+  ABORT_IF(consumer.spectra.size() != reference.size())
+  for (Size i = 0; i < reference.size(); ++i)
+  {
+    TEST_EQUAL(consumer.spectra[i].getNativeID(), reference[i].getNativeID())
+    TEST_REAL_SIMILAR(consumer.spectra[i].getRT(), reference[i].getRT())
+    TEST_EQUAL(consumer.spectra[i].size(), reference[i].size())
+    ABORT_IF(consumer.spectra[i].size() != reference[i].size())
+    for (Size k = 0; k < reference[i].size(); ++k)
+    {
+      TEST_EQUAL(consumer.spectra[i][k].getMZ(), reference[i][k].getMZ())
+      TEST_EQUAL(consumer.spectra[i][k].getIntensity(), reference[i][k].getIntensity())
+    }
+  }
+
+  // an exception thrown by the consumer on the worker thread reaches the caller
+  CollectingConsumer failing_consumer;
+  failing_consumer.throw_at = 2;
+  TEST_EXCEPTION(Exception::ParseError, mzml.transform(in, &failing_consumer))
+  TEST_EQUAL(failing_consumer.spectra.size(), 2)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -456,6 +456,66 @@ START_SECTION(std::vector<size_t> getSpectraIndicesbyRT(double RT, double deltaR
 }
 END_SECTION
 
+START_SECTION(std::vector<int> getSpectraIndicesByRange(double rt_start, double rt_end, int ms_level = 0, double isolation_target = -1.0, double isolation_tolerance = 0.01) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"), 0);
+
+  {
+    auto res = handler.getSpectraIndicesByRange(0.2, 0.5);
+    TEST_EQUAL(res.size(), 2)
+    TEST_EQUAL(res[0], 0)
+    TEST_EQUAL(res[1], 1)
+  }
+
+  {
+    auto res = handler.getSpectraIndicesByRange(0.4, 0.5);
+    TEST_EQUAL(res.size(), 1)
+    TEST_EQUAL(res[0], 1)
+  }
+
+  {
+    auto res = handler.getSpectraIndicesByRange(0.0, 0.1);
+    TEST_EQUAL(res.size(), 0)
+  }
+
+  // restrict by MS level (both spectra are MS1)
+  {
+    auto res = handler.getSpectraIndicesByRange(0.0, 1.0, 1);
+    TEST_EQUAL(res.size(), 2)
+    res = handler.getSpectraIndicesByRange(0.0, 1.0, 2);
+    TEST_EQUAL(res.size(), 0)
+  }
+
+  // restrict by precursor (the spectra have none)
+  {
+    auto res = handler.getSpectraIndicesByRange(0.0, 1.0, 0, 500.0, 10.0);
+    TEST_EQUAL(res.size(), 0)
+  }
+}
+END_SECTION
+
+START_SECTION(std::vector<double> getSpectraRT(const std::vector<int> & indices) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"), 0);
+
+  {
+    auto res = handler.getSpectraRT({});
+    TEST_EQUAL(res.size(), 2)
+    TEST_REAL_SIMILAR(res[0], 0.2961)
+    TEST_REAL_SIMILAR(res[1], 0.4738)
+  }
+
+  {
+    auto res = handler.getSpectraRT({1, 0});
+    TEST_EQUAL(res.size(), 2)
+    TEST_REAL_SIMILAR(res[0], 0.4738)
+    TEST_REAL_SIMILAR(res[1], 0.2961)
+  }
+
+  TEST_EXCEPTION(Exception::IllegalArgument, handler.getSpectraRT({5}))
+}
+END_SECTION
+
 START_SECTION(void writeExperiment(const MSExperiment & exp))
 {
   const MSExperiment exp_orig = [](){
@@ -128,6 +128,47 @@ START_SECTION(void load(const String& filename, IdentificationData& id_data))
 }
 END_SECTION
 
+START_SECTION(void storeBatches(const String& filename, const std::function<bool(IdentificationData&)>& next_batch))
+{
+  // write the same data twice - everything should be merged:
+  Size n_batches = 0;
+  String batches_tmp;
+  NEW_TMP_FILE(batches_tmp);
+  OMSFile().storeBatches(batches_tmp, [&](IdentificationData& batch)
+  {
+    if (n_batches == 2) return false;
+    ++n_batches;
+    IdentificationData copy(ids);
+    batch.swap(copy);
+    return true;
+  });
+  TEST_EQUAL(n_batches, 2);
+
+  IdentificationData out;
+  OMSFile().load(batches_tmp, out);
+  TEST_EQUAL(ids.getInputFiles().size(), out.getInputFiles().size());
+  TEST_EQUAL(ids.getScoreTypes().size(), out.getScoreTypes().size());
+  TEST_EQUAL(ids.getProcessingSteps().size(),
+             out.getProcessingSteps().size());
+  TEST_EQUAL(ids.getObservations().size(), out.getObservations().size());
+  TEST_EQUAL(ids.getParentSequences().size(),
+             out.getParentSequences().size());
+  TEST_EQUAL(ids.getIdentifiedPeptides().size(),
+             out.getIdentifiedPeptides().size());
+  TEST_EQUAL(ids.getAdducts().size(), out.getAdducts().size());
+  TEST_EQUAL(ids.getObservationMatches().size(),
+             out.getObservationMatches().size());
+  auto it1 = ids.getObservationMatches().begin();
+  auto it2 = out.getObservationMatches().begin();
+  for (; (it1 != ids.getObservationMatches().end()) &&
+         (it2 != out.getObservationMatches().end()); ++it1, ++it2)
+  {
+    TEST_EQUAL(it1->steps_and_scores.size(),
+               it2->steps_and_scores.size());
+  }
+}
+END_SECTION
+
 START_SECTION(void store(const String& filename, const FeatureMap& features))
 {
   FeatureMap features;
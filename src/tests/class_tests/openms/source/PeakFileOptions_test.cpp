@@ -246,6 +246,23 @@ START_SECTION(void setMaxDataPoolSize(Size size))
 }
 END_SECTION
 
+START_SECTION(Size getMaxInFlightBytes() const)
+{
+	PeakFileOptions tmp;
+	TEST_EQUAL(tmp.getMaxInFlightBytes(), 0);
+}
+END_SECTION
+
+START_SECTION(void setMaxInFlightBytes(Size bytes))
+{
+	PeakFileOptions tmp;
+	tmp.setMaxInFlightBytes(64 * 1024 * 1024);
+	TEST_EQUAL(tmp.getMaxInFlightBytes(), 64 * 1024 * 1024);
+	PeakFileOptions copy(tmp);
+	TEST_EQUAL(copy.getMaxInFlightBytes(), 64 * 1024 * 1024);
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
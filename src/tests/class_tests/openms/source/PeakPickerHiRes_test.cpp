@@ -469,6 +469,41 @@ START_SECTION([EXTRA] test spectrum level selection)
 }
 END_SECTION
 
+START_SECTION(bool pickOrCopy(const MSSpectrum& input, MSSpectrum& output, std::vector<PeakBoundary>& boundaries, const bool check_spectrum_type = true) const)
+{
+  PeakMap in_spec_selection;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_spectrum_selection.mzML"), in_spec_selection);
+
+  Param pp_hires_param;
+  pp_hires_param.setValue("ms_levels", ListUtils::create<Int>("2"));
+  PeakPickerHiRes pp_spec_select;
+  pp_spec_select.setParameters(pp_hires_param);
+
+  // same result as pickExperiment, spectrum by spectrum
+  PeakMap out_experiment;
+  pp_spec_select.pickExperiment(in_spec_selection, out_experiment);
+  ABORT_IF(in_spec_selection.size() != out_experiment.size())
+  for (Size i = 0; i < in_spec_selection.size(); ++i)
+  {
+    MSSpectrum out;
+    std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+    bool picked = pp_spec_select.pickOrCopy(in_spec_selection[i], out, boundaries);
+    TEST_EQUAL(picked, in_spec_selection[i].getMSLevel() == 2)
+    TEST_EQUAL(out == out_experiment[i], true)
+    TEST_EQUAL(boundaries.size(), picked ? out.size() : 0)
+  }
+
+  // centroided spectrum selected for picking
+  MSSpectrum centroided = in_spec_selection[0];
+  centroided.setMSLevel(2);
+  centroided.setType(SpectrumSettings::CENTROID);
+  MSSpectrum out;
+  std::vector<PeakPickerHiRes::PeakBoundary> boundaries;
+  TEST_EXCEPTION(Exception::IllegalArgument, pp_spec_select.pickOrCopy(centroided, out, boundaries))
+  TEST_EQUAL(pp_spec_select.pickOrCopy(centroided, out, boundaries, false), true)
+}
+END_SECTION
+
 //////////////////////////////////////////////
 // check peak boundaries on simulation data //
 //////////////////////////////////////////////
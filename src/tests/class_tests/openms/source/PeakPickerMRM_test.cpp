@@ -188,6 +188,48 @@ START_SECTION(void pickChromatogram(const RichPeakChromatogram &chromatogram, Ri
 }
 END_SECTION
 
+START_SECTION(void pickChromatograms(const std::vector<const MSChromatogram*>& chromatograms, std::vector<MSChromatogram>& picked_chroms, std::vector<MSChromatogram>& smoothed_chroms))
+{
+  RichPeakChromatogram chrom_0 = get_chrom(0), chrom_1 = get_chrom(1), empty_chrom;
+  std::vector<const MSChromatogram*> chroms = {&chrom_0, &empty_chrom, &chrom_1};
+
+  for (const String method : {"legacy", "corrected"})
+  {
+    PeakPickerMRM picker;
+    Param picker_param = picker.getDefaults();
+    picker_param.setValue("method", method);
+    picker_param.setValue("peak_width", 40.0);
+    picker.setParameters(picker_param);
+
+    std::vector<MSChromatogram> picked_chroms, smoothed_chroms;
+    picker.pickChromatograms(chroms, picked_chroms, smoothed_chroms);
+    TEST_EQUAL(picked_chroms.size(), 3)
+    TEST_EQUAL(smoothed_chroms.size(), 3)
+    TEST_EQUAL(picked_chroms[1].size(), 0)
+
+    for (Size k : {0, 2})
+    {
+      RichPeakChromatogram picked_chrom, smoothed_chrom;
+      picker.pickChromatogram(*chroms[k], picked_chrom, smoothed_chrom);
+      TEST_EQUAL(picked_chroms[k].size(), picked_chrom.size())
+      TEST_EQUAL(smoothed_chroms[k].size(), smoothed_chrom.size())
+      ABORT_IF(picked_chroms[k].size() != picked_chrom.size())
+      for (Size i = 0; i < picked_chrom.size(); ++i)
+      {
+        TEST_REAL_SIMILAR(picked_chroms[k][i].getRT(), picked_chrom[i].getRT())
+        TEST_REAL_SIMILAR(picked_chroms[k][i].getIntensity(), picked_chrom[i].getIntensity())
+        TEST_REAL_SIMILAR(picked_chroms[k].getFloatDataArrays()[PeakPickerMRM::IDX_ABUNDANCE][i],
+                          picked_chrom.getFloatDataArrays()[PeakPickerMRM::IDX_ABUNDANCE][i])
+      }
+      for (Size i = 0; i < smoothed_chrom.size(); ++i)
+      {
+        TEST_REAL_SIMILAR(smoothed_chroms[k][i].getIntensity(), smoothed_chrom[i].getIntensity())
+      }
+    }
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
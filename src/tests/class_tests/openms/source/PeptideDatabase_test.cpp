@@ -0,0 +1,213 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/PeptideDatabase.h>
+///////////////////////////
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(PeptideDatabase, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+PeptideDatabase* ptr = nullptr;
+PeptideDatabase* null_ptr = nullptr;
+START_SECTION(PeptideDatabase())
+{
+  ptr = new PeptideDatabase();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->isLoaded(), false)
+  TEST_EQUAL(ptr->size(), 0)
+}
+END_SECTION
+
+START_SECTION(~PeptideDatabase())
+{
+  delete ptr;
+}
+END_SECTION
+
+std::vector<FASTAFile::FASTAEntry> proteins;
+proteins.push_back(FASTAFile::FASTAEntry("P1", "", "AGGGKMGGGR"));
+proteins.push_back(FASTAFile::FASTAEntry("P2", "", "MGGGRAXGGK")); // AXGGK is skipped
+proteins.push_back(FASTAFile::FASTAEntry("P3", "", "AGGGK"));
+
+PeptideDatabase::Settings settings;
+settings.checksum = "test";
+settings.enzyme = "Trypsin";
+settings.missed_cleavages = 0;
+settings.min_length = 4;
+settings.max_length = 0;
+settings.variable_modifications = {"Oxidation (M)"};
+settings.max_variable_mods_per_peptide = 2;
+
+START_SECTION((String Settings::getKey() const))
+{
+  PeptideDatabase::Settings other = settings;
+  TEST_EQUAL(other.getKey(), settings.getKey())
+  other.missed_cleavages = 1;
+  TEST_NOT_EQUAL(other.getKey(), settings.getKey())
+  other = settings;
+  other.checksum = "other";
+  TEST_NOT_EQUAL(other.getKey(), settings.getKey())
+}
+END_SECTION
+
+String tmp_file;
+NEW_TMP_FILE(tmp_file)
+PeptideDatabase db;
+
+START_SECTION((static void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const Settings& settings, const String& filename)))
+{
+  PeptideDatabase::build(proteins, settings, tmp_file);
+  NOT_TESTABLE // see load()
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+{
+  db.load(tmp_file);
+  TEST_EQUAL(db.isLoaded(), true)
+  TEST_EQUAL(db.getKey(), settings.getKey())
+
+  PeptideDatabase other;
+  TEST_EXCEPTION(Exception::FileNotFound, other.load("this_file_does_not_exist.pepdb"))
+  TEST_EXCEPTION(Exception::ParseError, other.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta")))
+  TEST_EQUAL(other.isLoaded(), false)
+}
+END_SECTION
+
+START_SECTION((bool isCompatible(const Settings& settings) const))
+{
+  TEST_EQUAL(db.isCompatible(settings), true)
+  PeptideDatabase::Settings other = settings;
+  other.variable_modifications.clear();
+  TEST_EQUAL(db.isCompatible(other), false)
+  TEST_EQUAL(PeptideDatabase().isCompatible(settings), false)
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  // AGGGK, MGGGR and M(Oxidation)GGGR
+  TEST_EQUAL(db.size(), 3)
+}
+END_SECTION
+
+START_SECTION((const Candidate& getCandidate(Size index) const))
+{
+  TEST_REAL_SIMILAR(db.getCandidate(0).mono_mass, AASequence::fromString("AGGGK").getMonoWeight())
+  TEST_REAL_SIMILAR(db.getCandidate(1).mono_mass, AASequence::fromString("MGGGR").getMonoWeight())
+  TEST_REAL_SIMILAR(db.getCandidate(2).mono_mass, AASequence::fromString("M(Oxidation)GGGR").getMonoWeight())
+  TEST_EQUAL(db.getCandidate(0).peptide_index, 0)
+  TEST_EQUAL(db.getCandidate(1).peptide_index, 1)
+  TEST_EQUAL(db.getCandidate(2).peptide_index, 1)
+  TEST_NOT_EQUAL(db.getCandidate(1).mod_index, db.getCandidate(2).mod_index)
+}
+END_SECTION
+
+START_SECTION((StringView getModifiedSequence(Size index) const))
+{
+  TEST_EQUAL(db.getModifiedSequence(0).getString(), "AGGGK")
+  TEST_EQUAL(db.getModifiedSequence(1).getString(), "MGGGR")
+  TEST_EQUAL(db.getModifiedSequence(2).getString(), "M(Oxidation)GGGR")
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getCandidateRange(double min_mass, double max_mass) const))
+{
+  auto r = db.getCandidateRange(db.getCandidate(1).mono_mass - 0.01, 1000.0);
+  TEST_EQUAL(r.first, 1)
+  TEST_EQUAL(r.second, 3)
+  r = db.getCandidateRange(0.0, db.getCandidate(0).mono_mass);
+  TEST_EQUAL(r.first, 0)
+  TEST_EQUAL(r.second, 1)
+  r = db.getCandidateRange(1000.0, 2000.0);
+  TEST_EQUAL(r.first, r.second)
+}
+END_SECTION
+
+START_SECTION((Size getPeptideCount() const))
+{
+  TEST_EQUAL(db.getPeptideCount(), 2)
+}
+END_SECTION
+
+START_SECTION((const Peptide& getPeptide(Size index) const))
+{
+  TEST_EQUAL(db.getPeptide(0).protein_count, 2)
+  TEST_EQUAL(db.getPeptide(1).protein_count, 2)
+}
+END_SECTION
+
+START_SECTION((StringView getPeptideSequence(Size index) const))
+{
+  TEST_EQUAL(db.getPeptideSequence(0).getString(), "AGGGK")
+  TEST_EQUAL(db.getPeptideSequence(1).getString(), "MGGGR")
+}
+END_SECTION
+
+START_SECTION((Size getProteinCount() const))
+{
+  TEST_EQUAL(db.getProteinCount(), 3)
+}
+END_SECTION
+
+START_SECTION((Size getProteinIndex(const Peptide& peptide, Size i) const))
+{
+  TEST_EQUAL(db.getProteinIndex(db.getPeptide(0), 0), 0)
+  TEST_EQUAL(db.getProteinIndex(db.getPeptide(0), 1), 2)
+  TEST_EQUAL(db.getProteinIndex(db.getPeptide(1), 0), 0)
+  TEST_EQUAL(db.getProteinIndex(db.getPeptide(1), 1), 1)
+}
+END_SECTION
+
+START_SECTION((StringView getProteinAccession(Size index) const))
+{
+  TEST_EQUAL(db.getProteinAccession(0).getString(), "P1")
+  TEST_EQUAL(db.getProteinAccession(2).getString(), "P3")
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -369,6 +369,97 @@ START_SECTION((ExitCodes run(std::vector<FASTAFile::FASTAEntry>& proteins, std::
 }
 END_SECTION
 
+START_SECTION((ExitCodes run(const ProteinSequenceIndex& index, std::vector<ProteinIdentification>& prot_ids, std::vector<PeptideIdentification>& pep_ids)))
+{
+  // results must be identical to a full database scan
+  std::vector<FASTAFile::FASTAEntry> proteins = toFASTAVec(QStringList() << "MKPEPTIDERAAAKPEPTLDER*" << "PEPTLDEKAAAR" << "PEPTIDEXAAAKBEBER" << "JEBEKPEPTIDER"
+                                                                         << "REDITPEPKAAAREDITPEPKM" << "KAAAKPEPTIDER",
+                                                           QStringList() << "P1" << "P2" << "P3_amb" << "P4_J" << "DECOY_P1" << "DECOY_P2");
+  const QStringList peptides = QStringList() << "PEPTIDER" << "PEPTLDER" << "AAAKPEPTIDER" << "PEPTIDEK" << "AAAR" << "EBER" << "IEBEK" << "LEBEK"
+                                             << "REDITPEPK" << "PEPTIDEXAAAK" << "NOTFOUND" << "PEPTIDER";
+  auto evidences = [](const std::vector<PeptideIdentification>& pep_ids)
+  {
+    std::vector<String> result;
+    for (const auto& pep : pep_ids)
+    {
+      for (const auto& hit : pep.getHits())
+      {
+        String s = hit.getSequence().toString() + ":" + String(hit.getMetaValue("target_decoy", "")) + ":" + String(hit.getMetaValue("protein_references"));
+        std::vector<PeptideEvidence> ev = hit.getPeptideEvidences();
+        std::sort(ev.begin(), ev.end());
+        for (const auto& e : ev)
+        {
+          s += String(" ") + e.getProteinAccession() + "@" + String(e.getStart()) + "-" + String(e.getEnd()) + e.getAABefore() + e.getAAAfter();
+        }
+        result.push_back(s);
+      }
+    }
+    return result;
+  };
+
+  for (const String IL : {"true", "false"})
+  {
+    for (const int aaa_max : {0, 3})
+    {
+      for (const int mm_max : {0, 1})
+      {
+        for (const String specificity : {"full", "semi"})
+        {
+          PeptideIndexing pi;
+          Param p = pi.getParameters();
+          p.setValue("IL_equivalent", IL);
+          p.setValue("aaa_max", aaa_max);
+          p.setValue("mismatches_max", mm_max);
+          p.setValue("enzyme:specificity", specificity);
+          p.setValue("unmatched_action", "warn");
+          p.setValue("write_protein_sequence", "true");
+          pi.setParameters(p);
+
+          std::vector<ProteinIdentification> prot_ids_scan(1), prot_ids_index(1);
+          std::vector<PeptideIdentification> pep_ids_scan = toPepVec(peptides), pep_ids_index = toPepVec(peptides);
+          FASTAContainer<TFI_Vector> fc(proteins);
+          PeptideIndexing::ExitCodes r_scan = pi.run(fc, prot_ids_scan, pep_ids_scan);
+
+          FASTAContainer<TFI_Vector> fc_index(proteins);
+          ProteinSequenceIndex index;
+          index.build(fc_index, IL == "true", "");
+          PeptideIndexing::ExitCodes r_index = pi.run(index, prot_ids_index, pep_ids_index);
+
+          TEST_EQUAL(r_scan, r_index)
+          TEST_EQUAL(evidences(pep_ids_scan) == evidences(pep_ids_index), true)
+          TEST_EQUAL(prot_ids_scan[0].getHits().size(), prot_ids_index[0].getHits().size())
+          ABORT_IF(prot_ids_scan[0].getHits().size() != prot_ids_index[0].getHits().size())
+          for (Size i = 0; i < prot_ids_scan[0].getHits().size(); ++i)
+          {
+            TEST_EQUAL(prot_ids_scan[0].getHits()[i].getAccession(), prot_ids_index[0].getHits()[i].getAccession())
+            TEST_EQUAL(prot_ids_scan[0].getHits()[i].getSequence(), prot_ids_index[0].getHits()[i].getSequence())
+            TEST_EQUAL(prot_ids_scan[0].getHits()[i].getMetaValue("target_decoy"), prot_ids_index[0].getHits()[i].getMetaValue("target_decoy"))
+          }
+        }
+      }
+    }
+  }
+
+  // index built with different IL setting
+  PeptideIndexing pi;
+  Param p = pi.getParameters();
+  p.setValue("IL_equivalent", "true");
+  pi.setParameters(p);
+  FASTAContainer<TFI_Vector> fc(proteins);
+  ProteinSequenceIndex index;
+  index.build(fc, false, "");
+  std::vector<ProteinIdentification> prot_ids;
+  std::vector<PeptideIdentification> pep_ids = toPepVec(peptides);
+  TEST_EXCEPTION(Exception::InvalidParameter, pi.run(index, prot_ids, pep_ids))
+
+  // empty index
+  ProteinSequenceIndex empty_index;
+  p.setValue("IL_equivalent", "false");
+  pi.setParameters(p);
+  TEST_EQUAL(pi.run(empty_index, prot_ids, pep_ids), PeptideIndexing::DATABASE_EMPTY)
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -0,0 +1,192 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/ProteinSequenceIndex.h>
+///////////////////////////
+
+#include <algorithm>
+
+using namespace OpenMS;
+using namespace std;
+
+// all occurrences of @p pep in the preprocessed sequences, found naively
+std::vector<std::pair<Hit::T, Hit::T>> naiveFind(const ProteinSequenceIndex& index, const String& pep)
+{
+  std::vector<std::pair<Hit::T, Hit::T>> result;
+  const auto& ambiguous = index.getAmbiguousProteins();
+  for (Size i = 0; i < index.size(); ++i)
+  {
+    if (std::find(ambiguous.begin(), ambiguous.end(), Hit::T(i)) != ambiguous.end()) continue;
+    const String seq = index.getSearchSequence(i);
+    for (size_t pos = seq.find(pep); pos != std::string::npos; pos = seq.find(pep, pos + 1))
+    {
+      result.emplace_back(Hit::T(i), Hit::T(pos));
+    }
+  }
+  return result;
+}
+
+std::vector<std::pair<Hit::T, Hit::T>> indexFind(const ProteinSequenceIndex& index, const String& pep)
+{
+  std::vector<ProteinSequenceIndex::Occurrence> occ;
+  index.findExact(pep, occ);
+  std::vector<std::pair<Hit::T, Hit::T>> result;
+  for (const auto& o : occ) result.emplace_back(o.protein_index, o.position);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+START_TEST(ProteinSequenceIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+std::vector<FASTAFile::FASTAEntry> proteins;
+proteins.push_back(FASTAFile::FASTAEntry("P1", "first protein", "MKPEPTIDERAAAKPEPTIDER*"));
+proteins.push_back(FASTAFile::FASTAEntry("P2", "", "PEPTLDEKAAA"));
+proteins.push_back(FASTAFile::FASTAEntry("P3_amb", "", "PEPTIDEXAAAB"));
+proteins.push_back(FASTAFile::FASTAEntry("P4", "", "A"));
+proteins.push_back(FASTAFile::FASTAEntry("P5_lower", "", "peptider"));
+proteins.push_back(FASTAFile::FASTAEntry("DECOY_P1", "", "REDITPEPKAAAREDITPEPKM"));
+
+ProteinSequenceIndex* ptr = nullptr;
+ProteinSequenceIndex* null_ptr = nullptr;
+START_SECTION(ProteinSequenceIndex())
+{
+  ptr = new ProteinSequenceIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->empty(), true)
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void build(FASTAContainer<TFI_Vector>& proteins, bool IL_equivalent, const String& checksum)))
+{
+  FASTAContainer<TFI_Vector> fc(proteins);
+  ProteinSequenceIndex index;
+  index.build(fc, false, "abc");
+  TEST_EQUAL(index.size(), 6)
+  TEST_EQUAL(index.empty(), false)
+  TEST_STRING_EQUAL(index.getChecksum(), "abc")
+  TEST_EQUAL(index.isILEquivalent(), false)
+  TEST_EQUAL(index.hasInvalidSequences(), false)
+  TEST_STRING_EQUAL(index.getSearchSequence(0), "MKPEPTIDERAAAKPEPTIDER") // '*' removed
+  TEST_STRING_EQUAL(index.getEntries()[0].sequence, "MKPEPTIDERAAAKPEPTIDER*") // original entry
+  TEST_STRING_EQUAL(index.getEntries()[0].description, "first protein")
+  // ambiguous AAs and lower case letters cannot be matched exactly
+  TEST_EQUAL(index.getAmbiguousProteins().size(), 2)
+  TEST_EQUAL(index.getAmbiguousProteins()[0], 2)
+  TEST_EQUAL(index.getAmbiguousProteins()[1], 4)
+
+  FASTAContainer<TFI_Vector> fc_IL(proteins);
+  index.build(fc_IL, true, "IL");
+  TEST_EQUAL(index.isILEquivalent(), true)
+  TEST_STRING_EQUAL(index.getSearchSequence(1), "PEPTIDEKAAA")
+}
+END_SECTION
+
+START_SECTION((void findExact(const std::string& peptide, std::vector<Occurrence>& result) const))
+{
+  FASTAContainer<TFI_Vector> fc(proteins);
+  ProteinSequenceIndex index;
+  index.build(fc, false, "");
+
+  std::vector<std::pair<Hit::T, Hit::T>> expected = {{0, 2}, {0, 14}};
+  TEST_EQUAL(indexFind(index, "PEPTIDER") == expected, true)
+  expected = {{0, 10}, {1, 8}, {5, 9}};
+  TEST_EQUAL(indexFind(index, "AAA") == expected, true)
+  TEST_EQUAL(indexFind(index, "PEPTIDEX").empty(), true) // ambiguous protein is not in the suffix array
+  TEST_EQUAL(indexFind(index, "PEPTIDERA").size(), 1)
+  TEST_EQUAL(indexFind(index, "RAAAKPEPTIDERM").empty(), true) // beyond the end of a protein
+  TEST_EQUAL(indexFind(index, "DERRED").empty(), true) // across two proteins
+  TEST_EQUAL(indexFind(index, "").empty(), true)
+
+  // compare all substrings against a naive search
+  for (Size i = 0; i < proteins.size(); ++i)
+  {
+    const String seq = index.getSearchSequence(i);
+    for (Size b = 0; b < seq.size(); ++b)
+    {
+      for (Size len = 1; b + len <= seq.size(); ++len)
+      {
+        const String pep = seq.substr(b, len);
+        TEST_EQUAL(indexFind(index, pep) == naiveFind(index, pep), true)
+      }
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((void store(const String& filename) const))
+{
+  NOT_TESTABLE // tested below
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+{
+  FASTAContainer<TFI_Vector> fc(proteins);
+  ProteinSequenceIndex index;
+  index.build(fc, true, "checksum");
+  String tmp_file;
+  NEW_TMP_FILE(tmp_file)
+  index.store(tmp_file);
+
+  ProteinSequenceIndex loaded;
+  loaded.load(tmp_file);
+  TEST_STRING_EQUAL(loaded.getChecksum(), "checksum")
+  TEST_EQUAL(loaded.isILEquivalent(), true)
+  TEST_EQUAL(loaded.size(), index.size())
+  TEST_EQUAL(loaded.getAmbiguousProteins() == index.getAmbiguousProteins(), true)
+  for (Size i = 0; i < index.size(); ++i)
+  {
+    TEST_EQUAL(loaded.getEntries()[i] == index.getEntries()[i], true)
+    TEST_STRING_EQUAL(loaded.getSearchSequence(i), index.getSearchSequence(i))
+  }
+  TEST_EQUAL(indexFind(loaded, "PEPTIDE") == indexFind(index, "PEPTIDE"), true)
+  TEST_EQUAL(indexFind(loaded, "PEPTIDE").size(), 3)
+
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load("this_file_does_not_exist.idx"))
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta")))
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -157,6 +157,38 @@ START_SECTION((template <typename PeakType> void filterExperiment(MSExperiment<P
 
 END_SECTION
 
+START_SECTION((void filterChromatograms(std::vector<MSChromatogram>& chromatograms)))
+{
+  std::vector<MSChromatogram> chromatograms(3);
+  for (Size i = 0; i < 30; ++i)
+  {
+    ChromatogramPeak peak(100.0 + i, 100.0 * exp(-0.1 * (i - 15.0) * (i - 15.0)));
+    chromatograms[0].push_back(peak);
+    if (i < 5) chromatograms[1].push_back(peak); // shorter than the frame
+  }
+
+  SavitzkyGolayFilter sgolay;
+  std::vector<MSChromatogram> expected = chromatograms;
+  for (MSChromatogram& chrom : expected)
+  {
+    sgolay.filter(chrom);
+  }
+  sgolay.filterChromatograms(chromatograms);
+
+  TEST_EQUAL(chromatograms.size(), 3)
+  TEST_EQUAL(chromatograms[2].size(), 0)
+  for (Size c = 0; c < 2; ++c)
+  {
+    TEST_EQUAL(chromatograms[c].size(), expected[c].size())
+    for (Size i = 0; i < chromatograms[c].size(); ++i)
+    {
+      TEST_REAL_SIMILAR(chromatograms[c][i].getRT(), expected[c][i].getRT())
+      TEST_REAL_SIMILAR(chromatograms[c][i].getIntensity(), expected[c][i].getIntensity())
+    }
+  }
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -114,6 +114,57 @@ START_SECTION([EXTRA](virtual void init(const Container& c)))
 
 END_SECTION
 
+START_SECTION((std::vector<std::vector<double> > estimateSignalToNoise(const std::vector<Container>& data) const))
+{
+  MSSpectrum raw_data;
+  DTAFile().load(OPENMS_GET_TEST_DATA_PATH("SignalToNoiseEstimator_test.dta"), raw_data);
+
+  // several spectra (including an empty one) with different intensity distributions
+  std::vector<MSSpectrum> spectra;
+  for (Size i = 0; i < 20; ++i)
+  {
+    MSSpectrum spec = raw_data;
+    for (Size k = 0; k < spec.size(); ++k)
+    {
+      spec[k].setIntensity(spec[k].getIntensity() * (1.0 + double((i * k) % 7) / (i + 1)));
+    }
+    spectra.push_back(spec);
+  }
+  spectra.push_back(MSSpectrum());
+
+  SignalToNoiseEstimatorMedian< MSSpectrum > sne;
+  Param p;
+  p.setValue("win_len", 40.0);
+  p.setValue("noise_for_empty_window", 2.0);
+  p.setValue("min_required_elements", 10);
+  p.setValue("write_log_messages", "false");
+  sne.setParameters(p);
+
+  std::vector<std::vector<double> > stn = sne.estimateSignalToNoise(spectra);
+  ABORT_IF(stn.size() != spectra.size())
+  TEST_EQUAL(stn.back().empty(), true)
+
+  // same results as spectrum-by-spectrum estimation
+  bool all_equal = true;
+  for (Size i = 0; i + 1 < spectra.size(); ++i)
+  {
+    sne.init(spectra[i]);
+    all_equal &= (stn[i].size() == spectra[i].size());
+    for (Size k = 0; k < std::min(stn[i].size(), spectra[i].size()); ++k)
+    {
+      all_equal &= (stn[i][k] == sne.getSignalToNoise(k));
+    }
+  }
+  TEST_EQUAL(all_equal, true)
+
+  // invalid settings are reported
+  p.setValue("auto_mode", -1);
+  p.setValue("max_intensity", -1);
+  sne.setParameters(p);
+  TEST_EXCEPTION(Exception::InvalidValue, sne.estimateSignalToNoise(spectra))
+}
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
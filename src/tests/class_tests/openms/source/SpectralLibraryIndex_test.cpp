@@ -0,0 +1,246 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
+///////////////////////////
+
+#include <OpenMS/CONCEPT/Constants.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectralLibraryIndex, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectralLibraryIndex* ptr = nullptr;
+SpectralLibraryIndex* null_ptr = nullptr;
+START_SECTION(SpectralLibraryIndex())
+{
+  ptr = new SpectralLibraryIndex();
+  TEST_NOT_EQUAL(ptr, null_ptr)
+  TEST_EQUAL(ptr->isLoaded(), false)
+  TEST_EQUAL(ptr->size(), 0)
+}
+END_SECTION
+
+START_SECTION(~SpectralLibraryIndex())
+{
+  delete ptr;
+}
+END_SECTION
+
+// library spectrum with the given precursor and peaks at 100, 200, ... with intensities 1, 2, ...
+auto makeSpectrum = [](double precursor_mz, Int charge, Size peaks, double rt)
+{
+  PeakSpectrum s;
+  s.setRT(rt);
+  s.setMSLevel(2);
+  Precursor p;
+  p.setMZ(precursor_mz);
+  p.setCharge(charge);
+  s.getPrecursors().push_back(p);
+  for (Size i = 1; i <= peaks; ++i)
+  {
+    s.emplace_back(100.0 * i, double(i));
+  }
+  return s;
+};
+
+PeakMap library;
+library.addSpectrum(makeSpectrum(600.0, 2, 5, 10.0));
+library.addSpectrum(makeSpectrum(500.0, 2, 4, 20.0));
+library.addSpectrum(makeSpectrum(500.002, 3, 3, 30.0));
+library.addSpectrum(PeakSpectrum()); // no precursor: skipped
+vector<String> labels = {"PEPTIDER", "PEPTIDEK", "M(Oxidation)EPTIDEK", "IGNORED"};
+
+String tmp_file;
+NEW_TMP_FILE(tmp_file)
+SpectralLibraryIndex index;
+
+START_SECTION((static void build(const PeakMap& library, const std::vector<String>& labels, const String& key, const String& filename)))
+{
+  SpectralLibraryIndex::build(library, labels, "test_key", tmp_file);
+  TEST_EXCEPTION(Exception::IllegalArgument, SpectralLibraryIndex::build(library, vector<String>(1, "A"), "test_key", tmp_file))
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+{
+  index.load(tmp_file);
+  TEST_EQUAL(index.isLoaded(), true)
+
+  SpectralLibraryIndex other;
+  TEST_EXCEPTION(Exception::FileNotFound, other.load("this_file_does_not_exist.splib"))
+  TEST_EXCEPTION(Exception::ParseError, other.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta")))
+  TEST_EQUAL(other.isLoaded(), false)
+}
+END_SECTION
+
+START_SECTION((const String& getKey() const))
+{
+  TEST_EQUAL(index.getKey(), "test_key")
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  TEST_EQUAL(index.size(), 3)
+}
+END_SECTION
+
+START_SECTION((const Entry& getEntry(Size index) const))
+{
+  // sorted by precursor m/z
+  TEST_REAL_SIMILAR(index.getEntry(0).precursor_mz, 500.0)
+  TEST_REAL_SIMILAR(index.getEntry(1).precursor_mz, 500.002)
+  TEST_REAL_SIMILAR(index.getEntry(2).precursor_mz, 600.0)
+  TEST_EQUAL(index.getEntry(0).library_index, 1)
+  TEST_EQUAL(index.getEntry(1).library_index, 2)
+  TEST_EQUAL(index.getEntry(2).library_index, 0)
+  TEST_EQUAL(index.getEntry(1).charge, 3)
+  TEST_EQUAL(index.getEntry(0).peak_count, 4)
+  TEST_REAL_SIMILAR(index.getEntry(2).rt, 10.0)
+  TEST_REAL_SIMILAR(index.getEntry(1).norm, sqrt(1.0 + 4.0 + 9.0))
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPrecursorRange(double min_mz, double max_mz) const))
+{
+  auto r = index.getPrecursorRange(499.99, 500.001);
+  TEST_EQUAL(r.first, 0)
+  TEST_EQUAL(r.second, 1)
+  r = index.getPrecursorRange(499.0, 601.0);
+  TEST_EQUAL(r.first, 0)
+  TEST_EQUAL(r.second, 3)
+  r = index.getPrecursorRange(700.0, 800.0);
+  TEST_EQUAL(r.first, r.second)
+}
+END_SECTION
+
+START_SECTION((StringView getLabel(Size index) const))
+{
+  TEST_EQUAL(index.getLabel(0).getString(), "PEPTIDEK")
+  TEST_EQUAL(index.getLabel(1).getString(), "M(Oxidation)EPTIDEK")
+  TEST_EQUAL(index.getLabel(2).getString(), "PEPTIDER")
+}
+END_SECTION
+
+START_SECTION((void getSpectrum(Size index, PeakSpectrum& spectrum) const))
+{
+  PeakSpectrum s;
+  index.getSpectrum(2, s);
+  TEST_EQUAL(s.size(), 5)
+  TEST_REAL_SIMILAR(s[4].getMZ(), 500.0)
+  TEST_REAL_SIMILAR(s[4].getIntensity(), 5.0)
+  TEST_REAL_SIMILAR(s.getRT(), 10.0)
+  TEST_EQUAL(s.getPrecursors().size(), 1)
+  TEST_REAL_SIMILAR(s.getPrecursors()[0].getMZ(), 600.0)
+}
+END_SECTION
+
+START_SECTION((double score(const PeakSpectrum& query, Size index, double fragment_mass_tolerance, bool fragment_mass_tolerance_ppm) const))
+{
+  // identical spectrum (scaled intensities)
+  PeakSpectrum query = makeSpectrum(500.0, 2, 4, 0.0);
+  for (Peak1D& p : query) { p.setIntensity(p.getIntensity() * 10.0); }
+  TEST_REAL_SIMILAR(index.score(query, 0, 0.5, false), 1.0)
+
+  // shifted peaks are not matched
+  for (Peak1D& p : query) { p.setMZ(p.getMZ() + 1.0); }
+  TEST_REAL_SIMILAR(index.score(query, 0, 0.5, false), 0.0)
+  TEST_REAL_SIMILAR(index.score(query, 0, 20000.0, true), 1.0)
+
+  // subset: peaks 100 and 200 of entry 0 (intensities 1, 2, 3, 4)
+  query = makeSpectrum(500.0, 2, 2, 0.0);
+  TEST_REAL_SIMILAR(index.score(query, 0, 0.5, false), (1.0 + 4.0) / (sqrt(5.0) * sqrt(30.0)))
+}
+END_SECTION
+
+START_SECTION((void search(const std::vector<PeakSpectrum>& queries, const SearchParameters& params, std::vector<std::vector<Match> >& results) const))
+{
+  vector<PeakSpectrum> queries;
+  queries.push_back(makeSpectrum(500.001, 2, 4, 0.0)); // entry 0 (entry 1 differs in charge)
+  queries.push_back(makeSpectrum(500.001, 0, 3, 0.0)); // entries 0 and 1 (unknown charge)
+  queries.push_back(makeSpectrum(700.0, 2, 4, 0.0));   // nothing
+  queries.push_back(makeSpectrum(600.0 + Constants::C13C12_MASSDIFF_U / 2, 2, 5, 0.0)); // entry 2 (isotopic misassignment)
+
+  SpectralLibraryIndex::SearchParameters params;
+  params.precursor_mass_tolerance = 5.0;
+  params.precursor_mass_tolerance_ppm = true;
+  params.isotopes = {0, 1};
+
+  vector<vector<SpectralLibraryIndex::Match> > results;
+  index.search(queries, params, results);
+  TEST_EQUAL(results.size(), 4)
+  ABORT_IF(results.size() != 4)
+
+  TEST_EQUAL(results[0].size(), 1)
+  TEST_EQUAL(results[0][0].entry_index, 0)
+  TEST_REAL_SIMILAR(results[0][0].score, 1.0)
+  TEST_EQUAL(results[0][0].isotope, 0)
+
+  TEST_EQUAL(results[1].size(), 2)
+  TEST_EQUAL(results[1][0].entry_index, 1)
+  TEST_REAL_SIMILAR(results[1][0].score, 1.0)
+  TEST_EQUAL(results[1][1].entry_index, 0)
+
+  TEST_EQUAL(results[2].size(), 0)
+
+  TEST_EQUAL(results[3].size(), 1)
+  TEST_EQUAL(results[3][0].entry_index, 2)
+  TEST_EQUAL(results[3][0].isotope, 1)
+
+  params.top_hits = 1;
+  index.search(queries, params, results);
+  TEST_EQUAL(results[1].size(), 1)
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  index.clear();
+  TEST_EQUAL(index.isLoaded(), false)
+  TEST_EQUAL(index.size(), 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -43,6 +43,9 @@
 #include <OpenMS/FORMAT/HANDLERS/MzMLSqliteHandler.h>
 #include <OpenMS/FORMAT/HANDLERS/MzMLSqliteSwathHandler.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -160,6 +163,53 @@ START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
 }
 END_SECTION
 
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  OpenMS::Internal::MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"), 0);
+  SpectrumAccessSqMass sasm(handler);
+  std::vector<int> second;
+  second.push_back(1);
+  SpectrumAccessSqMass subset(handler, second);
+
+  for (const SpectrumAccessSqMass* access : {&sasm, &subset})
+  {
+    std::vector<double> rts;
+    for (Size i = 0; i < access->getNrSpectra(); ++i)
+    {
+      rts.push_back(access->getSpectrumMetaById(int(i)).RT);
+    }
+    double min_rt = *std::min_element(rts.begin(), rts.end());
+    double max_rt = *std::max_element(rts.begin(), rts.end());
+
+    // the indices returned have to be exactly those of the spectra within the RT window (in increasing order)
+    std::vector<std::pair<double, double> > windows = {
+      {min_rt, 0.001}, {max_rt, 0.001}, {(min_rt + max_rt) / 2, (max_rt - min_rt) / 2 + 1.0},
+      {(min_rt + max_rt) / 2, (max_rt - min_rt) / 4}, {min_rt - 100.0, 1.0}, {max_rt + 100.0, 1.0}};
+    for (const auto& window : windows)
+    {
+      std::vector<std::size_t> expected;
+      for (Size i = 0; i < rts.size(); ++i)
+      {
+        if (std::fabs(rts[i] - window.first) <= window.second) expected.push_back(i);
+      }
+      std::vector<std::size_t> result = access->getSpectraByRT(window.first, window.second);
+      TEST_EQUAL(result.size(), expected.size())
+      ABORT_IF(result.size() != expected.size())
+      for (Size i = 0; i < result.size(); ++i)
+      {
+        TEST_EQUAL(result[i], expected[i])
+      }
+    }
+
+    // without tolerance: the first spectrum at or after the given RT
+    std::vector<std::size_t> result = access->getSpectraByRT(min_rt - 100.0, 0.0);
+    TEST_EQUAL(result.size(), 1)
+    TEST_REAL_SIMILAR(rts[result[0]], min_rt)
+    TEST_EQUAL(access->getSpectraByRT(max_rt + 100.0, 0.0).size(), 0)
+  }
+}
+END_SECTION
+
 START_SECTION(void getAllSpectra(std::vector< OpenSwath::SpectrumPtr > & spectra, std::vector< OpenSwath::SpectrumMeta > & spectra_meta))
 {
   OpenMS::Internal::MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"), 0);
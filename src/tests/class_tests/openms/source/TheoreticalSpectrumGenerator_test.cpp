@@ -528,6 +528,75 @@ START_SECTION(static MSSpectrum generateSpectrum(const Precursor::ActivationMeth
 
 END_SECTION
 
+START_SECTION(void getFragmentMZs(const AASequence& peptide, Int min_charge, Int max_charge, std::vector<double>& mz) const)
+{
+  TheoreticalSpectrumGenerator t_gen;
+  Param param = t_gen.getParameters();
+  param.setValue("add_a_ions", "true");
+  param.setValue("add_c_ions", "true");
+  param.setValue("add_x_ions", "true");
+  param.setValue("add_z_ions", "true");
+  param.setValue("add_first_prefix_ion", "true");
+  t_gen.setParameters(param);
+
+  const AASequence modified = AASequence::fromString(".(Acetyl)PEPTM(Oxidation)IDEK.(Amidated)");
+  PeakSpectrum expected;
+  t_gen.getSpectrum(expected, modified, 1, 3);
+
+  vector<double> mz;
+  t_gen.getFragmentMZs(modified, 1, 3, mz);
+  TEST_EQUAL(mz.size(), expected.size())
+  ABORT_IF(mz.size() != expected.size())
+  for (Size i = 0; i < mz.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(mz[i], expected[i].getMZ())
+  }
+
+  // the buffer is reused
+  t_gen.getFragmentMZs(AASequence::fromString("PEPTIDEK"), 1, 1, mz);
+  TEST_EQUAL(mz.size(), 6 * 7)
+
+  // default settings: b2..b6 and y1..y6
+  TheoreticalSpectrumGenerator default_gen;
+  default_gen.getFragmentMZs(peptide, 1, 1, mz);
+  expected.clear(true);
+  default_gen.getSpectrum(expected, peptide, 1, 1);
+  TEST_EQUAL(mz.size(), 11)
+  ABORT_IF(mz.size() != expected.size())
+  for (Size i = 0; i < mz.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(mz[i], expected[i].getMZ())
+  }
+
+  default_gen.getFragmentMZs(AASequence::fromString("K"), 1, 1, mz);
+  TEST_EQUAL(mz.empty(), true)
+  TEST_EXCEPTION(Exception::IllegalArgument, default_gen.getFragmentMZs(peptide, 0, 1, mz))
+}
+END_SECTION
+
+START_SECTION(void getFragmentIons(const AASequence& peptide, Int min_charge, Int max_charge, std::vector<FragmentIon>& ions) const)
+{
+  TheoreticalSpectrumGenerator t_gen;
+  Param param = t_gen.getParameters();
+  param.setValue("add_metainfo", "true");
+  t_gen.setParameters(param);
+
+  PeakSpectrum expected;
+  t_gen.getSpectrum(expected, peptide, 1, 2);
+  const PeakSpectrum::StringDataArray& names = expected.getStringDataArrays()[0];
+
+  vector<TheoreticalSpectrumGenerator::FragmentIon> ions;
+  t_gen.getFragmentIons(peptide, 1, 2, ions);
+  TEST_EQUAL(ions.size(), expected.size())
+  ABORT_IF(ions.size() != expected.size())
+  for (Size i = 0; i < ions.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(ions[i].mz, expected[i].getMZ())
+    TEST_EQUAL(String(Residue::residueTypeToIonLetter(ions[i].type)) + String(ions[i].ordinal) + String(ions[i].charge, '+'), names[i])
+  }
+}
+END_SECTION
+
 START_SECTION(([EXTRA] bugfix test where losses lead to formulae with negative element frequencies))
 {
   // this tests for the loss of CONH2 on Arginine, however it is not clear how
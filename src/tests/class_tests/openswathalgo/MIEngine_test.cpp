@@ -0,0 +1,154 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "OpenMS/OPENSWATHALGO/OpenSwathAlgoConfig.h"
+
+#include "OpenMS/OPENSWATHALGO/ALGO/MIEngine.h"
+#include "OpenMS/OPENSWATHALGO/ALGO/Scoring.h"
+
+#ifdef USE_BOOST_UNIT_TEST
+
+// include boost unit test framework
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MyTest
+#include <boost/test/unit_test.hpp>
+// macros for boost
+#define EPS_05 boost::test_tools::fraction_tolerance(1.e-5)
+#define TEST_REAL_SIMILAR(val1, val2) \
+  BOOST_CHECK ( boost::test_tools::check_is_close(val1, val2, EPS_05 ));
+#define TEST_EQUAL(val1, val2) BOOST_CHECK_EQUAL(val1, val2);
+#define END_SECTION
+#define START_TEST(var1, var2)
+#define END_TEST
+
+#else
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#define BOOST_AUTO_TEST_CASE START_SECTION
+using namespace OpenMS;
+
+#endif
+
+using namespace std;
+using namespace OpenSwath;
+
+///////////////////////////
+
+START_TEST(MIEngine, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(test_addTraces)
+{
+  MIEngine engine;
+  TEST_EQUAL(engine.size(), 0)
+
+  std::vector<std::vector<double> > traces = { {5.0, 3.0, 3.0, 8.0, 0.0},
+                                                {1.0, 2.0, 3.0, 4.0, 5.0} };
+  TEST_EQUAL(engine.addTraces(traces), 0)
+  TEST_EQUAL(engine.addTrace(traces[0]), 2)
+  TEST_EQUAL(engine.size(), 3)
+
+  // ties share a rank, ranks have no gaps
+  std::vector<unsigned int> expected = {2, 1, 1, 3, 0};
+  TEST_EQUAL(engine.getRanks(0).size(), 5)
+  for (std::size_t k = 0; k < expected.size(); ++k)
+  {
+    TEST_EQUAL(engine.getRanks(0)[k], expected[k])
+  }
+
+  engine.clear();
+  TEST_EQUAL(engine.size(), 0)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_mutualInformation)
+{
+  // same data as in Scoring_test (test_rankedMutualInformation)
+  std::vector<double> data1 = {5.97543668746948, 4.2749171257019, 3.3301842212677, 4.08597040176392, 5.50307035446167, 5.24326848983765,
+    8.40812492370605, 2.83419919013977, 6.94378805160522, 7.69957494735718, 4.08597040176392};
+  std::vector<double> data2 = {15.8951349258423, 41.5446395874023, 76.0746307373047, 109.069435119629, 111.90364074707, 169.79216003418,
+    121.043930053711, 63.0136985778809, 44.6150207519531, 21.4926776885986, 7.93575811386108};
+  std::vector<double> data3(data1.size(), 0.0);
+
+  MIEngine engine;
+  engine.addTrace(data1);
+  engine.addTrace(data2);
+  engine.addTrace(data3);
+
+  std::vector<std::vector<double> > data = {data1, data2, data3};
+  for (std::size_t i = 0; i < data.size(); ++i)
+  {
+    for (std::size_t j = 0; j < data.size(); ++j)
+    {
+      std::vector<unsigned int> ranks1, ranks2;
+      unsigned int max_rank1 = Scoring::computeAndAppendRank(data[i], ranks1);
+      unsigned int max_rank2 = Scoring::computeAndAppendRank(data[j], ranks2);
+      double expected = Scoring::rankedMutualInformation(ranks1, ranks2, max_rank1, max_rank2);
+      // offset avoids relative comparisons of values close to zero
+      TEST_REAL_SIMILAR(engine.mutualInformation(i, j) + 1.0, expected + 1.0)
+    }
+  }
+
+  TEST_REAL_SIMILAR(engine.mutualInformation(0, 1), 3.2776134)
+  TEST_REAL_SIMILAR(engine.mutualInformation(1, 1), 3.4594316)
+  TEST_REAL_SIMILAR(engine.mutualInformation(1, 2) + 1.0, 1.0)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_mutualInformation_long_traces)
+{
+  // more than MAX_JOINT_TABLE_SIZE joint states: counted by sorting instead of the table
+  std::vector<double> data1(400), data2(400);
+  for (std::size_t k = 0; k < data1.size(); ++k)
+  {
+    data1[k] = static_cast<double>((k * 37) % 211);
+    data2[k] = static_cast<double>((k * 53) % 397);
+  }
+  MIEngine engine;
+  engine.addTrace(data1);
+  engine.addTrace(data2);
+
+  std::vector<unsigned int> ranks1, ranks2;
+  unsigned int max_rank1 = Scoring::computeAndAppendRank(data1, ranks1);
+  unsigned int max_rank2 = Scoring::computeAndAppendRank(data2, ranks2);
+  TEST_REAL_SIMILAR(engine.mutualInformation(0, 1), Scoring::rankedMutualInformation(ranks1, ranks2, max_rank1, max_rank2))
+  TEST_REAL_SIMILAR(engine.mutualInformation(1, 1), Scoring::rankedMutualInformation(ranks2, ranks2, max_rank2, max_rank2))
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,174 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2021.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include "OpenMS/OPENSWATHALGO/OpenSwathAlgoConfig.h"
+
+#include "OpenMS/OPENSWATHALGO/ALGO/XCorrEngine.h"
+
+#ifdef USE_BOOST_UNIT_TEST
+
+// include boost unit test framework
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MyTest
+#include <boost/test/unit_test.hpp>
+// macros for boost
+#define EPS_05 boost::test_tools::fraction_tolerance(1.e-5)
+#define TEST_REAL_SIMILAR(val1, val2) \
+  BOOST_CHECK ( boost::test_tools::check_is_close(val1, val2, EPS_05 ));
+#define TEST_EQUAL(val1, val2) BOOST_CHECK_EQUAL(val1, val2);
+#define END_SECTION
+#define START_TEST(var1, var2)
+#define END_TEST
+
+#else
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#define BOOST_AUTO_TEST_CASE START_SECTION
+using namespace OpenMS;
+
+#endif
+
+#include <cmath>
+
+using namespace std;
+using namespace OpenSwath;
+
+///////////////////////////
+
+START_TEST(XCorrEngine, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(test_addTraces)
+{
+  XCorrEngine engine;
+  TEST_EQUAL(engine.size(), 0)
+
+  std::vector<std::vector<double> > traces = { {5.97543668746948, 4.2749171257019, 3.3301842212677, 4.08597040176392, 5.50307035446167},
+                                                {0.0, 2.0, 4.0, 2.0, 0.0} };
+  TEST_EQUAL(engine.addTraces(traces), 0)
+  TEST_EQUAL(engine.addTrace(traces[0]), 2)
+  TEST_EQUAL(engine.size(), 3)
+
+  // traces are standardized (mean 0, sample standard deviation 1)
+  std::vector<double> expected = traces[1];
+  Scoring::standardize_data(expected);
+  for (std::size_t k = 0; k < expected.size(); ++k)
+  {
+    TEST_REAL_SIMILAR(engine.getTrace(1)[k], expected[k])
+  }
+
+  engine.clear();
+  TEST_EQUAL(engine.size(), 0)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_crossCorrelation_direct)
+{
+  // same data as in Scoring_test (test_NormalizedCrossCorrelation)
+  std::vector<double> data1 = {5.97543668746948, 4.2749171257019, 3.3301842212677, 4.08597040176392, 5.50307035446167, 5.24326848983765,
+    8.40812492370605, 2.83419919013977, 6.94378805160522, 7.69957494735718, 4.08597040176392};
+  std::vector<double> data2 = {15.8951349258423, 41.5446395874023, 76.0746307373047, 109.069435119629, 111.90364074707, 169.79216003418,
+    121.043930053711, 63.0136985778809, 44.6150207519531, 21.4926776885986, 7.93575811386108};
+
+  XCorrEngine engine(XCorrEngine::Method::DIRECT);
+  engine.addTrace(data1);
+  engine.addTrace(data2);
+
+  std::vector<double> s1 = data1, s2 = data2;
+  Scoring::standardize_data(s1);
+  Scoring::standardize_data(s2);
+  Scoring::XCorrArrayType expected = Scoring::normalizedCrossCorrelation(s1, s2, static_cast<int>(s1.size()), 1);
+
+  Scoring::XCorrArrayType result = engine.crossCorrelationArray(0, 1);
+  TEST_EQUAL(result.data.size(), 23)
+  for (std::size_t k = 0; k < result.data.size(); ++k)
+  {
+    TEST_EQUAL(result.data[k].first, expected.data[k].first)
+    TEST_REAL_SIMILAR(result.data[k].second + 10.0, expected.data[k].second + 10.0)
+  }
+  TEST_REAL_SIMILAR(result.data[11].second, 0.03129565)  // lag 0
+  TEST_REAL_SIMILAR(result.data[8].second, 0.39698322)   // lag -3
+
+  // auto-correlation is 1 at lag 0
+  TEST_REAL_SIMILAR(engine.crossCorrelation(0, 0)[11], 1.0)
+
+  XCorrEngine::XCorrPeak peak = engine.maxPeak(0, 1);
+  TEST_EQUAL(peak.first, Scoring::xcorrArrayGetMaxPeak(expected)->first)
+  TEST_REAL_SIMILAR(peak.second, Scoring::xcorrArrayGetMaxPeak(expected)->second)
+  TEST_EQUAL(peak.first, -3)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_crossCorrelation_fft)
+{
+  // long traces: the FFT path has to agree with the direct kernel
+  std::vector<double> data1(300), data2(300);
+  for (std::size_t k = 0; k < data1.size(); ++k)
+  {
+    data1[k] = std::exp(-0.01 * (k - 140.0) * (k - 140.0)) + 0.01 * std::sin(0.7 * k);
+    data2[k] = std::exp(-0.01 * (k - 150.0) * (k - 150.0)) + 0.01 * std::cos(1.3 * k);
+  }
+
+  XCorrEngine direct(XCorrEngine::Method::DIRECT);
+  XCorrEngine fft(XCorrEngine::Method::FFT);
+  XCorrEngine automatic;
+  for (XCorrEngine* e : {&direct, &fft, &automatic})
+  {
+    e->addTrace(data1);
+    e->addTrace(data2);
+  }
+
+  std::vector<double> expected = direct.crossCorrelation(0, 1);
+  std::vector<double> result_fft = fft.crossCorrelation(0, 1);
+  std::vector<double> result_auto = automatic.crossCorrelation(0, 1);
+  TEST_EQUAL(result_fft.size(), 601)
+  TEST_EQUAL(result_auto.size(), 601)
+  for (std::size_t k = 0; k < expected.size(); ++k)
+  {
+    // offset avoids relative comparisons of values close to zero
+    TEST_REAL_SIMILAR(result_fft[k] + 10.0, expected[k] + 10.0)
+    TEST_REAL_SIMILAR(result_auto[k] + 10.0, expected[k] + 10.0)
+  }
+
+  TEST_EQUAL(fft.maxPeak(0, 1).first, direct.maxPeak(0, 1).first)
+  TEST_EQUAL(fft.maxPeak(0, 1).first, 10)
+  TEST_REAL_SIMILAR(fft.maxPeak(0, 1).second, direct.maxPeak(0, 1).second)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
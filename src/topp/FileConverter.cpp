@@ -198,6 +198,8 @@ protected:
     registerDoubleOption_("lossy_mass_accuracy", "<error>", -1.0, "Desired (absolute) m/z accuracy for lossy compression (e.g. use 0.0001 for a mass accuracy of 0.2 ppm at 500 m/z, default uses -1.0 for maximal accuracy).", false, true);
 
     registerFlag_("process_lowmemory", "Whether to process the file on the fly without loading the whole file into memory first (only for conversions of mzXML/mzML to mzML).\nNote: this flag will prevent conversion from spectra to chromatograms.", true);
+    registerIntOption_("process_lowmemory_buffer", "<MB>", 0, "[mzML input with 'process_lowmemory' only] Decode spectra on a background thread while the file is read, holding at most this many megabytes of encoded spectra in flight (0 = decode on the reading thread).", false, true);
+    setMinInt_("process_lowmemory_buffer", 0);
     registerInputFile_("NET_executable", "<executable>", "", "The .NET framework executable. Only required on linux and mac.", false, true, {"is_executable"});
     registerInputFile_("ThermoRaw_executable", "<file>", "ThermoRawFileParser.exe", "The ThermoRawFileParser executable.", false, true, {"is_executable"});
     setValidFormats_("ThermoRaw_executable", {"exe"});
@@ -261,6 +263,7 @@ protected:
 
     bool TIC_DTA2D = getFlag_("TIC_DTA2D");
     bool process_lowmemory = getFlag_("process_lowmemory");
+    Size process_lowmemory_buffer = getIntOption_("process_lowmemory_buffer");
 
     writeDebug_(String("Output file type: ") + FileTypes::typeToName(out_type), 1);
 
@@ -429,6 +432,7 @@ protected:
         {
           MzMLFile mzmlfile;
           mzmlfile.setLogType(log_type_);
+          mzmlfile.getOptions().setMaxInFlightBytes(process_lowmemory_buffer * 1024 * 1024);
           mzmlfile.transform(in, &consumer, skip_full_count);
           return EXECUTION_OK;
         }
@@ -35,6 +35,7 @@
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
+#include <OpenMS/ANALYSIS/ID/ProteinSequenceIndex.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
@@ -86,6 +87,10 @@ using namespace OpenMS;
   PeptideIndexer supports relative database filenames, which (when not found in the current working directory) are looked up in the directories specified
   by @p OpenMS.ini:id_db_dir (see @subpage TOPP_advanced). The database is by default derived from the input idXML's metainformation ('auto' setting), but can be specified explicitly.
 
+  When many idXML files are indexed against the same (large) database, use @p index to store a protein sequence index (suffix array) of the database
+  on first use. Subsequent runs load the index instead of scanning the database, as long as the database checksum (and the @p IL_equivalent setting) match;
+  otherwise the index is rebuilt. Results are identical in both cases.
+
   Further details can be found in the underlying @ref OpenMS::PeptideIndexing implementation.
   
   @note Currently mzIdentML (mzid) is not directly supported as an input/output format of this tool. Convert mzid files to/from idXML using @ref TOPP_IDFileConverter if necessary.
@@ -121,6 +126,8 @@ protected:
     setValidFormats_("fasta", { "fasta" }, false);
     registerOutputFile_("out", "<file>", "", "Output idXML file.");
     setValidFormats_("out", {"idXML"});
+    registerStringOption_("index", "<file>", "", "Protein sequence index of the database (created if missing or outdated). "
+                                                 "Speeds up indexing of many runs against the same database.", false, true);
 
     registerFullParam_(PeptideIndexing().getParameters());
    }
@@ -133,6 +140,7 @@ protected:
     String in = getStringOption_("in");
     String out = getStringOption_("out");
     String db_name = getStringOption_("fasta"); // optional. Might be empty.
+    String index_file = getStringOption_("index"); // optional. Might be empty.
 
     //-------------------------------------------------------------
     // reading input
@@ -187,8 +195,69 @@ protected:
     param_pi.update(param, false, false, false, false, OpenMS_Log_debug); // suppress param. update message
     indexer.setParameters(param_pi);
     indexer.setLogType(this->log_type_);
-    FASTAContainer<TFI_File> proteins(db_name);
-    PeptideIndexing::ExitCodes indexer_exit = indexer.run(proteins, prot_ids, pep_ids);
+    PeptideIndexing::ExitCodes indexer_exit;
+    if (index_file.empty())
+    {
+      FASTAContainer<TFI_File> proteins(db_name);
+      indexer_exit = indexer.run(proteins, prot_ids, pep_ids);
+    }
+    else
+    {
+      const String checksum = FileHandler::computeFileHash(db_name);
+      const bool IL_equivalent = param_pi.getValue("IL_equivalent").toBool();
+      ProteinSequenceIndex index;
+      bool index_valid = false;
+      if (File::exists(index_file))
+      {
+        try
+        {
+          index.load(index_file);
+          index_valid = (index.getChecksum() == checksum && index.isILEquivalent() == IL_equivalent);
+        }
+        catch (Exception::BaseException& e) // unreadable (FileNotFound) or corrupt/outdated (ParseError) index
+        {
+          OPENMS_LOG_WARN << "Could not read protein sequence index: " << e.what() << std::endl;
+        }
+        if (!index_valid)
+        {
+          OPENMS_LOG_INFO << "Protein sequence index '" << index_file << "' does not match the database (or settings). Rebuilding it ..." << std::endl;
+        }
+      }
+      bool index_usable = true;
+      if (!index_valid)
+      {
+        FASTAContainer<TFI_File> proteins(db_name);
+        try
+        {
+          index.build(proteins, IL_equivalent, checksum);
+        }
+        catch (Exception::InvalidSize& e)
+        {
+          OPENMS_LOG_WARN << "Database is too large for a protein sequence index (" << e.what() << "). Indexing without it ..." << std::endl;
+          index_usable = false;
+        }
+        if (index_usable)
+        {
+          try
+          {
+            index.store(index_file);
+          }
+          catch (Exception::UnableToCreateFile& e)
+          {
+            OPENMS_LOG_WARN << "Could not write protein sequence index: " << e.what() << std::endl;
+          }
+        }
+      }
+      if (index_usable)
+      {
+        indexer_exit = indexer.run(index, prot_ids, pep_ids);
+      }
+      else
+      {
+        FASTAContainer<TFI_File> proteins(db_name);
+        indexer_exit = indexer.run(proteins, prot_ids, pep_ids);
+      }
+    }
 
     //-------------------------------------------------------------
     // calculate protein coverage
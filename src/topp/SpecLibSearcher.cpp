@@ -34,18 +34,21 @@
 
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 
+#include <OpenMS/ANALYSIS/ID/SpectralLibraryIndex.h>
 #include <OpenMS/CHEMISTRY/ModificationsDB.h>
 #include <OpenMS/CONCEPT/LogStream.h>
 #include <OpenMS/CONCEPT/Factory.h>
 #include <OpenMS/COMPARISON/SPECTRA/BinnedSpectrum.h>
 #include <OpenMS/COMPARISON/SPECTRA/SpectraSTSimilarityScore.h>
 #include <OpenMS/COMPARISON/SPECTRA/ZhangSimilarityScore.h>
+#include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/MSPFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/MATH/MISC/MathFunctions.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/SYSTEM/File.h>
 
 #include <ctime>
 #include <vector>
@@ -106,6 +109,8 @@ protected:
     setValidFormats_("in", ListUtils::create<String>("mzML"));
     registerInputFile_("lib", "<file>", "", "searchable spectral library (MSP format)");
     setValidFormats_("lib", ListUtils::create<String>("msp"));
+    registerStringOption_("lib_index", "<file>", "", "Binary index of the spectral library. If set, the library is searched in parallel via the index using the normalized dot product as score. 'compare_function' is not supported in this mode and has to be left at its default. "
+                                                     "The index is created from 'lib' if the file does not exist or was built from a different library or settings.", false);
     registerOutputFileList_("out", "<files>", ListUtils::create<String>(""), "Output files. Have to be as many as input files");
     setValidFormats_("out", ListUtils::create<String>("idXML"));
 
@@ -127,14 +132,14 @@ protected:
     registerIntList_("precursor:isotopes", "<num>", isotopes, "Corrects for mono-isotopic peak misassignments. (E.g.: 1 = prec. may be misassigned to first isotopic peak)", false, false);
     
     registerTOPPSubsection_("fragment", "Fragments (Product Ion) Options");
-    registerDoubleOption_("fragment:mass_tolerance", "<tolerance>", 10.0, "Fragment mass tolerance", false);
+    registerDoubleOption_("fragment:mass_tolerance", "<tolerance>", 10.0, "Fragment mass tolerance (only used with 'lib_index')", false);
     
-//    StringList fragment_mass_tolerance_unit_valid_strings;
-//    fragment_mass_tolerance_unit_valid_strings.push_back("ppm");
-//    fragment_mass_tolerance_unit_valid_strings.push_back("Da");
+    StringList fragment_mass_tolerance_unit_valid_strings;
+    fragment_mass_tolerance_unit_valid_strings.push_back("ppm");
+    fragment_mass_tolerance_unit_valid_strings.push_back("Da");
     
-//    registerStringOption_("fragment:mass_tolerance_unit", "<unit>", "ppm", "Unit of fragment m", false, false);
-//    setValidStrings_("fragment:mass_tolerance_unit", fragment_mass_tolerance_unit_valid_strings);
+    registerStringOption_("fragment:mass_tolerance_unit", "<unit>", "ppm", "Unit of fragment mass tolerance (only used with 'lib_index')", false, false);
+    setValidStrings_("fragment:mass_tolerance_unit", fragment_mass_tolerance_unit_valid_strings);
 
     registerStringOption_("compare_function", "<string>", "ZhangSimilarityScore", "function for similarity comparison", false);
     PeakSpectrumCompareFunctor::registerChildren();
@@ -269,6 +274,445 @@ protected:
     return annotated_lib;
   }
 
+  /// remove noise peaks and take the square root of the intensities; returns false if too few peaks remain
+  bool filterQuery_(const PeakSpectrum& spectrum, PeakSpectrum& filtered_query, double remove_peaks_below_threshold, Int cut_peaks_below, UInt min_peaks, UInt max_peaks) const
+  {
+    filtered_query.clear(true);
+    double max_intensity = std::max_element(spectrum.begin(), spectrum.end(), 
+                            [](const Peak1D& l, const Peak1D& r) 
+                            { 
+                              return (l.getIntensity() < r.getIntensity()); 
+                            })->getIntensity();
+
+    double min_high_intensity = max_intensity / cut_peaks_below;
+
+    for (UInt k = 0; k < spectrum.size(); ++k)
+    {
+      if (spectrum[k].getIntensity() >= remove_peaks_below_threshold 
+       && spectrum[k].getIntensity() >= min_high_intensity)
+      {
+        Peak1D peak;
+        peak.setIntensity(sqrt(spectrum[k].getIntensity()));
+        peak.setMZ(spectrum[k].getMZ());
+        filtered_query.push_back(peak);
+      }
+    }
+
+    // retain only top N peaks
+    if (filtered_query.size() > max_peaks)
+    {
+      filtered_query.sortByIntensity(true);
+      filtered_query.resize(max_peaks);
+      filtered_query.sortByPosition();
+    }
+
+    return filtered_query.size() >= min_peaks;
+  }
+
+  /**
+    @brief Serialize the sequence, peak annotations and meta values of a library hit into an index label
+
+    One field per line: the sequence, then "A" lines (peak annotations) and "M" lines (meta values with their type), tab separated.
+  */
+  static String encodeLibraryHit_(const PeptideHit& hit)
+  {
+    String label = hit.getSequence().toString();
+    for (const PeptideHit::PeakAnnotation& pa : hit.getPeakAnnotations())
+    {
+      label += "\nA\t" + pa.annotation + "\t" + String(pa.charge) + "\t" + String(pa.mz) + "\t" + String(pa.intensity);
+    }
+    vector<String> keys;
+    hit.getKeys(keys);
+    for (const String& key : keys)
+    {
+      const DataValue& value = hit.getMetaValue(key);
+      String type = "S";
+      if (value.valueType() == DataValue::INT_VALUE)
+      {
+        type = "I";
+      }
+      else if (value.valueType() == DataValue::DOUBLE_VALUE)
+      {
+        type = "D";
+      }
+      label += "\nM\t" + key + "\t" + type + "\t" + value.toString();
+    }
+    return label;
+  }
+
+  /// restore a library hit from a label written by encodeLibraryHit_()
+  static PeptideHit decodeLibraryHit_(const String& label)
+  {
+    vector<String> lines;
+    label.split('\n', lines);
+    if (lines.empty())
+    {
+      lines.push_back(label);
+    }
+
+    PeptideHit hit;
+    hit.setSequence(AASequence::fromString(lines[0]));
+    vector<PeptideHit::PeakAnnotation> annotations;
+    for (Size i = 1; i < lines.size(); ++i)
+    {
+      vector<String> fields;
+      lines[i].split('\t', fields);
+      if (fields.size() == 5 && fields[0] == "A")
+      {
+        PeptideHit::PeakAnnotation pa;
+        pa.annotation = fields[1];
+        pa.charge = fields[2].toInt();
+        pa.mz = fields[3].toDouble();
+        pa.intensity = fields[4].toDouble();
+        annotations.push_back(pa);
+      }
+      else if (fields.size() == 4 && fields[0] == "M")
+      {
+        if (fields[2] == "I")
+        {
+          hit.setMetaValue(fields[1], fields[3].toInt());
+        }
+        else if (fields[2] == "D")
+        {
+          hit.setMetaValue(fields[1], fields[3].toDouble());
+        }
+        else
+        {
+          hit.setMetaValue(fields[1], fields[3]);
+        }
+      }
+    }
+    hit.setPeakAnnotations(annotations);
+    return hit;
+  }
+
+  /// load the library index or (re)build it from the MSP library if it is missing or outdated
+  void loadLibraryIndex_(const String& lib_index_file, const String& key, const String& in_lib, const StringList& variable_modifications, const StringList& fixed_modifications, double remove_peaks_below_threshold, SpectralLibraryIndex& lib_index)
+  {
+    if (File::exists(lib_index_file))
+    {
+      try
+      {
+        lib_index.load(lib_index_file);
+        if (lib_index.getKey() == key)
+        {
+          OPENMS_LOG_INFO << "Using spectral library index '" << lib_index_file << "' with " << lib_index.size() << " spectra." << endl;
+          return;
+        }
+        OPENMS_LOG_INFO << "Spectral library index '" << lib_index_file << "' was built from a different library or settings. Rebuilding." << endl;
+      }
+      catch (Exception::BaseException& e)
+      {
+        OPENMS_LOG_WARN << "Spectral library index '" << lib_index_file << "' cannot be used (" << e.what() << "). Rebuilding." << endl;
+      }
+      lib_index.clear(); // unmap before overwriting the file
+    }
+
+    vector<PeptideIdentification> ids;
+    PeakMap library;
+    MSPFile().load(in_lib, ids, library);
+    MapLibraryPrecursorToLibrarySpectrum mslib = annotateIdentificationsToSpectra_(ids, library, variable_modifications, fixed_modifications, remove_peaks_below_threshold);
+
+    PeakMap annotated;
+    vector<String> labels;
+    for (auto& entry : mslib)
+    {
+      PeakSpectrum& spectrum = entry.second;
+      const PeptideHit& hit = spectrum.getPeptideIdentifications()[0].getHits()[0];
+      labels.push_back(encodeLibraryHit_(hit));
+      spectrum.getPrecursors()[0].setCharge(hit.getCharge());
+      spectrum.getPeptideIdentifications().clear();
+      annotated.addSpectrum(std::move(spectrum));
+    }
+    SpectralLibraryIndex::build(annotated, labels, key, lib_index_file);
+    lib_index.load(lib_index_file);
+  }
+
+  /// search all query spectra in one parallel batch against the library index
+  void searchLibraryIndex_(const PeakMap& query,
+    const SpectralLibraryIndex& lib_index,
+    const IntList& isotopes,
+    int pc_min_charge,
+    int pc_max_charge,
+    double precursor_mass_tolerance,
+    bool precursor_mass_tolerance_unit_ppm,
+    double fragment_mass_tolerance,
+    bool fragment_mass_tolerance_unit_ppm,
+    int top_hits,
+    double remove_peaks_below_threshold,
+    Int cut_peaks_below,
+    UInt min_peaks,
+    UInt max_peaks,
+    ProteinIdentification& prot_id,
+    vector<PeptideIdentification>& peptide_ids)
+  {
+    // filter the queries as in the classic search
+    vector<PeakSpectrum> filtered_queries;
+    vector<Size> query_indices;
+    for (UInt j = 0; j < query.size(); ++j)
+    {
+      ProteinHit pr_hit;
+      pr_hit.setAccession(j);
+      prot_id.insertHit(pr_hit);
+
+      // proper MS2?
+      if (query[j].empty() || query[j].getMSLevel() != 2)
+      {
+        continue;
+      }
+
+      if (query[j].getPrecursors().empty())
+      {
+        writeLog_("Warning MS2 spectrum without precursor information");
+        continue;
+      }
+
+      PeakSpectrum filtered_query;
+      if (!filterQuery_(query[j], filtered_query, remove_peaks_below_threshold, cut_peaks_below, min_peaks, max_peaks))
+      {
+        continue;
+      }
+
+      const int query_charge = query[j].getPrecursors()[0].getCharge();
+      if (query_charge > 0 && (query_charge < pc_min_charge || query_charge > pc_max_charge))
+      {
+        continue;
+      }
+
+      filtered_query.setPrecursors(query[j].getPrecursors());
+      filtered_query.setRT(query[j].getRT());
+      filtered_queries.push_back(std::move(filtered_query));
+      query_indices.push_back(j);
+    }
+
+    SpectralLibraryIndex::SearchParameters params;
+    params.precursor_mass_tolerance = precursor_mass_tolerance;
+    params.precursor_mass_tolerance_ppm = precursor_mass_tolerance_unit_ppm;
+    params.fragment_mass_tolerance = fragment_mass_tolerance;
+    params.fragment_mass_tolerance_ppm = fragment_mass_tolerance_unit_ppm;
+    params.isotopes = isotopes;
+    params.top_hits = top_hits == -1 ? 0 : (Size)top_hits;
+
+    vector<vector<SpectralLibraryIndex::Match> > results;
+    lib_index.search(filtered_queries, params, results);
+
+    for (Size q = 0; q < filtered_queries.size(); ++q)
+    {
+      PeptideIdentification pid;
+      pid.setIdentifier("test");
+      pid.setScoreType("NormalizedDotProduct");
+      pid.setHigherScoreBetter(true);
+      pid.setMZ(filtered_queries[q].getPrecursors()[0].getMZ());
+      pid.setRT(filtered_queries[q].getRT());
+      for (const SpectralLibraryIndex::Match& match : results[q])
+      {
+        const SpectralLibraryIndex::Entry& entry = lib_index.getEntry(match.entry_index);
+        // the library hit with its annotations, as copied by the linear search
+        PeptideHit hit = decodeLibraryHit_(lib_index.getLabel(match.entry_index).getString());
+        hit.setCharge(entry.charge);
+        hit.setMetaValue("lib:RT", entry.rt);
+        hit.setMetaValue("lib:MZ", entry.precursor_mz);
+        hit.setMetaValue(Constants::UserParam::ISOTOPE_ERROR, match.isotope);
+        hit.setScore(match.score);
+        PeptideEvidence pe;
+        pe.setProteinAccession(String(query_indices[q]));
+        hit.addPeptideEvidence(pe);
+        pid.insertHit(hit);
+      }
+      peptide_ids.push_back(pid);
+    }
+  }
+
+  /// compare each query spectrum with all library spectra in its precursor window using @p comparator
+  void searchLibraryLinear_(const PeakMap& query,
+    const MapLibraryPrecursorToLibrarySpectrum& mslib,
+    PeakSpectrumCompareFunctor& comparator,
+    const String& compare_function,
+    const IntList& isotopes,
+    int pc_min_charge,
+    int pc_max_charge,
+    double precursor_mass_tolerance,
+    bool precursor_mass_tolerance_unit_ppm,
+    int top_hits,
+    double remove_peaks_below_threshold,
+    Int cut_peaks_below,
+    UInt min_peaks,
+    UInt max_peaks,
+    ProteinIdentification& prot_id,
+    vector<PeptideIdentification>& peptide_ids)
+  {
+    double score;
+    for (UInt j = 0; j < query.size(); ++j)
+    {
+      //Set identifier for each identifications
+      PeptideIdentification pid;
+      pid.setIdentifier("test");
+      pid.setScoreType(compare_function);
+      ProteinHit pr_hit;
+      pr_hit.setAccession(j);
+      prot_id.insertHit(pr_hit);
+
+      // proper MS2?
+      if (query[j].empty() || query[j].getMSLevel() != 2)
+      {
+        continue;
+      }
+
+      if (query[j].getPrecursors().empty())
+      {
+        writeLog_("Warning MS2 spectrum without precursor information");
+        continue;
+      }
+
+      // filter query spectrum
+      PeakSpectrum filtered_query;
+      if (!filterQuery_(query[j], filtered_query, remove_peaks_below_threshold, cut_peaks_below, min_peaks, max_peaks))
+      { 
+        continue;
+      }
+
+      const double& query_rt = query[j].getRT();
+      const int& query_charge = query[j].getPrecursors()[0].getCharge();
+      const double query_mz = query[j].getPrecursors()[0].getMZ();
+
+      if (query_charge > 0 && (query_charge < pc_min_charge || query_charge > pc_max_charge))
+      { 
+        continue;
+      } 
+
+      for (auto const & iso : isotopes)
+      {
+        // isotopic misassignment corrected query
+        const double ic_query_mz = query_mz - iso * Constants::C13C12_MASSDIFF_U;
+
+        // if tolerance unit is ppm convert to m/z
+        const double precursor_mass_tolerance_mz = precursor_mass_tolerance_unit_ppm ? ic_query_mz * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance;
+
+        // skip matching of isotopic misassignments if charge not annotated
+        if (iso != 0 && query_charge == 0)
+        {
+          continue;
+        }
+
+        // skip matching of isotopic misassignments if search windows around isotopic peaks would overlap (resulting in more than one report of the same hit)
+        const double isotopic_peak_distance_mz = Constants::C13C12_MASSDIFF_U / query_charge;
+        if (iso != 0 && precursor_mass_tolerance_mz >= 0.5 * isotopic_peak_distance_mz)
+        { 
+          continue;
+        }
+
+        /* TODO: remove old code for charge estimation?
+        bool charge_one = false;
+        Int percent = (Int) Math::round((query[j].size() / 100.0) * 3.0);
+        Int margin  = (Int) Math::round((query[j].size() / 100.0) * 1.0);
+        for (vector<Peak1D>::iterator peak = query[j].end() - 1; percent >= 0; --peak, --percent)
+        {
+          if (peak->getMZ() < query_MZ)
+          {
+            break;
+          }
+        }
+        if (percent > margin)
+        {
+          charge_one = true;
+        }
+        */
+
+
+        // determine MS2 precursors that match to the current peptide mass
+        MapLibraryPrecursorToLibrarySpectrum::const_iterator low_it, up_it;
+
+        low_it = mslib.lower_bound(ic_query_mz - 0.5 * precursor_mass_tolerance_mz);
+        up_it = mslib.upper_bound(ic_query_mz + 0.5 * precursor_mass_tolerance_mz);
+
+        // no matching precursor in data
+        if (low_it == up_it)
+        { 
+          continue;
+        }
+
+        for (; low_it != up_it; ++low_it)
+        {
+          const PeakSpectrum& lib_spec = low_it->second;;
+          PeptideHit hit = lib_spec.getPeptideIdentifications()[0].getHits()[0];
+          const int& lib_charge = hit.getCharge();  
+
+          // check if charge state between library and experimental spectrum match
+          if (query_charge > 0 && lib_charge != query_charge)
+          {
+            continue;
+          }
+
+          // Special treatment for SpectraST score as it computes a score based on the whole library
+          if (compare_function == "SpectraSTSimilarityScore")
+          {
+            auto& sp = dynamic_cast<SpectraSTSimilarityScore&>(comparator);
+            BinnedSpectrum quer_bin_spec = sp.transform(filtered_query);
+            BinnedSpectrum lib_bin_spec = sp.transform(lib_spec);
+            score = sp(filtered_query, lib_spec); //(*sp)(quer_bin,librar_bin);
+            double dot_bias = sp.dot_bias(quer_bin_spec, lib_bin_spec, score);
+            hit.setMetaValue("DOTBIAS", dot_bias);
+          }
+          else
+          {
+            score = comparator(filtered_query, lib_spec);
+          }
+
+          DataValue RT(lib_spec.getRT());
+          DataValue MZ(lib_spec.getPrecursors()[0].getMZ());
+          hit.setMetaValue("lib:RT", RT);
+          hit.setMetaValue("lib:MZ", MZ);
+          hit.setMetaValue(Constants::UserParam::ISOTOPE_ERROR, iso);
+          hit.setScore(score);
+          PeptideEvidence pe;
+          pe.setProteinAccession(pr_hit.getAccession());
+          hit.addPeptideEvidence(pe);
+          pid.insertHit(hit);
+        }
+      }
+
+      pid.setHigherScoreBetter(true);
+      pid.sort();
+
+      if (compare_function == "SpectraSTSimilarityScore")
+      {
+        if (!pid.empty() && !pid.getHits().empty())
+        {
+          vector<PeptideHit> final_hits;
+          final_hits.resize(pid.getHits().size());
+          auto& sp = dynamic_cast<SpectraSTSimilarityScore&>(comparator);
+          Size runner_up = 1;
+          for (; runner_up < pid.getHits().size(); ++runner_up)
+          {
+            if (pid.getHits()[0].getSequence().toUnmodifiedString() != pid.getHits()[runner_up].getSequence().toUnmodifiedString() 
+             || runner_up > 5)
+            {
+              break;
+            }
+          }
+          double delta_D = sp.delta_D(pid.getHits()[0].getScore(), pid.getHits()[runner_up].getScore());
+          for (Size s = 0; s < pid.getHits().size(); ++s)
+          {
+            final_hits[s] = pid.getHits()[s];
+            final_hits[s].setMetaValue("delta D", delta_D);
+            final_hits[s].setMetaValue("dot product", pid.getHits()[s].getScore());
+            final_hits[s].setScore(sp.compute_F(pid.getHits()[s].getScore(), delta_D, pid.getHits()[s].getMetaValue("DOTBIAS")));
+          }
+          pid.setHits(final_hits);
+          pid.sort();
+          pid.setMZ(query[j].getPrecursors()[0].getMZ());
+          pid.setRT(query_rt);
+        }
+      }
+
+      if (top_hits != -1 && (UInt)top_hits < pid.getHits().size())
+      {
+        pid.getHits().resize(top_hits);
+      }
+      peptide_ids.push_back(pid);
+    }
+  }
+
   ExitCodes main_(int, const char**) override
   {
     //-------------------------------------------------------------
@@ -288,8 +732,10 @@ protected:
     // consider one before annotated monoisotopic peak and the annotated one
     IntList isotopes = getIntList_("precursor:isotopes");
    
-//    float fragment_mass_tolerance = getDoubleOption_("fragment:mass_tolerance");
-//    bool fragment_mass_tolerance_unit_ppm = getStringOption_("fragment:mass_tolerance_unit") == "ppm" ? true : false;
+    double fragment_mass_tolerance = getDoubleOption_("fragment:mass_tolerance");
+    bool fragment_mass_tolerance_unit_ppm = getStringOption_("fragment:mass_tolerance_unit") == "ppm" ? true : false;
+
+    String lib_index_file = getStringOption_("lib_index");
 
     int top_hits = getIntOption_("report:top_hits");
 
@@ -307,6 +753,13 @@ protected:
       return ILLEGAL_PARAMETERS;
     }
 
+    if (!lib_index_file.empty() && compare_function != "ZhangSimilarityScore")
+    {
+      writeLog_("compare_function '" + compare_function + "' is not supported with 'lib_index' (the index is always searched using the normalized dot product). "
+                "Remove 'lib_index' or use the default compare_function.");
+      return ILLEGAL_PARAMETERS;
+    }
+
     // -------------------------------------------------------------
     // loading input
     // -------------------------------------------------------------
@@ -331,7 +784,23 @@ protected:
 
     // library containing already identified peptide spectra
     vector<PeptideIdentification> ids;
-    spectral_library.load(in_lib, ids, library);
+    MapLibraryPrecursorToLibrarySpectrum mslib;
+    SpectralLibraryIndex lib_index;
+    if (!lib_index_file.empty())
+    {
+      // everything that changes the preprocessed library
+      String key = "checksum=" + FileHandler::computeFileHash(in_lib)
+        + ";remove_peaks_below_threshold=" + String(remove_peaks_below_threshold)
+        + ";fixed=" + ListUtils::concatenate(fixed_modifications, ",")
+        + ";variable=" + ListUtils::concatenate(variable_modifications, ",")
+        + ";labels=hit";
+      loadLibraryIndex_(lib_index_file, key, in_lib, variable_modifications, fixed_modifications, remove_peaks_below_threshold, lib_index);
+    }
+    else
+    {
+      spectral_library.load(in_lib, ids, library);
+      mslib = annotateIdentificationsToSpectra_(ids, library, variable_modifications, fixed_modifications, remove_peaks_below_threshold);
+    }
 
     /*
     // Output bin histogram
@@ -353,18 +822,16 @@ protected:
     cout << endl;
     */
 
-    MapLibraryPrecursorToLibrarySpectrum mslib = annotateIdentificationsToSpectra_(ids, library, variable_modifications, fixed_modifications, remove_peaks_below_threshold);
-
     time_t end_build_time = time(nullptr);
     OPENMS_LOG_INFO << "Time needed for preprocessing data: " << (end_build_time - start_build_time) << "\n";
 
     //compare function
     std::unique_ptr<PeakSpectrumCompareFunctor> comparator(Factory<PeakSpectrumCompareFunctor>::create(compare_function));
+    const String score_type = lib_index.isLoaded() ? String("NormalizedDotProduct") : compare_function;
  
    //-------------------------------------------------------------
     // calculations
     //-------------------------------------------------------------
-    double score;
     StringList::iterator in, out_file;
     for (in  = in_spec.begin(), out_file  = out.begin(); in < in_spec.end(); ++in, ++out_file)
     {
@@ -380,7 +847,7 @@ protected:
       prot_id.setIdentifier("test");
       prot_id.setSearchEngineVersion("SpecLibSearcher");
       prot_id.setDateTime(DateTime::now());
-      prot_id.setScoreType(compare_function);
+      prot_id.setScoreType(score_type);
 
       ProteinIdentification::SearchParameters search_parameters;
       search_parameters.db = getStringOption_("lib");
@@ -393,8 +860,11 @@ protected:
       // search_parameters.missed_cleavages = getIntOption_("peptide:missed_cleavages");
       search_parameters.precursor_mass_tolerance = getDoubleOption_("precursor:mass_tolerance");
       search_parameters.precursor_mass_tolerance_ppm = getStringOption_("precursor:mass_tolerance_unit") == "ppm" ? true : false;
-//      search_parameters.fragment_mass_tolerance = getDoubleOption_("fragment:mass_tolerance");
-//      search_parameters.fragment_mass_tolerance_ppm = getStringOption_("fragment:mass_tolerance_unit") == "ppm" ? true : false;
+      if (lib_index.isLoaded())
+      {
+        search_parameters.fragment_mass_tolerance = fragment_mass_tolerance;
+        search_parameters.fragment_mass_tolerance_ppm = fragment_mass_tolerance_unit_ppm;
+      }
 
 //TODO: report an Enzyme?
 
@@ -402,202 +872,16 @@ protected:
 
 
       /***********SEARCH**********/
-      for (UInt j = 0; j < query.size(); ++j)
+      if (lib_index.isLoaded())
       {
-        //Set identifier for each identifications
-        PeptideIdentification pid;
-        pid.setIdentifier("test");
-        pid.setScoreType(compare_function);
-        ProteinHit pr_hit;
-        pr_hit.setAccession(j);
-        prot_id.insertHit(pr_hit);
-
-        // proper MS2?
-        if (query[j].empty() || query[j].getMSLevel() != 2)
-        {
-          continue;
-        }
-
-        if (query[j].getPrecursors().empty())
-        {
-          writeLog_("Warning MS2 spectrum without precursor information");
-          continue;
-        }
-
-        // filter query spectrum
-        double max_intensity = std::max_element(query[j].begin(), query[j].end(), 
-                                [](const Peak1D& l, const Peak1D& r) 
-                                { 
-                                  return (l.getIntensity() < r.getIntensity()); 
-                                })->getIntensity();
-
-        double min_high_intensity = max_intensity / cut_peaks_below;
-
-        PeakSpectrum filtered_query;
-        for (UInt k = 0; k < query[j].size(); ++k)
-        {
-          if (query[j][k].getIntensity() >= remove_peaks_below_threshold 
-           && query[j][k].getIntensity() >= min_high_intensity)
-          {
-            Peak1D peak;
-            peak.setIntensity(sqrt(query[j][k].getIntensity()));
-            peak.setMZ(query[j][k].getMZ());
-            filtered_query.push_back(peak);
-          }
-        }
-
-        // retain only top N peaks
-        if (filtered_query.size() > max_peaks)
-        {
-          filtered_query.sortByIntensity(true);
-          filtered_query.resize(max_peaks);
-          filtered_query.sortByPosition();
-        }
-
-        if (filtered_query.size() < min_peaks)
-        { 
-          continue;
-        }
-
-        const double& query_rt = query[j].getRT();
-        const int& query_charge = query[j].getPrecursors()[0].getCharge();
-        const double query_mz = query[j].getPrecursors()[0].getMZ();
-        
-        if (query_charge > 0 && (query_charge < pc_min_charge || query_charge > pc_max_charge))
-        { 
-          continue;
-        } 
-
-        for (auto const & iso : isotopes)
-        {
-          // isotopic misassignment corrected query
-          const double ic_query_mz = query_mz - iso * Constants::C13C12_MASSDIFF_U;
-
-          // if tolerance unit is ppm convert to m/z
-          const double precursor_mass_tolerance_mz = precursor_mass_tolerance_unit_ppm ? ic_query_mz * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance;
-
-          // skip matching of isotopic misassignments if charge not annotated
-          if (iso != 0 && query_charge == 0)
-          {
-            continue;
-          }
-
-          // skip matching of isotopic misassignments if search windows around isotopic peaks would overlap (resulting in more than one report of the same hit)
-          const double isotopic_peak_distance_mz = Constants::C13C12_MASSDIFF_U / query_charge;
-          if (iso != 0 && precursor_mass_tolerance_mz >= 0.5 * isotopic_peak_distance_mz)
-          { 
-            continue;
-          }
-
-          /* TODO: remove old code for charge estimation?
-          bool charge_one = false;
-          Int percent = (Int) Math::round((query[j].size() / 100.0) * 3.0);
-          Int margin  = (Int) Math::round((query[j].size() / 100.0) * 1.0);
-          for (vector<Peak1D>::iterator peak = query[j].end() - 1; percent >= 0; --peak, --percent)
-          {
-            if (peak->getMZ() < query_MZ)
-            {
-              break;
-            }
-          }
-          if (percent > margin)
-          {
-            charge_one = true;
-          }
-          */
-
-
-          // determine MS2 precursors that match to the current peptide mass
-          MapLibraryPrecursorToLibrarySpectrum::const_iterator low_it, up_it;
-        
-          low_it = mslib.lower_bound(ic_query_mz - 0.5 * precursor_mass_tolerance_mz);
-          up_it = mslib.upper_bound(ic_query_mz + 0.5 * precursor_mass_tolerance_mz);
-        
-          // no matching precursor in data
-          if (low_it == up_it)
-          { 
-            continue;
-          }
-       
-          for (; low_it != up_it; ++low_it)
-          {
-            const PeakSpectrum& lib_spec = low_it->second;;
-            PeptideHit hit = lib_spec.getPeptideIdentifications()[0].getHits()[0];
-            const int& lib_charge = hit.getCharge();  
-
-            // check if charge state between library and experimental spectrum match
-            if (query_charge > 0 && lib_charge != query_charge)
-            {
-              continue;
-            }
-
-            // Special treatment for SpectraST score as it computes a score based on the whole library
-            if (compare_function == "SpectraSTSimilarityScore")
-            {
-              auto& sp = dynamic_cast<SpectraSTSimilarityScore&>(*comparator);
-              BinnedSpectrum quer_bin_spec = sp.transform(filtered_query);
-              BinnedSpectrum lib_bin_spec = sp.transform(lib_spec);
-              score = sp(filtered_query, lib_spec); //(*sp)(quer_bin,librar_bin);
-              double dot_bias = sp.dot_bias(quer_bin_spec, lib_bin_spec, score);
-              hit.setMetaValue("DOTBIAS", dot_bias);
-            }
-            else
-            {
-              score = (*comparator)(filtered_query, lib_spec);
-            }
-
-            DataValue RT(lib_spec.getRT());
-            DataValue MZ(lib_spec.getPrecursors()[0].getMZ());
-            hit.setMetaValue("lib:RT", RT);
-            hit.setMetaValue("lib:MZ", MZ);
-            hit.setMetaValue(Constants::UserParam::ISOTOPE_ERROR, iso);
-            hit.setScore(score);
-            PeptideEvidence pe;
-            pe.setProteinAccession(pr_hit.getAccession());
-            hit.addPeptideEvidence(pe);
-            pid.insertHit(hit);
-          }
-        }
-
-        pid.setHigherScoreBetter(true);
-        pid.sort();
-
-        if (compare_function == "SpectraSTSimilarityScore")
-        {
-          if (!pid.empty() && !pid.getHits().empty())
-          {
-            vector<PeptideHit> final_hits;
-            final_hits.resize(pid.getHits().size());
-            auto& sp = dynamic_cast<SpectraSTSimilarityScore&>(*comparator);
-            Size runner_up = 1;
-            for (; runner_up < pid.getHits().size(); ++runner_up)
-            {
-              if (pid.getHits()[0].getSequence().toUnmodifiedString() != pid.getHits()[runner_up].getSequence().toUnmodifiedString() 
-               || runner_up > 5)
-              {
-                break;
-              }
-            }
-            double delta_D = sp.delta_D(pid.getHits()[0].getScore(), pid.getHits()[runner_up].getScore());
-            for (Size s = 0; s < pid.getHits().size(); ++s)
-            {
-              final_hits[s] = pid.getHits()[s];
-              final_hits[s].setMetaValue("delta D", delta_D);
-              final_hits[s].setMetaValue("dot product", pid.getHits()[s].getScore());
-              final_hits[s].setScore(sp.compute_F(pid.getHits()[s].getScore(), delta_D, pid.getHits()[s].getMetaValue("DOTBIAS")));
-            }
-            pid.setHits(final_hits);
-            pid.sort();
-            pid.setMZ(query[j].getPrecursors()[0].getMZ());
-            pid.setRT(query_rt);
-          }
-        }
-
-        if (top_hits != -1 && (UInt)top_hits < pid.getHits().size())
-        {
-          pid.getHits().resize(top_hits);
-        }
-        peptide_ids.push_back(pid);
+        searchLibraryIndex_(query, lib_index, isotopes, pc_min_charge, pc_max_charge, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm,
+          fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, top_hits, remove_peaks_below_threshold, cut_peaks_below, min_peaks, max_peaks,
+          prot_id, peptide_ids);
+      }
+      else
+      {
+        searchLibraryLinear_(query, mslib, *comparator, compare_function, isotopes, pc_min_charge, pc_max_charge, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm,
+          top_hits, remove_peaks_below_threshold, cut_peaks_below, min_peaks, max_peaks, prot_id, peptide_ids);
       }
       protein_ids.push_back(prot_id);
 